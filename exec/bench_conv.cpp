@@ -0,0 +1,227 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * Compare the CPU convolution algorithms of ConvCell_Frame_Kernels
+ * (Direct and Im2col) for forward, backwardData and backwardFilter, per
+ * layer shape.
+*/
+
+#include <chrono>
+
+#include "N2D2.hpp"
+#include "Cell/ConvCell_Frame_Kernels.hpp"
+#include "third_party/half.hpp"
+#include "utils/ProgramOptions.hpp"
+#include "utils/Random.hpp"
+
+using namespace N2D2;
+
+struct LayerShape {
+    unsigned int width;
+    unsigned int height;
+    unsigned int nbChannels;
+    unsigned int nbOutputs;
+    unsigned int kernel;
+    unsigned int stride;
+    int padding;
+};
+
+template <class T>
+std::vector<double> benchmark(const LayerShape& shape,
+                              unsigned int batchSize,
+                              unsigned int nbIterations,
+                              ConvCell_Frame_Kernels::Algorithm algorithm)
+{
+    ConvCell_Frame_Kernels::Descriptor desc(
+        std::vector<unsigned int>({1U, 1U}),
+        std::vector<unsigned int>({shape.stride, shape.stride}),
+        std::vector<int>({shape.padding, shape.padding}),
+        std::vector<unsigned int>({1U, 1U}));
+    desc.algorithm = algorithm;
+
+    const unsigned int outputsWidth = (shape.width + 2 * shape.padding
+        - shape.kernel + shape.stride) / shape.stride;
+    const unsigned int outputsHeight = (shape.height + 2 * shape.padding
+        - shape.kernel + shape.stride) / shape.stride;
+
+    Tensor<T> inputs({shape.width, shape.height, shape.nbChannels,
+                      batchSize});
+    Tensor<T> synapses({shape.kernel, shape.kernel, shape.nbChannels,
+                        shape.nbOutputs});
+    Tensor<T> outputs({outputsWidth, outputsHeight, shape.nbOutputs,
+                       batchSize});
+    Tensor<T> diffSynapses({shape.kernel, shape.kernel, shape.nbChannels,
+                            shape.nbOutputs});
+    Tensor<T> diffOutputs({shape.width, shape.height, shape.nbChannels,
+                           batchSize});
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = T(Random::randUniform(-1.0, 1.0));
+
+    for (unsigned int index = 0; index < synapses.size(); ++index)
+        synapses(index) = T(Random::randUniform(-1.0, 1.0));
+
+    const T alpha(1.0);
+    const T beta(0.0);
+
+    // Forward, backwardData and backwardFilter timings, in ms
+    std::vector<double> timings(3, 0.0);
+
+    for (unsigned int iter = 0; iter <= nbIterations; ++iter) {
+        const std::chrono::high_resolution_clock::time_point t0
+            = std::chrono::high_resolution_clock::now();
+
+        ConvCell_Frame_Kernels::forward(&alpha, inputs, synapses, desc,
+                                        &beta, outputs);
+
+        const std::chrono::high_resolution_clock::time_point t1
+            = std::chrono::high_resolution_clock::now();
+
+        ConvCell_Frame_Kernels::backwardData(&alpha, synapses, outputs, desc,
+                                             &beta, diffOutputs);
+
+        const std::chrono::high_resolution_clock::time_point t2
+            = std::chrono::high_resolution_clock::now();
+
+        ConvCell_Frame_Kernels::backwardFilter(&alpha, inputs, outputs, desc,
+                                               &beta, diffSynapses);
+
+        const std::chrono::high_resolution_clock::time_point t3
+            = std::chrono::high_resolution_clock::now();
+
+        // First iteration is a warm-up
+        if (iter > 0) {
+            timings[0] += std::chrono::duration_cast
+                <std::chrono::duration<double, std::milli> >(t1 - t0).count();
+            timings[1] += std::chrono::duration_cast
+                <std::chrono::duration<double, std::milli> >(t2 - t1).count();
+            timings[2] += std::chrono::duration_cast
+                <std::chrono::duration<double, std::milli> >(t3 - t2).count();
+        }
+    }
+
+    for (unsigned int i = 0; i < timings.size(); ++i)
+        timings[i] /= nbIterations;
+
+    return timings;
+}
+
+template <class T>
+void benchmark(const std::vector<LayerShape>& shapes,
+               unsigned int batchSize,
+               unsigned int nbIterations)
+{
+    std::cout << "Layer (WxHxC -> O, KxK/S, P)      "
+        "    Direct [ms] (fwd/bwdData/bwdFilter)"
+        "    Im2col [ms] (fwd/bwdData/bwdFilter)    Speedup" << std::endl;
+
+    for (std::vector<LayerShape>::const_iterator it = shapes.begin(),
+        itEnd = shapes.end(); it != itEnd; ++it)
+    {
+        const std::vector<double> direct = benchmark<T>((*it), batchSize,
+            nbIterations, ConvCell_Frame_Kernels::Direct);
+        const std::vector<double> im2col = benchmark<T>((*it), batchSize,
+            nbIterations, ConvCell_Frame_Kernels::Im2col);
+
+        std::stringstream layerStr;
+        layerStr << (*it).width << "x" << (*it).height << "x"
+            << (*it).nbChannels << " -> " << (*it).nbOutputs << ", "
+            << (*it).kernel << "x" << (*it).kernel << "/" << (*it).stride
+            << ", " << (*it).padding;
+
+        const double directTotal = direct[0] + direct[1] + direct[2];
+        const double im2colTotal = im2col[0] + im2col[1] + im2col[2];
+
+        std::cout << std::setw(34) << std::left << layerStr.str()
+            << std::right << std::fixed << std::setprecision(2)
+            << std::setw(13) << direct[0] << std::setw(13) << direct[1]
+            << std::setw(13) << direct[2]
+            << std::setw(13) << im2col[0] << std::setw(13) << im2col[1]
+            << std::setw(13) << im2col[2]
+            << std::setw(10) << std::setprecision(1)
+            << (directTotal / im2colTotal) << "x" << std::endl;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    // Program command line options
+    ProgramOptions opts(argc, argv);
+    const unsigned int batchSize
+        = opts.parse("-batch", 8U, "batch size");
+    const unsigned int nbIterations
+        = opts.parse("-iter", 5U, 1U, "number of timed iterations");
+    const std::string dataType
+        = opts.parse<std::string>("-type", "float",
+                                  "data type (half, float or double)");
+    const std::string layer
+        = opts.parse<std::string>("-layer", "",
+            "benchmark a single layer, given as \"W,H,C,O,K,S,P\""
+            " (default: ResNet-18 convolution layers)");
+    opts.done();
+
+    std::vector<LayerShape> shapes;
+
+    if (!layer.empty()) {
+        std::string layerValues(layer);
+        std::replace(layerValues.begin(), layerValues.end(), ',', ' ');
+
+        std::stringstream layerStr(layerValues);
+        LayerShape shape;
+
+        if (!(layerStr >> shape.width >> shape.height >> shape.nbChannels
+            >> shape.nbOutputs >> shape.kernel >> shape.stride
+            >> shape.padding))
+        {
+            throw std::runtime_error("Unreadable layer shape: " + layer);
+        }
+
+        shapes.push_back(shape);
+    }
+    else {
+        // ResNet-18 convolution layers
+        const LayerShape resNet18[] = {
+            {224, 224, 3, 64, 7, 2, 3},
+            {56, 56, 64, 64, 3, 1, 1},
+            {56, 56, 64, 128, 3, 2, 1},
+            {28, 28, 128, 128, 3, 1, 1},
+            {56, 56, 64, 128, 1, 2, 0},
+            {28, 28, 128, 256, 3, 2, 1},
+            {14, 14, 256, 256, 3, 1, 1},
+            {14, 14, 256, 512, 3, 2, 1},
+            {7, 7, 512, 512, 3, 1, 1}};
+
+        shapes.assign(Utils::begin(resNet18), Utils::end(resNet18));
+    }
+
+    Random::mtSeed(0);
+
+    if (dataType == "half")
+        benchmark<half_float::half>(shapes, batchSize, nbIterations);
+    else if (dataType == "float")
+        benchmark<float>(shapes, batchSize, nbIterations);
+    else if (dataType == "double")
+        benchmark<double>(shapes, batchSize, nbIterations);
+    else
+        throw std::runtime_error("Unsupported data type: " + dataType);
+
+    return 0;
+}
@@ -0,0 +1,302 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * Scaling benchmark of the multi-process CPU data-parallel learning: the same
+ * fully-connected network is learned by 1 to N local processes, which average
+ * their gradients with RingAllReduce before each solver update (like with
+ * n2d2 -dp).
+*/
+
+#include <chrono>
+
+#ifndef WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "N2D2.hpp"
+#include "Database/Database.hpp"
+#include "DeepNet.hpp"
+#include "StimuliProvider.hpp"
+#include "Cell/FcCell_Frame.hpp"
+#include "Solver/Solver.hpp"
+#include "utils/ProgramOptions.hpp"
+#include "utils/Random.hpp"
+#include "utils/RingAllReduce.hpp"
+
+using namespace N2D2;
+
+struct BenchConfig {
+    unsigned int batchSize;
+    unsigned int nbIterations;
+    unsigned int nbInputs;
+    unsigned int width;
+    unsigned int depth;
+    unsigned int nbThreads;
+};
+
+void benchmarkRank(const BenchConfig& config,
+                   unsigned int rank,
+                   unsigned int nbProcesses,
+                   const std::string& address,
+                   double refStepTime)
+{
+#ifdef _OPENMP
+    omp_set_num_threads(config.nbThreads);
+#endif
+
+    std::shared_ptr<RingAllReduce> comm
+        = std::make_shared<RingAllReduce>(rank, nbProcesses, address);
+
+    if (nbProcesses > 1)
+        Solver::mGradientReduction = comm;
+
+    // Same initial free parameters on every rank
+    Network net(1U, false, false);
+    DeepNet deepNet(net);
+
+    std::shared_ptr<Database> database(new Database);
+    std::shared_ptr<StimuliProvider> sp(new StimuliProvider(*database,
+        {config.nbInputs, 1, 1}, config.batchSize, false));
+    deepNet.setDatabase(database);
+    deepNet.setStimuliProvider(sp);
+
+    std::vector<std::shared_ptr<FcCell> > cells;
+    std::size_t nbParameters = 0;
+
+    for (unsigned int l = 0; l <= config.depth; ++l) {
+        std::ostringstream nameStr;
+        nameStr << "fc" << l;
+
+        const unsigned int nbOutputs = (l < config.depth) ? config.width : 10;
+        cells.push_back(std::make_shared<FcCell_Frame<Float_T> >(deepNet,
+            nameStr.str(), nbOutputs));
+
+        deepNet.addCell(cells.back(), (l > 0)
+            ? std::vector<std::shared_ptr<Cell> >(1, cells[l - 1])
+            : std::vector<std::shared_ptr<Cell> >(1));
+
+        if (l > 0) {
+            cells.back()->addInput(cells[l - 1].get());
+            nbParameters += (std::size_t)(config.width + 1) * nbOutputs;
+        }
+        else {
+            cells.back()->addInput(*sp);
+            nbParameters += (std::size_t)(config.nbInputs + 1) * nbOutputs;
+        }
+    }
+
+    deepNet.initialize();
+
+    std::shared_ptr<Cell_Frame_Top> outputFrame
+        = std::dynamic_pointer_cast<Cell_Frame_Top>(cells.back());
+
+    // Each rank learns its own shard of the global batch
+    Random::mtSeed(1U + rank);
+
+    for (unsigned int index = 0; index < sp->getData().size(); ++index)
+        sp->getData()(index) = Random::randUniform(-1.0, 1.0);
+
+    Tensor<int> targets({1, 1, 1, config.batchSize});
+
+    for (unsigned int batchPos = 0; batchPos < config.batchSize; ++batchPos)
+        targets(batchPos) = Random::randUniform(0, 9);
+
+    double stepTime = 0.0;
+
+    for (unsigned int iter = 0; iter <= config.nbIterations; ++iter) {
+        comm->barrier();
+
+        const std::chrono::high_resolution_clock::time_point t0
+            = std::chrono::high_resolution_clock::now();
+
+        deepNet.propagate(false);
+        outputFrame->setOutputTarget(targets);
+        deepNet.backPropagate();
+        deepNet.update();
+
+        comm->barrier();
+
+        const std::chrono::high_resolution_clock::time_point t1
+            = std::chrono::high_resolution_clock::now();
+
+        // First iteration is a warm-up
+        if (iter > 0) {
+            stepTime += std::chrono::duration_cast
+                <std::chrono::duration<double, std::milli> >(t1 - t0).count();
+        }
+    }
+
+    stepTime /= config.nbIterations;
+
+    // Time of a single all-reduce of all the free parameters
+    std::vector<Float_T> gradients(nbParameters, Float_T(1.0));
+    double allReduceTime = 0.0;
+
+    for (unsigned int iter = 0; iter <= config.nbIterations; ++iter) {
+        comm->barrier();
+
+        const std::chrono::high_resolution_clock::time_point t0
+            = std::chrono::high_resolution_clock::now();
+
+        comm->allReduce(&gradients[0], gradients.size());
+
+        const std::chrono::high_resolution_clock::time_point t1
+            = std::chrono::high_resolution_clock::now();
+
+        if (iter > 0) {
+            allReduceTime += std::chrono::duration_cast
+                <std::chrono::duration<double, std::milli> >(t1 - t0).count();
+        }
+    }
+
+    allReduceTime /= config.nbIterations;
+
+    if (rank == 0) {
+        const double throughput = 1000.0 * nbProcesses * config.batchSize
+            / stepTime;
+        const double refThroughput = (refStepTime > 0.0)
+            ? 1000.0 * config.batchSize / refStepTime : throughput;
+
+        std::cout << std::setw(9) << nbProcesses
+            << std::fixed << std::setprecision(2)
+            << std::setw(14) << stepTime
+            << std::setw(16) << allReduceTime
+            << std::setw(20) << std::setprecision(1) << throughput
+            << std::setw(11) << std::setprecision(2)
+            << (throughput / refThroughput) << "x"
+            << std::setw(12) << std::setprecision(1)
+            << (100.0 * throughput / refThroughput / nbProcesses) << "%"
+            << std::endl;
+
+        // Communicate the reference step time to the launcher
+        std::ofstream refFile((address + ".step").c_str());
+        refFile << stepTime;
+    }
+}
+
+int main(int argc, char* argv[]) try
+{
+    // Program command line options
+    ProgramOptions opts(argc, argv);
+    const unsigned int maxProcesses
+        = opts.parse("-np", 4U, 1U, "max. number of processes");
+    BenchConfig config;
+    config.batchSize
+        = opts.parse("-batch", 32U, 1U, "batch size per process");
+    config.nbIterations
+        = opts.parse("-iter", 20U, 1U, "number of timed iterations");
+    config.nbInputs
+        = opts.parse("-inputs", 1024U, 1U, "number of network inputs");
+    config.width
+        = opts.parse("-width", 1024U, 1U, "number of outputs of the hidden "
+                                          "fully-connected layers");
+    config.depth
+        = opts.parse("-depth", 3U, 1U, "number of hidden layers");
+    const unsigned int nbThreads
+        = opts.parse("-threads", 0U, "number of OpenMP threads per process "
+                                     "(0 = cores / processes)");
+    opts.done();
+
+#ifdef WIN32
+    throw std::runtime_error("bench_dp is not supported on this platform");
+#else
+    const unsigned int nbCores = std::max(1L, sysconf(_SC_NPROCESSORS_ONLN));
+
+    std::ostringstream addressStr;
+    addressStr << "/tmp/n2d2_bench_dp_" << getpid();
+    const std::string address = addressStr.str();
+
+    std::cout << "Processes  Step [ms]  AllReduce [ms]"
+        "  Throughput [img/s]    Speedup  Efficiency" << std::endl;
+
+    double refStepTime = 0.0;
+
+    for (unsigned int nbProcesses = 1; nbProcesses <= maxProcesses;
+        ++nbProcesses)
+    {
+        config.nbThreads = (nbThreads > 0) ? nbThreads
+            : std::max(1U, nbCores / nbProcesses);
+
+        std::vector<pid_t> pids;
+
+        for (unsigned int rank = 0; rank < nbProcesses; ++rank) {
+            const pid_t pid = fork();
+
+            if (pid < 0)
+                throw std::runtime_error("Unable to fork benchmark process");
+            else if (pid == 0) {
+                int status = EXIT_SUCCESS;
+
+                try {
+                    benchmarkRank(config, rank, nbProcesses, address,
+                                  refStepTime);
+                }
+                catch (const std::exception& e) {
+                    std::cout << "Error (rank " << rank << "): " << e.what()
+                        << std::endl;
+                    status = EXIT_FAILURE;
+                }
+
+                std::cout.flush();
+                _exit(status);
+            }
+
+            pids.push_back(pid);
+        }
+
+        bool success = true;
+
+        for (std::vector<pid_t>::const_iterator it = pids.begin(),
+            itEnd = pids.end(); it != itEnd; ++it)
+        {
+            int status;
+
+            if (waitpid(*it, &status, 0) < 0 || !WIFEXITED(status)
+                || WEXITSTATUS(status) != EXIT_SUCCESS)
+            {
+                success = false;
+            }
+        }
+
+        if (!success)
+            throw std::runtime_error("Benchmark process failed");
+
+        if (nbProcesses == 1) {
+            std::ifstream refFile((address + ".step").c_str());
+
+            if (!(refFile >> refStepTime))
+                throw std::runtime_error("Missing reference step time");
+        }
+    }
+
+    std::remove((address + ".step").c_str());
+    return 0;
+#endif
+}
+catch (const std::exception& e)
+{
+    std::cout << "Error: " << e.what() << std::endl;
+    return 1;
+}
@@ -0,0 +1,204 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * Benchmark of the geometric fusion of the transformations
+ * (CompositeTransformation::setGeometricFusion()), on the transformations
+ * pipeline of the stimuli provider of a network INI file.
+ * The cacheable and on-the-fly transformations of a stimuli set are applied to
+ * the first stimuli of the database, sequentially and fused, with the same
+ * random draws. Reports the time per stimulus, the throughput, the speedup and
+ * the mean absolute difference between the fused and sequential frames.
+*/
+
+#include <chrono>
+
+#include "N2D2.hpp"
+#include "DeepNet.hpp"
+#include "StimuliProvider.hpp"
+#include "Generator/DeepNetGenerator.hpp"
+#include "utils/ProgramOptions.hpp"
+#include "utils/Random.hpp"
+
+using namespace N2D2;
+
+struct Stimulus {
+    cv::Mat data;
+    cv::Mat labels;
+    std::vector<std::shared_ptr<ROI> > labelsROI;
+};
+
+double benchmark(const std::vector<Stimulus>& stimuli,
+                 const CompositeTransformation& transformation,
+                 const CompositeTransformation& onTheFlyTransformation,
+                 bool geometricFusion,
+                 std::vector<cv::Mat>& frames)
+{
+    std::shared_ptr<CompositeTransformation> trans
+        = transformation.clone();
+    std::shared_ptr<CompositeTransformation> onTheFlyTrans
+        = onTheFlyTransformation.clone();
+
+    trans->setGeometricFusion(geometricFusion);
+    onTheFlyTrans->setGeometricFusion(geometricFusion);
+
+    frames.resize(stimuli.size());
+
+    // Same random draws for the sequential and fused transformations
+    Random::mtSeed(1U);
+
+    const std::chrono::high_resolution_clock::time_point startTime
+        = std::chrono::high_resolution_clock::now();
+
+    for (unsigned int i = 0; i < stimuli.size(); ++i) {
+        cv::Mat frame = stimuli[i].data.clone();
+        cv::Mat labels = stimuli[i].labels.clone();
+        std::vector<std::shared_ptr<ROI> > labelsROI;
+
+        for (std::vector<std::shared_ptr<ROI> >::const_iterator it
+             = stimuli[i].labelsROI.begin(),
+             itEnd = stimuli[i].labelsROI.end(); it != itEnd; ++it)
+        {
+            labelsROI.push_back((*it)->clone());
+        }
+
+        trans->apply(frame, labels, labelsROI, (int)i);
+        onTheFlyTrans->apply(frame, labels, labelsROI, (int)i);
+
+        frames[i] = frame;
+    }
+
+    return std::chrono::duration_cast<std::chrono::duration<double> >
+        (std::chrono::high_resolution_clock::now() - startTime).count();
+}
+
+int main(int argc, char* argv[]) try
+{
+    // Program command line options
+    ProgramOptions opts(argc, argv);
+    const Database::StimuliSet set
+        = opts.parse("-set", Database::Learn,
+                     "stimuli set of the transformations (Learn, "
+                     "Validation or Test)");
+    const unsigned int nbStimuli
+        = opts.parse("-stimuli", 100U, 1U, "number of stimuli");
+    const unsigned int nbRuns
+        = opts.parse("-runs", 3U, 1U, "number of runs per mode");
+    const std::string iniConfig
+        = opts.grab<std::string>("<net>",
+                                 "network config file (INI)");
+    opts.done();
+
+    Network net;
+    std::shared_ptr<DeepNet> deepNet
+        = DeepNetGenerator::generate(net, iniConfig);
+
+    std::shared_ptr<Database> database = deepNet->getDatabase();
+    std::shared_ptr<StimuliProvider> sp = deepNet->getStimuliProvider();
+
+    const unsigned int nbLoad = std::min(nbStimuli,
+                                         database->getNbStimuli(set));
+
+    if (nbLoad == 0) {
+        throw std::runtime_error("No stimulus found in the "
+                                 + Utils::toString(set) + " set");
+    }
+
+    std::vector<Stimulus> stimuli(nbLoad);
+
+    for (unsigned int index = 0; index < nbLoad; ++index) {
+        const Database::StimulusID id = database->getStimulusID(set, index);
+
+        stimuli[index].data = database->getStimulusData(id);
+        stimuli[index].labels = database->getStimulusLabelsData(id);
+        stimuli[index].labelsROI = database->getStimulusROIs(id);
+    }
+
+    const CompositeTransformation& transformation
+        = sp->getTransformation(set);
+    const CompositeTransformation& onTheFlyTransformation
+        = sp->getOnTheFlyTransformation(set);
+
+    std::cout << "Stimuli: " << stimuli.size() << ", transformations: "
+        << transformation.size() << " cacheable + "
+        << onTheFlyTransformation.size() << " on-the-fly" << std::endl;
+    std::cout << "Mode         Time [ms/stimulus]   Throughput [stimuli/s]"
+        "   Speedup   Mean abs. diff." << std::endl;
+
+    const char* modeNames[] = {"Sequential", "Fused"};
+    std::vector<cv::Mat> refFrames;
+    double refTime = 0.0;
+
+    for (unsigned int mode = 0; mode < 2; ++mode) {
+        std::vector<cv::Mat> frames;
+        double bestTime = 0.0;
+
+        for (unsigned int run = 0; run < nbRuns; ++run) {
+            const double time = benchmark(stimuli,
+                                          transformation,
+                                          onTheFlyTransformation,
+                                          (mode == 1),
+                                          frames);
+
+            if (run == 0 || time < bestTime)
+                bestTime = time;
+        }
+
+        double diff = 0.0;
+
+        if (mode == 0) {
+            refTime = bestTime;
+            refFrames.swap(frames);
+        }
+        else {
+            std::size_t nbValues = 0;
+
+            for (unsigned int i = 0; i < frames.size(); ++i) {
+                if (frames[i].size() != refFrames[i].size()
+                    || frames[i].type() != refFrames[i].type())
+                {
+                    throw std::runtime_error("Fused and sequential frames "
+                                             "differ in size or type");
+                }
+
+                diff += cv::norm(frames[i], refFrames[i], cv::NORM_L1);
+                nbValues += frames[i].total() * frames[i].channels();
+            }
+
+            diff /= nbValues;
+        }
+
+        std::cout << std::setw(13) << std::left << modeNames[mode]
+            << std::right << std::fixed << std::setprecision(3)
+            << std::setw(18) << (1.0e3 * bestTime / stimuli.size())
+            << std::setw(25) << std::setprecision(1)
+            << (stimuli.size() / bestTime)
+            << std::setw(10) << std::setprecision(2) << (refTime / bestTime)
+            << "x" << std::setw(17) << std::setprecision(3) << diff
+            << std::endl;
+    }
+
+    return 0;
+}
+catch (const std::exception& e)
+{
+    std::cout << "Error: " << e.what() << std::endl;
+    return 1;
+}
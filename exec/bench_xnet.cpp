@@ -0,0 +1,333 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * Benchmark of the events schedulers of the Xnet spike simulator
+ * (Network::PriorityQueue and Network::TimingWheel), on the event streams of
+ * an AER database (N-MNIST) or on synthetic Poisson event streams.
+ * The events are propagated through a layer of integrate-and-fire neurons with
+ * random synaptic delays, whose firing events are re-scheduled (and therefore
+ * discarded) at each threshold crossing, like in N2D2::NodeNeuron.
+*/
+
+#include <chrono>
+
+#include "N2D2.hpp"
+#include "Database/N_MNIST_Database.hpp"
+#include "Xnet/Network.hpp"
+#include "Xnet/Node.hpp"
+#include "Xnet/SpikeEvent.hpp"
+#include "utils/ProgramOptions.hpp"
+#include "utils/Random.hpp"
+
+using namespace N2D2;
+
+class BenchNeuron : public Node {
+public:
+    BenchNeuron(Network& net, double threshold, Time_T emitDelay)
+        : Node(net),
+          nbSpikes(0),
+          mThreshold(threshold),
+          mEmitDelay(emitDelay),
+          mIntegration(0.0),
+          mLastIntegration(0),
+          mEvent(NULL)
+    {
+    }
+    void incomingSpike(Node* /*origin*/,
+                       Time_T timestamp,
+                       EventType_T /*type*/)
+    {
+        const Time_T leak = 20 * TimeMs;
+
+        mIntegration = mIntegration
+            * std::exp(-((double)(timestamp - mLastIntegration)) / leak)
+            + 1.0;
+        mLastIntegration = timestamp;
+
+        if (mIntegration >= mThreshold) {
+            // The firing is postponed by each new threshold crossing
+            if (mEvent != NULL)
+                mEvent->discard();
+
+            mEvent = mNet.newEvent(this, NULL, timestamp + mEmitDelay, 0);
+        }
+    }
+    void emitSpike(Time_T /*timestamp*/, EventType_T /*type*/)
+    {
+        mEvent = NULL;
+        mIntegration = 0.0;
+        ++nbSpikes;
+    }
+    void notify(Time_T /*timestamp*/, NotifyType notify)
+    {
+        if (notify == Reset) {
+            mIntegration = 0.0;
+            mLastIntegration = 0;
+            mEvent = NULL;
+        }
+    }
+
+    unsigned long long int nbSpikes;
+
+private:
+    const double mThreshold;
+    const Time_T mEmitDelay;
+    double mIntegration;
+    Time_T mLastIntegration;
+    SpikeEvent* mEvent;
+};
+
+class BenchInput : public Node {
+public:
+    BenchInput(Network& net) : Node(net), nbSpikes(0)
+    {
+    }
+    void addBranch(Node* branch, Time_T delay)
+    {
+        mBranches.push_back(branch);
+        mDelays.push_back(delay);
+    }
+    void incomingSpike(Node* /*origin*/, Time_T timestamp, EventType_T type)
+    {
+        mNet.newEvent(this, NULL, timestamp, type);
+    }
+    void emitSpike(Time_T timestamp, EventType_T type)
+    {
+        for (unsigned int i = 0, size = mBranches.size(); i < size; ++i)
+            mNet.newEvent(this, mBranches[i], timestamp + mDelays[i], type);
+
+        ++nbSpikes;
+    }
+
+    unsigned long long int nbSpikes;
+
+private:
+    std::vector<Time_T> mDelays;
+};
+
+struct BenchResult {
+    double time;
+    unsigned long long int nbEvents;
+    unsigned long long int nbOutputSpikes;
+};
+
+BenchResult benchmark(const std::vector<std::vector<AerReadEvent> >& streams,
+                      Network::EventScheduler scheduler,
+                      Time_T resolution,
+                      unsigned int sizeX,
+                      unsigned int sizeY,
+                      unsigned int nbOutputs,
+                      unsigned int fanOut,
+                      Time_T maxDelay,
+                      double threshold)
+{
+    Network net(1U, false, false, scheduler, resolution);
+
+    std::vector<std::shared_ptr<BenchNeuron> > outputs;
+
+    for (unsigned int output = 0; output < nbOutputs; ++output) {
+        outputs.push_back(std::make_shared<BenchNeuron>(net, threshold,
+                                                        TimeUs));
+    }
+
+    // Same random connectivity for all the schedulers
+    Random::mtSeed(1U);
+    std::vector<std::shared_ptr<BenchInput> > inputs;
+
+    for (unsigned int input = 0; input < 2 * sizeX * sizeY; ++input) {
+        inputs.push_back(std::make_shared<BenchInput>(net));
+
+        for (unsigned int i = 0; i < fanOut; ++i) {
+            const unsigned int output = Random::randUniform(0, (int)nbOutputs - 1);
+            const Time_T delay = (Time_T)Random::randUniform(0.0,
+                                                             (double)maxDelay);
+
+            inputs.back()->addBranch(outputs[output].get(), delay);
+        }
+    }
+
+    const std::chrono::high_resolution_clock::time_point startTime
+        = std::chrono::high_resolution_clock::now();
+
+    for (std::vector<std::vector<AerReadEvent> >::const_iterator it
+         = streams.begin(), itEnd = streams.end(); it != itEnd; ++it)
+    {
+        net.reset();
+
+        for (std::vector<AerReadEvent>::const_iterator itEvent = (*it).begin(),
+             itEventEnd = (*it).end(); itEvent != itEventEnd; ++itEvent)
+        {
+            const unsigned int input = (*itEvent).x
+                + sizeX * ((*itEvent).y + sizeY * (*itEvent).channel);
+
+            if ((*itEvent).x < sizeX && (*itEvent).y < sizeY
+                && (*itEvent).channel < 2)
+            {
+                inputs[input]->incomingSpike(NULL,
+                                             (*itEvent).time * TimeUs,
+                                             (*itEvent).channel);
+            }
+        }
+
+        net.run();
+    }
+
+    BenchResult result;
+    result.time = std::chrono::duration_cast<std::chrono::duration<double> >
+        (std::chrono::high_resolution_clock::now() - startTime).count();
+    result.nbEvents = 0;
+    result.nbOutputSpikes = 0;
+
+    for (unsigned int input = 0; input < inputs.size(); ++input) {
+        // Input event + internal event + one event per synapse
+        result.nbEvents += inputs[input]->nbSpikes * (1 + fanOut);
+    }
+
+    for (unsigned int output = 0; output < nbOutputs; ++output) {
+        result.nbOutputSpikes += outputs[output]->nbSpikes;
+        result.nbEvents += outputs[output]->nbSpikes;
+    }
+
+    return result;
+}
+
+int main(int argc, char* argv[]) try
+{
+    // Program command line options
+    ProgramOptions opts(argc, argv);
+    const std::string dataPath
+        = opts.parse<std::string>("-db", N2D2_DATA("N-MNIST"),
+                                  "N-MNIST database path");
+    const unsigned int nbStimuli
+        = opts.parse("-stimuli", 100U, 1U, "number of stimuli (event streams)");
+    const bool synthetic
+        = opts.parse("-synthetic", "use synthetic Poisson event streams "
+                                   "instead of the database");
+    const unsigned int nbOutputs
+        = opts.parse("-outputs", 1000U, 1U, "number of output neurons");
+    const unsigned int fanOut
+        = opts.parse("-fanout", 32U, 1U, "number of synapses per input");
+    const double maxDelay
+        = opts.parse("-delay", 1000.0, "max. synaptic delay (in us)");
+    const double threshold
+        = opts.parse("-threshold", 4.0, "neurons threshold");
+    const double resolution
+        = opts.parse("-res", 1000.0, "timing wheel resolution (in ns)");
+    const unsigned int nbRuns
+        = opts.parse("-runs", 3U, 1U, "number of runs per scheduler");
+    opts.done();
+
+    const unsigned int sizeX = 34;
+    const unsigned int sizeY = 34;
+    std::vector<std::vector<AerReadEvent> > streams;
+
+    if (synthetic) {
+        // ~4,000 events per stimulus over 300 ms, like N-MNIST
+        Random::mtSeed(1U);
+
+        for (unsigned int id = 0; id < nbStimuli; ++id) {
+            std::vector<AerReadEvent> stream;
+            double time = 0.0;
+
+            while (time < 300000.0) {
+                time += Random::randExponential(75.0);
+
+                stream.push_back(AerReadEvent(Random::randUniform(0, (int)sizeX - 1),
+                                              Random::randUniform(0, (int)sizeY - 1),
+                                              Random::randUniform(0, 1),
+                                              0, 1, (Time_T)time));
+            }
+
+            streams.push_back(stream);
+        }
+    }
+    else {
+        N_MNIST_Database database;
+        database.load(dataPath);
+
+        const unsigned int nbLoad = std::min(nbStimuli,
+                                database.getNbStimuli(Database::Learn));
+
+        if (nbLoad == 0) {
+            throw std::runtime_error("No stimulus found in " + dataPath
+                                     + " (use -synthetic for synthetic "
+                                     "event streams)");
+        }
+
+        for (unsigned int id = 0; id < nbLoad; ++id) {
+            std::vector<AerReadEvent> stream;
+            database.loadAerStimulusData(stream, Database::Learn, id, 0);
+            streams.push_back(stream);
+        }
+    }
+
+    std::size_t nbInputEvents = 0;
+
+    for (unsigned int id = 0; id < streams.size(); ++id)
+        nbInputEvents += streams[id].size();
+
+    std::cout << "Stimuli: " << streams.size() << ", input events: "
+        << nbInputEvents << std::endl;
+    std::cout << "Scheduler        Time [s]   Events [M]   Throughput [Mev/s]"
+        "   Output spikes   Speedup" << std::endl;
+
+    const Network::EventScheduler schedulers[] = {Network::PriorityQueue,
+                                                  Network::TimingWheel};
+    const char* schedulerNames[] = {"PriorityQueue", "TimingWheel"};
+    double refTime = 0.0;
+
+    for (unsigned int s = 0; s < 2; ++s) {
+        BenchResult best = BenchResult();
+
+        for (unsigned int run = 0; run < nbRuns; ++run) {
+            const BenchResult result = benchmark(streams,
+                                                 schedulers[s],
+                                                 resolution * TimeNs,
+                                                 sizeX,
+                                                 sizeY,
+                                                 nbOutputs,
+                                                 fanOut,
+                                                 maxDelay * TimeUs,
+                                                 threshold);
+
+            if (run == 0 || result.time < best.time)
+                best = result;
+        }
+
+        if (s == 0)
+            refTime = best.time;
+
+        std::cout << std::setw(13) << std::left << schedulerNames[s]
+            << std::right << std::fixed << std::setprecision(3)
+            << std::setw(12) << best.time
+            << std::setw(13) << std::setprecision(2) << (best.nbEvents / 1.0e6)
+            << std::setw(21) << (best.nbEvents / 1.0e6 / best.time)
+            << std::setw(16) << best.nbOutputSpikes
+            << std::setw(9) << (refTime / best.time) << "x" << std::endl;
+    }
+
+    return 0;
+}
+catch (const std::exception& e)
+{
+    std::cout << "Error: " << e.what() << std::endl;
+    return 1;
+}
@@ -45,6 +45,9 @@
  * ./n2d2 $N2D2_MODELS/mnist-28x28-rbf.ini mnist -learn 6000000 -log 100000
 */
 #include <future>
+#ifndef WIN32
+#include <unistd.h>
+#endif
 
 #include "N2D2.hpp"
 #include "DeepNet.hpp"
@@ -77,6 +80,7 @@
 #include "Target/TargetMatching.hpp"
 #include "Transformation/RangeAffineTransformation.hpp"
 #include "utils/ProgramOptions.hpp"
+#include "utils/RingAllReduce.hpp"
 #include "Adversarial.hpp"
 #include "utils/Helper.hpp"
 
@@ -95,17 +99,44 @@ int main(int argc, char* argv[]) try
     signal(SIGINT, sigUsr1Handler);
 #endif
 
-    const Options opt(argc, argv);
+    Options opt(argc, argv);
+
+    // Data-parallel learning: spawn the processes and connect them in a ring
+    const std::shared_ptr<RingAllReduce> dataParallel
+        = initDataParallel(opt, argv);
+    const bool dataParallelWorker = (dataParallel
+                                     && dataParallel->getRank() > 0);
 
 #ifdef CUDA
     CudaContext::setDevice(cudaDevice);
 #endif
 
-    Network net(opt.seed);
+    Network net(opt.seed, !dataParallelWorker, true,
+                (opt.timingWheel) ? Network::TimingWheel
+                                  : Network::PriorityQueue);
+    net.setNbThreads(opt.simThreads);
     std::shared_ptr<DeepNet> deepNet
         = DeepNetGenerator::generate(net, opt.iniConfig);
     deepNet->initialize();
 
+    if (dataParallel) {
+        // Same initial free parameters everywhere, but each process draws
+        // its own learning batches
+        Random::mtSeed(opt.seed + dataParallel->getRank());
+
+        if (dataParallelWorker) {
+            // Keep the outputs of the other processes apart
+            std::ostringstream dirName;
+            dirName << "dp_rank" << dataParallel->getRank();
+            Utils::createDirectories(dirName.str());
+
+            if (chdir(dirName.str().c_str()) != 0) {
+                throw std::runtime_error("Unable to enter directory "
+                                         + dirName.str());
+            }
+        }
+    }
+
     if (opt.genConfig) {
         deepNet->saveNetworkParameters();
         std::exit(0);
@@ -229,6 +260,10 @@ int main(int argc, char* argv[]) try
         learn(opt, deepNet);
     }
 
+    // Only the rank 0 process continues after data-parallel learning
+    if (dataParallelWorker)
+        return 0;
+
     if (!afterCalibration) {
         if (opt.learn > 0) {
             // Reload best state after learning
@@ -0,0 +1,98 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * Pre-build offline the disk cache of pre-processed stimuli (CachePath
+ * parameter of the [sp] section), applying the CACHEABLE transformations to
+ * every stimulus of the selected sets in parallel.
+*/
+
+#include <chrono>
+
+#include "N2D2.hpp"
+#include "DeepNet.hpp"
+#include "StimuliProvider.hpp"
+#include "Generator/DeepNetGenerator.hpp"
+#include "utils/ProgramOptions.hpp"
+
+using namespace N2D2;
+
+int main(int argc, char* argv[])
+{
+    // Program command line options
+    ProgramOptions opts(argc, argv);
+    const Database::StimuliSetMask setMask
+        = opts.parse("-set", Database::All,
+                     "stimuli sets to cache (LearnOnly, ValidationOnly, "
+                     "TestOnly, NoLearn, NoValidation, NoTest or All)");
+    const std::string cachePath
+        = opts.parse<std::string>("-cache", "",
+                                  "cache path (default: CachePath of the INI "
+                                  "stimuli provider)");
+    const std::string iniConfig
+        = opts.grab<std::string>("<net>",
+                                 "network config file (INI)");
+    opts.done();
+
+    Network net;
+    std::shared_ptr<DeepNet> deepNet
+        = DeepNetGenerator::generate(net, iniConfig);
+
+    std::shared_ptr<Database> database = deepNet->getDatabase();
+    std::shared_ptr<StimuliProvider> sp = deepNet->getStimuliProvider();
+
+    if (!cachePath.empty())
+        sp->setCachePath(cachePath);
+
+    if (sp->getCachePath().empty()) {
+        std::cout << "No cache path: set CachePath in the stimuli provider "
+            "section or use the -cache option." << std::endl;
+        return 1;
+    }
+
+    const std::vector<Database::StimuliSet> stimuliSets
+        = database->getStimuliSets(setMask);
+
+    for (std::vector<Database::StimuliSet>::const_iterator it
+         = stimuliSets.begin(), itEnd = stimuliSets.end(); it != itEnd; ++it)
+    {
+        const Database::StimuliSet set = (*it);
+        const unsigned int nbStimuli = database->getNbStimuli(set);
+        unsigned int nbCached = 0;
+
+        const std::chrono::high_resolution_clock::time_point startTime
+            = std::chrono::high_resolution_clock::now();
+
+#pragma omp parallel for schedule(dynamic) reduction(+:nbCached)
+        for (int index = 0; index < (int)nbStimuli; ++index) {
+            if (sp->cacheStimulus(database->getStimulusID(set, index), set))
+                ++nbCached;
+        }
+
+        const std::chrono::duration<double> elapsed
+            = std::chrono::high_resolution_clock::now() - startTime;
+
+        std::cout << set << ": " << nbCached << " stimuli cached, "
+            << (nbStimuli - nbCached) << " already present ("
+            << elapsed.count() << " s)" << std::endl;
+    }
+
+    return 0;
+}
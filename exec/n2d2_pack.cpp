@@ -0,0 +1,80 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+/**
+ * Pack the stimuli of the [database] section of an INI file into sharded
+ * record files with an index, to be loaded with Packed_Database.
+*/
+
+#include <chrono>
+
+#include "N2D2.hpp"
+#include "Database/Packed_Database.hpp"
+#include "Generator/DatabaseGenerator.hpp"
+#include "utils/IniParser.hpp"
+#include "utils/ProgramOptions.hpp"
+
+using namespace N2D2;
+
+int main(int argc, char* argv[])
+{
+    // Program command line options
+    ProgramOptions opts(argc, argv);
+    const Database::StimuliSetMask setMask
+        = opts.parse("-set", Database::All,
+                     "stimuli sets to pack (LearnOnly, ValidationOnly, "
+                     "TestOnly, NoLearn, NoValidation, NoTest or All)");
+    const unsigned int shardSize
+        = opts.parse("-shard-size", 128U, "maximum size of a shard (in MiB)");
+    const bool compressed
+        = opts.parse("-compress", "store the 8 and 16 bits stimuli "
+                                  "PNG-encoded (lossless)");
+    const std::string iniFile
+        = opts.grab<std::string>("<net>",
+                                 "network config file (INI) with a "
+                                 "[database] section");
+    const std::string dataPath
+        = opts.grab<std::string>("<output>", "packed database directory");
+    opts.done();
+
+    IniParser iniConfig;
+    iniConfig.load(iniFile);
+
+    std::shared_ptr<Database> database
+        = DatabaseGenerator::generate(iniConfig, "database");
+
+    const std::chrono::high_resolution_clock::time_point startTime
+        = std::chrono::high_resolution_clock::now();
+
+    Packed_Database::pack(*database, dataPath, setMask,
+                          shardSize * 1024ULL * 1024ULL, compressed);
+
+    const std::chrono::duration<double> elapsed
+        = std::chrono::high_resolution_clock::now() - startTime;
+
+    Packed_Database packed;
+    packed.load(dataPath);
+
+    std::cout << packed.getNbStimuli() << " stimuli packed in "
+        << packed.getNbShards() << " shard(s) (" << elapsed.count() << " s)"
+        << std::endl;
+
+    return 0;
+}
@@ -10,6 +10,7 @@
 #ifndef N2D2_NETWORK_HPP
 #define N2D2_NETWORK_HPP
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstdint>
@@ -20,6 +21,9 @@
 #include <chrono>
 #include <map>
 #include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "typedefs.h" // old C header, deprecated
 #include "typedefs.hpp"
@@ -38,6 +42,26 @@
 #endif
 #define N2D2_SECTION_ATTRIBUTE(sec) __attribute__((section(sec)))
 
+#include "simd.hpp"
+
+/**
+ * Split of the convolution and fully-connected layers between the OpenMP
+ * threads, for the layers of at least N2D2_OUTPUT_CHANNEL_SPLIT_MIN_MACS MACs
+ * per output position. The convolutions are split by output rows, or by output
+ * channels when their input and output memory overlap. Disabled for the layers
+ * with packed (< 8 bits) outputs.
+*/
+#ifndef N2D2_OUTPUT_CHANNEL_SPLIT
+#ifdef _OPENMP
+#define N2D2_OUTPUT_CHANNEL_SPLIT 1
+#else
+#define N2D2_OUTPUT_CHANNEL_SPLIT 0
+#endif
+#endif
+#ifndef N2D2_OUTPUT_CHANNEL_SPLIT_MIN_MACS
+#define N2D2_OUTPUT_CHANNEL_SPLIT_MIN_MACS 32768
+#endif
+
 namespace N2D2 {
 
 class Network {
@@ -60,6 +84,23 @@ public:
     template<typename Input_T, typename Output_T>
     void propagate(const Input_T* inputs, Output_T* outputs) const;
 
+    /**
+     * Batched propagation: each layer is computed for all the batch positions
+     * before the next layer, so that its weights are loaded only once for the
+     * whole batch. The batch positions are distributed between the OpenMP
+     * threads.
+     *
+     * inputs[batchSize*inputSize()]
+     * outputs[batchSize*OUTPUTS_SIZE[0]]
+     * workspace[batchSize*memorySize()], aligned on MEMORY_ALIGNMENT
+    */
+    template<typename Input_T, typename Output_T>
+    void propagate(const Input_T* inputs, Output_T* outputs,
+                   std::size_t batchSize, uint8_t* workspace) const;
+
+    /// Size in bytes of the intermediate buffers of one batch position
+    std::size_t memorySize() const;
+
     std::size_t inputHeight() const;
     std::size_t inputWidth() const;
     std::size_t inputNbChannels() const;
@@ -70,7 +111,32 @@ public:
     std::size_t outputNbOutputs(std::size_t index = 0) const;
     std::size_t outputSize(std::size_t index = 0) const;
 
+    /**
+     * Per layer timing, only available when compiled with -DBENCHMARK.
+     * The timing of each layer is printed at each propagation if verbose.
+    */
+    void setBenchmarkVerbose(bool verbose) {
+        mBenchmarkVerbose = verbose;
+    }
+    const std::vector<std::pair<std::string, RunningMean_T> >&
+        getLayersTiming() const
+    {
+        return mLayersTiming;
+    }
+    void clearLayersTiming() const {
+        mLayersTiming.clear();
+    }
+
 private:
+    /// True if the memory ranges [offset1, offset1 + size1) and
+    /// [offset2, offset2 + size2) overlap
+    static constexpr bool rangesOverlap(int offset1, int size1,
+                                        int offset2, int size2)
+    {
+        return (size1 > 0 && size2 > 0
+            && offset1 < offset2 + size2 && offset2 < offset1 + size1);
+    }
+
     template<// For all inputs
             int NB_INPUTS,
             int CHANNELS_HEIGHT, int CHANNELS_WIDTH,
@@ -352,6 +418,8 @@ private:
 
 private:
     mutable std::map<std::string, double> cumulativeTiming;
+    mutable std::vector<std::pair<std::string, RunningMean_T> > mLayersTiming;
+    bool mBenchmarkVerbose = true;
 
     template<typename Output_T>
     N2D2_ALWAYS_INLINE void concatenate(
@@ -1473,7 +1541,9 @@ private:
              typename Weight_T, typename Bias_T,
              class Input_T,
              typename std::enable_if<(std::numeric_limits<Weight_T>::digits >= 8
-                && std::numeric_limits<Input_T>::digits >= 8)>::type* = nullptr>
+                && std::numeric_limits<Input_T>::digits >= 8
+                && !Simd::UseDot<NB_ITERATIONS, INPUTS_INC, WEIGHTS_INC,
+                                 Input_T, Weight_T, Bias_T>::value)>::type* = nullptr>
     N2D2_ALWAYS_INLINE static void macsOnRange(const Input_T* __restrict inputs,
                                                const Weight_T* __restrict weights,
                                                Bias_T& __restrict weightedSum)
@@ -1483,6 +1553,29 @@ private:
         }
     }
 
+    // Contiguous ranges: vectorized micro-kernels (see simd.hpp)
+    template<int NB_ITERATIONS,
+             int INPUTS_INC = 1,
+             int WEIGHTS_INC = 1,
+             typename Weight_T, typename Bias_T,
+             class Input_T,
+             typename std::enable_if<(std::numeric_limits<Weight_T>::digits >= 8
+                && std::numeric_limits<Input_T>::digits >= 8
+                && Simd::UseDot<NB_ITERATIONS, INPUTS_INC, WEIGHTS_INC,
+                                Input_T, Weight_T, Bias_T>::value)>::type* = nullptr>
+    N2D2_ALWAYS_INLINE static void macsOnRange(const Input_T* __restrict inputs,
+                                               const Weight_T* __restrict weights,
+                                               Bias_T& __restrict weightedSum)
+    {
+        typedef typename Simd::Raw<Input_T>::type RawInput_T;
+        typedef typename Simd::Raw<Weight_T>::type RawWeight_T;
+
+        weightedSum += Simd::Dot<RawInput_T, RawWeight_T, Bias_T>::run(
+            reinterpret_cast<const RawInput_T*>(inputs),
+            reinterpret_cast<const RawWeight_T*>(weights),
+            NB_ITERATIONS);
+    }
+
     /***************************************************************************************
     **************************************PACK_ACTIVATIONS**********************************
     ***************************************************************************************/
@@ -1844,7 +1937,20 @@ N2D2_ALWAYS_INLINE inline void N2D2::Network::convcellPropagate(
     constexpr int OUTPUTS_WIDTH_NOPAD
         = (CHANNELS_WIDTH - KERNEL_WIDTH + STRIDE_X) / STRIDE_X;
 
-    for (int oy = 0; oy < OUTPUTS_HEIGHT; ++oy) {
+    // With memory wrapping or in-place computation, the outputs may reuse the
+    // memory of the inputs of the previous output positions, which must then
+    // be computed in order
+    constexpr bool MEM_OVERLAP
+        = rangesOverlap(INPUT_MEM_CONT_OFFSET, INPUT_MEM_CONT_SIZE,
+                        OUTPUT_MEM_CONT_OFFSET, OUTPUT_MEM_CONT_SIZE)
+        || rangesOverlap(INPUT_MEM_CONT_OFFSET, INPUT_MEM_CONT_SIZE,
+                         OUTPUT_MEM_WRAP_OFFSET, OUTPUT_MEM_WRAP_SIZE)
+        || rangesOverlap(INPUT_MEM_WRAP_OFFSET, INPUT_MEM_WRAP_SIZE,
+                         OUTPUT_MEM_CONT_OFFSET, OUTPUT_MEM_CONT_SIZE)
+        || rangesOverlap(INPUT_MEM_WRAP_OFFSET, INPUT_MEM_WRAP_SIZE,
+                         OUTPUT_MEM_WRAP_OFFSET, OUTPUT_MEM_WRAP_SIZE);
+
+    const auto propagateOutput = [&](int oy, int ox, int output) {
         const int syMin = (PADDING_Y == 0) ? 0
             : max(PADDING_Y - (oy * STRIDE_Y), 0);
         const int syMax = (PADDING_Y == 0
@@ -1853,134 +1959,169 @@ N2D2_ALWAYS_INLINE inline void N2D2::Network::convcellPropagate(
                     0, KERNEL_HEIGHT);
         const int iy = (oy * STRIDE_Y) - PADDING_Y;
 
-//#pragma omp parallel for collapse(2)
-        for (int ox = 0; ox < OUTPUTS_WIDTH; ++ox) {
-            for (int output = 0; output < NB_OUTPUTS; ++output) {
-                // moved to inner loop for collapsing -->
-                const int sxMin = (PADDING_X == 0) ? 0
-                    : max(PADDING_X - (ox * STRIDE_X), 0);
-                const int sxMax = (PADDING_X == 0
-                        && OUTPUTS_WIDTH == OUTPUTS_WIDTH_NOPAD)
-                            ? KERNEL_WIDTH
-                    : clamp(CHANNELS_WIDTH + PADDING_X - (ox * STRIDE_X), 
-                            0, KERNEL_WIDTH);
-                const int ix = (ox * STRIDE_X) - PADDING_X;
+        // moved to inner loop for collapsing -->
+        const int sxMin = (PADDING_X == 0) ? 0
+            : max(PADDING_X - (ox * STRIDE_X), 0);
+        const int sxMax = (PADDING_X == 0
+                && OUTPUTS_WIDTH == OUTPUTS_WIDTH_NOPAD)
+                    ? KERNEL_WIDTH
+            : clamp(CHANNELS_WIDTH + PADDING_X - (ox * STRIDE_X), 
+                    0, KERNEL_WIDTH);
+        const int ix = (ox * STRIDE_X) - PADDING_X;
+
+        const int oPos = (ox + OUTPUTS_WIDTH * oy);
+        int oOffset = OUTPUT_MEM_STRIDE * oPos;
+
+        if (OUTPUT_MEM_WRAP_SIZE > 0 && oOffset >= OUTPUT_MEM_CONT_SIZE) {
+            oOffset += OUTPUT_MEM_WRAP_OFFSET - OUTPUT_MEM_CONT_OFFSET
+                        - OUTPUT_MEM_CONT_SIZE;
+        }
+        // <--
+        Bias_T weightedSum = biasses[output];
 
-                const int oPos = (ox + OUTPUTS_WIDTH * oy);
-                int oOffset = OUTPUT_MEM_STRIDE * oPos;
+        for (int sy = 0; sy < KERNEL_HEIGHT; ++sy) {
 
-                if (OUTPUT_MEM_WRAP_SIZE > 0 && oOffset >= OUTPUT_MEM_CONT_SIZE) {
-                    oOffset += OUTPUT_MEM_WRAP_OFFSET - OUTPUT_MEM_CONT_OFFSET
-                                - OUTPUT_MEM_CONT_SIZE;
-                }
-                // <--
-                Bias_T weightedSum = biasses[output];
+            if ((PADDING_Y != 0
+                    || OUTPUTS_HEIGHT != OUTPUTS_HEIGHT_NOPAD)
+                && sy >= syMax - syMin)
+            {
+                break;
+            }
 
-                for (int sy = 0; sy < KERNEL_HEIGHT; ++sy) {
+            const int iPos = ((sxMin + ix)
+                                + CHANNELS_WIDTH * (iy + syMin + sy));
+            //int iOffset = NB_INPUT_COMPACT * iPos;
+            int iOffset = INPUT_MEM_STRIDE * iPos;
 
-                    if ((PADDING_Y != 0
-                            || OUTPUTS_HEIGHT != OUTPUTS_HEIGHT_NOPAD)
-                        && sy >= syMax - syMin)
+            // Wrapping cannot occur in the middle of a line, except if
+            // there is only one line (1D)!
+            bool wrapInRange = false;
+
+            if (INPUT_MEM_WRAP_SIZE > 0
+                && iOffset >= INPUT_MEM_CONT_SIZE)
+            {
+                iOffset += INPUT_MEM_WRAP_OFFSET - INPUT_MEM_CONT_OFFSET
+                            - INPUT_MEM_CONT_SIZE;
+            }
+            else if (INPUT_MEM_WRAP_SIZE > 0 && KERNEL_WIDTH > 1
+                && CHANNELS_HEIGHT == 1 // single line (1D)!
+                && iOffset + KERNEL_WIDTH * NB_CHANNELS
+                    > INPUT_MEM_CONT_SIZE)
+            {
+                wrapInRange = true;
+            }
+
+            constexpr int NB_CHANNELS_BYTES
+                = ((NB_CHANNELS * std::numeric_limits<Weight_T>::digits)
+                    + (NB_CHANNELS * std::numeric_limits<Weight_T>::digits)
+                        % 8) / 8;
+            constexpr int W_BYTES = ((std::numeric_limits<Weight_T>::digits < 8)
+                    ? NB_CHANNELS_BYTES : NB_CHANNELS);
+            const int wOffset = W_BYTES * (sxMin
+                + KERNEL_WIDTH * (syMin + sy + KERNEL_HEIGHT * output));
+
+            //if (!wrapInRange && (NB_CHANNELS == INPUT_MEM_STRIDE
+            if (!wrapInRange && (NB_CHANNELS == NB_INPUT_COMPACT
+                && ((PADDING_X == 0
+                    && OUTPUTS_WIDTH == OUTPUTS_WIDTH_NOPAD)
+                        || sxMax - sxMin == KERNEL_WIDTH)) && ((NB_CHANNELS*std::numeric_limits<Weight_T>::digits)%8 == 0)
+                        && ((NB_CHANNELS*std::numeric_limits<Input_T>::digits)%8 == 0))
+            {
+                    macsOnRange<KERNEL_WIDTH * NB_CHANNELS>(
+                        (Input_T*)((uint8_t*)inputs + iOffset),
+                        weights + wOffset,
+                        weightedSum);
+            }
+            else {
+                for (int sx = 0; sx < KERNEL_WIDTH; ++sx) {
+                    if ((PADDING_X != 0
+                            || OUTPUTS_WIDTH != OUTPUTS_WIDTH_NOPAD)
+                        && sx >= sxMax - sxMin)
                     {
                         break;
                     }
 
-                    const int iPos = ((sxMin + ix)
-                                        + CHANNELS_WIDTH * (iy + syMin + sy));
-                    //int iOffset = NB_INPUT_COMPACT * iPos;
-                    int iOffset = INPUT_MEM_STRIDE * iPos;
+                    int iOffsetInRange = iOffset
+                        + sx * INPUT_MEM_STRIDE;
 
-                    // Wrapping cannot occur in the middle of a line, except if
-                    // there is only one line (1D)!
-                    bool wrapInRange = false;
-
-                    if (INPUT_MEM_WRAP_SIZE > 0
-                        && iOffset >= INPUT_MEM_CONT_SIZE)
-                    {
-                        iOffset += INPUT_MEM_WRAP_OFFSET - INPUT_MEM_CONT_OFFSET
-                                    - INPUT_MEM_CONT_SIZE;
-                    }
-                    else if (INPUT_MEM_WRAP_SIZE > 0 && KERNEL_WIDTH > 1
-                        && CHANNELS_HEIGHT == 1 // single line (1D)!
-                        && iOffset + KERNEL_WIDTH * NB_CHANNELS
-                            > INPUT_MEM_CONT_SIZE)
-                    {
-                        wrapInRange = true;
+                    /*
+                    if(std::numeric_limits<Input_T>::digits < 8){
+                        //if(output == 0 && std::numeric_limits<Input_T>::digits == 4) std::cout << "std::numeric_limits<Input_T>::digits>0" << std::flush;
+                        iOffsetInRange = iOffset
+                        + sx * NB_INPUT_COMPACT;
                     }
+                    */
 
-                    constexpr int NB_CHANNELS_BYTES
-                        = ((NB_CHANNELS * std::numeric_limits<Weight_T>::digits)
-                            + (NB_CHANNELS * std::numeric_limits<Weight_T>::digits)
-                                % 8) / 8;
-                    constexpr int W_BYTES = ((std::numeric_limits<Weight_T>::digits < 8)
-                            ? NB_CHANNELS_BYTES : NB_CHANNELS);
-                    const int wOffset = W_BYTES * (sxMin
-                        + KERNEL_WIDTH * (syMin + sy + KERNEL_HEIGHT * output));
-
-                    //if (!wrapInRange && (NB_CHANNELS == INPUT_MEM_STRIDE
-                    if (!wrapInRange && (NB_CHANNELS == NB_INPUT_COMPACT
-                        && ((PADDING_X == 0
-                            && OUTPUTS_WIDTH == OUTPUTS_WIDTH_NOPAD)
-                                || sxMax - sxMin == KERNEL_WIDTH)) && ((NB_CHANNELS*std::numeric_limits<Weight_T>::digits)%8 == 0)
-                                && ((NB_CHANNELS*std::numeric_limits<Input_T>::digits)%8 == 0))
+                    if (wrapInRange
+                        && iOffsetInRange >= INPUT_MEM_CONT_SIZE)
                     {
-                            macsOnRange<KERNEL_WIDTH * NB_CHANNELS>(
-                                (Input_T*)((uint8_t*)inputs + iOffset),
-                                weights + wOffset,
-                                weightedSum);
+                        iOffsetInRange += INPUT_MEM_WRAP_OFFSET
+                                    - INPUT_MEM_CONT_OFFSET
+                                    - INPUT_MEM_CONT_SIZE;
                     }
-                    else {
-                        for (int sx = 0; sx < KERNEL_WIDTH; ++sx) {
-                            if ((PADDING_X != 0
-                                    || OUTPUTS_WIDTH != OUTPUTS_WIDTH_NOPAD)
-                                && sx >= sxMax - sxMin)
-                            {
-                                break;
-                            }
 
-                            int iOffsetInRange = iOffset
-                                + sx * INPUT_MEM_STRIDE;
-
-                            /*
-                            if(std::numeric_limits<Input_T>::digits < 8){
-                                //if(output == 0 && std::numeric_limits<Input_T>::digits == 4) std::cout << "std::numeric_limits<Input_T>::digits>0" << std::flush;
-                                iOffsetInRange = iOffset
-                                + sx * NB_INPUT_COMPACT;
-                            }
-                            */
+                    macsOnRange<NB_CHANNELS>(
+                        // same input line so no wrapping can occur
+                        (Input_T*)((uint8_t*)inputs + iOffsetInRange), 
+                        weights + wOffset + sx * W_BYTES,
+                        weightedSum);
+                }
+            }
+        }
+       if(std::numeric_limits<Output_T>::digits < 8) {
+            int32_t output_val
+                = sat<Output_T>(weightedSum, output, ACTIVATION, rescaling);
 
-                            if (wrapInRange
-                                && iOffsetInRange >= INPUT_MEM_CONT_SIZE)
-                            {
-                                iOffsetInRange += INPUT_MEM_WRAP_OFFSET
-                                            - INPUT_MEM_CONT_OFFSET
-                                            - INPUT_MEM_CONT_SIZE;
-                            }
+            unsigned int nbSlot = ceil((double)8/std::numeric_limits<Output_T>::digits);
+            outputOffset = oOffset + std::floor(output/nbSlot);
+            compact_data_during_loop(output_val, outputs, &outputOffset, &infoPack);
+       }
+       else{
+        ((Output_T*)((uint8_t*)outputs + oOffset))[output]
+            = sat<Output_T>(weightedSum, output, ACTIVATION, rescaling);
+       }
+    };
 
-                            macsOnRange<NB_CHANNELS>(
-                                // same input line so no wrapping can occur
-                                (Input_T*)((uint8_t*)inputs + iOffsetInRange), 
-                                weights + wOffset + sx * W_BYTES,
-                                weightedSum);
-                        }
+#if N2D2_OUTPUT_CHANNEL_SPLIT
+#pragma omp parallel if (std::numeric_limits<Output_T>::digits >= 8 \
+        && NB_OUTPUTS * KERNEL_HEIGHT * KERNEL_WIDTH * NB_CHANNELS \
+            >= N2D2_OUTPUT_CHANNEL_SPLIT_MIN_MACS)
+#endif
+    {
+        if (!MEM_OVERLAP) {
+#if N2D2_OUTPUT_CHANNEL_SPLIT
+            // Output rows split, without synchronization
+#pragma omp for schedule(static)
+#endif
+            for (int oy = 0; oy < OUTPUTS_HEIGHT; ++oy) {
+                for (int ox = 0; ox < OUTPUTS_WIDTH; ++ox) {
+                    for (int output = 0; output < NB_OUTPUTS; ++output)
+                        propagateOutput(oy, ox, output);
+
+                    if (std::numeric_limits<Output_T>::digits < 8) {
+                        compact_data_end_loop(outputs, &outputOffset,
+                                              &infoPack);
                     }
                 }
-               if(std::numeric_limits<Output_T>::digits < 8) {
-                    int32_t output_val
-                        = sat<Output_T>(weightedSum, output, ACTIVATION, rescaling);
-
-                    unsigned int nbSlot = ceil((double)8/std::numeric_limits<Output_T>::digits);
-                    outputOffset = oOffset + std::floor(output/nbSlot);
-                    compact_data_during_loop(output_val, outputs, &outputOffset, &infoPack);
-               }
-               else{
-                ((Output_T*)((uint8_t*)outputs + oOffset))[output]
-                    = sat<Output_T>(weightedSum, output, ACTIVATION, rescaling);
-               }
             }
+        }
+        else {
+            for (int oy = 0; oy < OUTPUTS_HEIGHT; ++oy) {
+                for (int ox = 0; ox < OUTPUTS_WIDTH; ++ox) {
+#if N2D2_OUTPUT_CHANNEL_SPLIT
+                    // Output channels split, with an implicit barrier for
+                    // each output position
+#pragma omp for schedule(static)
+#endif
+                    for (int output = 0; output < NB_OUTPUTS; ++output)
+                        propagateOutput(oy, ox, output);
 
-            if(std::numeric_limits<Output_T>::digits < 8)
-                compact_data_end_loop(outputs, &outputOffset, &infoPack);
+                    if (std::numeric_limits<Output_T>::digits < 8) {
+                        compact_data_end_loop(outputs, &outputOffset,
+                                              &infoPack);
+                    }
+                }
+            }
         }
     }
 }
@@ -2025,7 +2166,20 @@ N2D2_ALWAYS_INLINE inline void N2D2::Network::convcellDWPropagate(
     constexpr int OUTPUTS_WIDTH_NOPAD
         = (CHANNELS_WIDTH - KERNEL_WIDTH + STRIDE_X) / STRIDE_X;
 
-    for (int oy = 0; oy < OUTPUTS_HEIGHT; ++oy) {
+    // With memory wrapping or in-place computation, the outputs may reuse the
+    // memory of the inputs of the previous output positions, which must then
+    // be computed in order
+    constexpr bool MEM_OVERLAP
+        = rangesOverlap(INPUT_MEM_CONT_OFFSET, INPUT_MEM_CONT_SIZE,
+                        OUTPUT_MEM_CONT_OFFSET, OUTPUT_MEM_CONT_SIZE)
+        || rangesOverlap(INPUT_MEM_CONT_OFFSET, INPUT_MEM_CONT_SIZE,
+                         OUTPUT_MEM_WRAP_OFFSET, OUTPUT_MEM_WRAP_SIZE)
+        || rangesOverlap(INPUT_MEM_WRAP_OFFSET, INPUT_MEM_WRAP_SIZE,
+                         OUTPUT_MEM_CONT_OFFSET, OUTPUT_MEM_CONT_SIZE)
+        || rangesOverlap(INPUT_MEM_WRAP_OFFSET, INPUT_MEM_WRAP_SIZE,
+                         OUTPUT_MEM_WRAP_OFFSET, OUTPUT_MEM_WRAP_SIZE);
+
+    const auto propagateOutput = [&](int oy, int ox, int output) {
         const int syMin = (PADDING_Y == 0) ? 0
             : max(PADDING_Y - (oy * STRIDE_Y), 0);
         const int syMax = (PADDING_Y == 0
@@ -2034,157 +2188,184 @@ N2D2_ALWAYS_INLINE inline void N2D2::Network::convcellDWPropagate(
                     0, KERNEL_HEIGHT);
         const int iy = (oy * STRIDE_Y) - PADDING_Y;
 
-//#pragma omp parallel for collapse(2)
-        for (int ox = 0; ox < OUTPUTS_WIDTH; ++ox) {
-            for (int output = 0; output < NB_OUTPUTS; ++output) {
-                // moved to inner loop for collapsing -->
-                const int sxMin = (PADDING_X == 0) ? 0
-                    : max(PADDING_X - (ox * STRIDE_X), 0);
-                const int sxMax = (PADDING_X == 0
-                        && OUTPUTS_WIDTH == OUTPUTS_WIDTH_NOPAD)
-                            ? KERNEL_WIDTH
-                    : clamp(CHANNELS_WIDTH + PADDING_X - (ox * STRIDE_X), 
-                            0, KERNEL_WIDTH);
-                const int ix = (ox * STRIDE_X) - PADDING_X;
+        // moved to inner loop for collapsing -->
+        const int sxMin = (PADDING_X == 0) ? 0
+            : max(PADDING_X - (ox * STRIDE_X), 0);
+        const int sxMax = (PADDING_X == 0
+                && OUTPUTS_WIDTH == OUTPUTS_WIDTH_NOPAD)
+                    ? KERNEL_WIDTH
+            : clamp(CHANNELS_WIDTH + PADDING_X - (ox * STRIDE_X), 
+                    0, KERNEL_WIDTH);
+        const int ix = (ox * STRIDE_X) - PADDING_X;
+
+        const int oPos = (ox + OUTPUTS_WIDTH * oy);
+        int oOffset = OUTPUT_MEM_STRIDE * oPos;
+
+        if (OUTPUT_MEM_WRAP_SIZE > 0 && oOffset >= OUTPUT_MEM_CONT_SIZE) {
+            oOffset += OUTPUT_MEM_WRAP_OFFSET - OUTPUT_MEM_CONT_OFFSET
+                        - OUTPUT_MEM_CONT_SIZE;
+        }
+        // <--
 
-                const int oPos = (ox + OUTPUTS_WIDTH * oy);
-                int oOffset = OUTPUT_MEM_STRIDE * oPos;
+        const int channel = (output * NB_CHANNELS) / NB_OUTPUTS;
 
-                if (OUTPUT_MEM_WRAP_SIZE > 0 && oOffset >= OUTPUT_MEM_CONT_SIZE) {
-                    oOffset += OUTPUT_MEM_WRAP_OFFSET - OUTPUT_MEM_CONT_OFFSET
-                                - OUTPUT_MEM_CONT_SIZE;
-                }
-                // <--
+        //SUM_T = Bias_T
+        //SUM_T weightedSum = biasses[output];
+        Bias_T weightedSum = biasses[output];
 
-                const int channel = (output * NB_CHANNELS) / NB_OUTPUTS;
+        for (int sy = 0; sy < KERNEL_HEIGHT; ++sy) {
+            if ((PADDING_Y != 0
+                    || OUTPUTS_HEIGHT != OUTPUTS_HEIGHT_NOPAD)
+                && sy >= syMax - syMin)
+            {
+                break;
+            }
 
-                //SUM_T = Bias_T
-                //SUM_T weightedSum = biasses[output];
-                Bias_T weightedSum = biasses[output];
+            const int iPos = (ix
+                                + CHANNELS_WIDTH * (iy + syMin + sy));
 
-                for (int sy = 0; sy < KERNEL_HEIGHT; ++sy) {
-                    if ((PADDING_Y != 0
-                            || OUTPUTS_HEIGHT != OUTPUTS_HEIGHT_NOPAD)
-                        && sy >= syMax - syMin)
-                    {
-                        break;
-                    }
+            int iOffset = INPUT_MEM_STRIDE * iPos;
 
-                    const int iPos = (ix
-                                        + CHANNELS_WIDTH * (iy + syMin + sy));
+            // Wrapping cannot occur in the middle of a line, except if
+            // there is only one line (1D)!
+            bool wrapInRange = false;
 
-                    int iOffset = INPUT_MEM_STRIDE * iPos;
+            if (INPUT_MEM_WRAP_SIZE > 0
+                && (iOffset+INPUT_MEM_STRIDE*sxMin) >= INPUT_MEM_CONT_SIZE)
+            {
+                iOffset += INPUT_MEM_WRAP_OFFSET - INPUT_MEM_CONT_OFFSET
+                            - INPUT_MEM_CONT_SIZE;
+            }
+            else if (INPUT_MEM_WRAP_SIZE > 0 && KERNEL_WIDTH > 1
+                && CHANNELS_HEIGHT == 1 // single line (1D)!
+                && (iOffset+INPUT_MEM_STRIDE*sxMin) + KERNEL_WIDTH * INPUT_MEM_STRIDE
+                    > INPUT_MEM_CONT_SIZE)
+            {
+                wrapInRange = true;
+            }
 
-                    // Wrapping cannot occur in the middle of a line, except if
-                    // there is only one line (1D)!
-                    bool wrapInRange = false;
+            int wOffset = (sxMin
+                + KERNEL_WIDTH * (syMin + sy + KERNEL_HEIGHT * output));
 
-                    if (INPUT_MEM_WRAP_SIZE > 0
-                        && (iOffset+INPUT_MEM_STRIDE*sxMin) >= INPUT_MEM_CONT_SIZE)
-                    {
-                        iOffset += INPUT_MEM_WRAP_OFFSET - INPUT_MEM_CONT_OFFSET
-                                    - INPUT_MEM_CONT_SIZE;
-                    }
-                    else if (INPUT_MEM_WRAP_SIZE > 0 && KERNEL_WIDTH > 1
-                        && CHANNELS_HEIGHT == 1 // single line (1D)!
-                        && (iOffset+INPUT_MEM_STRIDE*sxMin) + KERNEL_WIDTH * INPUT_MEM_STRIDE
-                            > INPUT_MEM_CONT_SIZE)
-                    {
-                        wrapInRange = true;
-                    }
 
-                    int wOffset = (sxMin
-                        + KERNEL_WIDTH * (syMin + sy + KERNEL_HEIGHT * output));
+            constexpr int NB_INT8 = ((KERNEL_WIDTH*std::numeric_limits<Weight_T>::digits)+(KERNEL_WIDTH*std::numeric_limits<Weight_T>::digits)%8)/8;
 
+            int nbInt8 = KERNEL_WIDTH;
+            int nbSlot_per_Int8 = 1;
 
-                    constexpr int NB_INT8 = ((KERNEL_WIDTH*std::numeric_limits<Weight_T>::digits)+(KERNEL_WIDTH*std::numeric_limits<Weight_T>::digits)%8)/8;
+            if(std::numeric_limits<Weight_T>::digits < 8) {
+                wOffset = (NB_INT8 * (syMin + sy + KERNEL_HEIGHT * output));
+                nbInt8 = NB_INT8;
+                nbSlot_per_Int8 = 8/(size_t)std::numeric_limits<Weight_T>::digits;
+            }
 
-                    int nbInt8 = KERNEL_WIDTH;
-                    int nbSlot_per_Int8 = 1;
+            if (!wrapInRange && ((PADDING_X == 0
+                    && OUTPUTS_WIDTH == OUTPUTS_WIDTH_NOPAD)
+                || sxMax - sxMin == KERNEL_WIDTH))
+            {
+                macsOnRange<KERNEL_WIDTH, INPUT_MEM_STRIDE / sizeof(Input_T)>(
+                    (Input_T*)((uint8_t*)inputs + iOffset) + channel, 
+                    weights + wOffset, 
+                    weightedSum);
+            }
+            else {
 
-                    if(std::numeric_limits<Weight_T>::digits < 8) {
-                        wOffset = (NB_INT8 * (syMin + sy + KERNEL_HEIGHT * output));
-                        nbInt8 = NB_INT8;
-                        nbSlot_per_Int8 = 8/(size_t)std::numeric_limits<Weight_T>::digits;
-                    }
+                int iInt8_start = sxMin/nbSlot_per_Int8;
+                int iSlot_start = (nbSlot_per_Int8 > 1)?(sxMin%nbSlot_per_Int8):0;
 
-                    if (!wrapInRange && ((PADDING_X == 0
-                            && OUTPUTS_WIDTH == OUTPUTS_WIDTH_NOPAD)
-                        || sxMax - sxMin == KERNEL_WIDTH))
-                    {
-                        macsOnRange<KERNEL_WIDTH, INPUT_MEM_STRIDE / sizeof(Input_T)>(
-                            (Input_T*)((uint8_t*)inputs + iOffset) + channel, 
-                            weights + wOffset, 
-                            weightedSum);
-                    }
-                    else {
+                for (int iInt8 = 0; iInt8 < nbInt8; ++iInt8) {
+                    for(int iSlot = 0; iSlot < nbSlot_per_Int8; ++iSlot){
 
-                        int iInt8_start = sxMin/nbSlot_per_Int8;
-                        int iSlot_start = (nbSlot_per_Int8 > 1)?(sxMin%nbSlot_per_Int8):0;
+                        int trueISlot = (iInt8==0)?iSlot+iSlot_start:iSlot;
 
-                        for (int iInt8 = 0; iInt8 < nbInt8; ++iInt8) {
-                            for(int iSlot = 0; iSlot < nbSlot_per_Int8; ++iSlot){
+                        if(trueISlot >= nbSlot_per_Int8){
+                            break;
+                        }
 
-                                int trueISlot = (iInt8==0)?iSlot+iSlot_start:iSlot;
+                        int sx = (iInt8_start+iInt8)*nbSlot_per_Int8 + trueISlot;
 
-                                if(trueISlot >= nbSlot_per_Int8){
-                                    break;
-                                }
+                        if(sx >= KERNEL_WIDTH) {
+                            break;
+                        }
 
-                                int sx = (iInt8_start+iInt8)*nbSlot_per_Int8 + trueISlot;
+                        if ((PADDING_X != 0
+                                || OUTPUTS_WIDTH != OUTPUTS_WIDTH_NOPAD)
+                            //&& sx >= sxMax - sxMin)
+                            && sx >= sxMax)
+                        {
+                            break;
+                        }
 
-                                if(sx >= KERNEL_WIDTH) {
-                                    break;
-                                }
+                        int iOffsetInRange = iOffset
+                            + sx * INPUT_MEM_STRIDE;
 
-                                if ((PADDING_X != 0
-                                        || OUTPUTS_WIDTH != OUTPUTS_WIDTH_NOPAD)
-                                    //&& sx >= sxMax - sxMin)
-                                    && sx >= sxMax)
-                                {
-                                    break;
-                                }
+                        if (wrapInRange &&
+                            iOffsetInRange >= INPUT_MEM_CONT_SIZE)
+                        {
+                            iOffsetInRange += INPUT_MEM_WRAP_OFFSET
+                                        - INPUT_MEM_CONT_OFFSET
+                                        - INPUT_MEM_CONT_SIZE;
+                        }
 
-                                int iOffsetInRange = iOffset
-                                    + sx * INPUT_MEM_STRIDE;
+                        //not accumulated weights for DW conv!
+                        /*
+                        weightedSum += ((Input_T*)((uint8_t*)inputs + iOffsetInRange))[channel]
+                            * weights[wOffset + sx];
+                        */
 
-                                if (wrapInRange &&
-                                    iOffsetInRange >= INPUT_MEM_CONT_SIZE)
-                                {
-                                    iOffsetInRange += INPUT_MEM_WRAP_OFFSET
-                                                - INPUT_MEM_CONT_OFFSET
-                                                - INPUT_MEM_CONT_SIZE;
-                                }
+                        //test for 4b only
+                        if constexpr(std::numeric_limits<Weight_T>::digits == 4) {
+                            const Weight_T w = weights[wOffset + (iInt8+iInt8_start)];
 
-                                //not accumulated weights for DW conv!
-                                /*
+                            if(trueISlot == 0) {
                                 weightedSum += ((Input_T*)((uint8_t*)inputs + iOffsetInRange))[channel]
-                                    * weights[wOffset + sx];
-                                */
-
-                                //test for 4b only
-                                if constexpr(std::numeric_limits<Weight_T>::digits == 4) {
-                                    const Weight_T w = weights[wOffset + (iInt8+iInt8_start)];
-
-                                    if(trueISlot == 0) {
-                                        weightedSum += ((Input_T*)((uint8_t*)inputs + iOffsetInRange))[channel]
-                                            *w.fields.op1;
-                                    }
-                                    else{
-                                        weightedSum += ((Input_T*)((uint8_t*)inputs + iOffsetInRange))[channel]
-                                            *w.fields.op0;
-                                    }
-                                }
-                                else{
-                                    weightedSum += ((Input_T*)((uint8_t*)inputs + iOffsetInRange))[channel]
-                                        * weights[wOffset + (iInt8+iInt8_start)];
-                                }
+                                    *w.fields.op1;
                             }
+                            else{
+                                weightedSum += ((Input_T*)((uint8_t*)inputs + iOffsetInRange))[channel]
+                                    *w.fields.op0;
+                            }
+                        }
+                        else{
+                            weightedSum += ((Input_T*)((uint8_t*)inputs + iOffsetInRange))[channel]
+                                * weights[wOffset + (iInt8+iInt8_start)];
                         }
                     }
                 }
-                ((Output_T*)((uint8_t*)outputs + oOffset))[output]
-                    = sat<Output_T>(weightedSum, output, ACTIVATION, rescaling);
+            }
+        }
+        ((Output_T*)((uint8_t*)outputs + oOffset))[output]
+            = sat<Output_T>(weightedSum, output, ACTIVATION, rescaling);
+    };
+
+#if N2D2_OUTPUT_CHANNEL_SPLIT
+#pragma omp parallel if (NB_OUTPUTS * KERNEL_HEIGHT * KERNEL_WIDTH \
+            >= N2D2_OUTPUT_CHANNEL_SPLIT_MIN_MACS)
+#endif
+    {
+        if (!MEM_OVERLAP) {
+#if N2D2_OUTPUT_CHANNEL_SPLIT
+            // Output rows split, without synchronization
+#pragma omp for schedule(static)
+#endif
+            for (int oy = 0; oy < OUTPUTS_HEIGHT; ++oy) {
+                for (int ox = 0; ox < OUTPUTS_WIDTH; ++ox) {
+                    for (int output = 0; output < NB_OUTPUTS; ++output)
+                        propagateOutput(oy, ox, output);
+                }
+            }
+        }
+        else {
+            for (int oy = 0; oy < OUTPUTS_HEIGHT; ++oy) {
+                for (int ox = 0; ox < OUTPUTS_WIDTH; ++ox) {
+#if N2D2_OUTPUT_CHANNEL_SPLIT
+                    // Output channels split, with an implicit barrier for
+                    // each output position
+#pragma omp for schedule(static)
+#endif
+                    for (int output = 0; output < NB_OUTPUTS; ++output)
+                        propagateOutput(oy, ox, output);
+                }
             }
         }
     }
@@ -2456,7 +2637,11 @@ N2D2_ALWAYS_INLINE inline void N2D2::Network::fccellPropagate(
 
     int outputOffset = 0;
 
-//#pragma omp parallel for
+#if N2D2_OUTPUT_CHANNEL_SPLIT
+#pragma omp parallel for if (std::numeric_limits<Output_T>::digits >= 8 \
+        && NB_OUTPUTS * NB_CHANNELS * CHANNELS_HEIGHT * CHANNELS_WIDTH \
+            >= N2D2_OUTPUT_CHANNEL_SPLIT_MIN_MACS)
+#endif
     for (int och = 0; och < NB_OUTPUTS; och++) {
         //SUM_T -> Bias_T
         //SUM_T weightedSum = biasses[och];
@@ -2836,6 +3021,25 @@ N2D2_ALWAYS_INLINE inline void N2D2::Network::benchmark(const char* name,
                     / (timing.count + 1.0);
     ++timing.count;
 
+    // Layers timing, in the order of execution
+    auto itTiming = std::find_if(mLayersTiming.begin(), mLayersTiming.end(),
+        [name] (const std::pair<std::string, RunningMean_T>& layerTiming)
+            { return (layerTiming.first == name); });
+
+    if (itTiming == mLayersTiming.end()) {
+        mLayersTiming.push_back(std::make_pair(std::string(name),
+                                               RunningMean_T{0.0, 0}));
+        itTiming = mLayersTiming.end() - 1;
+    }
+
+    RunningMean_T& layerTiming = (*itTiming).second;
+    layerTiming.mean = (layerTiming.mean * layerTiming.count + duration)
+                    / (layerTiming.count + 1.0);
+    ++layerTiming.count;
+
+    if (!mBenchmarkVerbose)
+        return;
+
     // Cumulative
     cumulativeTiming[name] = timing.mean;
     const double cumMeanTiming = std::accumulate(cumulativeTiming.begin(),
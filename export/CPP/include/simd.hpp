@@ -0,0 +1,334 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_EXPORTCPP_SIMD_HPP
+#define N2D2_EXPORTCPP_SIMD_HPP
+
+#include <cstdint>
+
+#include "typedefs.hpp"
+
+#ifndef N2D2_ALWAYS_INLINE
+#define N2D2_ALWAYS_INLINE __attribute__((always_inline))
+#endif
+
+/**
+ * Instruction set of the vectorized micro-kernels used by
+ * N2D2::Network::macsOnRange() for contiguous >= 8 bits inputs and weights:
+ * - N2D2_SIMD_NONE: portable scalar code;
+ * - N2D2_SIMD_SSE4: 128 bits SSE4.1 kernels;
+ * - N2D2_SIMD_AVX2: 256 bits AVX2 kernels (with FMA if available);
+ * - N2D2_SIMD_AVX512_VNNI: 512 bits AVX-512BW kernels, the 8 bits kernel
+ *   using the VNNI VPDPWSSD instruction.
+ * The micro-kernels are only available on x86-64.
+ * By default, the widest instruction set enabled by the compiler flags (see
+ * -march in the Makefile) is selected. It can be forced by defining N2D2_SIMD,
+ * for example with make CXXFLAGS=-DN2D2_SIMD=N2D2_SIMD_AVX2.
+*/
+#define N2D2_SIMD_NONE 0
+#define N2D2_SIMD_SSE4 1
+#define N2D2_SIMD_AVX2 2
+#define N2D2_SIMD_AVX512_VNNI 3
+
+// The kernels use 64 bits integer intrinsics (_mm_cvtsi128_si64), which are
+// only available in 64 bits mode
+#if !defined(__x86_64__)
+#undef N2D2_SIMD
+#define N2D2_SIMD N2D2_SIMD_NONE
+#elif !defined(N2D2_SIMD)
+#if defined(__AVX512BW__) && defined(__AVX512VNNI__)
+#define N2D2_SIMD N2D2_SIMD_AVX512_VNNI
+#elif defined(__AVX2__)
+#define N2D2_SIMD N2D2_SIMD_AVX2
+#elif defined(__SSE4_1__)
+#define N2D2_SIMD N2D2_SIMD_SSE4
+#else
+#define N2D2_SIMD N2D2_SIMD_NONE
+#endif
+#endif
+
+/// Minimum number of contiguous MACs for which the micro-kernels are used
+#ifndef N2D2_SIMD_MIN_ITERATIONS
+#define N2D2_SIMD_MIN_ITERATIONS 16
+#endif
+
+#if N2D2_SIMD != N2D2_SIMD_NONE
+#include <immintrin.h>
+#endif
+
+namespace N2D2 {
+namespace Simd {
+    /// Built-in type of the custom bit-width types
+    template<typename T> struct Raw { typedef T type; };
+    template<> struct Raw<data<8> > { typedef int8_t type; };
+    template<> struct Raw<udata<8> > { typedef uint8_t type; };
+    template<> struct Raw<data<16> > { typedef int16_t type; };
+    template<> struct Raw<udata<16> > { typedef uint16_t type; };
+    template<> struct Raw<data<-16> > { typedef float type; };
+    template<> struct Raw<data<-32> > { typedef float type; };
+
+    /**
+     * Dot product of n contiguous inputs and weights, accumulated in Sum_T.
+     * Only the specializations below are vectorized.
+    */
+    template<typename Input_T, typename Weight_T, typename Sum_T>
+    struct Dot {
+        static constexpr bool available = false;
+    };
+
+#if N2D2_SIMD != N2D2_SIMD_NONE
+    N2D2_ALWAYS_INLINE static inline int32_t hsum(__m128i acc) {
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0x4E));
+        acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, 0xB1));
+        return _mm_cvtsi128_si32(acc);
+    }
+
+    N2D2_ALWAYS_INLINE static inline int64_t hsum64(__m128i acc) {
+        return _mm_cvtsi128_si64(acc) + _mm_extract_epi64(acc, 1);
+    }
+
+    N2D2_ALWAYS_INLINE static inline float hsum(__m128 acc) {
+        acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+        acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 0x55));
+        return _mm_cvtss_f32(acc);
+    }
+
+    /// 8 bits inputs (signed or not) times signed 8 bits weights: the
+    /// operands are widened to 16 bits and multiplied-added by pairs in
+    /// 32 bits lanes, which is exact.
+    template<typename Input_T>
+    struct Dot8 {
+        static constexpr bool available = true;
+        static constexpr bool UNSIGNED = std::is_unsigned<Input_T>::value;
+
+        N2D2_ALWAYS_INLINE static inline int32_t run(
+            const Input_T* __restrict inputs,
+            const int8_t* __restrict weights,
+            int n)
+        {
+            int i = 0;
+            int32_t sum = 0;
+
+#if N2D2_SIMD >= N2D2_SIMD_AVX512_VNNI
+            __m512i acc512 = _mm512_setzero_si512();
+
+            for (; i + 32 <= n; i += 32) {
+                const __m256i in
+                    = _mm256_loadu_si256((const __m256i*)(inputs + i));
+                const __m512i vi = (UNSIGNED) ? _mm512_cvtepu8_epi16(in)
+                                              : _mm512_cvtepi8_epi16(in);
+                const __m512i vw = _mm512_cvtepi8_epi16(
+                    _mm256_loadu_si256((const __m256i*)(weights + i)));
+                acc512 = _mm512_dpwssd_epi32(acc512, vi, vw);
+            }
+
+            sum += _mm512_reduce_add_epi32(acc512);
+#elif N2D2_SIMD >= N2D2_SIMD_AVX2
+            __m256i acc256 = _mm256_setzero_si256();
+
+            for (; i + 16 <= n; i += 16) {
+                const __m128i in
+                    = _mm_loadu_si128((const __m128i*)(inputs + i));
+                const __m256i vi = (UNSIGNED) ? _mm256_cvtepu8_epi16(in)
+                                              : _mm256_cvtepi8_epi16(in);
+                const __m256i vw = _mm256_cvtepi8_epi16(
+                    _mm_loadu_si128((const __m128i*)(weights + i)));
+                acc256 = _mm256_add_epi32(acc256, _mm256_madd_epi16(vi, vw));
+            }
+
+            sum += hsum(_mm_add_epi32(_mm256_castsi256_si128(acc256),
+                                      _mm256_extracti128_si256(acc256, 1)));
+#endif
+            __m128i acc128 = _mm_setzero_si128();
+
+            for (; i + 8 <= n; i += 8) {
+                const __m128i in
+                    = _mm_loadl_epi64((const __m128i*)(inputs + i));
+                const __m128i vi = (UNSIGNED) ? _mm_cvtepu8_epi16(in)
+                                              : _mm_cvtepi8_epi16(in);
+                const __m128i vw = _mm_cvtepi8_epi16(
+                    _mm_loadl_epi64((const __m128i*)(weights + i)));
+                acc128 = _mm_add_epi32(acc128, _mm_madd_epi16(vi, vw));
+            }
+
+            sum += hsum(acc128);
+
+            for (; i < n; ++i)
+                sum += inputs[i] * weights[i];
+
+            return sum;
+        }
+    };
+
+    template<> struct Dot<int8_t, int8_t, int32_t> : public Dot8<int8_t> {};
+    template<> struct Dot<uint8_t, int8_t, int32_t> : public Dot8<uint8_t> {};
+
+    /// 16 bits inputs (signed or not) times signed 16 bits weights: the
+    /// products are computed in 32 bits lanes and accumulated in 64 bits
+    /// lanes, like the scalar code (SUM_T is 64 bits for 16 bits exports).
+    template<typename Input_T>
+    struct Dot16 {
+        static constexpr bool available = true;
+        static constexpr bool UNSIGNED = std::is_unsigned<Input_T>::value;
+
+        N2D2_ALWAYS_INLINE static inline int64_t run(
+            const Input_T* __restrict inputs,
+            const int16_t* __restrict weights,
+            int n)
+        {
+            int i = 0;
+            int64_t sum = 0;
+
+#if N2D2_SIMD >= N2D2_SIMD_AVX512_VNNI
+            __m512i acc512 = _mm512_setzero_si512();
+
+            for (; i + 16 <= n; i += 16) {
+                const __m256i in
+                    = _mm256_loadu_si256((const __m256i*)(inputs + i));
+                const __m512i vi = (UNSIGNED) ? _mm512_cvtepu16_epi32(in)
+                                              : _mm512_cvtepi16_epi32(in);
+                const __m512i vw = _mm512_cvtepi16_epi32(
+                    _mm256_loadu_si256((const __m256i*)(weights + i)));
+                const __m512i prod = _mm512_mullo_epi32(vi, vw);
+
+                acc512 = _mm512_add_epi64(acc512, _mm512_cvtepi32_epi64(
+                    _mm512_castsi512_si256(prod)));
+                acc512 = _mm512_add_epi64(acc512, _mm512_cvtepi32_epi64(
+                    _mm512_extracti64x4_epi64(prod, 1)));
+            }
+
+            sum += _mm512_reduce_add_epi64(acc512);
+#elif N2D2_SIMD >= N2D2_SIMD_AVX2
+            __m256i acc256 = _mm256_setzero_si256();
+
+            for (; i + 8 <= n; i += 8) {
+                const __m128i in
+                    = _mm_loadu_si128((const __m128i*)(inputs + i));
+                const __m256i vi = (UNSIGNED) ? _mm256_cvtepu16_epi32(in)
+                                              : _mm256_cvtepi16_epi32(in);
+                const __m256i vw = _mm256_cvtepi16_epi32(
+                    _mm_loadu_si128((const __m128i*)(weights + i)));
+                const __m256i prod = _mm256_mullo_epi32(vi, vw);
+
+                acc256 = _mm256_add_epi64(acc256, _mm256_cvtepi32_epi64(
+                    _mm256_castsi256_si128(prod)));
+                acc256 = _mm256_add_epi64(acc256, _mm256_cvtepi32_epi64(
+                    _mm256_extracti128_si256(prod, 1)));
+            }
+
+            sum += hsum64(_mm_add_epi64(_mm256_castsi256_si128(acc256),
+                                        _mm256_extracti128_si256(acc256, 1)));
+#endif
+            __m128i acc128 = _mm_setzero_si128();
+
+            for (; i + 4 <= n; i += 4) {
+                const __m128i in
+                    = _mm_loadl_epi64((const __m128i*)(inputs + i));
+                const __m128i vi = (UNSIGNED) ? _mm_cvtepu16_epi32(in)
+                                              : _mm_cvtepi16_epi32(in);
+                const __m128i vw = _mm_cvtepi16_epi32(
+                    _mm_loadl_epi64((const __m128i*)(weights + i)));
+                const __m128i prod = _mm_mullo_epi32(vi, vw);
+
+                acc128 = _mm_add_epi64(acc128, _mm_cvtepi32_epi64(prod));
+                acc128 = _mm_add_epi64(acc128,
+                    _mm_cvtepi32_epi64(_mm_unpackhi_epi64(prod, prod)));
+            }
+
+            sum += hsum64(acc128);
+
+            for (; i < n; ++i)
+                sum += (int64_t)inputs[i] * weights[i];
+
+            return sum;
+        }
+    };
+
+    template<> struct Dot<int16_t, int16_t, int64_t> : public Dot16<int16_t> {};
+    template<> struct Dot<uint16_t, int16_t, int64_t> : public Dot16<uint16_t> {};
+
+    /// Single precision floating point, accumulated in several vector lanes
+    template<>
+    struct Dot<float, float, float> {
+        static constexpr bool available = true;
+
+        N2D2_ALWAYS_INLINE static inline float run(
+            const float* __restrict inputs,
+            const float* __restrict weights,
+            int n)
+        {
+            int i = 0;
+            float sum = 0.0f;
+
+#if N2D2_SIMD >= N2D2_SIMD_AVX512_VNNI
+            __m512 acc512 = _mm512_setzero_ps();
+
+            for (; i + 16 <= n; i += 16) {
+                acc512 = _mm512_fmadd_ps(_mm512_loadu_ps(inputs + i),
+                                         _mm512_loadu_ps(weights + i), acc512);
+            }
+
+            sum += _mm512_reduce_add_ps(acc512);
+#elif N2D2_SIMD >= N2D2_SIMD_AVX2
+            __m256 acc256 = _mm256_setzero_ps();
+
+            for (; i + 8 <= n; i += 8) {
+                const __m256 vi = _mm256_loadu_ps(inputs + i);
+                const __m256 vw = _mm256_loadu_ps(weights + i);
+#ifdef __FMA__
+                acc256 = _mm256_fmadd_ps(vi, vw, acc256);
+#else
+                acc256 = _mm256_add_ps(acc256, _mm256_mul_ps(vi, vw));
+#endif
+            }
+
+            sum += hsum(_mm_add_ps(_mm256_castps256_ps128(acc256),
+                                   _mm256_extractf128_ps(acc256, 1)));
+#endif
+            __m128 acc128 = _mm_setzero_ps();
+
+            for (; i + 4 <= n; i += 4) {
+                acc128 = _mm_add_ps(acc128, _mm_mul_ps(_mm_loadu_ps(inputs + i),
+                                                       _mm_loadu_ps(weights + i)));
+            }
+
+            sum += hsum(acc128);
+
+            for (; i < n; ++i)
+                sum += inputs[i] * weights[i];
+
+            return sum;
+        }
+    };
+#endif
+
+    /// True if macsOnRange() can use a micro-kernel
+    template<int NB_ITERATIONS, int INPUTS_INC, int WEIGHTS_INC,
+             typename Input_T, typename Weight_T, typename Sum_T>
+    struct UseDot {
+        static constexpr bool value = (INPUTS_INC == 1 && WEIGHTS_INC == 1
+            && NB_ITERATIONS >= N2D2_SIMD_MIN_ITERATIONS
+            && Dot<typename Raw<Input_T>::type,
+                   typename Raw<Weight_T>::type, Sum_T>::available);
+    };
+}
+}
+
+#endif // N2D2_EXPORTCPP_SIMD_HPP
@@ -11,8 +11,12 @@
 #define STIMULI_DIRECTORY "stimuli"
 #endif
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <cstdint>
+#include <numeric>
 #include <string>
 #include <vector>
 
@@ -35,22 +39,19 @@ void readStimulus(const N2D2::Network& network, const std::string& stimulusPath,
             expectedOutputBuffer.size(), expectedOutputBuffer.data());
 }
 
-template<typename Input_T, typename Output_T>
-double processInput(const N2D2::Network& network, std::vector<Input_T>& inputBuffer, 
-                            std::vector<Output_T>& expectedOutputBuffer,
-                            std::vector<Output_T>& predictedOutputBuffer) 
+template<typename Output_T>
+double getSuccess(const Output_T* expectedOutputs,
+                  const Output_T* predictedOutputs,
+                  std::size_t outputSize)
 {
-    network.propagate(inputBuffer.data(), predictedOutputBuffer.data());
-
     std::size_t nbPredictions = 0;
     std::size_t nbValidPredictions = 0;
 
-    assert(expectedOutputBuffer.size() == predictedOutputBuffer.size());
-    for(std::size_t i = 0; i < expectedOutputBuffer.size(); i++) {
-        if (expectedOutputBuffer[i] >= 0) {
+    for(std::size_t i = 0; i < outputSize; i++) {
+        if (expectedOutputs[i] >= 0) {
             ++nbPredictions;
 
-            if(predictedOutputBuffer[i] == expectedOutputBuffer[i]) {
+            if(predictedOutputs[i] == expectedOutputs[i]) {
                 ++nbValidPredictions;
             }
         }
@@ -60,9 +61,126 @@ double processInput(const N2D2::Network& network, std::vector<Input_T>& inputBuf
         ? nbValidPredictions / (double)nbPredictions : 0.0;
 }
 
+template<typename Input_T, typename Output_T>
+double processInput(const N2D2::Network& network, std::vector<Input_T>& inputBuffer, 
+                            std::vector<Output_T>& expectedOutputBuffer,
+                            std::vector<Output_T>& predictedOutputBuffer) 
+{
+    network.propagate(inputBuffer.data(), predictedOutputBuffer.data());
+
+    assert(expectedOutputBuffer.size() == predictedOutputBuffer.size());
+    return getSuccess(expectedOutputBuffer.data(),
+                      predictedOutputBuffer.data(),
+                      expectedOutputBuffer.size());
+}
+
+/**
+ * Return the sum of the success ratios of the batch positions.
+ * The buffers contain batchSize consecutive stimuli.
+*/
+template<typename Input_T, typename Output_T>
+double processBatch(const N2D2::Network& network, std::size_t batchSize,
+                    std::vector<Input_T>& inputBuffer, 
+                    std::vector<Output_T>& expectedOutputBuffer,
+                    std::vector<Output_T>& predictedOutputBuffer,
+                    std::vector<uint8_t>& workspace) 
+{
+    network.propagate(inputBuffer.data(), predictedOutputBuffer.data(),
+                      batchSize, workspace.data());
+
+    assert(expectedOutputBuffer.size() == predictedOutputBuffer.size());
+    const std::size_t outputSize = expectedOutputBuffer.size() / batchSize;
+
+    double success = 0.0;
+    for(std::size_t batchPos = 0; batchPos < batchSize; ++batchPos) {
+        success += getSuccess(&expectedOutputBuffer[batchPos * outputSize],
+                              &predictedOutputBuffer[batchPos * outputSize],
+                              outputSize);
+    }
+
+    return success;
+}
+
+/**
+ * Benchmark mode: time nbRuns propagations of a batch of batchSize stimuli,
+ * after nbWarmupRuns untimed propagations.
+*/
+template<typename Input_T, typename Output_T>
+void benchmark(N2D2::Network& network, std::size_t batchSize,
+               unsigned int nbRuns, unsigned int nbWarmupRuns,
+               std::vector<Input_T>& inputBuffer, 
+               std::vector<Output_T>& predictedOutputBuffer,
+               std::vector<uint8_t>& workspace)
+{
+    network.setBenchmarkVerbose(false);
+
+    std::vector<double> latencies;
+    latencies.reserve(nbRuns);
+
+    for(unsigned int run = 0; run < nbWarmupRuns + nbRuns; ++run) {
+        if (run == nbWarmupRuns)
+            network.clearLayersTiming();
+
+        const auto start = std::chrono::high_resolution_clock::now();
+
+        if (batchSize > 1) {
+            network.propagate(inputBuffer.data(), predictedOutputBuffer.data(),
+                              batchSize, workspace.data());
+        }
+        else
+            network.propagate(inputBuffer.data(), predictedOutputBuffer.data());
+
+        const auto end = std::chrono::high_resolution_clock::now();
+
+        if (run >= nbWarmupRuns) {
+            latencies.push_back(std::chrono::duration_cast
+                <std::chrono::duration<double, std::micro> >(end - start)
+                    .count());
+        }
+    }
+
+    const auto& layersTiming = network.getLayersTiming();
+
+    if (!layersTiming.empty()) {
+        printf("Per layer latency (per batch position):\n");
+
+        double totalLatency = 0.0;
+        for (auto it = layersTiming.begin(); it != layersTiming.end(); ++it) {
+            printf("  %-32s %10.02f us\n", (*it).first.c_str(),
+                   (*it).second.mean);
+            totalLatency += (*it).second.mean;
+        }
+
+        printf("  %-32s %10.02f us\n", "TOTAL", totalLatency);
+    }
+    else
+        printf("Per layer latency: compile with -DBENCHMARK to enable\n");
+
+    const double totalTime = std::accumulate(latencies.begin(),
+                                             latencies.end(), 0.0);
+    std::sort(latencies.begin(), latencies.end());
+
+    const auto percentile = [&latencies](double p) {
+        const std::size_t index = (std::size_t)std::ceil(p * latencies.size());
+        return latencies[std::min(std::max(index, (std::size_t)1),
+                                  latencies.size()) - 1];
+    };
+
+    printf("Batch size: %zu\n", batchSize);
+    printf("Runs: %u (+%u warmup)\n", nbRuns, nbWarmupRuns);
+    printf("Throughput: %.02f images/s\n",
+           1.0e6 * nbRuns * batchSize / totalTime);
+    printf("Latency (per batch): mean %.02f us, p50 %.02f us, p99 %.02f us\n",
+           totalTime / nbRuns, percentile(0.50), percentile(0.99));
+}
+
 
 int main(int argc, char* argv[]) {
     std::string stimulus;
+    std::size_t batchSize = 1;
+    int nbThreads = 8;
+    unsigned int nbBenchmarkRuns = 0;
+    unsigned int nbWarmupRuns = 10;
 
     for(int iarg = 1; iarg < argc; iarg++) {
         const std::string arg = argv[iarg];
@@ -70,8 +188,33 @@ int main(int argc, char* argv[]) {
             stimulus = argv[iarg + 1];
             iarg++;
         }
+        else if(arg == "-batch" && iarg + 1 < argc) {
+            batchSize = std::max(std::stoi(argv[iarg + 1]), 1);
+            iarg++;
+        }
+        else if(arg == "-threads" && iarg + 1 < argc) {
+            nbThreads = std::max(std::stoi(argv[iarg + 1]), 1);
+            iarg++;
+        }
+        else if(arg == "-bench" && iarg + 1 < argc) {
+            nbBenchmarkRuns = std::max(std::stoi(argv[iarg + 1]), 1);
+            iarg++;
+        }
+        else if(arg == "-warmup" && iarg + 1 < argc) {
+            nbWarmupRuns = std::max(std::stoi(argv[iarg + 1]), 0);
+            iarg++;
+        }
         else if(arg == "-h" || arg == "-help") {
-            printf("%s [-stimulus stimulus]\n", argv[0]);
+            printf("%s [-stimulus stimulus] [-batch size] [-threads nb]"
+                   " [-bench nbRuns] [-warmup nbRuns]\n"
+                   "  -stimulus: process a single stimulus\n"
+                   "  -batch: number of stimuli propagated at once"
+                   " (default: 1)\n"
+                   "  -threads: number of OpenMP threads (default: 8)\n"
+                   "  -bench: benchmark mode, report the throughput and"
+                   " latency over nbRuns propagations\n"
+                   "  -warmup: number of untimed propagations in benchmark"
+                   " mode (default: 10)\n", argv[0]);
             std::exit(0);
         }
         else {
@@ -83,10 +226,10 @@ int main(int argc, char* argv[]) {
     }
 
 #ifdef _OPENMP
-    omp_set_num_threads(8);
+    omp_set_num_threads(nbThreads);
 #endif
 
-    const N2D2::Network network{};
+    N2D2::Network network{};
 
 #if NB_BITS > 0 && ENV_DATA_UNSIGNED
     std::vector<udata<NB_BITS>> inputBuffer(network.inputSize());
@@ -97,6 +240,32 @@ int main(int argc, char* argv[]) {
     std::vector<Target_T> expectedOutputBuffer(OUTPUTS_SIZE[0]);
     std::vector<Target_T> predictedOutputBuffer(OUTPUTS_SIZE[0]);
 
+    if (nbBenchmarkRuns > 0) {
+        const std::vector<std::string> stimuliFiles = (stimulus.empty())
+            ? getFilesList(STIMULI_DIRECTORY)
+            : std::vector<std::string>(1, stimulus);
+
+        // The same stimulus is used for all the batch positions
+        if (!stimuliFiles.empty()) {
+            readStimulus(network, stimuliFiles.front(), inputBuffer,
+                         expectedOutputBuffer);
+        }
+
+        std::vector<uint8_t> workspace(batchSize * network.memorySize());
+        std::vector<Target_T> batchOutputBuffer(batchSize * OUTPUTS_SIZE[0]);
+        auto batchInputBuffer = inputBuffer;
+        batchInputBuffer.reserve(batchSize * inputBuffer.size());
+
+        for(std::size_t batchPos = 1; batchPos < batchSize; ++batchPos) {
+            batchInputBuffer.insert(batchInputBuffer.end(),
+                                    inputBuffer.begin(), inputBuffer.end());
+        }
+
+        benchmark(network, batchSize, nbBenchmarkRuns, nbWarmupRuns,
+                  batchInputBuffer, batchOutputBuffer, workspace);
+        return 0;
+    }
+
     double successRate;
     if(!stimulus.empty()) {
         readStimulus(network, stimulus, inputBuffer, expectedOutputBuffer);
@@ -107,6 +276,47 @@ int main(int argc, char* argv[]) {
         successRate = success*100;
         printf("%02f/1\n", success);
     }
+    else if (batchSize > 1) {
+        const std::vector<std::string> stimuliFiles = getFilesList(STIMULI_DIRECTORY);
+
+        std::vector<uint8_t> workspace(batchSize * network.memorySize());
+        std::vector<Target_T> batchExpectedOutputBuffer(batchSize * OUTPUTS_SIZE[0]);
+        std::vector<Target_T> batchPredictedOutputBuffer(batchSize * OUTPUTS_SIZE[0]);
+        auto batchInputBuffer = inputBuffer;
+        batchInputBuffer.resize(batchSize * inputBuffer.size());
+
+        double success = 0;
+        for(std::size_t i = 0; i < stimuliFiles.size(); i += batchSize) {
+            const std::size_t nbStimuli = std::min(batchSize,
+                                                   stimuliFiles.size() - i);
+
+            for(std::size_t batchPos = 0; batchPos < nbStimuli; ++batchPos) {
+                readStimulus(network, stimuliFiles[i + batchPos], inputBuffer,
+                             expectedOutputBuffer);
+
+                std::copy(inputBuffer.begin(), inputBuffer.end(),
+                    batchInputBuffer.begin() + batchPos * inputBuffer.size());
+                std::copy(expectedOutputBuffer.begin(),
+                    expectedOutputBuffer.end(),
+                    batchExpectedOutputBuffer.begin()
+                        + batchPos * expectedOutputBuffer.size());
+            }
+
+            batchExpectedOutputBuffer.resize(nbStimuli * OUTPUTS_SIZE[0]);
+            batchPredictedOutputBuffer.resize(nbStimuli * OUTPUTS_SIZE[0]);
+
+            success += processBatch(network, nbStimuli, batchInputBuffer,
+                                    batchExpectedOutputBuffer,
+                                    batchPredictedOutputBuffer,
+                                    workspace);
+
+            printf("%02f/%d (%02f%%)\n", success, (int)(i + nbStimuli),
+                100.0*success/(i + nbStimuli));
+        }
+
+        successRate = success/stimuliFiles.size()*100;
+        printf("\n\nScore: %02f%%\n", successRate);
+    }
     else {
         const std::vector<std::string> stimuliFiles = getFilesList(STIMULI_DIRECTORY);
 
@@ -9,6 +9,7 @@
 
 #include "Network.hpp"
 #include "env.hpp"
+#include "mem_info.hpp"
 
 std::size_t N2D2::Network::inputHeight() const {
     return ENV_SIZE_Y;
@@ -42,3 +43,8 @@ std::size_t N2D2::Network::outputNbOutputs(std::size_t index) const {
 std::size_t N2D2::Network::outputSize(std::size_t index) const {
     return outputHeight(index)*outputWidth(index)*outputNbOutputs(index);
 }
+
+std::size_t N2D2::Network::memorySize() const {
+    return ((MEMORY_SIZE + MEMORY_ALIGNMENT - 1) / MEMORY_ALIGNMENT)
+        * MEMORY_ALIGNMENT;
+}
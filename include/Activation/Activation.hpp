@@ -32,6 +32,7 @@ namespace N2D2 {
 
 class BaseTensor;
 class Cell;
+struct FusedEpilogue;
 
 class Activation : public Parameterizable {
 public:
@@ -59,6 +60,16 @@ public:
                                const BaseTensor& output,
                                BaseTensor& diffInOut);
     virtual void update(unsigned int batchSize) = 0;
+    /**
+     * Describe in @p epilogue the operations done by propagate() in inference,
+     * so that they can be applied directly by the cell kernel.
+     * Return false if the activation cannot be fused.
+     */
+    virtual bool getFusedEpilogue(const Cell& /*cell*/,
+                                  FusedEpilogue& /*epilogue*/) const
+    {
+        return false;
+    };
     /**
      * Return the possible range of the activation's output as a pair of min-max. 
      */
@@ -102,6 +113,7 @@ protected:
     virtual void saveInternal(std::ostream& /*state*/,
                               std::ostream& /*log*/) const {};
     virtual void loadInternal(std::istream& /*state*/) {};
+    bool getFusedScaling(const Cell& cell, FusedEpilogue& epilogue) const;
 
     Scaling mScaling;
     std::shared_ptr<QuantizerActivation> mQuantizer;
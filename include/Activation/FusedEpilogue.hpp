@@ -0,0 +1,188 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_FUSEDEPILOGUE_H
+#define N2D2_FUSEDEPILOGUE_H
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <fenv.h>
+
+#include "FloatT.hpp"
+#include "utils/Utils.hpp"
+
+namespace N2D2 {
+/**
+ * Description of the element-wise operations applied on the outputs of a
+ * Conv or Fc cell after the accumulation: bias, activation scaling and
+ * activation function.
+ * It allows the Frame kernels to apply them on each output plane while it is
+ * still in the cache, instead of sweeping the whole output tensor once for
+ * the bias and twice for the activation.
+ * apply() gives exactly the same results as the separate passes.
+*/
+struct FusedEpilogue {
+    enum Function {
+        Identity,
+        Rectifier,
+        Clamp,
+        Logistic
+    };
+
+    FusedEpilogue()
+        : function(Identity),
+          scalingClipped(false),
+          quantizedNbBits(0),
+          outputUnsigned(false),
+          leakSlope(0.0),
+          clipping(0.0)
+    {
+    }
+
+    /// Apply the epilogue on @p size contiguous outputs of channel @p channel.
+    /// @p bias is added first if it is not NULL.
+    template <class T>
+    void apply(T* outputs,
+               std::size_t size,
+               unsigned int channel,
+               const T* bias = NULL) const;
+
+    Function function;
+    /// Activation FLOAT_MULT scaling per output channel (no scaling if empty)
+    std::vector<Float_T> scaling;
+    bool scalingClipped;
+    std::vector<Float_T> scalingClipping;
+    std::size_t quantizedNbBits;
+    bool outputUnsigned;
+    /// Leak slope for Rectifier
+    double leakSlope;
+    /// Clipping for Rectifier (if > 0) and Clamp
+    double clipping;
+
+private:
+    template <class T>
+    static T clip(T value, Float_T clip);
+    template <class T>
+    static T saturate(T value, std::size_t quantizedNbBits,
+                      bool isOutputUnsigned);
+};
+}
+
+template <class T>
+void N2D2::FusedEpilogue::apply(T* outputs,
+                                std::size_t size,
+                                unsigned int channel,
+                                const T* bias) const
+{
+    if (bias != NULL) {
+        // Same as ConvCell_Frame_Kernels::forwardBias() with alpha = beta = 1
+        const T alpha(1.0);
+        const T beta(1.0);
+
+        for (std::size_t index = 0; index < size; ++index)
+            outputs[index] = alpha * (*bias) + beta * outputs[index];
+    }
+
+    if (!scaling.empty()) {
+        // Same as floatingPointScaling_propagate()
+        const T scale(scaling[channel]);
+
+        for (std::size_t index = 0; index < size; ++index) {
+            T res = (scalingClipped)
+                ? clip(outputs[index], scalingClipping[channel])
+                : outputs[index];
+            res = res * scale;
+
+            if (quantizedNbBits > 0) {
+                res = saturate(std::round(res), quantizedNbBits,
+                               outputUnsigned);
+            }
+
+            outputs[index] = (T) res;
+        }
+    }
+
+    if (function == Rectifier) {
+        if (clipping > 0.0) {
+            for (std::size_t index = 0; index < size; ++index) {
+                outputs[index] = (outputs[index] > 0)
+                    ? std::min<T>(outputs[index], (T)clipping)
+                    : (T)leakSlope * outputs[index];
+            }
+        }
+        else {
+            for (std::size_t index = 0; index < size; ++index) {
+                outputs[index] = (outputs[index] > 0)
+                    ? outputs[index]
+                    : (T)leakSlope * outputs[index];
+            }
+        }
+    }
+    else if (function == Clamp) {
+        const T threshold(clipping);
+
+        for (std::size_t index = 0; index < size; ++index) {
+            outputs[index] = Utils::clamp<T>(outputs[index],
+                                             -threshold, threshold);
+        }
+    }
+    else if (function == Logistic) {
+#if !defined(WIN32) && !defined(__APPLE__) && !defined(__CYGWIN__) && !defined(_WIN32)
+        const int excepts = fegetexcept();
+        fedisableexcept(FE_OVERFLOW);
+#endif
+
+        for (std::size_t index = 0; index < size; ++index)
+            outputs[index] = 1.0f / (1.0f + std::exp(-outputs[index]));
+
+#if !defined(WIN32) && !defined(__APPLE__) && !defined(__CYGWIN__) && !defined(_WIN32)
+        feenableexcept(excepts);
+#endif
+    }
+}
+
+template <class T>
+T N2D2::FusedEpilogue::clip(T value, Float_T clip)
+{
+    T res = T(0.0);
+
+    if (clip > 0.0)
+        res = (value < T(0.0)) ? T(0.0) : (value > T(clip)) ? T(clip) : value;
+    else
+        res = (value > T(0.0)) ? T(0.0) : (value < T(clip)) ? T(clip) : value;
+
+    return res;
+}
+
+template <class T>
+T N2D2::FusedEpilogue::saturate(T value,
+                                std::size_t quantizedNbBits,
+                                bool isOutputUnsigned)
+{
+    const T min = isOutputUnsigned ? 0 : -(1ll << (quantizedNbBits - 1ll));
+    const T max = isOutputUnsigned ? (1ll << quantizedNbBits) - 1ll
+                                   : (1ll << (quantizedNbBits - 1ll)) - 1ll;
+
+    return Utils::clamp(value, min, max);
+}
+
+#endif // N2D2_FUSEDEPILOGUE_H
@@ -21,9 +21,11 @@
 #ifndef N2D2_LINEARACTIVATION_FRAME_H
 #define N2D2_LINEARACTIVATION_FRAME_H
 
+#include "Activation/FusedEpilogue.hpp"
 #include "Activation/LinearActivation.hpp"
 #include "Cell/Cell.hpp"
 #include "containers/Tensor.hpp"
+#include "Solver/FusedUpdate.hpp"
 #include "Solver/SGDSolver_Kernels.hpp"
 
 namespace N2D2 {
@@ -45,6 +47,8 @@ public:
                                const BaseTensor& diffInput,
                                BaseTensor& diffOutput);
     virtual void update(unsigned int batchSize);
+    virtual bool getFusedEpilogue(const Cell& cell,
+                                  FusedEpilogue& epilogue) const;
     virtual ~LinearActivation_Frame() {};
 
 private:
@@ -118,8 +122,27 @@ template <class T>
 void N2D2::LinearActivation_Frame<T>::update(unsigned int batchSize)
 {
     if(mQuantizer) {
+        FusedUpdateBarrier fusedUpdateBarrier;
         mQuantizer->update(batchSize);
     }
 }
 
+template <class T>
+bool N2D2::LinearActivation_Frame<T>::getFusedEpilogue(
+    const Cell& cell,
+    FusedEpilogue& epilogue) const
+{
+    if (!getFusedScaling(cell, epilogue))
+        return false;
+
+    if (mClipping != 0.0 && !cell.isQuantized()) {
+        epilogue.function = FusedEpilogue::Clamp;
+        epilogue.clipping = mClipping;
+    }
+    else
+        epilogue.function = FusedEpilogue::Identity;
+
+    return true;
+}
+
 #endif // N2D2_LINEARACTIVATION_FRAME_H
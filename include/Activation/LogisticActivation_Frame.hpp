@@ -25,9 +25,11 @@
 #include <fenv.h>
 #endif
 
+#include "Activation/FusedEpilogue.hpp"
 #include "Activation/LogisticActivation.hpp"
 #include "Cell/Cell.hpp"
 #include "containers/Tensor.hpp"
+#include "Solver/FusedUpdate.hpp"
 #include "Solver/SGDSolver_Kernels.hpp"
 
 namespace N2D2 {
@@ -51,6 +53,8 @@ public:
                                const BaseTensor& diffInput,
                                BaseTensor& diffOutput);
     virtual void update(unsigned int batchSize);
+    virtual bool getFusedEpilogue(const Cell& cell,
+                                  FusedEpilogue& epilogue) const;
     virtual ~LogisticActivation_Frame() {};
 
 private:
@@ -137,7 +141,26 @@ template <class T>
 void N2D2::LogisticActivation_Frame<T>::update(unsigned int batchSize)
 {
     if(mQuantizer) {
+        FusedUpdateBarrier fusedUpdateBarrier;
         mQuantizer->update(batchSize);
     }
 }
+
+template <class T>
+bool N2D2::LogisticActivation_Frame<T>::getFusedEpilogue(
+    const Cell& cell,
+    FusedEpilogue& epilogue) const
+{
+    if (LogisticActivationDisabled) {
+        epilogue = FusedEpilogue();
+        return true;
+    }
+
+    if (!getFusedScaling(cell, epilogue))
+        return false;
+
+    epilogue.function = FusedEpilogue::Logistic;
+    return true;
+}
+
 #endif // N2D2_LOGISTICACTIVATION_FRAME_H
@@ -21,9 +21,11 @@
 #ifndef N2D2_RECTIFIERACTIVATION_FRAME_H
 #define N2D2_RECTIFIERACTIVATION_FRAME_H
 
+#include "Activation/FusedEpilogue.hpp"
 #include "Activation/RectifierActivation.hpp"
 #include "Cell/Cell.hpp"
 #include "containers/Tensor.hpp"
+#include "Solver/FusedUpdate.hpp"
 #include "Solver/SGDSolver_Kernels.hpp"
 
 namespace N2D2 {
@@ -44,6 +46,8 @@ public:
                                const BaseTensor& diffInput,
                                BaseTensor& diffOutput);
     virtual void update(unsigned int batchSize);
+    virtual bool getFusedEpilogue(const Cell& cell,
+                                  FusedEpilogue& epilogue) const;
     virtual ~RectifierActivation_Frame() {};
 
 private:
@@ -125,7 +129,24 @@ template <class T>
 void N2D2::RectifierActivation_Frame<T>::update(unsigned int batchSize)
 {
     if(mQuantizer) {
+        FusedUpdateBarrier fusedUpdateBarrier;
         mQuantizer->update(batchSize);
     }
 }
+
+template <class T>
+bool N2D2::RectifierActivation_Frame<T>::getFusedEpilogue(
+    const Cell& cell,
+    FusedEpilogue& epilogue) const
+{
+    if (!getFusedScaling(cell, epilogue))
+        return false;
+
+    epilogue.function = FusedEpilogue::Rectifier;
+    epilogue.leakSlope = mLeakSlope;
+    epilogue.clipping = (mClipping > 0.0 && !cell.isQuantized())
+        ? (double)mClipping : 0.0;
+    return true;
+}
+
 #endif // N2D2_RECTIFIERACTIVATION_FRAME_H
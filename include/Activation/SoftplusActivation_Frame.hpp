@@ -28,6 +28,7 @@
 #include "Activation/SoftplusActivation.hpp"
 #include "Cell/Cell.hpp"
 #include "containers/Tensor.hpp"
+#include "Solver/FusedUpdate.hpp"
 
 namespace N2D2 {
 template <class T>
@@ -120,6 +121,7 @@ template <class T>
 void N2D2::SoftplusActivation_Frame<T>::update(unsigned int batchSize)
 {
     if(mQuantizer) {
+        FusedUpdateBarrier fusedUpdateBarrier;
         mQuantizer->update(batchSize);
     }
 }
@@ -24,6 +24,7 @@
 #include "Activation/SwishActivation.hpp"
 #include "Cell/Cell.hpp"
 #include "containers/Tensor.hpp"
+#include "Solver/FusedUpdate.hpp"
 #include "Solver/SGDSolver_Kernels.hpp"
 
 namespace N2D2 {
@@ -115,6 +116,7 @@ template <class T>
 void N2D2::SwishActivation_Frame<T>::update(unsigned int batchSize)
 {
     if(mQuantizer) {
+        FusedUpdateBarrier fusedUpdateBarrier;
         mQuantizer->update(batchSize);
     }
 }
@@ -62,6 +62,8 @@ public:
     virtual void propagate(bool inference = false);
     virtual void backPropagate();
     virtual void update();
+    virtual void getFreeParameters(std::vector<BaseTensor*>& parameters,
+                                   std::vector<BaseTensor*>& gradients);
     inline void getScale(unsigned int index, BaseTensor& value) const
     {
         // Need to specify std::initializer_list<size_t> for GCC 4.4
@@ -77,6 +77,12 @@ public:
     virtual void propagate(bool inference = false) = 0;
     virtual void backPropagate() = 0;
     virtual void update() = 0;
+    /// Append the free parameters updated by update() and their gradients,
+    /// which can be moved in the DeepNet parameter arena. Cells with free
+    /// parameters must implement it, and throw if the parameters cannot be
+    /// moved.
+    virtual void getFreeParameters(std::vector<BaseTensor*>& /*parameters*/,
+                                   std::vector<BaseTensor*>& /*gradients*/) {};
     virtual void checkGradient(double /*epsilon*/, double /*maxError*/) = 0;
     virtual void setOutputTarget(const Tensor<int>& targets) = 0;
     virtual double applyLoss(double targetVal,
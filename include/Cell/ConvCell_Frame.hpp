@@ -96,6 +96,8 @@ public:
     virtual void propagate(bool inference = false);
     virtual void backPropagate();
     virtual void update();
+    virtual void getFreeParameters(std::vector<BaseTensor*>& parameters,
+                                   std::vector<BaseTensor*>& gradients);
     inline void getWeight(unsigned int output,
                           unsigned int channel,
                           BaseTensor& value) const
@@ -188,6 +190,9 @@ protected:
         (*mBias)(output) = tensor_cast<T>(value)(0);
     };
 
+    /// CPU convolution algorithm (Direct or Im2col)
+    Parameter<ConvCell_Frame_Kernels::Algorithm> mAlgorithm;
+
     // Internal
     std::vector<std::shared_ptr<Solver> > mWeightsSolvers;
     Interface<T> mSharedSynapses;
@@ -203,4 +208,10 @@ private:
 };
 }
 
+namespace {
+template <>
+const char* const EnumStrings<N2D2::ConvCell_Frame_Kernels::Algorithm>::data[]
+    = {"Direct", "Im2col"};
+}
+
 #endif // N2D2_CONVCELL_FRAME_H
@@ -23,16 +23,32 @@
 
 #include <vector>
 #include "containers/Tensor.hpp"
+#include "utils/Utils.hpp"
 
 namespace N2D2 {
 
+struct FusedEpilogue;
+
 namespace ConvCell_Frame_Kernels {
+    enum Algorithm {
+        // Direct convolution loops
+        Direct,
+        // Convolution lowered to a matrix product with im2col/col2im and a
+        // cache-blocked GEMM (see utils/Gemm.hpp)
+        Im2col
+    };
+
+    // Enum stream operators, required to use Algorithm as a Parameter
+    using ::operator<<;
+    using ::operator>>;
+
     struct Descriptor {
         const std::vector<unsigned int> subSample;
         const std::vector<unsigned int> stride;
         // left, top, right, bottom (if 2D)
         std::vector<int> padding;
         const std::vector<unsigned int> dilation;
+        Algorithm algorithm;
 
         Descriptor(const std::vector<unsigned int>& subSample_,
                    const std::vector<unsigned int>& stride_,
@@ -41,7 +57,8 @@ namespace ConvCell_Frame_Kernels {
             : subSample(subSample_),
               stride(stride_),
               padding(padding_),
-              dilation(dilation_)
+              dilation(dilation_),
+              algorithm(Direct)
         {
             if (padding.size() == stride.size()) {
                 // Duplicate left, top padding for right, bottom padding
@@ -52,6 +69,9 @@ namespace ConvCell_Frame_Kernels {
     };
 
     // Forward
+    // If bias is not empty or epilogue is not NULL, the bias and the epilogue
+    // are applied on each output plane once it is computed, which is
+    // equivalent to forwardBias() followed by the activation
     template <class T>
     void forward(const T* alpha,
                  const Tensor<T>& inputs,
@@ -59,7 +79,9 @@ namespace ConvCell_Frame_Kernels {
                  const Descriptor& desc,
                  const T* beta,
                  Tensor<T>& outputs,
-                 const Tensor<bool>& maps = Tensor<bool>());
+                 const Tensor<bool>& maps = Tensor<bool>(),
+                 const Tensor<T>& bias = Tensor<T>(),
+                 const FusedEpilogue* epilogue = NULL);
     template <class T>
     void forwardBias(const T* alpha,
                      const Tensor<T>& bias,
@@ -84,6 +84,8 @@ public:
     virtual void propagate(bool inference = false);
     virtual void backPropagate();
     virtual void update();
+    virtual void getFreeParameters(std::vector<BaseTensor*>& parameters,
+                                   std::vector<BaseTensor*>& gradients);
     inline void getWeight(unsigned int output,
                           unsigned int channel,
                           BaseTensor& value) const
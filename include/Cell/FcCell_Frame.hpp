@@ -59,6 +59,8 @@ public:
     virtual void propagate(bool inference = false);
     virtual void backPropagate();
     virtual void update();
+    virtual void getFreeParameters(std::vector<BaseTensor*>& parameters,
+                                   std::vector<BaseTensor*>& gradients);
 
     void resetWeights();
     void resetBias();
@@ -53,6 +53,10 @@ public:
     virtual void
     incomingSpike(NodeIn* node, Time_T timestamp, EventType_T type = 0);
     virtual void notify(Time_T timestamp, NotifyType notify);
+    bool canStop() const
+    {
+        return (mTerminateDelta > 0 || mTerminateMax > 0);
+    };
     inline void getWeight(unsigned int output, unsigned int channel,
                           BaseTensor& value) const;
     inline void getQuantWeight(unsigned int output, unsigned int channel,
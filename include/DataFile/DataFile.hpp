@@ -52,7 +52,35 @@ public:
         return rMap;
     }
 
+    /// Minimum size of the decoded data required by the downstream
+    /// processing. A null hint means that the full resolution is required.
+    struct SizeHint {
+        SizeHint(unsigned int width_ = 0,
+                 unsigned int height_ = 0,
+                 double area_ = 0.0)
+            : width(width_), height(height_), area(area_) {}
+        bool empty() const
+        {
+            return (width == 0 && height == 0 && area <= 0.0);
+        };
+        /// Return true if a @p cols x @p rows decoded data is large enough
+        bool accept(unsigned int cols, unsigned int rows) const
+        {
+            return (cols >= width && rows >= height
+                    && (double)cols * rows >= area);
+        };
+
+        unsigned int width;
+        unsigned int height;
+        double area;
+    };
+
     virtual cv::Mat read(const std::string& fileName) = 0;
+    /// Read the data at the lowest resolution still satisfying @p sizeHint,
+    /// when the file format allows it (full resolution by default)
+    virtual cv::Mat readReduced(const std::string& fileName,
+                                const SizeHint& /*sizeHint*/)
+        { return read(fileName); }
     virtual cv::Mat readLabel(const std::string& /*fileName*/)
         { return cv::Mat(); }
     virtual void write(const std::string& fileName, const cv::Mat& data) = 0;
@@ -34,10 +34,23 @@ public:
     }
 
     virtual cv::Mat read(const std::string& fileName);
+    /// Decode 8 bits gray or color JPEG images at 1/2, 1/4 or 1/8 of their
+    /// resolution, when allowed by @p sizeHint
+    virtual cv::Mat readReduced(const std::string& fileName,
+                                const SizeHint& sizeHint);
     virtual void write(const std::string& fileName, const cv::Mat& data);
     virtual ~ImageDataFile() {};
 
+    /// Read the size and number of channels of an 8 bits JPEG image from its
+    /// header. Return false for any other image format.
+    static bool readHeader(const std::string& fileName,
+                           unsigned int& width,
+                           unsigned int& height,
+                           unsigned int& channels);
+
 private:
+    static cv::Mat decode(const std::string& fileName, int flags);
+
     static Registrar<DataFile> mRegistrar;
 };
 }
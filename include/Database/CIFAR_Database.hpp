@@ -37,6 +37,14 @@ public:
     virtual ~CIFAR_Database() {};
 
 protected:
+    void loadCIFARDirect(const std::string& dataFile,
+                         const std::vector<std::string>& labelsName,
+                         bool coarseAndFine,
+                         bool useCoarse);
+
+    /// If true, the stimuli are decoded in memory from the binary files,
+    /// instead of being extracted to PPM files
+    Parameter<bool> mDirectLoad;
     double mValidation;
 };
 
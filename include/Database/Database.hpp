@@ -55,6 +55,7 @@
 namespace N2D2 {
 
 class ROI;
+class StimuliMemoryCache;
 
 /**
  * Database specifications:
@@ -279,11 +280,29 @@ public:
     inline void setStimulusROIs(StimulusID id,
                                 const std::vector<ROI*>& ROIs = std::vector
                                 <ROI*>());
+    /// Set the minimum size of the stimuli required downstream, allowing
+    /// them to be decoded directly at a reduced resolution when nothing else
+    /// depends on their full resolution (no ROI, slice, pixel-wise label,
+    /// multi-channel or target data)
+    void setDecodeSizeHint(const DataFile::SizeHint& sizeHint)
+    {
+        mDecodeSizeHint = sizeHint;
+    };
 
     // Getters
     bool getLoadDataInMemory(){
         return mLoadDataInMemory;
     };
+    /// Return the stimuli memory cache, or nullptr if CacheSize is 0 or no
+    /// stimulus was accessed yet
+    std::shared_ptr<StimuliMemoryCache> getMemoryCache() const
+    {
+        return mMemoryCache;
+    };
+    /// Print the memory cache statistics and append them to @p fileName,
+    /// for the learning @p step (do nothing if the cache is not used)
+    void logMemoryCacheStats(const std::string& fileName,
+                             unsigned int step) const;
     
     inline StimulusID getStimulusID(StimuliSet set, unsigned int index) const;
     std::string getStimulusName(StimulusID id, bool appendSlice = true) const;
@@ -339,6 +358,16 @@ public:
                             = std::vector<std::shared_ptr<ROI> >());
     std::vector<StimuliSet> getStimuliSets(StimuliSetMask setMask) const;
     StimuliSetMask getStimuliSetMask(StimuliSet set) const;
+    /// Shuffle the indexes of stimuli in @p set, for a learning epoch. The
+    /// default is a uniform random shuffle.
+    virtual void shuffleIndexes(StimuliSet set,
+                                std::vector<unsigned int>& indexes) const;
+    /// If true, the batches must be read in the order of shuffleIndexes()
+    /// (for databases stored sequentially)
+    virtual bool isSequential() const
+    {
+        return false;
+    };
     virtual cv::Mat readLabel(const StimulusID id) { 
         std::string fileExtension = Utils::fileExtension(mStimuli[id].name);
         if(mDataFileLabel && Registrar<DataFile>::exists(fileExtension)){
@@ -358,10 +387,18 @@ protected:
     std::map<std::string, StimulusID>
     getRelPathStimuli(const std::string& fileName, const std::string& relPath);
     int labelID(const std::string& labelName);
-    cv::Mat loadStimulusData(StimulusID id);
-    cv::Mat loadStimulusLabelsData(StimulusID id);
+    virtual cv::Mat loadStimulusData(StimulusID id);
+    virtual cv::Mat loadStimulusLabelsData(StimulusID id);
     cv::Mat loadStimulusTargetData(StimulusID id);
-    cv::Mat loadData(StimulusID id, int depth, const std::string fileName) const;
+    /// Update the per-stimulus data after removeStimulus() or
+    /// removeStimuli(). @p mapping gives the new ID of each former stimulus,
+    /// or -1 if it was removed
+    virtual void remapStimuli(const std::vector<int>& mapping);
+    cv::Mat loadData(StimulusID id,
+                     int depth,
+                     const std::string fileName,
+                     const DataFile::SizeHint& sizeHint
+                        = DataFile::SizeHint()) const;
     std::vector<unsigned int> getLabelStimuliSetIndexes(int label,
                                                         StimuliSet set) const;
     std::vector<std::vector<unsigned int> >
@@ -384,6 +421,8 @@ protected:
                                                         unsigned int>& sizeStats,
         const std::map<int, unsigned int>& labelStats) const;
 
+    StimuliMemoryCache& getOrCreateMemoryCache();
+
     /// Default label for composite image (for areas outside the ROIs). If
     /// empty, no default label is created and label ID is -1
     Parameter<std::string> mDefaultLabel;
@@ -421,6 +460,12 @@ protected:
     Parameter<std::string> mTargetDataPath;
     Parameter<std::string> mMultiChannelMatch;
     Parameter<std::vector<std::string> > mMultiChannelReplace;
+    /// Size budget of the stimuli memory cache, in MiB (0 = no cache)
+    Parameter<unsigned int> mCacheSize;
+    /// Number of independently locked shards of the memory cache
+    Parameter<unsigned int> mCacheShards;
+    /// If true, store the 8 and 16 bits stimuli PNG-encoded in the cache
+    Parameter<bool> mCacheCompression;
 
     /**
      * TABLES
@@ -440,10 +485,15 @@ protected:
 
     /// Put data in program memory
     bool mLoadDataInMemory;
+    /// Bounded stimuli memory cache, used instead of the unbounded
+    /// mStimuli*Data tables when CacheSize > 0
+    std::shared_ptr<StimuliMemoryCache> mMemoryCache;
     /// Stimuli depth
     int mStimuliDepth;
     /// Stimuli target depth
     int mStimuliTargetDepth;
+    /// Minimum size of the stimuli required downstream
+    DataFile::SizeHint mDecodeSizeHint;
 };
 }
 
@@ -22,6 +22,7 @@
 #define N2D2_IDX_DATABASE_H
 
 #include "Database/Database.hpp"
+#include "utils/MemoryMappedFile.hpp"
 
 namespace N2D2 {
 class IDX_Database : public Database {
@@ -45,6 +46,15 @@ public:
                       const std::string& labelPath = "",
                       bool /*extractROIs*/ = false);
     virtual ~IDX_Database() {};
+
+protected:
+    void loadDirect(const std::string& dataPath, const std::string& labelPath);
+
+    /// If true, the IDX files are memory-mapped and the stimuli data are
+    /// views on the mapping, instead of being extracted to PGM files
+    Parameter<bool> mDirectLoad;
+    /// Mapped IDX files (which own the stimuli data in direct load mode)
+    std::vector<std::shared_ptr<MemoryMappedFile> > mMappedFiles;
 };
 }
 
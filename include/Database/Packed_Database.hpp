@@ -0,0 +1,136 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_PACKED_DATABASE_H
+#define N2D2_PACKED_DATABASE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+
+#include "Database/Database.hpp"
+
+namespace N2D2 {
+/**
+ * Database stored in a few large record files (shards), with an index.
+ *
+ * A packed database is a directory containing:
+ * - index.bin: the labels name and, for each stimulus, its name, label, set,
+ *   ROIs (as bounding rectangles) and the location of its record;
+ * - shard-NNNNN.bin: the records of the stimuli, stored contiguously in the
+ *   order of the index. A record is made of the data and labels matrices of
+ *   the stimulus.
+ *
+ * The data and labels are stored as returned by the packed database (after
+ * the multi-channel merge, slices and ROI extraction and composite labels
+ * construction). A shard is read as a whole, in one sequential read, and a
+ * bounded number of shards is kept in memory. With the ShuffleShards
+ * parameter, the learning epochs are shuffled at the shard level (order of
+ * the shards, then order of the stimuli within each shard), so that each
+ * shard is read only once per epoch.
+*/
+class Packed_Database : public Database {
+public:
+    Packed_Database();
+    /// Load the packed database in the @p dataPath directory. Several packed
+    /// databases can be loaded successively.
+    virtual void load(const std::string& dataPath,
+                      const std::string& /*labelPath*/ = "",
+                      bool /*extractROIs*/ = false);
+    virtual void shuffleIndexes(StimuliSet set,
+                                std::vector<unsigned int>& indexes) const;
+    virtual bool isSequential() const
+    {
+        return mShuffleShards;
+    };
+    unsigned int getNbShards() const
+    {
+        return mShardsName.size();
+    };
+
+    /**
+     * Pack the stimuli of @p database in @p setMask into the @p dataPath
+     * directory. The stimuli are loaded and serialized in parallel.
+     *
+     * @param shardSize     Maximum size of a shard, in bytes (a shard always
+     *                      contains at least one stimulus)
+     * @param compressed    If true, store the 8 and 16 bits matrices
+     *                      PNG-encoded (lossless)
+    */
+    static void pack(Database& database,
+                     const std::string& dataPath,
+                     StimuliSetMask setMask = All,
+                     std::size_t shardSize = 128 * 1024 * 1024,
+                     bool compressed = false);
+    virtual ~Packed_Database() {};
+
+protected:
+    virtual cv::Mat loadStimulusData(StimulusID id);
+    virtual cv::Mat loadStimulusLabelsData(StimulusID id);
+    virtual void remapStimuli(const std::vector<int>& mapping);
+
+private:
+    struct Record {
+        std::uint32_t shard;
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    struct MatHeader {
+        std::int32_t rows;
+        std::int32_t cols;
+        std::int32_t type;
+        /// Size of the PNG-encoded matrix, 0 if stored raw
+        std::uint32_t encodedSize;
+    };
+
+    struct Shard {
+        unsigned int shard;
+        /// NULL while the shard is being read
+        std::shared_ptr<const std::vector<char> > data;
+    };
+
+    std::shared_ptr<const std::vector<char> > getShard(unsigned int shard);
+    cv::Mat readRecord(StimulusID id, unsigned int matrix);
+    static void writeMat(std::vector<char>& buffer,
+                         const cv::Mat& mat,
+                         bool compressed);
+    static std::string getShardName(const std::string& dataPath,
+                                    unsigned int shard);
+
+    static const char Magic[8];
+
+    /// Number of shards kept in memory
+    Parameter<unsigned int> mShardCache;
+    /// If true, shuffle the learning epochs at the shard level
+    Parameter<bool> mShuffleShards;
+
+    std::vector<std::string> mShardsName;
+    std::vector<Record> mRecords;
+    /// Shards in memory, most recently used first
+    std::list<Shard> mShards;
+    std::mutex mShardsMutex;
+    std::condition_variable mShardRead;
+};
+}
+
+#endif // N2D2_PACKED_DATABASE_H
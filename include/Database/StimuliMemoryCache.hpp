@@ -0,0 +1,132 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_STIMULIMEMORYCACHE_H
+#define N2D2_STIMULIMEMORYCACHE_H
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "utils/Utils.hpp"
+
+namespace N2D2 {
+/**
+ * In-memory cache of decoded stimuli, bounded in size, with a least recently
+ * used (LRU) eviction policy.
+ *
+ * The cache is split in independent shards, each with its own lock and an
+ * equal share of the size budget, so that concurrent accesses from the
+ * loading threads rarely contend. When compression is enabled, the 8 and 16
+ * bits matrices with 1, 3 or 4 channels are stored PNG-encoded (lossless) and
+ * decoded at each access; other matrices are always stored raw.
+ * get() and put() can be called concurrently.
+*/
+class StimuliMemoryCache {
+public:
+    enum DataType {
+        Data,
+        Labels,
+        Target
+    };
+
+    struct Stats {
+        unsigned long long hits;
+        unsigned long long misses;
+        unsigned long long evictions;
+        unsigned long long nbEntries;
+        /// Memory used by the cached matrices, in bytes
+        unsigned long long size;
+
+        double hitRate() const
+        {
+            return (hits + misses > 0)
+                ? hits / (double)(hits + misses) : 0.0;
+        }
+    };
+
+    /// @p maxSize is the total size budget in bytes. @p nbShards is rounded up
+    /// to a power of two.
+    StimuliMemoryCache(std::size_t maxSize,
+                       unsigned int nbShards = 16,
+                       bool compressed = false);
+    /// Return false (and count a miss) if the matrix is not in the cache
+    bool get(unsigned int id, DataType type, cv::Mat& mat);
+    /// Insert or replace a matrix, evicting the least recently used matrices
+    /// of the shard if needed. Matrices larger than the budget of a shard are
+    /// not cached.
+    void put(unsigned int id, DataType type, const cv::Mat& mat);
+    Stats getStats() const;
+    /// Return true if @p mat can be stored PNG-encoded (8 and 16 bits
+    /// matrices with 1, 3 or 4 channels)
+    static bool isEncodable(const cv::Mat& mat);
+    void resetStats();
+    void clear();
+    std::size_t getMaxSize() const
+    {
+        return mMaxSize;
+    };
+    unsigned int getNbShards() const
+    {
+        return mShards.size();
+    };
+    bool isCompressed() const
+    {
+        return mCompressed;
+    };
+
+private:
+    struct Entry {
+        std::uint64_t key;
+        cv::Mat mat;
+        std::shared_ptr<const std::vector<unsigned char> > encoded;
+        std::size_t size;
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        /// Most recently used first
+        std::list<Entry> entries;
+        std::unordered_map<std::uint64_t, std::list<Entry>::iterator> index;
+        std::size_t size;
+        unsigned long long hits;
+        unsigned long long misses;
+        unsigned long long evictions;
+
+        Shard() : size(0), hits(0), misses(0), evictions(0) {}
+    };
+
+    static std::uint64_t getKey(unsigned int id, DataType type)
+    {
+        return (static_cast<std::uint64_t>(id) << 2) | type;
+    }
+    Shard& getShard(std::uint64_t key) const;
+
+    const std::size_t mMaxSize;
+    const bool mCompressed;
+    std::size_t mShardMaxSize;
+    std::vector<std::unique_ptr<Shard> > mShards;
+};
+}
+
+#endif // N2D2_STIMULIMEMORYCACHE_H
@@ -25,9 +25,13 @@
 #include <string>
 #include <vector>
 #include <atomic>
+#include <functional>
+#include <mutex>
 
 #include "Cell/Cell.hpp"
+#include "containers/ParameterArena.hpp"
 #include "Database/Database.hpp"
+#include "Export/MemoryManager.hpp"
 #include "Xnet/Network.hpp"
 #include "Target/Target.hpp"
 
@@ -45,6 +49,7 @@
 namespace N2D2 {
 
 class CMonitor;
+class Cell_Frame_Top;
 class Gnuplot;
 class Monitor;
 
@@ -108,6 +113,42 @@ public:
     void importNetworkSolverParameters(const std::string& dirName);
     void checkGradient(double epsilon = 1.0e-4, double maxError = 1.0e-6);
     void initialize();
+    /// Build the execution plan used by propagate() and backPropagate():
+    /// flat list of the cells in mLayers order, with their dependencies.
+    /// Called by initialize() and automatically after any change in the
+    /// network graph.
+    void compileExecPlan();
+    /// Inference memory planning: the outputs of the cells whose lifetimes
+    /// do not overlap share the same storage, and the gradients storage is
+    /// released. The lifetimes are computed with the MemoryManager, as for
+    /// the C++ export.
+    /// While the plan is active, only propagate() in inference mode is
+    /// allowed, and the outputs of a cell are only valid until all its
+    /// children are propagated (except for the network outputs and the
+    /// targets cells).
+    /// @return Peak activations memory with the plan, in bytes
+    std::size_t planInferenceMemory(MemoryManager::OptimizeStrategy strategy
+                                = MemoryManager::OptimizeMaxLifetimeMaxSizeFirst);
+    /// Give back its own storage to each cell
+    void clearInferenceMemoryPlan();
+    bool isInferenceMemoryPlanned() const
+    {
+        return !mMemorySlots.empty();
+    };
+    /// Move the free parameters and the gradients of all the Frame cells
+    /// in a single contiguous and aligned arena (see ParameterArena), to
+    /// allow single copy snapshots and whole network gradients operations.
+    /// Must be called after initialize(), once the network graph is final.
+    /// An exception is thrown for the cells whose parameters cannot be moved
+    /// in the arena: CUDA cells and cells with a quantizer.
+    /// Once initialized, the data-parallel gradients are averaged in a single
+    /// reduction in update() and the arena is saved by save() in a single
+    /// file (= -param-arena parameter of exec/n2d2).
+    void initializeParameterArena();
+    std::shared_ptr<ParameterArena<Float_T> > getParameterArena() const
+    {
+        return mParameterArena;
+    };
     void learn(std::vector<std::pair<std::string, double> >* timings = NULL);
     void learn_singleDevice(std::vector<std::pair<std::string, double> >* timings = NULL);
 #ifdef CUDA
@@ -278,9 +319,44 @@ public:
 
 protected:
     Parameter<std::string> mName;
+    /// If true, independent cells (parallel branches) are executed
+    /// concurrently during propagation and back-propagation (CPU only)
+    Parameter<bool> mParallelBranches;
 
 private:
+    struct ExecNode {
+        std::string name;
+        /// NULL if the cell is not a Cell_Frame_Top
+        std::shared_ptr<Cell_Frame_Top> cell;
+        /// Nodes depending on this node for the propagation
+        std::vector<unsigned int> successors;
+        /// Nodes depending on this node for the back-propagation
+        std::vector<unsigned int> backSuccessors;
+        unsigned int nbPredecessors;
+        unsigned int nbBackPredecessors;
+        /// The cell uses the global random generator and must not run
+        /// concurrently with another exclusive cell
+        bool exclusive;
+        /// Index in mMemorySlots, -1 if the outputs have their own storage
+        int memorySlot;
+    };
+
+    struct MemorySlot {
+        const std::type_info* type;
+        /// Storage size, in bytes
+        std::size_t size;
+        /// Clock at which the last user of the slot is released
+        MemoryManager::Clock_T released;
+        /// Cell currently holding the storage
+        const ExecNode* holder;
+    };
+
     std::string getCellModelType(const Cell& cell);
+    void invalidateExecPlan();
+    void acquireMemorySlot(const ExecNode& node);
+    void runExecPlan(bool backward,
+                     bool parallel,
+                     const std::function<void(const ExecNode&)>& func);
 
     Network& mNet;
     std::shared_ptr<Database> mDatabase;
@@ -322,6 +398,14 @@ private:
     mutable std::map<std::string,
                      std::map<std::vector<unsigned int>,
                               std::vector<unsigned int> > > mReceptiveFields;
+    // Execution plan, in propagation order
+    std::vector<ExecNode> mExecPlan;
+    // Indexes in mExecPlan, in back-propagation order
+    std::vector<unsigned int> mExecBackOrder;
+    bool mExecPlanValid;
+    std::mutex mExecPlanMutex;
+    std::vector<MemorySlot> mMemorySlots;
+    std::shared_ptr<ParameterArena<Float_T> > mParameterArena;
 };
 }
 
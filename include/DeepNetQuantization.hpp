@@ -25,6 +25,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "FloatT.hpp"
 #include "Histogram.hpp"
 #include "ScalingMode.hpp"
 #include "utils/Registrar.hpp"
@@ -37,6 +38,7 @@ class DeepNet;
 class ElemWiseCell;
 class RangeStats;
 class ScalingCell;
+template <class T> class Tensor;
 
 class DeepNetQuantization {
 public:
@@ -49,6 +51,25 @@ public:
                                 const std::unordered_map<std::string, RangeStats>& outputsRange,
                                 std::size_t nbBits, ClippingMode actClippingMode) const;
 
+    /// Outputs of the valid stimuli of the batch, for each cell
+    typedef std::unordered_map<std::string, std::vector<Float_T> > OutputsSnapshot;
+
+    /**
+     * Copy the outputs of the last propagated batch, so that their range and
+     * histogram can be reported with reportOutputsStats() while the next
+     * batch is propagated.
+     */
+    void snapshotOutputs(OutputsSnapshot& outputs) const;
+
+    /**
+     * Same as reportOutputsRange() followed by reportOutputsHistogram(), in
+     * a single pass on a snapshot of the outputs.
+     */
+    void reportOutputsStats(const OutputsSnapshot& outputs,
+                            std::unordered_map<std::string, RangeStats>& outputsRange,
+                            std::unordered_map<std::string, Histogram>& outputsHistogram,
+                            std::size_t nbBits, ClippingMode actClippingMode) const;
+
     void rescaleAdditiveParameters(double rescaleFactor);
 
     void crossLayerEqualization(double maxQuantRangeDelta = 1.0,
@@ -102,6 +123,12 @@ private:
                              std::size_t nbBits, ClippingMode actClippingMode,
                              double quantileValue = 0.9999);
 
+    void initOutputsHistogram(std::unordered_map<std::string, Histogram>& outputsHistogram,
+                              const std::unordered_map<std::string, RangeStats>& outputsRange,
+                              std::size_t nbBins) const;
+    template <class T>
+    void addOutputsHistogram(Histogram& hist, const Tensor<T>& outputs) const;
+
     double getActivationQuantizationScaling(const Cell& cell, std::size_t nbBits) const;
 
     void fuseScalingCells();
@@ -66,6 +66,12 @@ public:
 
 private:
     static std::string getCellModelType(const Cell& cell);
+    static void generateBatchLoop(const std::string& name,
+        const std::vector<std::pair<std::string, std::string> >& outputBuffers,
+        const std::string& callCode,
+        std::stringstream& batchFunctionCalls);
+    static bool isIdentifierInCode(const std::string& identifier,
+                                   const std::string& code);
 
     static Registrar<DeepNetExport> mRegistrar;
 };
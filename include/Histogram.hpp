@@ -22,11 +22,17 @@
 #ifndef N2D2_HISTOGRAM_H
 #define N2D2_HISTOGRAM_H
 
+#include <algorithm>
 #include <iosfwd>
+#include <stdexcept>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace N2D2 {
 
 enum class ClippingMode {
@@ -76,6 +82,16 @@ public:
 
     void operator()(double value, std::size_t count = 1);
 
+    /**
+     * Add the @p size contiguous values starting at @p values.
+     * The bin indexes are computed by blocks (vectorizable loop) and large
+     * ranges are binned in parallel in thread-local partial histograms.
+     * If a value is outside [getMinVal(), getMaxVal()], std::out_of_range is
+     * thrown and the histogram is left unchanged.
+     */
+    template <class T>
+    void add(const T* values, std::size_t size);
+
     std::size_t getNbBins() const;
     double getBinWidth() const;
     double getBinValue(std::size_t binIdx) const;
@@ -114,12 +130,28 @@ public:
                     double quantileValue = 0.9999);
 
 private:
-    static double KLDivergence(const Histogram& ref, const Histogram& quant);
+    /// Minimum number of values for a parallel add()
+    static const std::size_t ParallelMinSize = 65536;
+
+    static std::size_t getBinIdx(double value, double minVal, double maxVal,
+                                 std::size_t nbBins);
+    template <class T>
+    bool binValues(const T* values, std::size_t size,
+                   std::size_t* bins) const;
+    template <class T>
+    bool isOutOfRange(const T* values, std::size_t size) const;
+    void getPrefixSums(std::vector<unsigned long long>& count,
+                       std::vector<unsigned long long>& first,
+                       std::vector<unsigned long long>& second) const;
+
+    double KLDivergence(double threshold, std::size_t nbBits,
+                        const std::vector<unsigned long long>& count,
+                        double entropy) const;
 
-    double MSE(double threshold, std::size_t nbBits) const;
-                
-    Histogram quantize(double newMinVal, double newMaxVal,
-                       std::size_t newNbBins) const;
+    double MSE(double threshold, std::size_t nbBits,
+               const std::vector<unsigned long long>& count,
+               const std::vector<unsigned long long>& first,
+               const std::vector<unsigned long long>& second) const;
 private:
     double mMinVal;
     double mMaxVal;
@@ -129,4 +161,131 @@ private:
 };
 }
 
+inline std::size_t N2D2::Histogram::getBinIdx(double value,
+                                              double minVal,
+                                              double maxVal,
+                                              std::size_t nbBins)
+{
+    const double clampedValue = std::min(std::max(value, minVal), maxVal);
+    const std::size_t binIdx = static_cast<std::size_t>(
+        (clampedValue - minVal) / ((maxVal - minVal) / nbBins) + 1e-6);
+
+    return std::min(binIdx, nbBins - 1);
+}
+
+template <class T>
+bool N2D2::Histogram::binValues(const T* values,
+                                std::size_t size,
+                                std::size_t* bins) const
+{
+    // Same computation as getBinIdx(), by blocks: the index loop has no
+    // dependency and can be vectorized (int conversion, which is available
+    // in SSE2/NEON, unlike the 64 bits unsigned conversion)
+    const std::size_t BlockSize = 1024;
+    const double binWidth = getBinWidth();
+    const int maxBinIdx = static_cast<int>(mNbBins) - 1;
+    int indexes[BlockSize];
+    bool outOfRange = false;
+
+    for (std::size_t offset = 0; offset < size; offset += BlockSize) {
+        const std::size_t blockSize = std::min(BlockSize, size - offset);
+        const T* blockValues = values + offset;
+
+        for (std::size_t i = 0; i < blockSize; ++i) {
+            const double value = static_cast<double>(blockValues[i]);
+            outOfRange |= (value > mMaxVal || value < mMinVal);
+
+            const double clampedValue
+                = std::min(std::max(value, mMinVal), mMaxVal);
+            const int binIdx = static_cast<int>(
+                (clampedValue - mMinVal) / binWidth + 1e-6);
+            indexes[i] = std::min(binIdx, maxBinIdx);
+        }
+
+        for (std::size_t i = 0; i < blockSize; ++i)
+            ++bins[indexes[i]];
+    }
+
+    return outOfRange;
+}
+
+template <class T>
+bool N2D2::Histogram::isOutOfRange(const T* values, std::size_t size) const
+{
+    bool outOfRange = false;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        const double value = static_cast<double>(values[i]);
+        outOfRange |= (value > mMaxVal || value < mMinVal);
+    }
+
+    return outOfRange;
+}
+
+template <class T>
+void N2D2::Histogram::add(const T* values, std::size_t size)
+{
+    bool outOfRange = false;
+
+#ifdef _OPENMP
+    if (size >= std::max(ParallelMinSize, 4 * mNbBins)
+        && omp_get_max_threads() > 1 && !omp_in_parallel())
+    {
+        std::vector<std::vector<std::size_t> > partialBins(
+                                                    omp_get_max_threads());
+        const int nbBlocks = static_cast<int>((size + ParallelMinSize - 1)
+                                              / ParallelMinSize);
+
+#pragma omp parallel
+        {
+            std::vector<std::size_t>& bins = partialBins[omp_get_thread_num()];
+            bins.assign(mNbBins, 0);
+
+#pragma omp for schedule(static) reduction(|| : outOfRange)
+            for (int block = 0; block < nbBlocks; ++block) {
+                const std::size_t offset = block * ParallelMinSize;
+
+                outOfRange = binValues(values + offset,
+                                       std::min(ParallelMinSize,
+                                                size - offset),
+                                       &bins[0]) || outOfRange;
+            }
+
+            // Implicit barrier of the omp for: outOfRange is reduced
+            if (!outOfRange) {
+                const int nbThreads = omp_get_num_threads();
+
+#pragma omp for schedule(static)
+                for (int bin = 0; bin < (int)mNbBins; ++bin) {
+                    for (int t = 0; t < nbThreads; ++t)
+                        mValues[bin] += partialBins[t][bin];
+                }
+            }
+        }
+    }
+    else
+#endif
+    {
+        // Check first to leave the histogram unchanged on error
+        outOfRange = isOutOfRange(values, size);
+
+        if (!outOfRange)
+            binValues(values, size, &mValues[0]);
+    }
+
+    if (outOfRange) {
+        for (std::size_t i = 0; i < size; ++i) {
+            const double value = static_cast<double>(values[i]);
+
+            if (value > mMaxVal || value < mMinVal) {
+                throw std::out_of_range(std::to_string(value)
+                    + " not between [" + std::to_string(mMinVal) + ";"
+                    + std::to_string(mMaxVal) + "]");
+            }
+        }
+    }
+
+    mNbValues += size;
+}
+
 #endif // N2D2_HISTOGRAM_H
@@ -22,6 +22,8 @@
 #ifndef N2D2_RANGESTATS_H
 #define N2D2_RANGESTATS_H
 
+#include <algorithm>
+#include <cassert>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -38,6 +40,10 @@ public:
     double mean() const;
     double stdDev() const;
     void operator()(double value);
+
+    /// Add the @p size contiguous values starting at @p values, in one pass
+    template <class T>
+    void add(const T* values, std::size_t size);
     void save(std::ostream& state) const;
     void load(std::istream& state);
 
@@ -61,4 +67,33 @@ private:
 };
 }
 
+template <class T>
+void N2D2::RangeStats::add(const T* values, std::size_t size)
+{
+    assert(mMoments.size() == 3);
+
+    if (size == 0)
+        return;
+
+    double minVal = (mMoments[0] > 0) ? mMinVal : (double)values[0];
+    double maxVal = (mMoments[0] > 0) ? mMaxVal : (double)values[0];
+    double sum = 0.0;
+    double sumSquares = 0.0;
+
+    for (std::size_t i = 0; i < size; ++i) {
+        const double value = static_cast<double>(values[i]);
+
+        minVal = std::min(minVal, value);
+        maxVal = std::max(maxVal, value);
+        sum += value;
+        sumSquares += value * value;
+    }
+
+    mMinVal = minVal;
+    mMaxVal = maxVal;
+    mMoments[0] += size;
+    mMoments[1] += sum;
+    mMoments[2] += sumSquares;
+}
+
 #endif // N2D2_RANGESTATS_H
@@ -22,7 +22,9 @@
 #define N2D2_ADAMSOLVER_FRAME_H
 
 #include "Solver/AdamSolver.hpp"
+#include "Solver/FusedUpdate.hpp"
 #include "Solver/SGDSolver_Kernels.hpp"
+#include "utils/RingAllReduce.hpp"
 
 namespace N2D2 {
 template <class T> class AdamSolver_Frame : public AdamSolver {
@@ -83,6 +85,14 @@ void N2D2::AdamSolver_Frame<T>::update(BaseTensor& baseData,
 
     ++mNbSteps;
 
+    // Data-parallel learning: average the gradients of all the processes,
+    // unless already done with the whole parameter arena
+    if (mGradientReduction && !diffData.empty()
+        && !isReducedGradient(&diffData(0)))
+    {
+        mGradientReduction->average(diffData);
+    }
+
     if (mMomentum1Data.empty())
         mMomentum1Data.resize(data.dims(), T(0.0));
 
@@ -100,27 +110,46 @@ void N2D2::AdamSolver_Frame<T>::update(BaseTensor& baseData,
     const double epsilon = mEpsilon
         * std::sqrt(1.0 - std::pow((double)mBeta2, (double)mNbSteps));
 
-#pragma omp parallel for if (data.size() > 1024)
-    for (int index = 0; index < (int)data.size(); ++index) {
-        // Update biased first moment estimate
-        mMomentum1Data(index) = mBeta1 * mMomentum1Data(index)
-                                + (1.0 - mBeta1) * diffData(index);
-
-        // Update biased second raw moment estimate
-        mMomentum2Data(index) = mBeta2 * mMomentum2Data(index)
-                        + (1.0 - mBeta2) * (diffData(index) * diffData(index));
-
-        data(index) += alpha * mMomentum1Data(index)
-            / (std::sqrt(mMomentum2Data(index)) + epsilon);
-
-        // Clamping
-        if (clampMin != std::numeric_limits<T>::lowest()
-            || clampMax != std::numeric_limits<T>::max())
-        {
-            data(index) = Utils::clamp<T>(data(index),
-                clampMin, clampMax);
+    const bool clamping = (clampMin != std::numeric_limits<T>::lowest()
+                           || clampMax != std::numeric_limits<T>::max());
+
+    if (data.empty())
+        return;
+
+    const double beta1 = mBeta1;
+    const double beta2 = mBeta2;
+    T* dataPtr = &data(0);
+    const T* diffDataPtr = &diffData(0);
+    T* momentum1DataPtr = &mMomentum1Data(0);
+    T* momentum2DataPtr = &mMomentum2Data(0);
+
+    const FusedUpdate::Kernel_T kernel
+        = [=](std::size_t begin, std::size_t end)
+    {
+        for (std::size_t index = begin; index < end; ++index) {
+            // Update biased first moment estimate
+            momentum1DataPtr[index] = beta1 * momentum1DataPtr[index]
+                                    + (1.0 - beta1) * diffDataPtr[index];
+
+            // Update biased second raw moment estimate
+            momentum2DataPtr[index] = beta2 * momentum2DataPtr[index]
+                + (1.0 - beta2) * (diffDataPtr[index] * diffDataPtr[index]);
+
+            dataPtr[index] += alpha * momentum1DataPtr[index]
+                / (std::sqrt(momentum2DataPtr[index]) + epsilon);
+
+            // Clamping
+            if (clamping) {
+                dataPtr[index] = Utils::clamp<T>(dataPtr[index],
+                    clampMin, clampMax);
+            }
         }
-    }
+    };
+
+    if (mFusedUpdate)
+        mFusedUpdate->add(dataPtr, data.size(), kernel);
+    else
+        FusedUpdate::run(data.size(), kernel);
 }
 
 template <class T>
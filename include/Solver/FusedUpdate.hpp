@@ -0,0 +1,135 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_FUSEDUPDATE_H
+#define N2D2_FUSEDUPDATE_H
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "Solver/Solver.hpp"
+
+namespace N2D2 {
+/**
+ * List of element-wise parameter updates, executed all at once in a single
+ * parallel sweep, split in chunks of ChunkSize elements.
+ * While Solver::mFusedUpdate points to a FusedUpdate, the Frame solvers
+ * append their update to it instead of executing it (see DeepNet::update()).
+ */
+class FusedUpdate {
+public:
+    /// Update of the elements [begin, end) of a parameter tensor
+    typedef std::function<void(std::size_t, std::size_t)> Kernel_T;
+
+    FusedUpdate() : mNbElements(0), mGroup(0), mRunTime(0.0) {};
+    /// Append the update of the @p size elements of a parameter tensor
+    /// starting at @p data. If these elements are also updated by a pending
+    /// update (parameters shared between cells), the pending updates are
+    /// executed first, so that both updates are applied in order.
+    template <class T>
+    void add(const T* data, std::size_t size, const Kernel_T& kernel)
+    {
+        addRange(reinterpret_cast<const char*>(data),
+                 reinterpret_cast<const char*>(data + size), size, kernel);
+    }
+    /// Execute and clear the pending updates
+    void run();
+    /// Attribute the next appended updates to @p group, for the timings
+    void setGroup(std::size_t group)
+    {
+        mGroup = group;
+    }
+    /// Measure the execution time of the updates of @p nbGroups groups
+    void enableTimings(std::size_t nbGroups)
+    {
+        mGroupTimes.assign(nbGroups, 0.0);
+    }
+    /// Execution time of the updates of each group, in s. The time of each
+    /// run is split between the groups in proportion of their work.
+    const std::vector<double>& getGroupTimes() const
+    {
+        return mGroupTimes;
+    }
+    /// Total time spent in run(), in s
+    double getRunTime() const
+    {
+        return mRunTime;
+    }
+    bool empty() const
+    {
+        return mKernels.empty();
+    }
+    std::size_t getNbElements() const
+    {
+        return mNbElements;
+    }
+
+    /// Execute a single update, in parallel for large tensors
+    static void run(std::size_t size, const Kernel_T& kernel);
+
+private:
+    static const std::size_t ChunkSize = 4096;
+
+    void addRange(const char* begin,
+                  const char* end,
+                  std::size_t size,
+                  const Kernel_T& kernel);
+
+    std::vector<std::pair<std::size_t, Kernel_T> > mKernels;
+    /// Timings group of the pending kernels
+    std::vector<std::size_t> mGroups;
+    /// Memory ranges updated by the pending kernels
+    std::vector<std::pair<const char*, const char*> > mRanges;
+    std::size_t mNbElements;
+    std::size_t mGroup;
+    std::vector<double> mGroupTimes;
+    double mRunTime;
+};
+
+/**
+ * Execute the pending fused updates and disable the fused update in the
+ * scope, for code that reads the parameters right after their update, like
+ * the quantizers.
+ */
+class FusedUpdateBarrier {
+public:
+    FusedUpdateBarrier() : mFusedUpdate(Solver::mFusedUpdate)
+    {
+        if (mFusedUpdate) {
+            mFusedUpdate->run();
+            Solver::mFusedUpdate = NULL;
+        }
+    }
+    ~FusedUpdateBarrier()
+    {
+        Solver::mFusedUpdate = mFusedUpdate;
+    }
+
+private:
+    FusedUpdateBarrier(const FusedUpdateBarrier&);
+    FusedUpdateBarrier& operator=(const FusedUpdateBarrier&);
+
+    FusedUpdate* mFusedUpdate;
+};
+}
+
+#endif // N2D2_FUSEDUPDATE_H
@@ -21,9 +21,11 @@
 #ifndef N2D2_SGDSOLVER_FRAME_H
 #define N2D2_SGDSOLVER_FRAME_H
 
+#include "Solver/FusedUpdate.hpp"
 #include "Solver/SGDSolver.hpp"
 #include "Solver/SGDSolver_Kernels.hpp"
 #include "utils/Registrar.hpp"
+#include "utils/RingAllReduce.hpp"
 
 namespace N2D2 {
 template <class T> class SGDSolver_Frame : public SGDSolver {
@@ -86,63 +88,85 @@ void N2D2::SGDSolver_Frame<T>::update(BaseTensor& baseData,
     if (rate == 0.0)
         return;
 
+    // Data-parallel learning: average the gradients of all the processes,
+    // unless already done with the whole parameter arena
+    if (mGradientReduction && !diffData.empty()
+        && !isReducedGradient(&diffData(0)))
+    {
+        mGradientReduction->average(diffData);
+    }
+
     // Normalize in function of the iteration size
     const T rateDiff(rate / (batchSize * (T)mIterationSize));
 
     T clampMin, clampMax;
     std::tie(clampMin, clampMax) = getClamping<T>();
 
+    const bool clamping = (clampMin != std::numeric_limits<T>::lowest()
+                           || clampMax != std::numeric_limits<T>::max());
+
+    if (data.empty())
+        return;
+
+    T* dataPtr = &data(0);
+    const T* diffDataPtr = &diffData(0);
+    FusedUpdate::Kernel_T kernel;
+
     if (mMomentum == 0.0 && mDecay == 0.0) {
         // if outside the loop for better performance
-        // Clamping
-        if (clampMin != std::numeric_limits<T>::lowest()
-            || clampMax != std::numeric_limits<T>::max())
-        {
-            for (int index = 0; index < (int)data.size(); ++index) {
-                data(index) = Utils::clamp<T>(
-                    data(index)
-                        + rateDiff * diffData(index), clampMin, clampMax);
-            }
+        if (clamping) {
+            kernel = [=](std::size_t begin, std::size_t end) {
+                for (std::size_t index = begin; index < end; ++index) {
+                    dataPtr[index] = Utils::clamp<T>(
+                        dataPtr[index] + rateDiff * diffDataPtr[index],
+                        clampMin, clampMax);
+                }
+            };
         }
         else {
-            //#pragma omp parallel for
-            for (int index = 0; index < (int)data.size(); ++index)
-                data(index) += rateDiff * diffData(index);
+            kernel = [=](std::size_t begin, std::size_t end) {
+                for (std::size_t index = begin; index < end; ++index)
+                    dataPtr[index] += rateDiff * diffDataPtr[index];
+            };
         }
     } else {
         const T momentum(mMomentum);
+        const bool decay = (mDecay != 0.0);
+        // mMomentumData = mMomentumData - decay*rate*data
+        const T alpha = -T(mDecay) * rate;
 
         if (mMomentumData.empty())
             mMomentumData.resize(data.dims(), T(0.0));
 
-#pragma omp parallel for if (mMomentumData.size() > 1024)
-        for (int index = 0; index < (int)mMomentumData.size(); ++index) {
-            // mMomentumData = mMomentumData*momentum
-            mMomentumData(index) *= momentum;
+        T* momentumDataPtr = &mMomentumData(0);
 
-            // mMomentumData = mMomentumData + diffData*mWeightsLearningRate
-            mMomentumData(index) += rateDiff * diffData(index);
+        kernel = [=](std::size_t begin, std::size_t end) {
+            for (std::size_t index = begin; index < end; ++index) {
+                // mMomentumData = mMomentumData*momentum
+                // + diffData*mWeightsLearningRate
+                T momentumData = momentum * momentumDataPtr[index]
+                    + rateDiff * diffDataPtr[index];
 
-            if (mDecay != 0.0) {
-                const T decay(mDecay);
-                const T alpha = -decay * rate;
+                if (decay)
+                    momentumData += alpha * dataPtr[index];
 
-                // mMomentumData = mMomentumData - decay*rate*data
-                mMomentumData(index) += alpha * data(index);
-            }
+                momentumDataPtr[index] = momentumData;
 
-            // data = data + mMomentumData
-            if (clampMin != std::numeric_limits<T>::lowest()
-                || clampMax != std::numeric_limits<T>::max())
-            {
-                data(index) = Utils::clamp<T>(
-                    data(index) + mMomentumData(index),
-                        clampMin, clampMax);
+                // data = data + mMomentumData
+                if (clamping) {
+                    dataPtr[index] = Utils::clamp<T>(
+                        dataPtr[index] + momentumData, clampMin, clampMax);
+                }
+                else
+                    dataPtr[index] += momentumData;
             }
-            else
-                data(index) += mMomentumData(index);
-        }
+        };
     }
+
+    if (mFusedUpdate)
+        mFusedUpdate->add(dataPtr, data.size(), kernel);
+    else
+        FusedUpdate::run(data.size(), kernel);
 }
 
 template <class T>
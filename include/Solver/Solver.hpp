@@ -22,11 +22,14 @@
 #define N2D2_SOLVER_H
 
 #include <iosfwd>
+#include <utility>
 #include "utils/Parameterizable.hpp"
 
 namespace N2D2 {
 
 class BaseTensor;
+class FusedUpdate;
+class RingAllReduce;
 
 class Solver : public Parameterizable {
 public:
@@ -38,6 +41,24 @@ public:
     static unsigned long long int mLogSteps;
     /// Global learning rate, if > 0.0, overrides every solvers rate
     static double mGlobalLearningRate;
+    /// If not NULL, the gradients are averaged over the data-parallel
+    /// processes of this communicator before each update (= -dp parameter of
+    /// exec/n2d2)
+    static std::shared_ptr<RingAllReduce> mGradientReduction;
+    /// Memory range of the gradients already averaged over the
+    /// data-parallel processes for the current update, in a single reduction
+    /// of the parameter arena (see DeepNet::update())
+    static std::pair<const void*, const void*> mReducedGradients;
+    /// If not NULL, the Frame solvers append their element-wise update to
+    /// this list instead of executing it, so that the parameters of all the
+    /// cells are updated in a single parallel sweep (see DeepNet::update())
+    static FusedUpdate* mFusedUpdate;
+
+    static bool isReducedGradient(const void* diffData)
+    {
+        return (diffData >= mReducedGradients.first
+                && diffData < mReducedGradients.second);
+    }
 
     virtual const char* getType() const = 0;
     virtual void update(BaseTensor& data,
@@ -0,0 +1,112 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_STIMULICACHE_H
+#define N2D2_STIMULICACHE_H
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Database/Database.hpp"
+
+namespace N2D2 {
+/**
+ * Packed, append-only cache of pre-processed stimuli.
+ *
+ * The cache is made of two files:
+ * - @p fileName.dat: the matrices of each stimulus (data channels followed by
+ *   labels channels), stored contiguously and aligned;
+ * - @p fileName.idx: one fixed-size record per stimulus, giving its
+ *   location in the data file.
+ *
+ * A record is appended to the index only once the data is written, so that an
+ * interrupted run leaves a valid cache. The data present when the cache is
+ * opened is memory-mapped once, and the matrices returned by get() for these
+ * stimuli are read-only views on the mapping, valid for the lifetime of the
+ * cache. The stimuli appended afterwards are read with pread() and returned
+ * as copies, so that the growing file is never mapped again (see
+ * n2d2_cache to build the cache beforehand).
+ * put() and get() can be called concurrently.
+*/
+class StimuliCache {
+public:
+    StimuliCache(const std::string& fileName);
+    bool contains(Database::StimulusID id) const;
+    /// Return false if the stimulus @p id is not in the cache
+    bool get(Database::StimulusID id,
+             std::vector<cv::Mat>& data,
+             std::vector<cv::Mat>& labels) const;
+    /// Append the stimulus @p id to the cache, do nothing if it is already
+    /// present
+    void put(Database::StimulusID id,
+             const std::vector<cv::Mat>& data,
+             const std::vector<cv::Mat>& labels);
+    unsigned int size() const;
+    const std::string& getFileName() const
+    {
+        return mFileName;
+    };
+    virtual ~StimuliCache();
+
+private:
+    struct Entry {
+        std::uint32_t id;
+        std::uint32_t nbData;
+        std::uint32_t nbLabels;
+        std::uint32_t reserved;
+        std::uint64_t offset;
+        std::uint64_t size;
+    };
+
+    struct MatHeader {
+        std::int32_t rows;
+        std::int32_t cols;
+        std::int32_t type;
+        std::int32_t reserved;
+    };
+
+    void loadIndex();
+    void readData(std::uint64_t offset,
+                  std::uint64_t size,
+                  std::vector<char>& buffer) const;
+    static std::uint64_t matSize(const cv::Mat& mat);
+
+    static const char Magic[8];
+    static const std::uint64_t Alignment = 64;
+
+    const std::string mFileName;
+    std::unordered_map<Database::StimulusID, Entry> mEntries;
+    std::uint64_t mDataSize;
+    std::ofstream mDataFile;
+    std::ofstream mIndexFile;
+    int mFd;
+    /// Mapping of the data present when the cache was opened
+    void* mMapping;
+    std::uint64_t mMappingSize;
+    mutable std::mutex mMutex;
+};
+}
+
+#endif // N2D2_STIMULICACHE_H
@@ -23,9 +23,15 @@
 #define N2D2_STIMULIPROVIDER_H
 
 #include <algorithm>
+#include <condition_variable>
+#include <exception>
 #include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 #include <set>
 #include <deque>
@@ -43,6 +49,7 @@
 namespace N2D2 {
 
 class Adversarial;
+class StimuliCache;
 
 class StimuliProvider : virtual public Parameterizable, public std::enable_shared_from_this<StimuliProvider> {
 public:
@@ -186,6 +193,11 @@ public:
                                            Database::StimuliSetMask setMask
                                            = Database::All);
 
+    /// Set the Database decoding size hint from the first global
+    /// transformation of each set (only if ReducedDecode is true). Called
+    /// each time a global transformation is added.
+    void updateDecodeSizeHint();
+
     /// Add the transformation so that it is executed last.
     /// If any channel tranformation are present, the transformation will be
     /// added as an ON-THE-FLY transformation to ALL the existing channel.
@@ -257,6 +269,22 @@ public:
     void future();
     void synchronize();
 
+    /// Start reading random batches from the StimuliSet @p set in the
+    /// background, up to PrefetchDepth batches ahead, with PrefetchThreads
+    /// dedicated worker threads. The workers wait when all the buffers are
+    /// full.
+    void startPrefetch(Database::StimuliSet set);
+    /// Make the next prefetched batch current, waiting for it if it is not
+    /// ready yet, and synchronize it to the devices.
+    /// This replaces the future() / readRandomBatch() / synchronize() sequence
+    /// and leaves the future mode.
+    void readPrefetchedBatch();
+    void stopPrefetch();
+    bool isPrefetching() const
+    {
+        return !mPrefetchWorkers.empty();
+    };
+
     /// Return a random index from the StimuliSet @p set
     unsigned int getRandomIndex(Database::StimuliSet set);
 
@@ -325,6 +353,12 @@ public:
                                            unsigned int index,
                                            int dev = -1);
 
+    /// Apply the CACHEABLE transformations to the stimulus with StimulusID
+    /// @p id and store the result in the disk cache, if not already present.
+    /// Can be called concurrently, to pre-build the cache.
+    /// @return true if the stimulus was added to the cache
+    bool cacheStimulus(Database::StimulusID id, Database::StimuliSet set);
+
     /// Read the stimulus with index @p index in StimuliSet @p set, apply all
     /// the transformations and put the results at batch
     /// position @p batchPos in mData and mLabelsData
@@ -564,7 +598,10 @@ public:
     {
         return mCachePath;
     };
-    virtual ~StimuliProvider() {};
+    virtual ~StimuliProvider()
+    {
+        stopPrefetch();
+    };
 
     static void logData(const std::string& fileName,
                         Tensor<Float_T> data);
@@ -582,9 +619,22 @@ public:
     //                                     const unsigned int nbEpochs = 1,
     //                                     const bool randPermutation = false); 
 protected:
-    std::vector<cv::Mat> loadDataCache(const std::string& fileName) const;
-    void saveDataCache(const std::string& fileName,
-                       const std::vector<cv::Mat>& data) const;
+    /// Read the stimulus from the disk cache, or load it from the database and
+    /// apply the CACHEABLE transformations
+    /// @return true if the stimulus was read from the disk cache
+    bool readCacheableStimulus(Database::StimulusID id,
+                               Database::StimuliSet set,
+                               std::vector<std::shared_ptr<ROI> >& labelsROI,
+                               std::vector<cv::Mat>& rawChannelsData,
+                               std::vector<cv::Mat>& rawChannelsLabels);
+    void readStimulusData(Database::StimulusID id,
+                          Database::StimuliSet set,
+                          unsigned int batchPos,
+                          int dev,
+                          ProvidedData& provided);
+    void prefetchWorker(Database::StimuliSet set, unsigned int worker);
+    std::shared_ptr<StimuliCache> getStimuliCache(Database::StimuliSet set);
+    std::string getCacheName(Database::StimuliSet set) const;
     inline int getDevice(int dev) const;
 
 protected:
@@ -601,6 +651,21 @@ protected:
     Parameter<bool> mStreamTensor;
     /// Set to deepnet interface mode
     Parameter<bool> mStreamLabel;
+    /// Number of batches read ahead by startPrefetch() (0 = no prefetch)
+    Parameter<unsigned int> mPrefetchDepth;
+    /// Number of prefetch worker threads
+    Parameter<unsigned int> mPrefetchThreads;
+    /// Pin each prefetch worker thread to one of the last available CPUs
+    Parameter<bool> mPrefetchPinning;
+    /// Decode the stimuli directly at a reduced resolution when the first
+    /// transformation downscales them (Rescale or RandomResizeCrop)
+    Parameter<bool> mReducedDecode;
+    /// Relative size deficit tolerated for the reduced resolution stimuli,
+    /// compared to the size required by the first transformation
+    Parameter<double> mReducedDecodeTolerance;
+    /// Compose the consecutive geometric global transformations, in order
+    /// to resample the stimuli only once
+    Parameter<bool> mGeometricFusion;
 
     // Internal variables
     Database& mDatabase;
@@ -610,6 +675,10 @@ protected:
     bool mCompositeStimuli;
     /// Disk cache path for pre-processed stimuli (no disk cache if empty)
     std::string mCachePath;
+    /// Disk caches of pre-processed stimuli, opened on first use
+    std::map<Database::StimuliSet, std::shared_ptr<StimuliCache> >
+        mStimuliCaches;
+    std::mutex mStimuliCachesMutex;
     /// Global transformations
     TransformationsSets mTransformations;
     /// Channel transformations
@@ -639,6 +708,17 @@ protected:
     std::deque<unsigned int> mIndexesLearn;
     std::deque<unsigned int> mIndexesVal;
     std::deque<unsigned int> mIndexesTest;
+
+    /// Prefetch buffers (buffer x device)
+    std::vector<std::vector<ProvidedData> > mPrefetchBuffers;
+    /// Queues of the free and ready prefetch buffers
+    std::deque<unsigned int> mPrefetchFree;
+    std::deque<unsigned int> mPrefetchReady;
+    std::vector<std::thread> mPrefetchWorkers;
+    std::mutex mPrefetchMutex;
+    std::condition_variable mPrefetchCond;
+    std::exception_ptr mPrefetchError;
+    bool mPrefetchStop;
 };
 }
 
@@ -30,7 +30,7 @@ public:
 
     static const char* Type;
 
-    CompositeTransformation() {};
+    CompositeTransformation(): mGeometricFusion(false) {};
     /// Any transformation can be transformed to a composite transformation
     template <class T> CompositeTransformation(const T& transformation);
     template <class T>
@@ -65,17 +65,34 @@ public:
     getOutputsSize(unsigned int width, unsigned int height) const;
     int getOutputsDepth(int depth) const;
     inline void setStimuliProvider(StimuliProvider* sp);
+    /// If true, consecutive geometric transformations are composed and the
+    /// frame is resampled only once (see Transformation::warp())
+    void setGeometricFusion(bool geometricFusion)
+    {
+        mGeometricFusion = geometricFusion;
+    };
+    bool getGeometricFusion() const
+    {
+        return mGeometricFusion;
+    };
     virtual ~CompositeTransformation() {};
 
 private:
     inline virtual CompositeTransformation* doClone() const;
+    void applyFused(cv::Mat& frame,
+                    cv::Mat& labels,
+                    std::vector<std::shared_ptr<ROI> >& labelsROI,
+                    int id);
+    static void applyWarp(const Warp& warp, cv::Mat& frame, cv::Mat& labels);
 
     std::vector<std::shared_ptr<Transformation> > mTransformationSet;
+    bool mGeometricFusion;
 };
 }
 
 template <class T>
 N2D2::CompositeTransformation::CompositeTransformation(const T& transformation)
+    : mGeometricFusion(false)
 {
     mTransformationSet.push_back(std::make_shared<T>(transformation));
 }
@@ -83,6 +100,7 @@ N2D2::CompositeTransformation::CompositeTransformation(const T& transformation)
 template <class T>
 N2D2::CompositeTransformation::CompositeTransformation(const std::shared_ptr
                                                        <T>& transformation)
+    : mGeometricFusion(false)
 {
     mTransformationSet.push_back(transformation);
 }
@@ -93,6 +111,11 @@ void N2D2::CompositeTransformation::apply(cv::Mat& frame,
                                           <std::shared_ptr<ROI> >& labelsROI,
                                           int id)
 {
+    if (mGeometricFusion) {
+        applyFused(frame, labels, labelsROI, id);
+        return;
+    }
+
     for (std::vector<std::shared_ptr<Transformation> >::const_iterator it
          = mTransformationSet.begin(),
          itEnd = mTransformationSet.end();
@@ -170,6 +193,7 @@ N2D2::CompositeTransformation::operator[](unsigned int k) const
 N2D2::CompositeTransformation* N2D2::CompositeTransformation::doClone() const
 {
     CompositeTransformation* newTrans = new CompositeTransformation();
+    newTrans->mGeometricFusion = mGeometricFusion;
 
     for (std::vector<std::shared_ptr<Transformation> >::const_iterator it
          = mTransformationSet.begin(),
@@ -57,6 +57,13 @@ public:
     {
         return depth;
     };
+    bool isWarpable(const Warp& /*warp*/) const
+    {
+        return true;
+    };
+    void warp(Warp& warp,
+              std::vector<std::shared_ptr<ROI> >& labelsROI,
+              int /*id*/ = -1);
     virtual ~FlipTransformation() {};
     bool getHorizontalFlip(){
         return mHorizontalFlip;
@@ -71,6 +71,10 @@ public:
     {
         return depth;
     };
+    bool isWarpable(const Warp& warp) const;
+    void warp(Warp& warp,
+              std::vector<std::shared_ptr<ROI> >& labelsROI,
+              int /*id*/ = -1);
     virtual ~PadCropTransformation() {};
     int getWidth(){
         return mWidth;
@@ -58,6 +58,10 @@ public:
     {
         return depth;
     };
+    bool isWarpable(const Warp& warp) const;
+    void warp(Warp& warp,
+              std::vector<std::shared_ptr<ROI> >& labelsROI,
+              int /*id*/ = -1);
     virtual ~RescaleTransformation() {};
     unsigned int getWidth(){
         return mWidth;
@@ -81,6 +85,9 @@ private:
     void resize(cv::Mat& mat,
                 int interpolation,
                 std::vector<std::shared_ptr<ROI> >& labelsROI) const;
+    cv::Size getResizedSize(const cv::Size& size,
+                            double& xRatio,
+                            double& yRatio) const;
 
     const unsigned int mWidth;
     const unsigned int mHeight;
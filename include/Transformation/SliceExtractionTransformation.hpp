@@ -69,6 +69,10 @@ public:
     {
         return depth;
     };
+    bool isWarpable(const Warp& warp) const;
+    void warp(Warp& warp,
+              std::vector<std::shared_ptr<ROI> >& labelsROI,
+              int /*id*/ = -1);
     virtual ~SliceExtractionTransformation();
     unsigned int getWidth(){
         return mWidth;
@@ -127,6 +131,16 @@ private:
     {
         return new SliceExtractionTransformation(*this);
     }
+    /// Draw the slice scaling and offsets, return true if the slice must
+    /// be padded
+    bool randomSlice(const cv::Size& size,
+                     double& scaling,
+                     unsigned int& targetWidth,
+                     unsigned int& targetHeight,
+                     unsigned int& width,
+                     unsigned int& height,
+                     unsigned int& offsetX,
+                     unsigned int& offsetY) const;
 
     const unsigned int mWidth;
     const unsigned int mHeight;
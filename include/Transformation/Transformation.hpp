@@ -72,6 +72,26 @@ struct opencv_data_type<double> {
 
 class Transformation : public Parameterizable {
 public:
+    /// Geometric mapping of consecutive transformations, accumulated by
+    /// CompositeTransformation in order to resample the frame only once
+    struct Warp {
+        Warp(const cv::Size& size_ = cv::Size())
+            : matrix(cv::Matx33d::eye()),
+              size(size_),
+              interpolation(-1),
+              borderType(-1) {}
+
+        /// Mapping from the frame coordinates to the current coordinates
+        cv::Matx33d matrix;
+        /// Current size
+        cv::Size size;
+        /// Interpolation of the resampling steps (-1 if none)
+        int interpolation;
+        /// Border type for the out-of-frame pixels (-1 if none)
+        int borderType;
+        cv::Scalar borderValue;
+    };
+
     Transformation(): mStimuliProvider(NULL) {}
     virtual const char* getType() const = 0;
     inline void apply(cv::Mat& frame, int id = -1);
@@ -100,6 +120,17 @@ public:
         return std::make_pair(0U, 0U);
     };
     virtual int getOutputsDepth(int depth) const = 0;
+    /// Return true if the transformation is geometric and can be composed
+    /// with @p warp (compatible interpolation and border)
+    virtual bool isWarpable(const Warp& /*warp*/) const
+    {
+        return false;
+    };
+    /// Compose the transformation with @p warp and apply it to the ROIs,
+    /// instead of applying it to the frame
+    virtual void warp(Warp& /*warp*/,
+                      std::vector<std::shared_ptr<ROI> >& /*labelsROI*/,
+                      int /*id*/ = -1) {};
     virtual void setStimuliProvider(StimuliProvider* sp)
     {
         mStimuliProvider = sp;
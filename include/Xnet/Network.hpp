@@ -24,9 +24,9 @@
 
 #include <chrono>
 #include <functional>
+#include <memory>
 #include <queue>
 #include <set>
-#include <stack>
 #include <string>
 #include <unordered_map>
 #include <utility>
@@ -47,6 +47,7 @@
 
 namespace N2D2 {
 class SpikeEvent;
+class SpikeEventQueue;
 class Xcell;
 class Node;
 class NodeNeuron;
@@ -83,6 +84,13 @@ public:
 
     NetworkObserver(Network& net);
     virtual void notify(Time_T timestamp, NotifyType notify) = 0;
+    /// Returns true if the observer may call Network::stop() during the
+    /// simulation. The simulation is then run sequentially (see
+    /// Network::setNbThreads()).
+    virtual bool canStop() const
+    {
+        return false;
+    };
     virtual ~NetworkObserver();
 
 protected:
@@ -117,27 +125,56 @@ protected:
  * is called. This method handles all the internal events created by the node
  *itself, either in the N2D2::Node::incomingSpike()
  * or any other method and create events to its child nodes.
+ *
+ * The events are allocated by value in contiguous slabs and recycled. They are
+ *scheduled either in a binary heap (Network::PriorityQueue, the default) or in
+ *a hierarchical timing wheel (Network::TimingWheel, see
+ *N2D2::SpikeEventWheel), which is faster for large event-driven simulations.
+ *
+ * With setNbThreads(), the simulation is run in parallel with a conservative
+ *time-window synchronization: the nodes are partitioned between the threads,
+ *each with its own events queue, and the threads process the events of the
+ *window [t, t + lookahead) independently before exchanging the events created
+ *for the other partitions. The lookahead is the minimum synaptic delay between
+ *two partitions. The nodes that interact synchronously (lateral inhibition,
+ *synapses without delay, non parallelizable neurons, see
+ *NodeNeuron::isParallelizable()) are always in the same partition, so that the
+ *spike recordings are identical to the sequential simulation.
+ * A stop() requested during a time window cannot be applied to the events that
+ *the other partitions already processed: the simulation is therefore run
+ *sequentially when an observer can stop it (NetworkObserver::canStop()).
 */
 class Network {
 public:
+    enum EventScheduler {
+        PriorityQueue,
+        TimingWheel
+    };
+
     /// Constructor.
     /// @param seed Seed for the random generator, used in any N2D2 function. If
     /// left to 0, a seed based on the system clock
     /// is produced. If the seed is set to a positive value, it is garanteed
     /// that the simulation will always produce the
     /// same results.
-    Network(unsigned int seed = 0, bool saveSeed = true, bool printTimeElapsed=true);
+    /// @param scheduler Events scheduler.
+    /// @param wheelResolution Duration of a tick of the timing wheel
+    /// (Network::TimingWheel scheduler only).
+    Network(unsigned int seed = 0,
+            bool saveSeed = true,
+            bool printTimeElapsed = true,
+            EventScheduler scheduler = PriorityQueue,
+            Time_T wheelResolution = TimeNs);
     /// Process all the events in the network until no further event remains in
     /// the priority queue.
     /// @param stop If not 0, stop the simulation to the specified timestamp.
     /// Usefull for debug purpose, or to stop network
     /// simulations containing oscillations.
     bool run(Time_T stop = 0, bool clearActivity = true);
-    void stop(Time_T stop = 0, bool discard = false)
-    {
-        mStop = stop;
-        mDiscard = discard;
-    };
+    /// Stop the simulation at @p stop. During a parallel simulation, the
+    /// earliest requested stop is applied to the events that were not
+    /// processed yet by the partitions.
+    void stop(Time_T stop = 0, bool discard = false);
     void reset(Time_T timestamp = 0);
     /// Save the entire network state in a given location (binary format, not
     /// portable).
@@ -167,6 +204,31 @@ public:
     {
         return mLoadSavePath;
     };
+    EventScheduler getEventScheduler() const
+    {
+        return mScheduler;
+    };
+    /// Set the number of threads of the simulation (0 or 1 = sequential).
+    /// The parallel simulation requires OpenMP.
+    void setNbThreads(unsigned int nbThreads);
+    unsigned int getNbThreads() const
+    {
+        return mNbThreads;
+    };
+    /// Returns the number of partitions and the lookahead of the last
+    /// partitioning (1 partition means that it was run sequentially).
+    std::pair<unsigned int, Time_T> getPartitioning() const
+    {
+        return std::make_pair(mNbPartitions, mLookahead);
+    };
+    /// Force the partitioning of the nodes to be computed again at the next
+    /// parallel simulation. It is done automatically when nodes are added or
+    /// connected, when the synaptic delays are updated and when the state
+    /// returned by NodeNeuron::getLinkDelayState() changes.
+    void invalidatePartitions()
+    {
+        mPartitionsValid = false;
+    };
     /// Destructor.
     virtual ~Network();
 
@@ -184,21 +246,44 @@ public:
     recordSpike(NodeId_T nodeId, Time_T timestamp = 0, EventType_T type = 0);
 
 private:
+    bool runSequential();
+    bool runParallel();
+    void partition();
+    bool isPartitioningValid() const;
+    bool canStop() const;
+    void distributeEvents(unsigned int nbQueues);
+    void recordSpikeParallel(NodeId_T nodeId,
+                             Time_T timestamp,
+                             EventType_T type);
+
     // Internal variables
     std::set<NetworkObserver*> mObservers;
     std::string mLoadSavePath;
-    /// The priority queue containing the events to be processed by the
-    /// simulator.
-    std::priority_queue
-        <SpikeEvent*, std::vector<SpikeEvent*>, Utils::PtrLess<SpikeEvent*> >
-    mEvents;
+    const EventScheduler mScheduler;
+    const Time_T mWheelResolution;
+    /// The queues containing the events to be processed by the simulator
+    /// (one per partition, only the first one for the sequential simulation).
+    std::vector<std::shared_ptr<SpikeEventQueue> > mQueues;
     std::unordered_map<NodeId_T, NodeEvents_T> mSpikeRecording;
     bool mInitialized;
     Time_T mFirstEvent;
     Time_T mLastEvent;
     Time_T mStop;
     bool mDiscard;
-    std::stack<SpikeEvent*> mEventsPool;
+    // Parallel simulation
+    unsigned int mNbThreads;
+    bool mPartitionsValid;
+    unsigned int mNbPartitions;
+    Time_T mLookahead;
+    bool mParallelRun;
+    Time_T mWindowEnd;
+    /// State of the link delays of the parallelizable neurons at the last
+    /// partitioning (see NodeNeuron::getLinkDelayState())
+    std::vector<std::pair<NodeNeuron*, unsigned int> > mLinkDelayStates;
+    /// Events created for another partition, for each [from][to] partitions
+    std::vector<std::vector<std::vector<SpikeEvent*> > > mOutbox;
+    std::vector<std::unordered_map<NodeId_T, NodeEvents_T> >
+        mPartitionsRecording;
     const std::chrono::high_resolution_clock::time_point mStartTime;
     bool mSaveSeed;
     bool mPrintTimeElapsed;
@@ -208,7 +293,10 @@ private:
 void
 N2D2::Network::recordSpike(NodeId_T nodeId, Time_T timestamp, EventType_T type)
 {
-    mSpikeRecording[nodeId].push_back(std::make_pair(timestamp, type));
+    if (mParallelRun)
+        recordSpikeParallel(nodeId, timestamp, type);
+    else
+        mSpikeRecording[nodeId].push_back(std::make_pair(timestamp, type));
 }
 
 #endif // N2D2_NETWORK_H
@@ -169,6 +169,16 @@ public:
     {
         return mBranches;
     };
+    /// Returns the partition of the node in the parallel simulation (set by
+    /// the Network)
+    unsigned int getPartition() const
+    {
+        return mPartition;
+    };
+    void setPartition(unsigned int partition)
+    {
+        mPartition = partition;
+    };
     /// Destructor
     virtual ~Node() {};
 
@@ -187,6 +197,7 @@ protected:
     float mOrientation;
     unsigned short mLayer;
     Area mArea;
+    unsigned int mPartition;
 
     static unsigned int mIdCnt;
 
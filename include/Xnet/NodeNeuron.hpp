@@ -156,7 +156,64 @@ public:
 
     unsigned int getNbLinks() const
     {
-        return mLinks.size();
+        return mLinkOrigins.size();
+    };
+    /// Returns the input nodes of the neuron, sorted by ID
+    const std::vector<Node*>& getLinkOrigins() const
+    {
+        return mLinkOrigins;
+    };
+    /// Returns the synapses of the neuron, in the same order as
+    /// getLinkOrigins()
+    const std::vector<Synapse*>& getSynapses() const
+    {
+        return mSynapses;
+    };
+
+    /**
+     * Returns the index of the link from the input node @p origin in
+     *getLinkOrigins(), or -1 if @p origin is not linked to the neuron.
+     * The lookup is a direct indexing with the node ID when the IDs of the
+     *input nodes are dense, otherwise a binary search.
+     *
+     * @param origin        Input node
+     * @return Link index
+    */
+    inline int findLink(const Node* origin) const;
+    const std::vector<NodeNeuron*>& getLateralBranches() const
+    {
+        return mLateralBranches;
+    };
+
+    /**
+     * Indicates whether the neuron can be simulated in a different thread than
+     * its input nodes (see Network::setNbThreads()). This requires that the
+     * neuron does not draw random numbers during the simulation and only
+     * accesses the state of its input nodes through delayed events.
+    */
+    virtual bool isParallelizable() const
+    {
+        return false;
+    };
+
+    /**
+     * Minimum delay between the activation of the input node @p origin and its
+     * effect on the neuron, or 0 if the neuron depends synchronously on
+     * @p origin (only used if isParallelizable() is true).
+    */
+    virtual Time_T getLinkDelay(Node* /*origin*/) const
+    {
+        return 0;
+    };
+
+    /**
+     * State of the parameters that getLinkDelay() depends on, besides the
+     * synaptic delays. When it changes, the network is partitioned again at
+     * the next parallel simulation.
+    */
+    virtual unsigned int getLinkDelayState() const
+    {
+        return 0;
     };
 
     /// Destructor.
@@ -177,6 +234,19 @@ protected:
     virtual void finalize() {};
 
     virtual Synapse* newSynapse() const = 0;
+    /// Returns the synapse of the link from @p origin (NULL if there is none)
+    Synapse* getSynapse(const Node* origin) const
+    {
+        const int link = findLink(origin);
+        return (link >= 0) ? mSynapses[link] : NULL;
+    };
+    /// Synaptic delay of the link @p link
+    Time_T getLinkDelayAt(unsigned int link) const
+    {
+        return (mLinkDelays.empty()) ? 0 : mLinkDelays[link];
+    };
+    /// Update mLinkDelays from the synapses, after they were modified
+    void updateLinkDelays();
     virtual void saveInternal(std::ofstream& /*dataFile*/) const {};
     virtual void loadInternal(std::ifstream& /*dataFile*/) {};
     virtual void logStatePlot() = 0;
@@ -192,9 +262,27 @@ protected:
      * activation of the neuron
     */
     std::vector<NodeNeuron*> mLateralBranches;
-    /// Map containing the synapses of the neuron, associated to their input
-    /// neurons
-    std::unordered_map<Node*, Synapse*> mLinks;
+    /**
+     * The links of the neuron are stored in parallel arrays, sorted by input
+     * node ID, so that the learning rules can scan them linearly.
+     * They take 20 bytes per link (28 with synaptic delays), instead of 34 to
+     * 40 bytes per entry for the former unordered_map<Node*, Synapse*>.
+     * The synaptic state (weights, PCM/RRAM conductances, stats) remains in
+     * the Synapse objects, one per link, which are specific to each model.
+    */
+    /// Input nodes of the links
+    std::vector<Node*> mLinkOrigins;
+    /// Synapses of the links
+    std::vector<Synapse*> mSynapses;
+    /// Synaptic delays of the links (copy of Synapse::getDelay(), which avoids
+    /// accessing the synapse for events propagation). Empty if all the delays
+    /// are 0.
+    std::vector<Time_T> mLinkDelays;
+    /// ID of the first input node
+    NodeId_T mLinksIdOffset;
+    /// Link index of the input nodes, indexed by their ID minus mLinksIdOffset
+    /// (NoLink if not linked). Empty if the input node IDs are too sparse.
+    std::vector<unsigned int> mLinksIndex;
     /// File stream to store the state of the neuron
     std::ofstream mStateLog; // Note: using fstream makes this class
     // automatically non-copyable
@@ -205,7 +293,33 @@ protected:
     /// Indicates if the weight reconstruction images stored in cache are still
     /// valid or not
     bool mCacheValid;
+
+private:
+    void indexLinks();
+
+    static const unsigned int NoLink;
 };
 }
 
+int N2D2::NodeNeuron::findLink(const Node* origin) const
+{
+    const NodeId_T id = origin->getId();
+
+    if (!mLinksIndex.empty()) {
+        // Unsigned arithmetic: IDs below the offset are out of the table
+        const NodeId_T offset = id - mLinksIdOffset;
+
+        return (offset < mLinksIndex.size() && mLinksIndex[offset] != NoLink)
+            ? (int)mLinksIndex[offset] : -1;
+    }
+
+    const std::vector<Node*>::const_iterator it
+        = std::lower_bound(mLinkOrigins.begin(), mLinkOrigins.end(), id,
+                           [](const Node* node, NodeId_T nodeId)
+                           { return (node->getId() < nodeId); });
+
+    return (it != mLinkOrigins.end() && (*it) == origin)
+        ? (int)(it - mLinkOrigins.begin()) : -1;
+}
+
 #endif // N2D2_NODENEURON_H
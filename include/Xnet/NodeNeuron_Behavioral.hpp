@@ -44,6 +44,17 @@ public:
     void emitSpike(Time_T timestamp, EventType_T type = 0);
     void lateralInhibition(Time_T timestamp, EventType_T /*type*/ = 0);
     void reset(Time_T timestamp = 0);
+    bool isParallelizable() const
+    {
+        return true;
+    };
+    Time_T getLinkDelay(Node* origin) const;
+    unsigned int getLinkDelayState() const
+    {
+        // The time-based STDP reads the last activation time of the input
+        // nodes
+        return (mEnableStdp && mOrderStdp == 0);
+    };
     Time_T getRefractoryEnd() const
     {
         return mRefractoryEnd;
@@ -52,6 +52,14 @@ public:
     {
         return mDiscarded;
     };
+    Node* getOrigin() const
+    {
+        return mOrigin;
+    };
+    Node* getDestination() const
+    {
+        return mDestination;
+    };
     Time_T getTimestamp() const
     {
         return mTimestamp;
@@ -111,9 +119,32 @@ N2D2::Time_T N2D2::SpikeEvent::release()
 
 bool N2D2::SpikeEvent::operator<(const SpikeEvent& event) const
 {
-    return (mTimestamp > event.mTimestamp
-            || (mTimestamp == event.mTimestamp && mDestination == NULL
-                && event.mDestination != NULL));
+    if (mTimestamp != event.mTimestamp)
+        return (mTimestamp > event.mTimestamp);
+
+    // Incoming events before internal events
+    if ((mDestination == NULL) != (event.mDestination == NULL))
+        return (mDestination == NULL);
+
+    // Simultaneous events are ordered by nodes ID, so that the order does not
+    // depend on the scheduling order (which differs in the parallel
+    // simulation)
+    const NodeId_T origin = (mOrigin != NULL) ? mOrigin->getId() : 0;
+    const NodeId_T eventOrigin = (event.mOrigin != NULL)
+        ? event.mOrigin->getId() : 0;
+
+    if (origin != eventOrigin)
+        return (origin > eventOrigin);
+
+    const NodeId_T destination = (mDestination != NULL)
+        ? mDestination->getId() : 0;
+    const NodeId_T eventDestination = (event.mDestination != NULL)
+        ? event.mDestination->getId() : 0;
+
+    if (destination != eventDestination)
+        return (destination > eventDestination);
+
+    return (mType > event.mType);
 }
 
 #endif // N2D2_SPIKEEVENT_H
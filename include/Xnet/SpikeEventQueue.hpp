@@ -0,0 +1,130 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_SPIKEEVENTQUEUE_H
+#define N2D2_SPIKEEVENTQUEUE_H
+
+#include <memory>
+#include <queue>
+#include <vector>
+
+#include "SpikeEvent.hpp"
+#include "SpikeEventWheel.hpp"
+
+namespace N2D2 {
+/**
+ * Events queue of a N2D2::Network: allocates the N2D2::SpikeEvent by value in
+ * contiguous slabs, recycles them and schedules them either in a binary heap
+ * or in a N2D2::SpikeEventWheel.
+ * The sequential simulation uses a single queue, the parallel simulation one
+ * queue per partition of the nodes.
+*/
+class SpikeEventQueue {
+public:
+    SpikeEventQueue(Network::EventScheduler scheduler, Time_T wheelResolution);
+    /// Allocate a new event, without scheduling it.
+    inline SpikeEvent* newEvent(Node* origin,
+                                Node* destination,
+                                Time_T timestamp,
+                                EventType_T type);
+    inline void push(SpikeEvent* event);
+    /// Returns the next event to be processed, or NULL if there is none.
+    inline SpikeEvent* top();
+    inline void pop();
+    /// Make a processed or discarded event available for newEvent().
+    void recycle(SpikeEvent* event)
+    {
+        mEventsPool.push_back(event);
+    };
+    /// Remove all the scheduled events and return them in @p events.
+    void drain(std::vector<SpikeEvent*>& events);
+    /// Recycle all the scheduled events.
+    void clear();
+
+private:
+    static const std::size_t EventsSlabSize = 4096;
+
+    /// The priority queue (PriorityQueue scheduler)
+    std::priority_queue
+        <SpikeEvent*, std::vector<SpikeEvent*>, Utils::PtrLess<SpikeEvent*> >
+    mEvents;
+    /// The timing wheel (TimingWheel scheduler)
+    std::unique_ptr<SpikeEventWheel> mEventsWheel;
+    /// Storage of the events, by slabs of EventsSlabSize events.
+    std::vector<std::vector<SpikeEvent> > mEventsSlabs;
+    std::vector<SpikeEvent*> mEventsPool;
+};
+}
+
+N2D2::SpikeEvent* N2D2::SpikeEventQueue::newEvent(Node* origin,
+                                                  Node* destination,
+                                                  Time_T timestamp,
+                                                  EventType_T type)
+{
+    SpikeEvent* event;
+
+    if (mEventsPool.empty()) {
+        if (mEventsSlabs.empty()
+            || mEventsSlabs.back().size() == EventsSlabSize)
+        {
+            // A slab is never reallocated, so that the events addresses
+            // remain valid
+            mEventsSlabs.push_back(std::vector<SpikeEvent>());
+            mEventsSlabs.back().reserve(EventsSlabSize);
+        }
+
+        mEventsSlabs.back().push_back(
+            SpikeEvent(origin, destination, timestamp, type));
+        event = &mEventsSlabs.back().back();
+    }
+    else {
+        event = mEventsPool.back();
+        mEventsPool.pop_back();
+        event->initialize(origin, destination, timestamp, type);
+    }
+
+    return event;
+}
+
+void N2D2::SpikeEventQueue::push(SpikeEvent* event)
+{
+    if (mEventsWheel)
+        mEventsWheel->push(event);
+    else
+        mEvents.push(event);
+}
+
+N2D2::SpikeEvent* N2D2::SpikeEventQueue::top()
+{
+    if (mEventsWheel)
+        return mEventsWheel->top();
+
+    return (mEvents.empty()) ? NULL : mEvents.top();
+}
+
+void N2D2::SpikeEventQueue::pop()
+{
+    if (mEventsWheel)
+        mEventsWheel->pop();
+    else
+        mEvents.pop();
+}
+
+#endif // N2D2_SPIKEEVENTQUEUE_H
@@ -0,0 +1,106 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_SPIKEEVENTWHEEL_H
+#define N2D2_SPIKEEVENTWHEEL_H
+
+#include <cstdint>
+#include <queue>
+#include <vector>
+
+#include "SpikeEvent.hpp"
+
+namespace N2D2 {
+/**
+ * Hierarchical timing wheel scheduling the N2D2::SpikeEvent of a
+ * N2D2::Network, as an alternative to the binary heap
+ * (Network::PriorityQueue scheduler).
+ *
+ * The timestamps are divided in ticks of @p resolution. The wheel has 8 levels
+ * of 256 slots, one for each byte of the 64 bits tick: an event is stored in
+ * the slot of the most significant byte of its tick that differs from the
+ * current tick. Insertion is therefore O(1) and each event is moved at most
+ * once per level when the wheel advances. The events of the current tick are
+ * ordered exactly like in the priority queue, in a small heap.
+ * Discarded events are recycled as soon as their slot is expanded, without
+ * going through the heap.
+*/
+class SpikeEventWheel {
+public:
+    /// Constructor.
+    /// @param resolution       Duration of a tick
+    /// @param eventsPool       Pool where the discarded events are recycled
+    SpikeEventWheel(Time_T resolution, std::vector<SpikeEvent*>& eventsPool);
+    void push(SpikeEvent* event);
+    /// Returns the next event to be processed, or NULL if there is none.
+    inline SpikeEvent* top();
+    inline void pop();
+    /// Recycle all the remaining events in the pool.
+    void clear();
+    bool empty() const
+    {
+        return (mSize == 0);
+    };
+    std::size_t size() const
+    {
+        return mSize;
+    };
+    Time_T getResolution() const
+    {
+        return mResolution;
+    };
+
+private:
+    static const unsigned int NbLevels = 8;
+    static const unsigned int NbSlots = 256;
+
+    void insert(SpikeEvent* event);
+    bool advance();
+    int findSlot(unsigned int level, unsigned int first) const;
+
+    const Time_T mResolution;
+    std::vector<SpikeEvent*>& mEventsPool;
+    /// Events of the ticks <= mCurrentTick, in the priority queue order
+    std::priority_queue
+        <SpikeEvent*, std::vector<SpikeEvent*>, Utils::PtrLess<SpikeEvent*> >
+    mCurrent;
+    std::vector<SpikeEvent*> mSlots[NbLevels][NbSlots];
+    uint64_t mOccupancy[NbLevels][NbSlots / 64];
+    std::vector<SpikeEvent*> mExpanded;
+    Time_T mCurrentTick;
+    std::size_t mSize;
+};
+}
+
+N2D2::SpikeEvent* N2D2::SpikeEventWheel::top()
+{
+    if (mCurrent.empty() && !advance())
+        return NULL;
+
+    return mCurrent.top();
+}
+
+void N2D2::SpikeEventWheel::pop()
+{
+    mCurrent.pop();
+    --mSize;
+}
+
+#endif // N2D2_SPIKEEVENTWHEEL_H
@@ -27,6 +27,8 @@
 #include <stdexcept>
 #include <string>
 
+#include "Network.hpp"
+
 namespace N2D2 {
 /**
  * Abstract synapse base class, which provides the minimum interface required
@@ -65,6 +67,12 @@ struct Synapse {
             "Not possible to set the relative weight for this synapse model");
     };
 
+    /// Get the synaptic delay (0 = no synaptic delay)
+    virtual Time_T getDelay() const
+    {
+        return 0;
+    };
+
     virtual void saveInternal(std::ofstream& dataFile) const = 0;
     virtual void loadInternal(std::ifstream& dataFile) = 0;
 
@@ -76,6 +76,10 @@ struct Synapse_Normalized : public Synapse {
         return weight;
     };
     virtual void setRelativeWeight(double relWeight);
+    virtual Time_T getDelay() const
+    {
+        return delay;
+    };
     virtual void saveInternal(std::ofstream& dataFile) const;
     virtual void loadInternal(std::ifstream& dataFile);
     virtual Stats* newStats() const;
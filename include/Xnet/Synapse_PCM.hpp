@@ -148,6 +148,10 @@ struct Synapse_PCM : public Synapse {
     virtual Weight_T getWeight(double bipolarPosGain = 1.0) const;
     virtual void setPulse(Device& dev);
     virtual void resetPulse(Device& dev);
+    virtual Time_T getDelay() const
+    {
+        return delay;
+    };
     virtual void saveInternal(std::ofstream& dataFile) const;
     virtual void loadInternal(std::ifstream& dataFile);
     virtual Stats* newStats() const;
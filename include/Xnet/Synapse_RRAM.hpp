@@ -125,6 +125,10 @@ struct Synapse_RRAM : public Synapse {
     virtual int getDigitalWeight(double threshold) const;
     virtual void setPulse(Device& dev);
     virtual void resetPulse(Device& dev);
+    virtual Time_T getDelay() const
+    {
+        return delay;
+    };
     virtual void saveInternal(std::ofstream& dataFile) const;
     virtual void loadInternal(std::ifstream& dataFile);
     virtual Stats* newStats() const;
@@ -45,6 +45,10 @@ struct Synapse_Static : public Synapse {
     inline virtual double getRelativeWeight(bool allowBipolarRange
                                             = false) const;
     virtual void setRelativeWeight(double relWeight);
+    virtual Time_T getDelay() const
+    {
+        return delay;
+    };
     virtual void saveInternal(std::ofstream& dataFile) const;
     virtual void loadInternal(std::ifstream& dataFile);
     virtual Stats* newStats() const;
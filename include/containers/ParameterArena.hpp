@@ -0,0 +1,126 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_PARAMETERARENA_H
+#define N2D2_PARAMETERARENA_H
+
+#include <string>
+#include <vector>
+
+#include "containers/Tensor.hpp"
+
+namespace N2D2 {
+/**
+ * Contiguous storage for the free parameters and the gradients of a network.
+ *
+ * The registered tensors are moved in two buffers, one for the parameters
+ * and one for the gradients, and become views of these buffers. Each tensor
+ * starts on an Alignment bytes boundary and the padding between tensors is
+ * filled with zeros.
+ * The tensors must keep their dimensions as long as they are in the arena.
+*/
+template <class T>
+class ParameterArena {
+public:
+    /// Alignment of each tensor in the buffers, in bytes
+    static const std::size_t Alignment = 64;
+
+    ParameterArena();
+    /// Register a parameters tensor. Tensors registered several times (for
+    /// example weights shared between cells) are only stored once.
+    void addParameters(Tensor<T>& parameters);
+    void addGradients(Tensor<T>& gradients);
+    /// Move all the registered tensors in the arena
+    void initialize();
+    bool isInitialized() const
+    {
+        return mInitialized;
+    };
+    /// Number of registered parameters tensors
+    std::size_t getNbParametersTensors() const
+    {
+        return mParameters.tensors.size();
+    };
+    std::size_t getNbGradientsTensors() const
+    {
+        return mGradients.tensors.size();
+    };
+    /// Size of the parameters buffer, padding included
+    std::size_t getParametersSize() const
+    {
+        return mParameters.size;
+    };
+    std::size_t getGradientsSize() const
+    {
+        return mGradients.size;
+    };
+    T* getParameters()
+    {
+        return getData(mParameters);
+    };
+    const T* getParameters() const
+    {
+        return getData(mParameters);
+    };
+    T* getGradients()
+    {
+        return getData(mGradients);
+    };
+    const T* getGradients() const
+    {
+        return getData(mGradients);
+    };
+
+    /// Copy all the parameters in @p parameters, in a single copy
+    void snapshot(std::vector<T>& parameters) const;
+    /// Restore the parameters from a snapshot()
+    void restore(const std::vector<T>& parameters);
+    /// Save all the parameters in a single binary file
+    void save(const std::string& fileName) const;
+    void load(const std::string& fileName);
+    /// L2 norm of all the gradients
+    double getGradientsNorm() const;
+    /// Scale all the gradients so that their L2 norm is at most @p maxNorm
+    /// @return L2 norm of the gradients before clipping
+    double clipGradientsNorm(double maxNorm);
+
+private:
+    struct Buffer {
+        Buffer() : offset(0), size(0) {}
+
+        std::vector<Tensor<T>*> tensors;
+        Tensor<T> storage;
+        /// Offset of the first aligned element in storage
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    void add(Buffer& buffer, Tensor<T>& tensor);
+    void initialize(Buffer& buffer);
+    static T* getData(Buffer& buffer);
+    static const T* getData(const Buffer& buffer);
+
+    bool mInitialized;
+    Buffer mParameters;
+    Buffer mGradients;
+};
+}
+
+#endif // N2D2_PARAMETERARENA_H
@@ -398,6 +398,11 @@ public:
     virtual void save(std::ostream& stream) const;
     virtual void load(std::istream& stream);
     void swap(Tensor<T>& tensor);
+    /// Make the tensor a view of the data of @p storage, starting at
+    /// @p offset. The current content of the tensor is copied to the storage.
+    /// Other tensors sharing the previous data of this tensor (views and
+    /// copies) are not affected.
+    void share(Tensor<T>& storage, size_t offset = 0);
     Tensor<T> clone() const;
     // Return type should be "reference" (not T&), in order to ensure it works
     // for std::vector<bool>, which is a special case...
@@ -491,8 +496,8 @@ protected:
     template <class U> friend class Tensor;
 
 protected:
-    const std::shared_ptr<DataTensor<T> > mData;
-    const size_t mDataOffset;
+    std::shared_ptr<DataTensor<T> > mData;
+    size_t mDataOffset;
 };
 
 template <class T, bool ROUND>
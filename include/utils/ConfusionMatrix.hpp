@@ -214,6 +214,12 @@ public:
     {
     }
     inline void clear();
+    /// Histogram of the (target, estimated) labels pairs of @p size
+    /// elements, added to the matrix. Negative targets are ignored.
+    void accumulate(const int* targets,
+                    const int* estimated,
+                    std::size_t size);
+    inline ConfusionMatrix<T>& operator+=(const ConfusionMatrix<T>& matrix);
     inline ConfusionTable<T> getConfusionTable(unsigned int target,
                                                bool compute = true) const;
     std::vector<ConfusionTable<T> > getConfusionTables() const;
@@ -281,6 +287,68 @@ void N2D2::ConfusionMatrix<T>::clear()
     mSum = 0;
 }
 
+template <class T>
+void N2D2::ConfusionMatrix<T>::accumulate(const int* targets,
+                                          const int* estimated,
+                                          std::size_t size)
+{
+    const unsigned int nbCols = this->cols();
+    // Negative targets go to an extra bin, which is discarded
+    const unsigned int nbBins = this->rows() * nbCols + 1;
+    // Interleaved partial histograms: consecutive identical pairs (frequent
+    // in segmentation maps) increment different counters, which avoids
+    // serializing the increments on the same memory location
+    const unsigned int nbStripes = (size >= 4 * (std::size_t)nbBins) ? 4 : 1;
+    std::vector<unsigned int> histogram(nbStripes * nbBins, 0U);
+
+    const unsigned int blockSize = 256;
+    unsigned int bins[blockSize];
+
+    for (std::size_t offset = 0; offset < size; offset += blockSize) {
+        const unsigned int nbPairs
+            = std::min<std::size_t>(blockSize, size - offset);
+
+        // Branch-free bins computation, which can be vectorized
+        for (unsigned int i = 0; i < nbPairs; ++i) {
+            const int target = targets[offset + i];
+
+            bins[i] = (target >= 0)
+                ? (target * nbCols + estimated[offset + i])
+                : (nbBins - 1);
+        }
+
+        unsigned int i = 0;
+
+        for (; i + nbStripes <= nbPairs; i += nbStripes) {
+            for (unsigned int stripe = 0; stripe < nbStripes; ++stripe)
+                ++histogram[stripe * nbBins + bins[i + stripe]];
+        }
+
+        for (; i < nbPairs; ++i)
+            ++histogram[bins[i]];
+    }
+
+    for (unsigned int stripe = 0; stripe < nbStripes; ++stripe) {
+        for (unsigned int bin = 0; bin < nbBins - 1; ++bin)
+            (*this)(bin) += histogram[stripe * nbBins + bin];
+    }
+}
+
+template <class T>
+N2D2::ConfusionMatrix<T>&
+N2D2::ConfusionMatrix<T>::operator+=(const ConfusionMatrix<T>& matrix)
+{
+    if (matrix.empty())
+        return *this;
+
+    if (this->empty())
+        this->resize(matrix.rows(), matrix.cols(), 0);
+
+    std::transform(this->begin(), this->end(), matrix.begin(), this->begin(),
+                   std::plus<T>());
+    return *this;
+}
+
 template <class T>
 N2D2::ConfusionTable<T>
 N2D2::ConfusionMatrix<T>::getConfusionTable(unsigned int target,
@@ -0,0 +1,60 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_GEMM_H
+#define N2D2_GEMM_H
+
+#include "third_party/half.hpp"
+
+namespace N2D2 {
+namespace Gemm {
+    enum Operation {
+        NoTrans,
+        Trans
+    };
+
+    /// Type used by the packed micro-kernels to accumulate products
+    template <class T> struct Acc {
+        typedef T type;
+    };
+    template <> struct Acc<half_float::half> {
+        typedef float type;
+    };
+
+    /**
+     * Cache-blocked, register-tiled general matrix multiply on the host.
+     * Follows the same column-major conventions as cublasGemm():
+     * C = alpha * op(A) * op(B) + beta * C
+     * with op(A) a m x k matrix, op(B) a k x n matrix and C a m x n matrix.
+     * Operand panels are packed in contiguous buffers of type Acc<T>::type,
+     * so that half_float::half products are accumulated in float.
+    */
+    template <class T>
+    void gemm(Operation transA, Operation transB,
+              int m, int n, int k,
+              const T* alpha,
+              const T* A, int lda,
+              const T* B, int ldb,
+              const T* beta,
+              T* C, int ldc);
+}
+}
+
+#endif // N2D2_GEMM_H
@@ -31,6 +31,7 @@
 #include "Target/TargetMatching.hpp"
 #include "Transformation/RangeAffineTransformation.hpp"
 #include "utils/ProgramOptions.hpp"
+#include "utils/RingAllReduce.hpp"
 #include "Adversarial.hpp"
 #ifdef CUDA
 #include <cudnn.h>
@@ -59,9 +60,14 @@ namespace N2D2_HELPER{
         bool test = false;
         bool testQAT = false;
         bool fuse = false;
+        bool memPlan = false;
         bool bench = false;
+        unsigned int dataParallel = 0U;
+        bool paramArena = false;
         unsigned int learnStdp = 0U;
         double presentTime = 1.0;
+        bool timingWheel = false;
+        unsigned int simThreads = 0U;
         unsigned int avgWindow = 10000U;
         int testIndex = -1;
         int testId = -1;
@@ -76,6 +82,7 @@ namespace N2D2_HELPER{
         int nbBits = 8;
         int calibration = 0;
         bool calibrationReload = false;
+        unsigned int calibrationCheckpoint = 0U;
         // TODO : these attributes are not used as default on parser (see Options ctor)
         WeightsApprox cRoundMode = weightsScalingMode("NONE");
         WeightsApprox bRoundMode = weightsScalingMode("NONE");
@@ -119,10 +126,13 @@ namespace N2D2_HELPER{
     void sigUsr1Handler(int /*sig*/);
     #endif
     void printVersionInformation();
+    std::shared_ptr<RingAllReduce> initDataParallel(Options& opt,
+                                                    char* argv[]);
     void test(const Options&, std::shared_ptr<DeepNet>&, bool);
     void importFreeParameters(const Options& opt, DeepNet& deepNet);
     bool generateExport(const Options&, std::shared_ptr<DeepNet>&);
     void findLearningRate(const Options&, std::shared_ptr<DeepNet>&);
+    void initParameterArena(const Options&, std::shared_ptr<DeepNet>&);
     void learn_epoch(const Options&, std::shared_ptr<DeepNet>&);
     void learn(const Options&, std::shared_ptr<DeepNet>&);
     void learnStdp(const Options& opt, std::shared_ptr<DeepNet>& deepNet, 
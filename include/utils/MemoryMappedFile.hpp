@@ -0,0 +1,71 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_MEMORYMAPPEDFILE_H
+#define N2D2_MEMORYMAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace N2D2 {
+/**
+ * Read-only file content, mapped once in memory.
+ *
+ * The pages are only loaded on first access. The content must not be
+ * written: the mapping is read-only and a write faults (the non-const data()
+ * is only meant for wrapping the content in a cv::Mat, which the users must
+ * clone before modifying it, like Database::getStimulusData()). On platforms
+ * without mmap(), the whole file is read in memory.
+ * The content is valid for the lifetime of the object.
+*/
+class MemoryMappedFile {
+public:
+    MemoryMappedFile(const std::string& fileName);
+    unsigned char* data()
+    {
+        return mData;
+    };
+    const unsigned char* data() const
+    {
+        return mData;
+    };
+    std::size_t size() const
+    {
+        return mSize;
+    };
+    const std::string& getFileName() const
+    {
+        return mFileName;
+    };
+    virtual ~MemoryMappedFile();
+
+private:
+    MemoryMappedFile(const MemoryMappedFile&);
+    MemoryMappedFile& operator=(const MemoryMappedFile&);
+
+    const std::string mFileName;
+    unsigned char* mData;
+    std::size_t mSize;
+    std::vector<unsigned char> mBuffer;
+};
+}
+
+#endif // N2D2_MEMORYMAPPEDFILE_H
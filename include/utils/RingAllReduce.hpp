@@ -0,0 +1,95 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_RINGALLREDUCE_H
+#define N2D2_RINGALLREDUCE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "containers/Tensor.hpp"
+
+namespace N2D2 {
+/**
+ * Collective communications between local processes connected in a ring
+ * through Unix domain sockets.
+ * Rank r listens on "<address>.<r>" and connects to rank (r + 1) % size.
+ * Reductions use the bandwidth-optimal ring algorithm: the buffer is split
+ * in size segments, which are summed in size - 1 reduce-scatter steps and
+ * then circulated in size - 1 all-gather steps. Every segment is exchanged
+ * in chunks of ChunkSize bytes, each chunk being sent to the next rank while
+ * the matching chunk is received from the previous one.
+*/
+class RingAllReduce {
+public:
+    RingAllReduce(unsigned int rank,
+                  unsigned int size,
+                  const std::string& address,
+                  std::size_t chunkSize = 256 * 1024,
+                  double connectTimeout = 60.0);
+    unsigned int getRank() const
+    {
+        return mRank;
+    };
+    unsigned int getSize() const
+    {
+        return mSize;
+    };
+    /// In-place sum of @p data over all the ranks
+    template <class T> void allReduce(T* data, std::size_t count);
+    template <class T> void allReduce(Tensor<T>& data)
+    {
+        if (!data.empty())
+            allReduce(&data(0), data.size());
+    };
+    /// In-place average of @p data over all the ranks
+    template <class T> void average(T* data, std::size_t count);
+    template <class T> void average(Tensor<T>& data)
+    {
+        if (!data.empty())
+            average(&data(0), data.size());
+    };
+    /// Replace @p data on every rank by its value on rank @p root
+    template <class T> void broadcast(T* data, std::size_t count,
+                                      unsigned int root = 0);
+    void barrier();
+    virtual ~RingAllReduce();
+
+private:
+    void exchange(const char* sendData,
+                  std::size_t sendSize,
+                  char* recvData,
+                  std::size_t recvSize);
+    std::size_t segmentBegin(unsigned int segment, std::size_t count) const
+    {
+        return (count * segment) / mSize;
+    };
+
+    const unsigned int mRank;
+    const unsigned int mSize;
+    const std::size_t mChunkSize;
+    int mNextFd;
+    int mPrevFd;
+    std::vector<char> mRecvBuffer;
+};
+}
+
+#endif // N2D2_RINGALLREDUCE_H
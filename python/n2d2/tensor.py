@@ -313,6 +313,9 @@ class Tensor:
         """
         if not numpy_imported:
             raise ImportError("Numpy is not installed !")
+        if not copy and self._datatype != "bool":
+            # Non-owning view, which keeps the tensor data alive
+            return self.N2D2().numpyView()
         return array(self.N2D2(), copy=copy) 
 
     @classmethod
@@ -363,6 +366,29 @@ class Tensor:
         n2d2_tensor.reshape(np_array.shape)
         return n2d2_tensor
 
+    @classmethod
+    def from_dlpack(cls, tensor):
+        """Convert a tensor implementing the DLPack protocol (like a ``torch.Tensor`` or a ``numpy.array``)
+        or a DLPack capsule into a tensor.
+        The data is copied once, the dimensions are kept with the ``Numpy`` convention.
+
+        :param tensor: CPU tensor to convert
+        :type tensor: object implementing ``__dlpack__()``, or ``PyCapsule``
+        :return: Converted tensor
+        :rtype: :py:class:`n2d2.Tensor`
+        """
+        return cls.from_N2D2(N2D2.tensorFromDLPack(tensor))
+
+    def __dlpack__(self, **kwargs):
+        """Export the tensor with the DLPack protocol, without copy (for example with ``torch.from_dlpack()``).
+        The exported tensor shares the memory of the :py:class:`n2d2.Tensor`.
+        For a CUDA tensor, the host memory is exported.
+        """
+        return self.N2D2().__dlpack__(**kwargs)
+
+    def __dlpack_device__(self):
+        return self.N2D2().__dlpack_device__()
+
     @classmethod
     def from_N2D2(cls, N2D2_Tensor):
         """Convert an N2D2 tensor into a Tensor.
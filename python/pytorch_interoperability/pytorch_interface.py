@@ -20,6 +20,7 @@
 """
 try:
     import torch
+    import torch.utils.dlpack
 except ImportError:
     pass
 import n2d2
@@ -66,11 +67,9 @@ def _to_n2d2(torch_tensor):
         if n2d2_tensor.nb_dims() == 4:
             n2d2_tensor.reshape([dims[0], dims[1], dims[3], dims[2]])
     else:
-        numpy_tensor = torch_tensor.cpu().detach().numpy() 
-        # This operation create a CPU memory copy.
-        # torch.Tensor can have a discontiguous memory while n2d2.Tensor need a contiguous memory space. 
-        # Making the conversion hard to do without copy.
-        n2d2_tensor = n2d2.Tensor.from_numpy(numpy_tensor) 
+        # Single CPU memory copy through DLPack, which also handles a
+        # discontiguous torch.Tensor (n2d2.Tensor need a contiguous memory space).
+        n2d2_tensor = n2d2.Tensor.from_dlpack(torch_tensor.detach())
         if n2d2_tensor.nb_dims() == 4:
             n2d2_tensor.reshape(_switching_convention(n2d2_tensor.dims())) 
     return n2d2_tensor
@@ -83,12 +82,14 @@ def _to_torch(N2D2_tensor):
     This method also convert the shape of the tensor to follow torch convention.
     """
     n2d2_tensor = n2d2.Tensor.from_N2D2(N2D2_tensor)
-    numpy_tensor = n2d2_tensor.to_numpy() 
-    torch_tensor = torch.from_numpy(numpy_tensor)
+    # No CPU memory copy: the torch.Tensor shares the memory of the N2D2 tensor
+    torch_tensor = torch.utils.dlpack.from_dlpack(n2d2_tensor.__dlpack__())
     if n2d2_tensor.is_cuda:
         torch_tensor = torch_tensor.cuda() # Create GPU memory copy
     if n2d2_tensor.nb_dims() == 4:
-        torch_tensor.resize_(_switching_convention(n2d2_tensor.dims())) 
+        # view() only changes the shape and raises an error if the number of
+        # elements differs, whereas resize_() could reallocate the storage
+        torch_tensor = torch_tensor.view(_switching_convention(n2d2_tensor.dims())) 
     return torch_tensor
 
 
@@ -104,6 +104,30 @@ class test_tensor(unittest.TestCase):
         self.assertTrue(np.array_equal(np_tensor, equivalent_numpy))
         tensor_numpy = n2d2.Tensor.from_numpy(np_tensor)
         self.assertTrue(self.tensor == tensor_numpy)
+    def test_numpy_view(self):
+        N2D2_tensor = N2D2.Tensor_float([2, 3], 1.0)
+        view = N2D2_tensor.numpyView()
+        self.assertEqual(view.shape, (3, 2))
+        view[1, 1] = 5.0
+        self.assertEqual(N2D2_tensor[3], 5.0)
+        # The view keeps the data alive
+        del N2D2_tensor
+        self.assertEqual(view[1, 1], 5.0)
+
+    def test_dlpack(self):
+        self.tensor = n2d2.Tensor([3, 2], cuda=self.cuda)
+        for i in range(6):
+            self.tensor[i] = i + 1
+        np_tensor = np.from_dlpack(self.tensor)
+        self.assertTrue(np.array_equal(np_tensor, np.array([[1, 2], [3, 4], [5, 6]])))
+        # The memory is shared
+        np_tensor[0, 0] = 10
+        self.assertEqual(self.tensor[0], 10)
+        # Import of a discontiguous array
+        tensor_dlpack = n2d2.Tensor.from_dlpack(np.arange(6, dtype=np.float32).reshape(2, 3).T)
+        self.assertEqual(tensor_dlpack.shape(), [3, 2])
+        self.assertEqual([tensor_dlpack[i] for i in range(6)], [0, 3, 1, 4, 2, 5])
+
     def test_N2D2(self):
         N2D2_tensor = N2D2.Tensor_int([3, 2])
         N2D2_tensor[0] = 1
@@ -20,6 +20,7 @@
 
 #include "Scaling.hpp"
 #include "Activation/Activation.hpp"
+#include "Activation/FusedEpilogue.hpp"
 
 N2D2::Activation::Activation()
     : mScaling()
@@ -48,6 +49,33 @@ const N2D2::Scaling& N2D2::Activation::getActivationScaling() const {
 void N2D2::Activation::setActivationScaling(Scaling scaling) {
     mScaling = scaling;
 }
+bool N2D2::Activation::getFusedScaling(const Cell& cell,
+                                       FusedEpilogue& epilogue) const
+{
+    if (mQuantizer)
+        return false;
+
+    if (mScaling.getMode() == ScalingMode::NONE) {
+        epilogue.scaling.clear();
+        return true;
+    }
+    else if (mScaling.getMode() == ScalingMode::FLOAT_MULT) {
+        const FloatingPointScaling& scaling
+            = mScaling.getFloatingPointScaling();
+
+        epilogue.scaling = scaling.getScalingPerOutput();
+        epilogue.scalingClipped = scaling.getIsClipped();
+        epilogue.scalingClipping = scaling.getClippingPerOutput();
+        epilogue.quantizedNbBits = (mQuantizedNbBits > 0)
+            ? mQuantizedNbBits : cell.getQuantizedNbBits();
+        epilogue.outputUnsigned = DeepNetExport::isCellOutputUnsigned(cell);
+        return true;
+    }
+
+    // Fixed-point and shift scalings are only used for export simulation
+    return false;
+}
+
 void N2D2::Activation::exportParameters(const std::string& dirName,
                                         const std::string& cellName) const
 {
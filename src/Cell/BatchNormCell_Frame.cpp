@@ -519,6 +519,18 @@ void N2D2::BatchNormCell_Frame<T>::update()
     Cell_Frame<T>::update();
 }
 
+template <class T>
+void N2D2::BatchNormCell_Frame<T>::getFreeParameters(
+    std::vector<BaseTensor*>& parameters,
+    std::vector<BaseTensor*>& gradients)
+{
+    // The running mean and variance are not updated by the solvers
+    parameters.push_back(mScale.get());
+    parameters.push_back(mBias.get());
+    gradients.push_back(&mDiffScale);
+    gradients.push_back(&mDiffBias);
+}
+
 template <class T>
 void N2D2::BatchNormCell_Frame<T>::checkGradient(double epsilon, double maxError)
 {
@@ -18,10 +18,12 @@
     knowledge of the CeCILL-C license and that you accept its terms.
 */
 
+#include "Activation/FusedEpilogue.hpp"
 #include "GradientCheck.hpp"
 #include "Cell/ConvCell_Frame.hpp"
 #include "DeepNet.hpp"
 #include "Filler/NormalFiller.hpp"
+#include "Solver/FusedUpdate.hpp"
 #include "Solver/SGDSolver_Frame.hpp"
 #include "third_party/half.hpp"
 
@@ -64,6 +66,7 @@ N2D2::ConvCell_Frame<T>::ConvCell_Frame(const DeepNet& deepNet, const std::strin
       Cell_Frame<T>(deepNet, name, nbOutputs, activation),
       // IMPORTANT: Do not change the value of the parameters here! Use
       // setParameter() or loadParameters().
+      mAlgorithm(this, "Algorithm", ConvCell_Frame_Kernels::Direct),
       mBias(std::make_shared<Tensor<T> >()),
       mDiffBias({1, 1, getNbOutputs(), 1}),
       mConvDesc(mSubSampleDims, mStrideDims, mPaddingDims, mDilationDims)
@@ -377,10 +380,23 @@ void N2D2::ConvCell_Frame<T>::propagate(bool inference)
 
     unsigned int offset = 0;
 
+    mConvDesc.algorithm = mAlgorithm;
+
     if (mQuantizer) {
         mQuantizer->propagate();
     }
 
+    // The bias, and the activation in inference, are applied by the kernel
+    // of the last input on each output plane, instead of separate passes on
+    // the whole outputs
+    const Tensor<T> biases = (mNoBias) ? Tensor<T>()
+        : mQuantizer ? tensor_cast<T>(mQuantizer->getQuantizedBiases())
+                     : tensor_cast<T>(*mBias);
+
+    FusedEpilogue epilogue;
+    const bool fusedActivation = (inference && this->mActivation
+        && this->mActivation->getFusedEpilogue(*this, epilogue));
+
     for (unsigned int k = 0, size = mInputs.size(); k < size; ++k) {
         if (k > 0)
             beta = 1.0;
@@ -390,6 +406,7 @@ void N2D2::ConvCell_Frame<T>::propagate(bool inference)
         const Tensor<T>& sharedSynapses 
             = mQuantizer ? (tensor_cast<T>(mQuantizer->getQuantizedWeights(k))) 
                         : tensor_cast<T>(mSharedSynapses[k]);
+        const bool last = (k == size - 1);
 
         ConvCell_Frame_Kernels::forward<T>(&alpha,
                                         input,
@@ -397,19 +414,16 @@ void N2D2::ConvCell_Frame<T>::propagate(bool inference)
                                         mConvDesc,
                                         &beta,
                                         mOutputs,
-                                        mMapping.rows(offset, mInputs[k].dimZ()));
+                                        mMapping.rows(offset, mInputs[k].dimZ()),
+                                        (last) ? biases : Tensor<T>(),
+                                        (last && fusedActivation) ? &epilogue
+                                                                  : NULL);
 
         offset += mInputs[k].dimZ();
     }
 
-    if (!mNoBias) {
-        const Tensor<T>& biases 
-            = mQuantizer ? tensor_cast<T>(mQuantizer->getQuantizedBiases())
-                        : tensor_cast<T>(*mBias);
-        ConvCell_Frame_Kernels::forwardBias<T>(&alpha, biases, &alpha, mOutputs);
-    }
-
-    Cell_Frame<T>::propagate(inference);
+    if (!fusedActivation)
+        Cell_Frame<T>::propagate(inference);
     mDiffInputs.clearValid();
     mDiffSharedSynapses.clearValid();
     mDiffBias.clearValid();
@@ -526,6 +540,8 @@ void N2D2::ConvCell_Frame<T>::update()
     }
 
     if(mQuantizer){
+        // The quantizer reads the updated full precision weights
+        FusedUpdateBarrier fusedUpdateBarrier;
         mQuantizer->update((unsigned int)mInputs.dimB());
     }
     Cell_Frame<T>::update();
@@ -546,6 +562,33 @@ void N2D2::ConvCell_Frame<T>::setWeights(unsigned int k,
     mExtSharedSynapses[k] = std::make_pair(weightsInterface, offset);
 }
 
+template <class T>
+void N2D2::ConvCell_Frame<T>::getFreeParameters(
+    std::vector<BaseTensor*>& parameters,
+    std::vector<BaseTensor*>& gradients)
+{
+    // The quantizer keeps its own references to the parameters
+    if (mQuantizer) {
+        throw std::runtime_error("ConvCell_Frame<T>::getFreeParameters(): the "
+                                 "parameters of cell " + mName + " cannot be "
+                                 "moved in the parameter arena, as it has a "
+                                 "quantizer");
+    }
+
+    for (unsigned int k = 0, size = mSharedSynapses.size(); k < size; ++k) {
+        // External weights are registered by the cell owning them
+        if (mExtSharedSynapses.find(k) == mExtSharedSynapses.end())
+            parameters.push_back(&mSharedSynapses[k]);
+
+        gradients.push_back(&mDiffSharedSynapses[k]);
+    }
+
+    if (!mNoBias) {
+        parameters.push_back(mBias.get());
+        gradients.push_back(&mDiffBias);
+    }
+}
+
 template <class T>
 void N2D2::ConvCell_Frame<T>::checkGradient(double epsilon, double maxError)
 {
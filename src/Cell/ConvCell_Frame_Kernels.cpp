@@ -18,11 +18,458 @@
     knowledge of the CeCILL-C license and that you accept its terms.
 */
 
+#include "Activation/FusedEpilogue.hpp"
 #include "Cell/ConvCell_Frame_Kernels.hpp"
 #include "containers/Tensor.hpp"
 #include "third_party/half.hpp"
+#include "utils/Gemm.hpp"
 #include "utils/Utils.hpp"
 
+namespace {
+template <class T>
+inline const T* tensorPtr(const N2D2::Tensor<T>& tensor)
+{
+    return &(*tensor.begin());
+}
+
+template <class T>
+inline T* tensorPtr(N2D2::Tensor<T>& tensor)
+{
+    return &(*tensor.begin());
+}
+
+/// Apply the bias and the epilogue on the (output, batchPos) output plane
+template <class T>
+inline void forwardEpilogue(N2D2::Tensor<T>& outputs,
+                            unsigned int output,
+                            unsigned int batchPos,
+                            const N2D2::Tensor<T>& bias,
+                            const N2D2::FusedEpilogue& epilogue)
+{
+    const size_t planeSize = outputs.dimX() * outputs.dimY();
+    T* plane = tensorPtr(outputs)
+        + ((size_t)batchPos * outputs.dimZ() + output) * planeSize;
+
+    epilogue.apply(plane, planeSize, output,
+                   (bias.empty()) ? NULL : &bias(output));
+}
+
+bool isFullMap(const N2D2::Tensor<bool>& maps)
+{
+    return (maps.empty()
+        || std::find(maps.begin(), maps.end(), false) == maps.end());
+}
+
+/// Return the kernels as a (channels * kernel size) x (outputs) column-major
+/// matrix, with the kernels of the non-connected (output, channel) pairs
+/// zeroed
+template <class T>
+const T* maskedSynapses(const N2D2::Tensor<T>& sharedSynapses,
+                        const N2D2::Tensor<bool>& maps,
+                        std::vector<T>& masked)
+{
+    if (isFullMap(maps))
+        return tensorPtr(sharedSynapses);
+
+    const size_t kernelSize = sharedSynapses.dimX() * sharedSynapses.dimY();
+    masked.assign(sharedSynapses.begin(), sharedSynapses.end());
+
+    for (unsigned int output = 0; output < sharedSynapses.dimB(); ++output) {
+        for (unsigned int channel = 0; channel < sharedSynapses.dimZ();
+            ++channel)
+        {
+            if (!maps(output, channel)) {
+                T* kernel = &masked[(output * sharedSynapses.dimZ() + channel)
+                                    * kernelSize];
+                std::fill(kernel, kernel + kernelSize, T(0.0));
+            }
+        }
+    }
+
+    return &masked[0];
+}
+
+/// True if the convolution is a plain matrix product, without any im2col
+/// transformation (1x1 kernel, unit stride and no padding)
+bool isPointwise(unsigned int kernelWidth,
+                 unsigned int kernelHeight,
+                 const N2D2::ConvCell_Frame_Kernels::Descriptor& desc)
+{
+    return (kernelWidth == 1 && kernelHeight == 1
+        && desc.stride[0] == 1 && desc.stride[1] == 1
+        && desc.padding[0] == 0 && desc.padding[1] == 0
+        && desc.padding[2] == 0 && desc.padding[3] == 0);
+}
+
+/// Unfold the receptive fields of one input (channels x height x width) in a
+/// (oxSize * oySize) x (channels * kernelHeight * kernelWidth) column-major
+/// matrix
+template <class T>
+void im2col(const T* input,
+            unsigned int width,
+            unsigned int height,
+            unsigned int channels,
+            unsigned int kernelWidth,
+            unsigned int kernelHeight,
+            const N2D2::ConvCell_Frame_Kernels::Descriptor& desc,
+            unsigned int oxSize,
+            unsigned int oySize,
+            T* col)
+{
+    const int kernelSize = kernelWidth * kernelHeight;
+    const int size = channels * kernelSize;
+    const size_t oSize = oxSize * oySize;
+
+#pragma omp parallel for if (size > 16 && size * oSize > 16384)
+    for (int k = 0; k < size; ++k) {
+        const unsigned int sx = k % kernelWidth;
+        const unsigned int sy = (k / kernelWidth) % kernelHeight;
+        const unsigned int channel = k / kernelSize;
+
+        const T* inputChannel = input + (size_t)channel * width * height;
+        T* colK = col + (size_t)k * oSize;
+
+        for (unsigned int oy = 0; oy < oySize; ++oy) {
+            const int iy = (int)(oy * desc.stride[1] + sy) - desc.padding[1];
+            T* colKy = colK + oy * oxSize;
+
+            if (iy < 0 || iy >= (int)height) {
+                std::fill(colKy, colKy + oxSize, T(0.0));
+                continue;
+            }
+
+            const T* inputLine = inputChannel + (size_t)iy * width;
+
+            for (unsigned int ox = 0; ox < oxSize; ++ox) {
+                const int ix = (int)(ox * desc.stride[0] + sx)
+                    - desc.padding[0];
+
+                colKy[ox] = (ix >= 0 && ix < (int)width) ? inputLine[ix]
+                                                         : T(0.0);
+            }
+        }
+    }
+}
+
+/// Fold back a matrix produced by im2col(), accumulating alpha * col in
+/// diffOutput
+template <class T>
+void col2im(const T* col,
+            const T& alpha,
+            unsigned int width,
+            unsigned int height,
+            unsigned int channels,
+            unsigned int kernelWidth,
+            unsigned int kernelHeight,
+            const N2D2::ConvCell_Frame_Kernels::Descriptor& desc,
+            unsigned int oxSize,
+            unsigned int oySize,
+            T* diffOutput)
+{
+    const size_t oSize = oxSize * oySize;
+
+#pragma omp parallel for if (channels > 4 && channels * oSize > 16384)
+    for (int channel = 0; channel < (int)channels; ++channel) {
+        T* diffOutputChannel = diffOutput + (size_t)channel * width * height;
+
+        for (unsigned int sy = 0; sy < kernelHeight; ++sy) {
+            for (unsigned int sx = 0; sx < kernelWidth; ++sx) {
+                const T* colK = col + (size_t)(sx + kernelWidth
+                    * (sy + kernelHeight * channel)) * oSize;
+
+                for (unsigned int oy = 0; oy < oySize; ++oy) {
+                    const int iy = (int)(oy * desc.stride[1] + sy)
+                        - desc.padding[1];
+
+                    if (iy < 0 || iy >= (int)height)
+                        continue;
+
+                    T* diffOutputLine = diffOutputChannel + (size_t)iy * width;
+                    const T* colKy = colK + oy * oxSize;
+
+                    for (unsigned int ox = 0; ox < oxSize; ++ox) {
+                        const int ix = (int)(ox * desc.stride[0] + sx)
+                            - desc.padding[0];
+
+                        if (ix >= 0 && ix < (int)width)
+                            diffOutputLine[ix] += alpha * colKy[ox];
+                    }
+                }
+            }
+        }
+    }
+}
+
+template <class T>
+bool forwardIm2col(const T* alpha,
+                   const N2D2::Tensor<T>& inputs,
+                   const N2D2::Tensor<T>& sharedSynapses,
+                   const N2D2::ConvCell_Frame_Kernels::Descriptor& desc,
+                   const T* beta,
+                   N2D2::Tensor<T>& outputs,
+                   const N2D2::Tensor<bool>& maps,
+                   const N2D2::Tensor<T>& bias,
+                   const N2D2::FusedEpilogue* epilogue)
+{
+    const unsigned int oxSize
+        = (unsigned int)((inputs.dimX() + desc.padding[0] + desc.padding[2]
+                          - sharedSynapses.dimX() + desc.stride[0])
+                         / (double)desc.stride[0]);
+    const unsigned int oySize
+        = (unsigned int)((inputs.dimY() + desc.padding[1] + desc.padding[3]
+                          - sharedSynapses.dimY() + desc.stride[1])
+                         / (double)desc.stride[1]);
+
+    if (desc.subSample[0] > 1 || desc.subSample[1] > 1
+        || outputs.dimX() != oxSize || outputs.dimY() != oySize)
+    {
+        return false;
+    }
+
+    const int oSize = oxSize * oySize;
+    const int kSize = sharedSynapses.dimX() * sharedSynapses.dimY()
+                        * inputs.dimZ();
+    const bool pointwise = isPointwise(sharedSynapses.dimX(),
+                                       sharedSynapses.dimY(), desc);
+
+    std::vector<T> masked;
+    const T* synapses = maskedSynapses(sharedSynapses, maps, masked);
+    std::vector<T> col((pointwise) ? 0 : (size_t)oSize * kSize);
+
+    for (unsigned int batchPos = 0; batchPos < inputs.dimB(); ++batchPos) {
+        const T* input = tensorPtr(inputs) + batchPos * inputs.dimX()
+            * inputs.dimY() * inputs.dimZ();
+        T* output = tensorPtr(outputs) + batchPos * outputs.dimX()
+            * outputs.dimY() * outputs.dimZ();
+
+        if (!pointwise) {
+            im2col(input, inputs.dimX(), inputs.dimY(), inputs.dimZ(),
+                   sharedSynapses.dimX(), sharedSynapses.dimY(), desc,
+                   oxSize, oySize, &col[0]);
+        }
+
+        // outputs = col * synapses
+        N2D2::Gemm::gemm<T>(N2D2::Gemm::NoTrans,
+                            N2D2::Gemm::NoTrans,
+                            oSize,
+                            outputs.dimZ(),
+                            kSize,
+                            alpha,
+                            (pointwise) ? input : &col[0],
+                            oSize,
+                            synapses,
+                            kSize,
+                            beta,
+                            output,
+                            oSize);
+
+        if (epilogue != NULL) {
+#pragma omp parallel for if (outputs.dimZ() > 4 \
+                             && outputs.dimZ() * oSize > 16384)
+            for (int output = 0; output < (int)outputs.dimZ(); ++output)
+                forwardEpilogue(outputs, output, batchPos, bias, *epilogue);
+        }
+    }
+
+    return true;
+}
+
+template <class T>
+bool backwardDataIm2col(const T* alpha,
+                        const N2D2::Tensor<T>& sharedSynapses,
+                        const N2D2::Tensor<T>& diffInputs,
+                        const N2D2::ConvCell_Frame_Kernels::Descriptor& desc,
+                        const T* beta,
+                        N2D2::Tensor<T>& diffOutputs,
+                        const N2D2::Tensor<bool>& maps)
+{
+    const unsigned int oxSize
+        = (unsigned int)((diffOutputs.dimX() + desc.padding[0]
+            + desc.padding[2] - sharedSynapses.dimX() + desc.stride[0])
+                         / (double)desc.stride[0]);
+    const unsigned int oySize
+        = (unsigned int)((diffOutputs.dimY() + desc.padding[1]
+            + desc.padding[3] - sharedSynapses.dimY() + desc.stride[1])
+                         / (double)desc.stride[1]);
+
+    if (desc.subSample[0] > 1 || desc.subSample[1] > 1
+        || diffInputs.dimX() != oxSize || diffInputs.dimY() != oySize)
+    {
+        return false;
+    }
+
+    const int oSize = oxSize * oySize;
+    const int kSize = sharedSynapses.dimX() * sharedSynapses.dimY()
+                        * diffOutputs.dimZ();
+    const bool pointwise = isPointwise(sharedSynapses.dimX(),
+                                       sharedSynapses.dimY(), desc);
+
+    std::vector<T> masked;
+    const T* synapses = maskedSynapses(sharedSynapses, maps, masked);
+    std::vector<T> col((pointwise) ? 0 : (size_t)oSize * kSize);
+
+    const T zero(0.0);
+    const T one(1.0);
+
+    for (unsigned int batchPos = 0; batchPos < diffOutputs.dimB();
+        ++batchPos)
+    {
+        const size_t diffOutputSize = diffOutputs.dimX() * diffOutputs.dimY()
+            * diffOutputs.dimZ();
+        const T* diffInput = tensorPtr(diffInputs) + batchPos
+            * diffInputs.dimX() * diffInputs.dimY() * diffInputs.dimZ();
+        T* diffOutput = tensorPtr(diffOutputs) + batchPos * diffOutputSize;
+
+        if (pointwise) {
+            // diffOutputs = diffInputs * synapses'
+            N2D2::Gemm::gemm<T>(N2D2::Gemm::NoTrans,
+                                N2D2::Gemm::Trans,
+                                oSize,
+                                kSize,
+                                diffInputs.dimZ(),
+                                alpha,
+                                diffInput,
+                                oSize,
+                                synapses,
+                                kSize,
+                                beta,
+                                diffOutput,
+                                oSize);
+            continue;
+        }
+
+        // col = diffInputs * synapses'
+        N2D2::Gemm::gemm<T>(N2D2::Gemm::NoTrans,
+                            N2D2::Gemm::Trans,
+                            oSize,
+                            kSize,
+                            diffInputs.dimZ(),
+                            &one,
+                            diffInput,
+                            oSize,
+                            synapses,
+                            kSize,
+                            &zero,
+                            &col[0],
+                            oSize);
+
+        if (*beta == zero)
+            std::fill(diffOutput, diffOutput + diffOutputSize, zero);
+        else if (*beta != one) {
+            for (size_t index = 0; index < diffOutputSize; ++index)
+                diffOutput[index] *= (*beta);
+        }
+
+        col2im(&col[0], *alpha,
+               diffOutputs.dimX(), diffOutputs.dimY(), diffOutputs.dimZ(),
+               sharedSynapses.dimX(), sharedSynapses.dimY(), desc,
+               oxSize, oySize, diffOutput);
+    }
+
+    return true;
+}
+
+template <class T>
+bool backwardFilterIm2col(const T* alpha,
+                          const N2D2::Tensor<T>& inputs,
+                          const N2D2::Tensor<T>& diffInputs,
+                          const N2D2::ConvCell_Frame_Kernels::Descriptor& desc,
+                          const T* beta,
+                          N2D2::Tensor<T>& diffSharedSynapses,
+                          const N2D2::Tensor<bool>& maps)
+{
+    const unsigned int oxSize
+        = (unsigned int)((inputs.dimX() + desc.padding[0] + desc.padding[2]
+                          - diffSharedSynapses.dimX() + desc.stride[0])
+                         / (double)desc.stride[0]);
+    const unsigned int oySize
+        = (unsigned int)((inputs.dimY() + desc.padding[1] + desc.padding[3]
+                          - diffSharedSynapses.dimY() + desc.stride[1])
+                         / (double)desc.stride[1]);
+
+    if (desc.subSample[0] > 1 || desc.subSample[1] > 1
+        || diffInputs.dimX() != oxSize || diffInputs.dimY() != oySize)
+    {
+        return false;
+    }
+
+    const int oSize = oxSize * oySize;
+    const size_t kernelSize = diffSharedSynapses.dimX()
+                                * diffSharedSynapses.dimY();
+    const int kSize = kernelSize * inputs.dimZ();
+    const bool pointwise = isPointwise(diffSharedSynapses.dimX(),
+                                       diffSharedSynapses.dimY(), desc);
+    const bool fullMap = isFullMap(maps);
+
+    // With a partial mapping, the gradient of the non-connected kernels must
+    // be left untouched: compute the full gradient in a temporary buffer first
+    std::vector<T> diffFull((fullMap) ? 0
+        : (size_t)kSize * diffSharedSynapses.dimB());
+    T* diffSynapses = (fullMap) ? tensorPtr(diffSharedSynapses)
+                                : &diffFull[0];
+    std::vector<T> col((pointwise) ? 0 : (size_t)oSize * kSize);
+
+    const T zero(0.0);
+    const T one(1.0);
+
+    for (unsigned int batchPos = 0; batchPos < inputs.dimB(); ++batchPos) {
+        const T* input = tensorPtr(inputs) + batchPos * inputs.dimX()
+            * inputs.dimY() * inputs.dimZ();
+        const T* diffInput = tensorPtr(diffInputs) + batchPos
+            * diffInputs.dimX() * diffInputs.dimY() * diffInputs.dimZ();
+
+        if (!pointwise) {
+            im2col(input, inputs.dimX(), inputs.dimY(), inputs.dimZ(),
+                   diffSharedSynapses.dimX(), diffSharedSynapses.dimY(), desc,
+                   oxSize, oySize, &col[0]);
+        }
+
+        // diffSynapses = col' * diffInputs, accumulated over the batch
+        N2D2::Gemm::gemm<T>(N2D2::Gemm::Trans,
+                            N2D2::Gemm::NoTrans,
+                            kSize,
+                            diffInputs.dimZ(),
+                            oSize,
+                            alpha,
+                            (pointwise) ? input : &col[0],
+                            oSize,
+                            diffInput,
+                            oSize,
+                            (batchPos > 0) ? &one
+                                : ((fullMap) ? beta : &zero),
+                            diffSynapses,
+                            kSize);
+    }
+
+    if (!fullMap) {
+        T* diffSharedSynapsesPtr = tensorPtr(diffSharedSynapses);
+
+        for (unsigned int output = 0; output < diffSharedSynapses.dimB();
+            ++output)
+        {
+            for (unsigned int channel = 0; channel < inputs.dimZ();
+                ++channel)
+            {
+                if (!maps(output, channel))
+                    continue;
+
+                const size_t offset = (output * inputs.dimZ() + channel)
+                                        * kernelSize;
+
+                for (size_t index = offset; index < offset + kernelSize;
+                    ++index)
+                {
+                    diffSharedSynapsesPtr[index] = diffFull[index]
+                        + (*beta) * diffSharedSynapsesPtr[index];
+                }
+            }
+        }
+    }
+
+    return true;
+}
+}
+
 template <class T>
 void N2D2::ConvCell_Frame_Kernels::forward(const T* alpha,
                                            const Tensor<T>& inputs,
@@ -31,8 +478,22 @@ void N2D2::ConvCell_Frame_Kernels::forward(const T* alpha,
                                            const Descriptor& desc,
                                            const T* beta,
                                            Tensor<T>& outputs,
-                                           const Tensor<bool>& maps)
+                                           const Tensor<bool>& maps,
+                                           const Tensor<T>& bias,
+                                           const FusedEpilogue* epilogue)
 {
+    // A bias without epilogue is applied with an identity epilogue
+    const FusedEpilogue identity;
+    const FusedEpilogue* fused = (epilogue != NULL) ? epilogue
+        : (!bias.empty()) ? &identity : NULL;
+
+    if (desc.algorithm == Im2col
+        && forwardIm2col(alpha, inputs, sharedSynapses, desc, beta, outputs,
+                         maps, bias, fused))
+    {
+        return;
+    }
+
     const unsigned int oxSize
         = (unsigned int)((inputs.dimX() + desc.padding[0] + desc.padding[2]
                           - sharedSynapses.dimX() + desc.stride[0])
@@ -133,6 +594,23 @@ void N2D2::ConvCell_Frame_Kernels::forward(const T* alpha,
                               + (*beta) * outputs(ox, oy, output, batchPos);
                 }
             }
+
+            // The output plane is complete (and still in the cache)
+            if (fused != NULL && !subSample)
+                forwardEpilogue(outputs, output, batchPos, bias, *fused);
+        }
+    }
+
+    if (fused != NULL && subSample) {
+        // The sub-sampled planes are accumulated by several threads
+#if defined(_OPENMP) && _OPENMP >= 200805
+#pragma omp parallel for collapse(2) if (size > 16)
+#else
+#pragma omp parallel for if (outputs.dimB() > 4 && size > 16)
+#endif
+        for (int batchPos = 0; batchPos < (int)outputs.dimB(); ++batchPos) {
+            for (unsigned int output = 0; output < outputs.dimZ(); ++output)
+                forwardEpilogue(outputs, output, batchPos, bias, *fused);
         }
     }
 }
@@ -173,6 +651,13 @@ void N2D2::ConvCell_Frame_Kernels::backwardData(const T* alpha,
                                                 Tensor<T>& diffOutputs,
                                                 const Tensor<bool>& maps)
 {
+    if (desc.algorithm == Im2col
+        && backwardDataIm2col(alpha, sharedSynapses, diffInputs, desc, beta,
+                              diffOutputs, maps))
+    {
+        return;
+    }
+
     const unsigned int oxStride
         = desc.stride[0] * (unsigned int)((diffOutputs.dimX() + desc.padding[0]
             + desc.padding[2] - sharedSynapses.dimX() + desc.stride[0])
@@ -325,6 +810,13 @@ void N2D2::ConvCell_Frame_Kernels::backwardFilter(const T* alpha,
                                                   <T>& diffSharedSynapses,
                                                   const Tensor<bool>& maps)
 {
+    if (desc.algorithm == Im2col
+        && backwardFilterIm2col(alpha, inputs, diffInputs, desc, beta,
+                                diffSharedSynapses, maps))
+    {
+        return;
+    }
+
     const unsigned int oxSize
         = (unsigned int)((inputs.dimX() + desc.padding[0] + desc.padding[2]
                           - diffSharedSynapses.dimX() + desc.stride[0])
@@ -439,7 +931,9 @@ namespace N2D2 {
                                            const Descriptor& desc,
                                            const half_float::half* beta,
                                            Tensor<half_float::half>& outputs,
-                                           const Tensor<bool>& maps);
+                                           const Tensor<bool>& maps,
+                                           const Tensor<half_float::half>& bias,
+                                           const FusedEpilogue* epilogue);
     template void ConvCell_Frame_Kernels::forward<float>(const float* alpha,
                                            const Tensor<float>& inputs,
                                            const Tensor
@@ -447,7 +941,9 @@ namespace N2D2 {
                                            const Descriptor& desc,
                                            const float* beta,
                                            Tensor<float>& outputs,
-                                           const Tensor<bool>& maps);
+                                           const Tensor<bool>& maps,
+                                           const Tensor<float>& bias,
+                                           const FusedEpilogue* epilogue);
     template void ConvCell_Frame_Kernels::forward<double>(const double* alpha,
                                            const Tensor<double>& inputs,
                                            const Tensor
@@ -455,7 +951,9 @@ namespace N2D2 {
                                            const Descriptor& desc,
                                            const double* beta,
                                            Tensor<double>& outputs,
-                                           const Tensor<bool>& maps);
+                                           const Tensor<bool>& maps,
+                                           const Tensor<double>& bias,
+                                           const FusedEpilogue* epilogue);
 
     template void ConvCell_Frame_Kernels::forwardBias<half_float::half>(const half_float::half* alpha,
                                                const Tensor<half_float::half>& bias,
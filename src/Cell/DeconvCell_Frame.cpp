@@ -413,6 +413,25 @@ void N2D2::DeconvCell_Frame<T>::update()
     Cell_Frame<T>::update();
 }
 
+template <class T>
+void N2D2::DeconvCell_Frame<T>::getFreeParameters(
+    std::vector<BaseTensor*>& parameters,
+    std::vector<BaseTensor*>& gradients)
+{
+    for (unsigned int k = 0, size = mSharedSynapses.size(); k < size; ++k) {
+        // External weights are registered by the cell owning them
+        if (mExtSharedSynapses.find(k) == mExtSharedSynapses.end())
+            parameters.push_back(&mSharedSynapses[k]);
+
+        gradients.push_back(&mDiffSharedSynapses[k]);
+    }
+
+    if (!mNoBias) {
+        parameters.push_back(mBias.get());
+        gradients.push_back(&mDiffBias);
+    }
+}
+
 template <class T>
 void N2D2::DeconvCell_Frame<T>::setWeights(unsigned int k,
                                         BaseInterface* weights,
@@ -18,12 +18,15 @@
     knowledge of the CeCILL-C license and that you accept its terms.
 */
 
+#include "Activation/FusedEpilogue.hpp"
 #include "GradientCheck.hpp"
 #include "Cell/FcCell_Frame.hpp"
 #include "DeepNet.hpp"
 #include "Filler/NormalFiller.hpp"
+#include "Solver/FusedUpdate.hpp"
 #include "Solver/SGDSolver_Frame.hpp"
 #include "third_party/half.hpp"
+#include "utils/Gemm.hpp"
 
 template <>
 N2D2::Registrar<N2D2::FcCell>
@@ -43,6 +46,22 @@ N2D2::FcCell_Frame<double>::mRegistrar("Frame",
     N2D2::FcCell_Frame<double>::create,
     N2D2::Registrar<N2D2::FcCell>::Type<double>());
 
+namespace {
+/// Copy the synapses, with the connections dropped by the mask set to zero
+template <class T>
+void maskSynapses(const N2D2::Tensor<T>& synapses,
+                  const N2D2::Tensor<bool>& mask,
+                  N2D2::Tensor<T>& maskedSynapses)
+{
+    maskedSynapses.resize(synapses.dims());
+
+#pragma omp parallel for if (synapses.size() > 1024)
+    for (int index = 0; index < (int)synapses.size(); ++index) {
+        maskedSynapses(index) = (mask(index)) ? synapses(index) : T(0.0);
+    }
+}
+}
+
 template <class T>
 N2D2::FcCell_Frame<T>::FcCell_Frame(const DeepNet& deepNet, const std::string& name,
                                  unsigned int nbOutputs,
@@ -272,10 +291,20 @@ void N2D2::FcCell_Frame<T>::propagate(bool inference)
 
     const unsigned int outputSize = mOutputs.dimX() * mOutputs.dimY()
                                     * mOutputs.dimZ();
-    const unsigned int count = mInputs.dimB() * outputSize;
-
+    const T alpha(1.0);
     T beta(0.0);
 
+    if (!mNoBias) {
+        // The biases are added once, whatever the number of inputs
+#pragma omp parallel for if (mInputs.dimB() > 4)
+        for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
+            for (unsigned int output = 0; output < outputSize; ++output)
+                mOutputs(output, batchPos) = mBias(output);
+        }
+
+        beta = 1.0;
+    }
+
     for (unsigned int k = 0, size = mInputs.size(); k < size; ++k) {
         if (k > 0)
             beta = 1.0;
@@ -294,46 +323,44 @@ void N2D2::FcCell_Frame<T>::propagate(bool inference)
                         : tensor_cast<T>(mSynapses[k]);
         const unsigned int inputSize = input.dimX() * input.dimY()
                                         * input.dimZ();
-        //const Tensor<T>& biases 
-        //    = (!mNoBias) ? (mQuantizer ? tensor_cast<T>(mQuantizer->getQuantizedBiases())
-        //                : mBias) : T(0.0) ;
-
-#if defined(_OPENMP) && _OPENMP >= 200805
-#pragma omp parallel for collapse(2) if (count > 16)
-#else
-#pragma omp parallel for if (mInputs.dimB() > 4 && count > 16)
-#endif
+
+        const bool dropConnect = (mDropConnect < 1.0 && !inference);
+        Tensor<T> maskedSynapses;
+
+        if (dropConnect)
+            maskSynapses(synapses, mDropConnectMask[k], maskedSynapses);
+
+        const Tensor<T>& weights = (dropConnect) ? maskedSynapses : synapses;
+
+        // outputs = weights^T * inputs
+        Gemm::gemm(Gemm::Trans, Gemm::NoTrans,
+                   outputSize, mInputs.dimB(), inputSize,
+                   &alpha,
+                   &(*weights.begin()), inputSize,
+                   &(*input.begin()), inputSize,
+                   &beta,
+                   &(*mOutputs.begin()), outputSize);
+    }
+
+    FusedEpilogue epilogue;
+
+    if (inference && this->mActivation
+        && this->mActivation->getFusedEpilogue(*this, epilogue))
+    {
+        // Apply the activation on the outputs of each stimulus while they
+        // are still in the cache after the GEMM
+        const unsigned int planeSize = mOutputs.dimX() * mOutputs.dimY();
+
+#pragma omp parallel for if (mInputs.dimB() > 4)
         for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
-            for (unsigned int output = 0; output < outputSize; ++output) {
-                // Compute the weighted sum
-                T weightedSum((!mNoBias) ? mBias(output) : 0.0);
-
-                if (mDropConnect < 1.0 && !inference) {
-                    for (unsigned int channel = 0; channel < inputSize;
-                        ++channel)
-                    {
-                        if (mDropConnectMask[k](channel, output))
-                            weightedSum += input(channel, batchPos)
-                                           * synapses(channel, output);
-                    }
-                } else {
-                    // init with weightedSum and not 0.0 to match for loop
-                    // (otherwise it can lead to different result because of
-                    // limited machine precision)
-                    weightedSum = std::inner_product(
-                                    input.begin() + batchPos * inputSize,
-                                    input.begin() + (batchPos + 1) * inputSize,
-                                    synapses[output].begin(),
-                                    weightedSum);
-                }
-
-                mOutputs(output, batchPos)
-                    = weightedSum + beta * mOutputs(output, batchPos);
-            }
+            T* outputs = &mOutputs(0, batchPos);
+
+            for (unsigned int output = 0; output < mOutputs.dimZ(); ++output)
+                epilogue.apply(outputs + output * planeSize, planeSize, output);
         }
     }
-
-    Cell_Frame<T>::propagate(inference);
+    else
+        Cell_Frame<T>::propagate(inference);
     mDiffInputs.clearValid();
     mDiffSynapses.clearValid();
     mDiffBias.clearValid();
@@ -366,75 +393,64 @@ void N2D2::FcCell_Frame<T>::backPropagate()
             const Tensor<T>& synapses 
                 = mQuantizer ? tensor_cast<T>(mQuantizer->getQuantizedWeights(k))
                             : tensor_cast<T>(mSynapses[k]);
-            const unsigned int count = mInputs.dimB() * nbChannels;
-
-#if defined(_OPENMP) && _OPENMP >= 200805
-#pragma omp parallel for collapse(2) if (count > 16)
-#else
-#pragma omp parallel for if (mInputs.dimB() > 4 && count > 16)
-#endif
-            for (int batchPos = 0; batchPos < (int)mInputs.dimB(); ++batchPos) {
-                for (unsigned int channel = 0; channel < nbChannels; ++channel)
-                {
-                    T gradient(0.0);
-
-                    if (mDropConnect < 1.0) {
-                        for (unsigned int output = 0; output < outputSize;
-                             ++output)
-                        {
-                            if (mDropConnectMask[k](channel, output))
-                                gradient += synapses(channel, output)
-                                            * mDiffInputs(output, batchPos);
-                        }
-                    }
-                    else {
-                        for (unsigned int output = 0; output < outputSize;
-                             ++output)
-                        {
-                            gradient += synapses(channel, output)
-                                        * mDiffInputs(output, batchPos);
-                        }
-                    }
-
-                    diffOutput(channel, batchPos) = gradient
-                        + beta * diffOutput(channel, batchPos);
-                }
-            }
+            Tensor<T> maskedSynapses;
+
+            if (mDropConnect < 1.0)
+                maskSynapses(synapses, mDropConnectMask[k], maskedSynapses);
+
+            const Tensor<T>& weights = (mDropConnect < 1.0) ? maskedSynapses
+                                                            : synapses;
+            const T alpha(1.0);
+
+            // diffOutput = weights * diffInputs
+            Gemm::gemm(Gemm::NoTrans, Gemm::NoTrans,
+                       nbChannels, mInputs.dimB(), outputSize,
+                       &alpha,
+                       &(*weights.begin()), nbChannels,
+                       &(*mDiffInputs.begin()), outputSize,
+                       &beta,
+                       &(*diffOutput.begin()), nbChannels);
 
             mDiffOutputs[k] = diffOutput;
             mDiffOutputs[k].setValid();
         }
 
         Tensor<T>& diffSynapses = mDiffSynapses[k];
-        const unsigned int count2 = nbChannels * getNbOutputs();
-
-        const float beta = (mWeightsSolvers[k]->isNewIteration()) ? 0.0f : 1.0f;
-
-#if defined(_OPENMP) && _OPENMP >= 200805
-#pragma omp parallel for collapse(2) if (count2 > 16)
-#else
-#pragma omp parallel for if (getNbOutputs() > 4 && count2 > 16)
-#endif
-        for (int output = 0; output < (int)getNbOutputs(); ++output) {
-            for (unsigned int channel = 0; channel < nbChannels; ++channel) {
-                if (!(mDropConnect < 1.0)
-                    || mDropConnectMask[k](channel, output)) {
-                    T sum(0.0);
-
-                    for (unsigned int batchPos = 0; batchPos < input.dimB();
-                         ++batchPos)
-                        sum += input(channel, batchPos)
-                               * mDiffInputs(output, batchPos);
-
-                    diffSynapses(channel, output) = sum
-                        + beta * diffSynapses(channel, output);
-                }
-                else {
-                    diffSynapses(channel, output) = beta
-                        * diffSynapses(channel, output);
-                }
+        const T alpha(1.0);
+        const T beta((mWeightsSolvers[k]->isNewIteration()) ? 0.0 : 1.0);
+
+        if (mDropConnect < 1.0) {
+            // Gradient of the dropped synapses is zero
+            Tensor<T> gradient(diffSynapses.dims());
+            const T zero(0.0);
+
+            Gemm::gemm(Gemm::NoTrans, Gemm::Trans,
+                       nbChannels, getNbOutputs(), input.dimB(),
+                       &alpha,
+                       &(*input.begin()), nbChannels,
+                       &(*mDiffInputs.begin()), outputSize,
+                       &zero,
+                       &(*gradient.begin()), nbChannels);
+
+            const Tensor<bool>& mask = mDropConnectMask[k];
+
+#pragma omp parallel for if (gradient.size() > 1024)
+            for (int index = 0; index < (int)gradient.size(); ++index) {
+                diffSynapses(index) = ((mask(index)) ? gradient(index)
+                                                     : T(0.0))
+                    + beta * diffSynapses(index);
             }
         }
+        else {
+            // diffSynapses = inputs * diffInputs^T
+            Gemm::gemm(Gemm::NoTrans, Gemm::Trans,
+                       nbChannels, getNbOutputs(), input.dimB(),
+                       &alpha,
+                       &(*input.begin()), nbChannels,
+                       &(*mDiffInputs.begin()), outputSize,
+                       &beta,
+                       &(*diffSynapses.begin()), nbChannels);
+        }
 
         mDiffSynapses[k].setValid();
     }
@@ -481,12 +497,38 @@ void N2D2::FcCell_Frame<T>::update()
         mBiasSolver->update(mBias, mDiffBias, mInputs.dimB());
 
     if(mQuantizer){
+        // The quantizer reads the updated full precision weights
+        FusedUpdateBarrier fusedUpdateBarrier;
         mQuantizer->update((unsigned int)mInputs.dimB());
     }
 
     Cell_Frame<T>::update();
 }
 
+template <class T>
+void N2D2::FcCell_Frame<T>::getFreeParameters(
+    std::vector<BaseTensor*>& parameters,
+    std::vector<BaseTensor*>& gradients)
+{
+    // The quantizer keeps its own references to the parameters
+    if (mQuantizer) {
+        throw std::runtime_error("FcCell_Frame<T>::getFreeParameters(): the "
+                                 "parameters of cell " + mName + " cannot be "
+                                 "moved in the parameter arena, as it has a "
+                                 "quantizer");
+    }
+
+    for (unsigned int k = 0, size = mSynapses.size(); k < size; ++k) {
+        parameters.push_back(&mSynapses[k]);
+        gradients.push_back(&mDiffSynapses[k]);
+    }
+
+    if (!mNoBias) {
+        parameters.push_back(&mBias);
+        gradients.push_back(&mDiffBias);
+    }
+}
+
 template <class T>
 void N2D2::FcCell_Frame<T>::checkGradient(double epsilon, double maxError)
 {
@@ -18,6 +18,8 @@
     knowledge of the CeCILL-C license and that you accept its terms.
 */
 
+#include <fstream>
+
 #include "DataFile/ImageDataFile.hpp"
 #include "utils/Utils.hpp"
 
@@ -47,14 +49,140 @@ N2D2::ImageDataFile::mRegistrar({// Windows bitmaps
 
 cv::Mat N2D2::ImageDataFile::read(const std::string& fileName)
 {
-    cv::Mat data;
-
-    try {
 #if CV_MAJOR_VERSION >= 3
-        data = cv::imread(fileName, cv::IMREAD_UNCHANGED);
+    return decode(fileName, cv::IMREAD_UNCHANGED);
 #else
-        data = cv::imread(fileName, CV_LOAD_IMAGE_UNCHANGED);
+    return decode(fileName, CV_LOAD_IMAGE_UNCHANGED);
 #endif
+}
+
+cv::Mat N2D2::ImageDataFile::readReduced(const std::string& fileName,
+                                         const SizeHint& sizeHint)
+{
+#if CV_MAJOR_VERSION > 3 || (CV_MAJOR_VERSION == 3 && CV_MINOR_VERSION >= 1)
+    unsigned int width;
+    unsigned int height;
+    unsigned int channels;
+
+    if (!sizeHint.empty()
+        && readHeader(fileName, width, height, channels))
+    {
+        // Largest scale denominator for which the decoded image is still
+        // large enough. Only JPEG images are scaled in the DCT domain (other
+        // formats are decoded at full resolution then resized by OpenCV,
+        // which saves nothing), hence readHeader() only accepts JPEG.
+        unsigned int scale = 8;
+
+        while (scale > 1 && !sizeHint.accept(width / scale, height / scale))
+            scale /= 2;
+
+        if (scale > 1) {
+            const int flags = (scale == 8)
+                ? ((channels == 1) ? cv::IMREAD_REDUCED_GRAYSCALE_8
+                                   : cv::IMREAD_REDUCED_COLOR_8)
+                : (scale == 4)
+                ? ((channels == 1) ? cv::IMREAD_REDUCED_GRAYSCALE_4
+                                   : cv::IMREAD_REDUCED_COLOR_4)
+                : ((channels == 1) ? cv::IMREAD_REDUCED_GRAYSCALE_2
+                                   : cv::IMREAD_REDUCED_COLOR_2);
+
+            // Same orientation as with cv::IMREAD_UNCHANGED
+            return decode(fileName, flags | cv::IMREAD_IGNORE_ORIENTATION);
+        }
+    }
+#else
+    (void)sizeHint;
+#endif
+
+    return read(fileName);
+}
+
+bool N2D2::ImageDataFile::readHeader(const std::string& fileName,
+                                     unsigned int& width,
+                                     unsigned int& height,
+                                     unsigned int& channels)
+{
+    std::ifstream data(fileName.c_str(), std::fstream::binary);
+    unsigned char header[8];
+
+    if (!data.read(reinterpret_cast<char*>(&header[0]), sizeof(header)))
+        return false;
+
+    if (header[0] == 0xFF && header[1] == 0xD8) {
+        // Look for the Start Of Frame segment
+        data.seekg(2);
+
+        unsigned char marker[2];
+
+        while (data.read(reinterpret_cast<char*>(&marker[0]), 2)) {
+            if (marker[0] != 0xFF)
+                return false;
+
+            // Skip fill bytes
+            while (marker[1] == 0xFF) {
+                if (!data.read(reinterpret_cast<char*>(&marker[1]), 1))
+                    return false;
+            }
+
+            // Stand-alone markers
+            if (marker[1] == 0x01 || (marker[1] >= 0xD0 && marker[1] <= 0xD8))
+                continue;
+
+            // End Of Image or Start Of Scan before any Start Of Frame
+            if (marker[1] == 0xD9 || marker[1] == 0xDA)
+                return false;
+
+            unsigned char segment[6];
+
+            if (!data.read(reinterpret_cast<char*>(&segment[0]), 2))
+                return false;
+
+            const unsigned int length = (segment[0] << 8) | segment[1];
+
+            if (length < 2)
+                return false;
+
+            // SOFn markers (C4, C8 and CC are DHT, JPG and DAC)
+            if (marker[1] >= 0xC0 && marker[1] <= 0xCF && marker[1] != 0xC4
+                && marker[1] != 0xC8 && marker[1] != 0xCC)
+            {
+                if (length < 8
+                    || !data.read(reinterpret_cast<char*>(&segment[0]), 6))
+                {
+                    return false;
+                }
+
+                height = (segment[1] << 8) | segment[2];
+                width = (segment[3] << 8) | segment[4];
+                channels = segment[5];
+
+                return (segment[0] == 8 && width > 0 && height > 0
+                        && (channels == 1 || channels == 3));
+            }
+
+            data.seekg(length - 2, std::ios::cur);
+        }
+
+        return false;
+    }
+
+    return false;
+}
+
+void N2D2::ImageDataFile::write(const std::string& fileName,
+                                const cv::Mat& data)
+{
+    if (!cv::imwrite(fileName, data))
+        throw std::runtime_error(
+            "ImageDataFile::write(): unable to write image: " + fileName);
+}
+
+cv::Mat N2D2::ImageDataFile::decode(const std::string& fileName, int flags)
+{
+    cv::Mat data;
+
+    try {
+        data = cv::imread(fileName, flags);
     }
     catch (...) {
         std::cout << Utils::cwarning
@@ -71,11 +199,3 @@ cv::Mat N2D2::ImageDataFile::read(const std::string& fileName)
 
     return data;
 }
-
-void N2D2::ImageDataFile::write(const std::string& fileName,
-                                const cv::Mat& data)
-{
-    if (!cv::imwrite(fileName, data))
-        throw std::runtime_error(
-            "ImageDataFile::write(): unable to write image: " + fileName);
-}
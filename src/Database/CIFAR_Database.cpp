@@ -19,9 +19,12 @@
 */
 
 #include "Database/CIFAR_Database.hpp"
+#include "utils/MemoryMappedFile.hpp"
 
 N2D2::CIFAR_Database::CIFAR_Database(double validation)
-    : Database(true), mValidation(validation)
+    : Database(true),
+      mDirectLoad(this, "DirectLoad", false),
+      mValidation(validation)
 {
     // ctor
 }
@@ -49,6 +52,11 @@ void N2D2::CIFAR_Database::loadCIFAR(const std::string& dataFile,
 
     labels.close();
 
+    if (mDirectLoad) {
+        loadCIFARDirect(dataFile, labelsName, coarseAndFine, useCoarse);
+        return;
+    }
+
     // Images
     std::ifstream images(dataFile.c_str(), std::fstream::binary);
 
@@ -120,6 +128,66 @@ void N2D2::CIFAR_Database::loadCIFAR(const std::string& dataFile,
                                  + dataFile);
 }
 
+void N2D2::CIFAR_Database::loadCIFARDirect(
+    const std::string& dataFile,
+    const std::vector<std::string>& labelsName,
+    bool coarseAndFine,
+    bool useCoarse)
+{
+    const unsigned int nbRows = 32;
+    const unsigned int nbColumns = 32;
+    const std::size_t planeSize = nbRows * nbColumns;
+    const std::size_t recordSize = 1 + coarseAndFine + 3 * planeSize;
+
+    const MemoryMappedFile images(dataFile);
+    const unsigned int nbImages = images.size() / recordSize;
+
+    if (images.size() > nbImages * recordSize)
+        throw std::runtime_error("Data file size larger than expected: "
+                                 + dataFile);
+
+    // The planar RGB records are interleaved in a single BGR block, of which
+    // each stimulus is a view
+    cv::Mat frames(nbImages * nbRows, nbColumns, CV_8UC3);
+
+#pragma omp parallel for if (nbImages > 16)
+    for (int i = 0; i < (int)nbImages; ++i) {
+        const unsigned char* planes = images.data() + i * recordSize
+                                      + 1 + coarseAndFine;
+
+        for (unsigned int y = 0; y < nbRows; ++y) {
+            cv::Vec3b* row = frames.ptr<cv::Vec3b>(i * nbRows + y);
+
+            for (unsigned int x = 0; x < nbColumns; ++x) {
+                const std::size_t index = y * nbColumns + x;
+
+                // Vec3b color order: blue, green, red
+                row[x][0] = planes[2 * planeSize + index];
+                row[x][1] = planes[planeSize + index];
+                row[x][2] = planes[index];
+            }
+        }
+    }
+
+    mStimuliData.resize(mStimuli.size());
+    mStimuliData.reserve(mStimuli.size() + nbImages);
+
+    // For each image...
+    for (unsigned int i = 0; i < nbImages; ++i) {
+        const unsigned char* record = images.data() + i * recordSize;
+        const unsigned char label = (coarseAndFine && !useCoarse)
+            ? record[1] : record[0];
+
+        std::ostringstream nameStr;
+        nameStr << dataFile << "[" << std::setfill('0') << std::setw(5) << i
+                << "]";
+
+        mStimuli.push_back(Stimulus(nameStr.str(), labelID(labelsName[label])));
+        mStimuliSets(Unpartitioned).push_back(mStimuli.size() - 1);
+        mStimuliData.push_back(frames.rowRange(i * nbRows, (i + 1) * nbRows));
+    }
+}
+
 N2D2::CIFAR10_Database::CIFAR10_Database(double validation, bool useTestForVal)
     : CIFAR_Database(validation), mUseTestForValidation(useTestForVal)
 {
@@ -21,6 +21,7 @@
 #include "LabelFile/LabelFile.hpp"
 #include "LabelFile/CsvLabelFile.hpp"
 #include "Database/Database.hpp"
+#include "Database/StimuliMemoryCache.hpp"
 #include "ROI/RectangularROI.hpp"
 #include "utils/Gnuplot.hpp"
 
@@ -40,6 +41,9 @@ N2D2::Database::Database(bool loadDataInMemory)
       mMultiChannelMatch(this, "MultiChannelMatch", ""),
       mMultiChannelReplace(this, "MultiChannelReplace",
                            std::vector<std::string>()),
+      mCacheSize(this, "CacheSize", 0U),
+      mCacheShards(this, "CacheShards", 16U),
+      mCacheCompression(this, "CacheCompression", false),
       mLoadDataInMemory(loadDataInMemory),
       mStimuliDepth(-1),
       mStimuliTargetDepth(-1)
@@ -1493,7 +1497,13 @@ void N2D2::Database::removeStimulus(StimulusID id)
         throw std::runtime_error("Database::removeStimulus(): could not find "
                                  "the stimulus in any of the partition!");
 
+    std::vector<int> mapping(mStimuli.size());
+
+    for (int i = 0, size = mStimuli.size(); i < size; ++i)
+        mapping[i] = (i < (int)id) ? i : (i > (int)id) ? (i - 1) : -1;
+
     mStimuli.erase(mStimuli.begin() + id);
+    remapStimuli(mapping);
 }
 
 void N2D2::Database::removeStimuli(const std::vector<StimulusID>& ids)
@@ -1501,7 +1511,7 @@ void N2D2::Database::removeStimuli(const std::vector<StimulusID>& ids)
     std::vector<StimulusID> sortedIds(ids);
     std::sort(sortedIds.begin(), sortedIds.end());
 
-    std::map<int, int> stimuliMapping;
+    std::vector<int> stimuliMapping(mStimuli.size());
     int offset = 0;
 
     // mStimuli.erase() is very slow, better create a new vector and swap!
@@ -1509,12 +1519,12 @@ void N2D2::Database::removeStimuli(const std::vector<StimulusID>& ids)
 
     for (unsigned int i = 0, size = mStimuli.size(); i < size; ++i) {
         if (std::binary_search(sortedIds.begin(), sortedIds.end(), i)) {
-            stimuliMapping.insert(std::make_pair(i, -1));
+            stimuliMapping[i] = -1;
             //mStimuli.erase(mStimuli.begin() + (i - offset));
             ++offset;
         }
         else {
-            stimuliMapping.insert(std::make_pair(i, i - offset));
+            stimuliMapping[i] = i - offset;
             newStimuli.push_back(mStimuli[i]);
         }
     }
@@ -1553,6 +1563,37 @@ void N2D2::Database::removeStimuli(const std::vector<StimulusID>& ids)
 
         mStimuliSets(*it).swap(newStimuliSet);
     }
+
+    remapStimuli(stimuliMapping);
+}
+
+void N2D2::Database::remapStimuli(const std::vector<int>& mapping)
+{
+    // Tables in memory (loaded on demand, or directly from a container
+    // file). The mapping is increasing, so they can be compacted in place.
+    std::vector<cv::Mat>* tables[] = {&mStimuliData,
+                                      &mStimuliLabelsData,
+                                      &mStimuliTargetData};
+
+    for (unsigned int t = 0; t < sizeof(tables) / sizeof(tables[0]); ++t) {
+        std::vector<cv::Mat>& table = *(tables[t]);
+
+        if (table.empty())
+            continue;
+
+        for (int i = 0, size = std::min(mapping.size(), table.size());
+            i < size; ++i)
+        {
+            if (mapping[i] >= 0 && mapping[i] != i)
+                table[mapping[i]] = std::move(table[i]);
+        }
+
+        table.resize(mStimuli.size());
+    }
+
+    // The in-memory cache is indexed by stimulus ID
+    if (mMemoryCache)
+        mMemoryCache->clear();
 }
 
 void N2D2::Database::removeLabel(int label)
@@ -1923,7 +1964,18 @@ cv::Mat N2D2::Database::getStimulusData(StimulusID id)
 {
     assert(id < mStimuli.size());
 
-    if (mLoadDataInMemory) {
+    if (mCacheSize > 0) {
+        StimuliMemoryCache& cache = getOrCreateMemoryCache();
+        cv::Mat data;
+
+        if (!cache.get(id, StimuliMemoryCache::Data, data)) {
+            data = loadStimulusData(id);
+            cache.put(id, StimuliMemoryCache::Data, data);
+        }
+
+        return data;
+    }
+    else if (mLoadDataInMemory) {
         if (mStimuliData.empty()) {
 #pragma omp critical(Database__getStimulusData)
             if (mStimuliData.empty())
@@ -1942,7 +1994,18 @@ cv::Mat N2D2::Database::getStimulusLabelsData(StimulusID id)
 {
     assert(id < mStimuli.size());
 
-    if (mLoadDataInMemory) {
+    if (mCacheSize > 0) {
+        StimuliMemoryCache& cache = getOrCreateMemoryCache();
+        cv::Mat labels;
+
+        if (!cache.get(id, StimuliMemoryCache::Labels, labels)) {
+            labels = loadStimulusLabelsData(id);
+            cache.put(id, StimuliMemoryCache::Labels, labels);
+        }
+
+        return labels;
+    }
+    else if (mLoadDataInMemory) {
         if (mStimuliLabelsData.empty()) {
 #pragma omp critical(Database__getStimulusLabelsData)
             if (mStimuliLabelsData.empty())
@@ -1966,7 +2029,18 @@ cv::Mat N2D2::Database::getStimulusTargetData(StimulusID id,
 {
     assert(id < mStimuli.size());
 
-    if (mLoadDataInMemory) {
+    if (mCacheSize > 0) {
+        StimuliMemoryCache& cache = getOrCreateMemoryCache();
+        cv::Mat target;
+
+        if (!cache.get(id, StimuliMemoryCache::Target, target)) {
+            target = loadStimulusTargetData(id);
+            cache.put(id, StimuliMemoryCache::Target, target);
+        }
+
+        return target;
+    }
+    else if (mLoadDataInMemory) {
         if (mStimuliTargetData.empty()) {
 #pragma omp critical(Database__getStimulusTargetData)
             if (mStimuliTargetData.empty())
@@ -1981,6 +2055,61 @@ cv::Mat N2D2::Database::getStimulusTargetData(StimulusID id,
         return loadStimulusTargetData(id);
 }
 
+void N2D2::Database::logMemoryCacheStats(const std::string& fileName,
+                                         unsigned int step) const
+{
+    if (!mMemoryCache)
+        return;
+
+    const StimuliMemoryCache::Stats stats = mMemoryCache->getStats();
+
+    std::cout << "Stimuli memory cache: hit rate " << std::fixed
+        << std::setprecision(2) << (100.0 * stats.hitRate()) << "% ("
+        << stats.nbEntries << " entries, "
+        << (stats.size / (1024.0 * 1024.0)) << " MiB, "
+        << stats.evictions << " evictions)" << std::endl;
+
+    const bool newFile = !std::ifstream(fileName.c_str()).good();
+    std::ofstream log(fileName.c_str(), std::ios::app);
+
+    if (!log.good()) {
+        throw std::runtime_error("Could not create stimuli memory cache log "
+                                 "file: " + fileName);
+    }
+
+    if (newFile)
+        log << "# step hits misses hit_rate evictions entries size\n";
+
+    log << step << " "
+        << stats.hits << " "
+        << stats.misses << " "
+        << stats.hitRate() << " "
+        << stats.evictions << " "
+        << stats.nbEntries << " "
+        << stats.size << "\n";
+}
+
+N2D2::StimuliMemoryCache& N2D2::Database::getOrCreateMemoryCache()
+{
+    if (!mMemoryCache) {
+#pragma omp critical(Database__getOrCreateMemoryCache)
+        if (!mMemoryCache) {
+            mMemoryCache = std::make_shared<StimuliMemoryCache>(
+                (std::size_t)mCacheSize * 1024 * 1024,
+                mCacheShards,
+                mCacheCompression);
+        }
+    }
+
+    return *mMemoryCache;
+}
+
+void N2D2::Database::shuffleIndexes(StimuliSet /*set*/,
+                                    std::vector<unsigned int>& indexes) const
+{
+    std::random_shuffle(indexes.begin(), indexes.end(), Random::randShuffle);
+}
+
 std::vector<N2D2::Database::StimuliSet>
 N2D2::Database::getStimuliSets(StimuliSetMask setMask) const
 {
@@ -2078,6 +2207,11 @@ int N2D2::Database::getStimuliDepth() {
 
 cv::Mat N2D2::Database::loadStimulusData(StimulusID id)
 {
+    // Data already in memory, for databases loaded directly from a container
+    // file (which have no file for each stimulus)
+    if (id < mStimuliData.size() && !mStimuliData[id].empty())
+        return mStimuliData[id];
+
     // Initialize mStimuliDepth using the first stimulus
     if (mStimuliDepth == -1) {
 #pragma omp critical(Database__loadStimulusData)
@@ -2099,7 +2233,19 @@ cv::Mat N2D2::Database::loadStimulusData(StimulusID id)
         }
     }
 
-    return loadData(id, mStimuliDepth, mStimuli[id].name);
+    // The stimulus can only be decoded at a reduced resolution if nothing
+    // else depends on its full resolution
+    const bool reducible = !mDecodeSizeHint.empty()
+        && mStimuli[id].ROIs.empty()
+        && mStimuli[id].slice == NULL
+        && !mDataFileLabel
+        && (mCompositeLabel == None
+            || (mCompositeLabel == Auto && mStimuli[id].label >= 0))
+        && ((std::string)mMultiChannelMatch).empty()
+        && ((std::string)mTargetDataPath).empty();
+
+    return loadData(id, mStimuliDepth, mStimuli[id].name,
+                    (reducible) ? mDecodeSizeHint : DataFile::SizeHint());
 }
 
 cv::Mat N2D2::Database::loadStimulusLabelsData(StimulusID id)
@@ -2219,7 +2365,8 @@ cv::Mat N2D2::Database::loadStimulusTargetData(StimulusID id) {
 cv::Mat N2D2::Database::loadData(
     StimulusID id,
     int depth,
-    const std::string fileName) const
+    const std::string fileName,
+    const DataFile::SizeHint& sizeHint) const
 {
     std::string fileExtension = Utils::fileExtension(fileName);
     std::transform(fileExtension.begin(),
@@ -2229,7 +2376,9 @@ cv::Mat N2D2::Database::loadData(
 
     std::shared_ptr<DataFile> dataFile = Registrar
         <DataFile>::create(fileExtension)();
-    cv::Mat data = dataFile->read(fileName);
+    cv::Mat data = (sizeHint.empty()) ? dataFile->read(fileName)
+                                      : dataFile->readReduced(fileName,
+                                                              sizeHint);
 
     if (!((std::string)mMultiChannelMatch).empty()) {
         const std::regex regexp((std::string)mMultiChannelMatch);
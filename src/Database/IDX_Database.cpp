@@ -20,8 +20,22 @@
 
 #include "Database/IDX_Database.hpp"
 
+namespace {
+unsigned int readIdxHeader(const unsigned char* header, unsigned int index)
+{
+    unsigned int value;
+    std::memcpy(&value, header + index * sizeof(value), sizeof(value));
+
+    if (!N2D2::Utils::isBigEndian())
+        N2D2::Utils::swapEndian(value);
+
+    return value;
+}
+}
+
 N2D2::IDX_Database::IDX_Database(bool loadDataInMemory)
-    : Database(loadDataInMemory)
+    : Database(loadDataInMemory),
+      mDirectLoad(this, "DirectLoad", false)
 {
     // ctor
 }
@@ -30,6 +44,11 @@ void N2D2::IDX_Database::load(const std::string& dataPath,
                               const std::string& labelPath,
                               bool /*extractROIs*/)
 {
+    if (mDirectLoad) {
+        loadDirect(dataPath, labelPath);
+        return;
+    }
+
     // Images
     std::ifstream images(dataPath.c_str(), std::fstream::binary);
 
@@ -144,3 +163,84 @@ void N2D2::IDX_Database::load(const std::string& dataPath,
         throw std::runtime_error("Data file size larger than expected: "
                                  + labelPath);
 }
+
+void N2D2::IDX_Database::loadDirect(const std::string& dataPath,
+                                    const std::string& labelPath)
+{
+    // Images
+    std::shared_ptr<MemoryMappedFile> images
+        = std::make_shared<MemoryMappedFile>(dataPath);
+    const unsigned char* imagesHeader = images->data();
+
+    if (images->size() < 4 * sizeof(unsigned int)
+        || imagesHeader[0] != 0 || imagesHeader[1] != 0
+        || imagesHeader[2] != Unsigned || imagesHeader[3] != 3)
+    {
+        throw std::runtime_error("Wrong file format for images file: "
+                                 + dataPath);
+    }
+
+    const unsigned int nbImages = readIdxHeader(imagesHeader, 1);
+    const unsigned int nbRows = readIdxHeader(imagesHeader, 2);
+    const unsigned int nbColumns = readIdxHeader(imagesHeader, 3);
+
+    const std::size_t imagesOffset = 4 * sizeof(unsigned int);
+    const std::size_t imageSize = (std::size_t)nbRows * nbColumns;
+    const std::size_t imagesSize = imagesOffset + nbImages * imageSize;
+
+    if (images->size() < imagesSize)
+        throw std::runtime_error(
+            "End-of-file reached prematurely in data file: " + dataPath);
+    else if (images->size() > imagesSize)
+        throw std::runtime_error("Data file size larger than expected: "
+                                 + dataPath);
+
+    // Labels
+    MemoryMappedFile labels(labelPath);
+    const unsigned char* labelsHeader = labels.data();
+
+    if (labels.size() < 2 * sizeof(unsigned int)
+        || labelsHeader[0] != 0 || labelsHeader[1] != 0
+        || labelsHeader[2] != Unsigned || labelsHeader[3] != 1)
+    {
+        throw std::runtime_error("Wrong file format for labels file: "
+                                 + labelPath);
+    }
+
+    const unsigned int nbItemsLabels = readIdxHeader(labelsHeader, 1);
+
+    if (nbImages != nbItemsLabels)
+        throw std::runtime_error(
+            "The number of images and the number of labels does not match.");
+
+    const std::size_t labelsOffset = 2 * sizeof(unsigned int);
+
+    if (labels.size() < labelsOffset + nbItemsLabels)
+        throw std::runtime_error(
+            "End-of-file reached prematurely in data file: " + labelPath);
+    else if (labels.size() > labelsOffset + nbItemsLabels)
+        throw std::runtime_error("Data file size larger than expected: "
+                                 + labelPath);
+
+    // The stimuli data are views on the mapping: no copy is made and the
+    // pages are only read from the file when first accessed
+    mLoadDataInMemory = true;
+    mStimuliData.resize(mStimuli.size());
+    mStimuliData.reserve(mStimuli.size() + nbImages);
+
+    for (unsigned int i = 0; i < nbImages; ++i) {
+        std::ostringstream nameStr;
+        nameStr << dataPath << "[" << std::setfill('0') << std::setw(5) << i
+                << "]";
+
+        std::ostringstream labelStr;
+        labelStr << (unsigned int)labels.data()[labelsOffset + i];
+
+        mStimuli.push_back(Stimulus(nameStr.str(), labelID(labelStr.str())));
+        mStimuliSets(Unpartitioned).push_back(mStimuli.size() - 1);
+        mStimuliData.push_back(cv::Mat(nbRows, nbColumns, CV_8UC1,
+            images->data() + imagesOffset + i * imageSize));
+    }
+
+    mMappedFiles.push_back(images);
+}
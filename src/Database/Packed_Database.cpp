@@ -0,0 +1,550 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "Database/Packed_Database.hpp"
+#include "Database/StimuliMemoryCache.hpp"
+#include "ROI/RectangularROI.hpp"
+
+namespace {
+template <class T> void writeValue(std::ostream& os, const T& value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <class T> T readValue(std::istream& is)
+{
+    T value = T();
+    is.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return value;
+}
+
+void writeString(std::ostream& os, const std::string& str)
+{
+    writeValue<std::uint32_t>(os, str.size());
+    os.write(str.data(), str.size());
+}
+
+std::string readString(std::istream& is)
+{
+    const std::uint32_t size = readValue<std::uint32_t>(is);
+    std::string str;
+
+    if (is.good() && size > 0) {
+        str.resize(size);
+        is.read(&str[0], size);
+    }
+
+    return str;
+}
+}
+
+const char N2D2::Packed_Database::Magic[8] = {'N', '2', 'D', '2', 'P', 'K', '0', '1'};
+
+N2D2::Packed_Database::Packed_Database()
+    : Database(false),
+      mShardCache(this, "ShardCache", 4U),
+      mShuffleShards(this, "ShuffleShards", false)
+{
+    // ctor
+}
+
+void N2D2::Packed_Database::load(const std::string& dataPath,
+                                 const std::string& /*labelPath*/,
+                                 bool /*extractROIs*/)
+{
+    const std::string indexName = dataPath + "/index.bin";
+    std::ifstream index(indexName.c_str(), std::ios::binary);
+
+    if (!index.good())
+        throw std::runtime_error("Could not open index file: " + indexName);
+
+    char magic[sizeof(Magic)];
+    index.read(magic, sizeof(magic));
+
+    if (!index.good() || !std::equal(magic, magic + sizeof(magic), Magic)) {
+        throw std::runtime_error("Wrong file format for index file: "
+                                 + indexName);
+    }
+
+    const unsigned int nbLabels = readValue<std::uint32_t>(index);
+    const unsigned int nbStimuli = readValue<std::uint32_t>(index);
+    const unsigned int nbShards = readValue<std::uint32_t>(index);
+    const int depth = readValue<std::int32_t>(index);
+
+    // The labels ID may differ from the packed ones when several packed
+    // databases are loaded
+    std::vector<int> labels;
+
+    for (unsigned int label = 0; label < nbLabels && index.good(); ++label)
+        labels.push_back(labelID(readString(index)));
+
+    const unsigned int shardOffset = mShardsName.size();
+
+    for (unsigned int shard = 0; shard < nbShards; ++shard)
+        mShardsName.push_back(getShardName(dataPath, shard));
+
+    mRecords.reserve(mRecords.size() + nbStimuli);
+
+    for (unsigned int i = 0; i < nbStimuli && index.good(); ++i) {
+        const std::string name = readString(index);
+        const int label = readValue<std::int32_t>(index);
+        const unsigned int set = readValue<std::uint32_t>(index);
+
+        Record record;
+        record.shard = shardOffset + readValue<std::uint32_t>(index);
+        record.offset = readValue<std::uint64_t>(index);
+        record.size = readValue<std::uint64_t>(index);
+
+        const unsigned int nbROIs = readValue<std::uint32_t>(index);
+        std::vector<ROI*> ROIs;
+
+        for (unsigned int r = 0; r < nbROIs && index.good(); ++r) {
+            const int roiLabel = readValue<std::int32_t>(index);
+            const int x = readValue<std::int32_t>(index);
+            const int y = readValue<std::int32_t>(index);
+            const int width = readValue<std::int32_t>(index);
+            const int height = readValue<std::int32_t>(index);
+
+            ROIs.push_back(new RectangularROI<int>(
+                (roiLabel >= 0 && roiLabel < (int)labels.size())
+                    ? labels[roiLabel] : -1,
+                cv::Point(x, y), width, height));
+        }
+
+        if (set > Unpartitioned || record.shard >= mShardsName.size()) {
+            std::for_each(ROIs.begin(), ROIs.end(), Utils::Delete());
+            throw std::runtime_error("Wrong file format for index file: "
+                                     + indexName);
+        }
+
+        mStimuli.push_back(Stimulus(name,
+            (label >= 0 && label < (int)labels.size()) ? labels[label] : -1,
+            ROIs));
+        mStimuliSets((StimuliSet)set).push_back(mStimuli.size() - 1);
+        mRecords.push_back(record);
+    }
+
+    if (!index.good())
+        throw std::runtime_error("Error while reading index file: "
+                                 + indexName);
+
+    if (mStimuliDepth == -1)
+        mStimuliDepth = depth;
+}
+
+void N2D2::Packed_Database::shuffleIndexes(StimuliSet set,
+                                           std::vector<unsigned int>& indexes)
+    const
+{
+    if (!mShuffleShards) {
+        Database::shuffleIndexes(set, indexes);
+        return;
+    }
+
+    // Group the indexes per shard
+    const std::vector<StimulusID>& stimuli = mStimuliSets(set);
+    std::vector<std::vector<unsigned int> > shardIndexes(mShardsName.size());
+
+    for (std::vector<unsigned int>::const_iterator it = indexes.begin(),
+         itEnd = indexes.end(); it != itEnd; ++it)
+    {
+        const unsigned int shard = ((*it) < stimuli.size())
+            ? mRecords[stimuli[*it]].shard : 0;
+        shardIndexes[shard].push_back(*it);
+    }
+
+    // Shuffle the order of the shards, then the stimuli within each shard
+    std::vector<unsigned int> shards(mShardsName.size());
+    std::iota(shards.begin(), shards.end(), 0U);
+    std::random_shuffle(shards.begin(), shards.end(), Random::randShuffle);
+
+    indexes.clear();
+
+    for (std::vector<unsigned int>::const_iterator it = shards.begin(),
+         itEnd = shards.end(); it != itEnd; ++it)
+    {
+        std::vector<unsigned int>& shardIdx = shardIndexes[*it];
+        std::random_shuffle(shardIdx.begin(), shardIdx.end(),
+                            Random::randShuffle);
+        indexes.insert(indexes.end(), shardIdx.begin(), shardIdx.end());
+    }
+}
+
+void N2D2::Packed_Database::pack(Database& database,
+                                 const std::string& dataPath,
+                                 StimuliSetMask setMask,
+                                 std::size_t shardSize,
+                                 bool compressed)
+{
+    Utils::createDirectories(dataPath);
+
+    // Stimuli to pack, in the order of their set
+    std::vector<std::pair<StimulusID, StimuliSet> > stimuli;
+    const std::vector<StimuliSet> stimuliSets
+        = database.getStimuliSets(setMask);
+
+    for (std::vector<StimuliSet>::const_iterator it = stimuliSets.begin(),
+         itEnd = stimuliSets.end(); it != itEnd; ++it)
+    {
+        for (unsigned int index = 0; index < database.getNbStimuli(*it);
+             ++index)
+        {
+            stimuli.push_back(std::make_pair(
+                database.getStimulusID(*it, index), *it));
+        }
+    }
+
+    std::vector<Record> records(stimuli.size());
+    std::vector<std::exception_ptr> errors(stimuli.size());
+    std::ofstream shardFile;
+    std::uint64_t shardOffset = 0;
+    unsigned int nbShards = 0;
+    int depth = -1;
+
+    // The stimuli are loaded and serialized in parallel, then written in
+    // order
+#pragma omp parallel for schedule(dynamic) ordered
+    for (int i = 0; i < (int)stimuli.size(); ++i) {
+        std::vector<char> buffer;
+        cv::Mat data;
+
+        try {
+            data = database.getStimulusData(stimuli[i].first);
+            writeMat(buffer, data, compressed);
+            writeMat(buffer,
+                     database.getStimulusLabelsData(stimuli[i].first),
+                     compressed);
+        }
+        catch (...) {
+            errors[i] = std::current_exception();
+        }
+
+#pragma omp ordered
+        if (!errors[i]) {
+            try {
+                if (!shardFile.is_open()
+                    || (shardOffset > 0
+                        && shardOffset + buffer.size() > shardSize))
+                {
+                    const std::string shardName
+                        = getShardName(dataPath, nbShards);
+
+                    shardFile.close();
+                    shardFile.open(shardName.c_str(),
+                                   std::ios::binary | std::ios::trunc);
+
+                    if (!shardFile.good()) {
+                        throw std::runtime_error("Packed_Database::pack(): "
+                            "could not create shard file: " + shardName);
+                    }
+
+                    ++nbShards;
+                    shardOffset = 0;
+                }
+
+                shardFile.write(&buffer[0], buffer.size());
+
+                if (!shardFile.good()) {
+                    throw std::runtime_error("Packed_Database::pack(): "
+                        "could not write shard file: "
+                        + getShardName(dataPath, nbShards - 1));
+                }
+
+                records[i].shard = nbShards - 1;
+                records[i].offset = shardOffset;
+                records[i].size = buffer.size();
+                shardOffset += buffer.size();
+
+                if (depth == -1)
+                    depth = data.depth();
+            }
+            catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }
+    }
+
+    for (std::vector<std::exception_ptr>::const_iterator it = errors.begin(),
+         itEnd = errors.end(); it != itEnd; ++it)
+    {
+        if (*it)
+            std::rethrow_exception(*it);
+    }
+
+    shardFile.close();
+
+    // Index
+    const std::string indexName = dataPath + "/index.bin";
+    std::ofstream index(indexName.c_str(), std::ios::binary);
+
+    if (!index.good()) {
+        throw std::runtime_error("Packed_Database::pack(): could not create "
+                                 "index file: " + indexName);
+    }
+
+    const std::vector<std::string>& labelsName = database.getLabels();
+
+    index.write(Magic, sizeof(Magic));
+    writeValue<std::uint32_t>(index, labelsName.size());
+    writeValue<std::uint32_t>(index, stimuli.size());
+    writeValue<std::uint32_t>(index, nbShards);
+    writeValue<std::int32_t>(index, depth);
+
+    for (std::vector<std::string>::const_iterator it = labelsName.begin(),
+         itEnd = labelsName.end(); it != itEnd; ++it)
+    {
+        writeString(index, *it);
+    }
+
+    for (unsigned int i = 0; i < stimuli.size(); ++i) {
+        const StimulusID id = stimuli[i].first;
+
+        writeString(index, database.getStimulusName(id));
+        writeValue<std::int32_t>(index, database.getStimulusLabel(id));
+        writeValue<std::uint32_t>(index, stimuli[i].second);
+        writeValue<std::uint32_t>(index, records[i].shard);
+        writeValue<std::uint64_t>(index, records[i].offset);
+        writeValue<std::uint64_t>(index, records[i].size);
+
+        const std::vector<std::shared_ptr<ROI> > ROIs
+            = database.getStimulusROIs(id);
+
+        writeValue<std::uint32_t>(index, ROIs.size());
+
+        for (std::vector<std::shared_ptr<ROI> >::const_iterator
+             it = ROIs.begin(), itEnd = ROIs.end(); it != itEnd; ++it)
+        {
+            const cv::Rect rect = (*it)->getBoundingRect();
+
+            writeValue<std::int32_t>(index, (*it)->getLabel());
+            writeValue<std::int32_t>(index, rect.x);
+            writeValue<std::int32_t>(index, rect.y);
+            writeValue<std::int32_t>(index, rect.width);
+            writeValue<std::int32_t>(index, rect.height);
+        }
+    }
+
+    if (!index.good()) {
+        throw std::runtime_error("Packed_Database::pack(): could not write "
+                                 "index file: " + indexName);
+    }
+}
+
+cv::Mat N2D2::Packed_Database::loadStimulusData(StimulusID id)
+{
+    return readRecord(id, 0);
+}
+
+cv::Mat N2D2::Packed_Database::loadStimulusLabelsData(StimulusID id)
+{
+    return readRecord(id, 1);
+}
+
+std::shared_ptr<const std::vector<char> >
+N2D2::Packed_Database::getShard(unsigned int shard)
+{
+    std::unique_lock<std::mutex> lock(mShardsMutex);
+    std::list<Shard>::iterator itShard;
+
+    while (true) {
+        itShard = std::find_if(mShards.begin(), mShards.end(),
+            [shard](const Shard& s) { return (s.shard == shard); });
+
+        if (itShard == mShards.end())
+            break;
+
+        if ((*itShard).data) {
+            // Move to the front (most recently used)
+            mShards.splice(mShards.begin(), mShards, itShard);
+            return (*itShard).data;
+        }
+
+        // The shard is being read by another thread
+        mShardRead.wait(lock);
+    }
+
+    Shard entry;
+    entry.shard = shard;
+    mShards.push_front(entry);
+    itShard = mShards.begin();
+
+    // Read the whole shard at once, outside the lock
+    lock.unlock();
+
+    std::shared_ptr<std::vector<char> > data
+        = std::make_shared<std::vector<char> >();
+
+    try {
+        std::ifstream shardFile(mShardsName[shard].c_str(), std::ios::binary);
+
+        if (!shardFile.good()) {
+            throw std::runtime_error("Packed_Database::getShard(): could not "
+                "open shard file: " + mShardsName[shard]);
+        }
+
+        shardFile.seekg(0, std::ios::end);
+        data->resize(shardFile.tellg());
+        shardFile.seekg(0, std::ios::beg);
+
+        if (!data->empty())
+            shardFile.read(&(*data)[0], data->size());
+
+        if (!shardFile.good()) {
+            throw std::runtime_error("Packed_Database::getShard(): could not "
+                "read shard file: " + mShardsName[shard]);
+        }
+    }
+    catch (...) {
+        lock.lock();
+        mShards.erase(itShard);
+        mShardRead.notify_all();
+        throw;
+    }
+
+    lock.lock();
+    (*itShard).data = data;
+
+    // Evict the least recently used shards, except the ones being read
+    const std::size_t maxShards = std::max(1U, (unsigned int)mShardCache);
+    std::list<Shard>::iterator itEvict = mShards.end();
+
+    while (mShards.size() > maxShards && itEvict != mShards.begin()) {
+        --itEvict;
+
+        if ((*itEvict).data && itEvict != itShard)
+            itEvict = mShards.erase(itEvict);
+    }
+
+    mShardRead.notify_all();
+    return data;
+}
+
+void N2D2::Packed_Database::remapStimuli(const std::vector<int>& mapping)
+{
+    Database::remapStimuli(mapping);
+
+    // The records are indexed by stimulus ID, and the mapping is increasing
+    for (int i = 0, size = std::min(mapping.size(), mRecords.size());
+        i < size; ++i)
+    {
+        if (mapping[i] >= 0 && mapping[i] != i)
+            mRecords[mapping[i]] = mRecords[i];
+    }
+
+    mRecords.resize(mStimuli.size());
+}
+
+cv::Mat N2D2::Packed_Database::readRecord(StimulusID id, unsigned int matrix)
+{
+    const Record& record = mRecords[id];
+    const std::shared_ptr<const std::vector<char> > shard
+        = getShard(record.shard);
+
+    if (record.offset + record.size > shard->size()) {
+        throw std::runtime_error("Packed_Database::readRecord(): truncated "
+                                 "shard file: " + mShardsName[record.shard]);
+    }
+
+    const char* ptr = &(*shard)[0] + record.offset;
+    const char* end = ptr + record.size;
+
+    for (unsigned int m = 0; ; ++m) {
+        MatHeader header;
+
+        if (ptr + sizeof(header) > end) {
+            throw std::runtime_error("Packed_Database::readRecord(): corrupted "
+                "record in shard file: " + mShardsName[record.shard]);
+        }
+
+        std::memcpy(&header, ptr, sizeof(header));
+        ptr += sizeof(header);
+
+        const std::size_t size = (header.encodedSize > 0)
+            ? header.encodedSize
+            : (std::size_t)header.rows * header.cols
+                * CV_ELEM_SIZE(header.type);
+
+        if (ptr + size > end) {
+            throw std::runtime_error("Packed_Database::readRecord(): corrupted "
+                "record in shard file: " + mShardsName[record.shard]);
+        }
+
+        if (m == matrix) {
+            if (header.encodedSize > 0) {
+                const cv::Mat encoded(1, size, CV_8UC1, (void*)ptr);
+#if CV_MAJOR_VERSION >= 3
+                return cv::imdecode(encoded, cv::IMREAD_UNCHANGED);
+#else
+                return cv::imdecode(encoded, CV_LOAD_IMAGE_UNCHANGED);
+#endif
+            }
+
+            // Copy, as the shard may be evicted
+            cv::Mat mat(header.rows, header.cols, header.type);
+
+            if (size > 0)
+                std::memcpy(mat.data, ptr, size);
+
+            return mat;
+        }
+
+        ptr += size;
+    }
+}
+
+void N2D2::Packed_Database::writeMat(std::vector<char>& buffer,
+                                     const cv::Mat& mat,
+                                     bool compressed)
+{
+    MatHeader header;
+    header.rows = mat.rows;
+    header.cols = mat.cols;
+    header.type = mat.type();
+    header.encodedSize = 0;
+
+    std::vector<unsigned char> encoded;
+
+    if (compressed && StimuliMemoryCache::isEncodable(mat)) {
+        cv::imencode(".png", mat, encoded);
+        header.encodedSize = encoded.size();
+    }
+
+    buffer.insert(buffer.end(), reinterpret_cast<const char*>(&header),
+                  reinterpret_cast<const char*>(&header) + sizeof(header));
+
+    if (header.encodedSize > 0)
+        buffer.insert(buffer.end(), encoded.begin(), encoded.end());
+    else if (!mat.empty()) {
+        const cv::Mat continuous = (mat.isContinuous()) ? mat : mat.clone();
+        const char* data = reinterpret_cast<const char*>(continuous.data);
+
+        buffer.insert(buffer.end(), data,
+                      data + continuous.total() * continuous.elemSize());
+    }
+}
+
+std::string N2D2::Packed_Database::getShardName(const std::string& dataPath,
+                                                unsigned int shard)
+{
+    std::ostringstream shardName;
+    shardName << dataPath << "/shard-" << std::setfill('0') << std::setw(5)
+              << shard << ".bin";
+    return shardName.str();
+}
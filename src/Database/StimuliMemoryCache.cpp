@@ -0,0 +1,187 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "Database/StimuliMemoryCache.hpp"
+
+N2D2::StimuliMemoryCache::StimuliMemoryCache(std::size_t maxSize,
+                                             unsigned int nbShards,
+                                             bool compressed)
+    : mMaxSize(maxSize),
+      mCompressed(compressed)
+{
+    unsigned int nbShardsPow2 = 1;
+
+    while (nbShardsPow2 < nbShards)
+        nbShardsPow2 <<= 1;
+
+    mShardMaxSize = mMaxSize / nbShardsPow2;
+
+    for (unsigned int i = 0; i < nbShardsPow2; ++i)
+        mShards.push_back(std::unique_ptr<Shard>(new Shard()));
+}
+
+bool N2D2::StimuliMemoryCache::get(unsigned int id,
+                                   DataType type,
+                                   cv::Mat& mat)
+{
+    const std::uint64_t key = getKey(id, type);
+    Shard& shard = getShard(key);
+    std::shared_ptr<const std::vector<unsigned char> > encoded;
+
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+
+        const auto it = shard.index.find(key);
+
+        if (it == shard.index.end()) {
+            ++shard.misses;
+            return false;
+        }
+
+        // Move to the front (most recently used)
+        shard.entries.splice(shard.entries.begin(), shard.entries,
+                             (*it).second);
+        ++shard.hits;
+
+        if (!(*(*it).second).encoded) {
+            mat = (*(*it).second).mat;
+            return true;
+        }
+
+        encoded = (*(*it).second).encoded;
+    }
+
+    // Decode outside the lock
+#if CV_MAJOR_VERSION >= 3
+    mat = cv::imdecode(*encoded, cv::IMREAD_UNCHANGED);
+#else
+    mat = cv::imdecode(*encoded, CV_LOAD_IMAGE_UNCHANGED);
+#endif
+    return true;
+}
+
+void N2D2::StimuliMemoryCache::put(unsigned int id,
+                                   DataType type,
+                                   const cv::Mat& mat)
+{
+    Entry entry;
+    entry.key = getKey(id, type);
+
+    if (mCompressed && isEncodable(mat)) {
+        std::shared_ptr<std::vector<unsigned char> > encoded
+            = std::make_shared<std::vector<unsigned char> >();
+        cv::imencode(".png", mat, *encoded);
+
+        entry.size = encoded->size();
+        entry.encoded = encoded;
+    }
+    else {
+        // Keep a continuous matrix not referencing a larger buffer
+        entry.mat = (mat.isContinuous()) ? mat : mat.clone();
+        entry.size = mat.total() * mat.elemSize();
+    }
+
+    if (entry.size > mShardMaxSize)
+        return;
+
+    Shard& shard = getShard(entry.key);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+
+    const auto it = shard.index.find(entry.key);
+
+    if (it != shard.index.end()) {
+        shard.size -= (*(*it).second).size;
+        shard.entries.erase((*it).second);
+        shard.index.erase(it);
+    }
+
+    // Evict the least recently used entries
+    while (!shard.entries.empty() && shard.size + entry.size > mShardMaxSize) {
+        shard.size -= shard.entries.back().size;
+        shard.index.erase(shard.entries.back().key);
+        shard.entries.pop_back();
+        ++shard.evictions;
+    }
+
+    shard.size += entry.size;
+    shard.entries.push_front(entry);
+    shard.index[entry.key] = shard.entries.begin();
+}
+
+N2D2::StimuliMemoryCache::Stats N2D2::StimuliMemoryCache::getStats() const
+{
+    Stats stats = {0, 0, 0, 0, 0};
+
+    for (std::vector<std::unique_ptr<Shard> >::const_iterator
+        it = mShards.begin(), itEnd = mShards.end(); it != itEnd; ++it)
+    {
+        std::lock_guard<std::mutex> lock((*it)->mutex);
+
+        stats.hits += (*it)->hits;
+        stats.misses += (*it)->misses;
+        stats.evictions += (*it)->evictions;
+        stats.nbEntries += (*it)->entries.size();
+        stats.size += (*it)->size;
+    }
+
+    return stats;
+}
+
+void N2D2::StimuliMemoryCache::resetStats()
+{
+    for (std::vector<std::unique_ptr<Shard> >::iterator
+        it = mShards.begin(), itEnd = mShards.end(); it != itEnd; ++it)
+    {
+        std::lock_guard<std::mutex> lock((*it)->mutex);
+
+        (*it)->hits = 0;
+        (*it)->misses = 0;
+        (*it)->evictions = 0;
+    }
+}
+
+void N2D2::StimuliMemoryCache::clear()
+{
+    for (std::vector<std::unique_ptr<Shard> >::iterator
+        it = mShards.begin(), itEnd = mShards.end(); it != itEnd; ++it)
+    {
+        std::lock_guard<std::mutex> lock((*it)->mutex);
+
+        (*it)->entries.clear();
+        (*it)->index.clear();
+        (*it)->size = 0;
+    }
+}
+
+N2D2::StimuliMemoryCache::Shard&
+N2D2::StimuliMemoryCache::getShard(std::uint64_t key) const
+{
+    // All the data types of a stimulus are in the same shard and consecutive
+    // stimuli are in different shards
+    return *mShards[(key >> 2) & (mShards.size() - 1)];
+}
+
+bool N2D2::StimuliMemoryCache::isEncodable(const cv::Mat& mat)
+{
+    return ((mat.depth() == CV_8U || mat.depth() == CV_16U)
+        && (mat.channels() == 1 || mat.channels() == 3
+            || mat.channels() == 4)
+        && mat.rows > 0 && mat.cols > 0);
+}
@@ -33,6 +33,9 @@
 #include "Cell/ConvCell_Spike.hpp"
 #include "Cell/DropoutCell.hpp"
 #include "Cell/FcCell.hpp"
+#include "Cell/FMPCell.hpp"
+#include "Cell/RPCell.hpp"
+#include "Cell/AnchorCell.hpp"
 #include "Cell/PoolCell.hpp"
 #include "Cell/PaddingCell.hpp"
 #include "Cell/ReshapeCell.hpp"
@@ -41,14 +44,18 @@
 #include "Cell/SoftmaxCell.hpp"
 #include "Cell/Cell_CSpike_Top.hpp"
 #include "utils/Utils.hpp"
+#include "Solver/FusedUpdate.hpp"
 #include "Solver/Solver.hpp"
+#include "utils/RingAllReduce.hpp"
 
 N2D2::DeepNet::DeepNet(Network& net)
     : mName(this, "Name", ""),
+      mParallelBranches(this, "ParallelBranches", false),
       mNet(net),
       mLayers(1, std::vector<std::string>(1, "env")),
       mStreamIdx(0),
-      mStreamTestIdx(0)
+      mStreamTestIdx(0),
+      mExecPlanValid(false)
 {
     // ctor
 
@@ -72,6 +79,8 @@ N2D2::DeepNet::DeepNet(Network& net)
 void N2D2::DeepNet::addCell(const std::shared_ptr<Cell>& cell,
                             const std::vector<std::shared_ptr<Cell>>& parents)
 {
+    invalidateExecPlan();
+
     // Check which parent has the largest order in mLayers 
     unsigned int cellOrder = 0;
     for (auto it = mLayers.begin(); it != mLayers.end(); ++it) {
@@ -111,6 +120,8 @@ void N2D2::DeepNet::addCellBetween(const std::shared_ptr<Cell>& newCell,
                                    const std::shared_ptr<Cell>& parent,
                                    const std::shared_ptr<Cell>& child)
 {
+    invalidateExecPlan();
+
     auto parentChildren = parent->getChildrenCells();
     if(std::find(parentChildren.begin(), parentChildren.end(), child) == parentChildren.end()) {
         throw std::runtime_error("The cell '" + parent->getName() + "' isn't a parent of the cell '" + 
@@ -183,6 +194,8 @@ void N2D2::DeepNet::addCellBetween(const std::shared_ptr<Cell>& newCell,
 void N2D2::DeepNet::addCellAfter(const std::shared_ptr<Cell>& newCell,
                                  const std::shared_ptr<Cell>& parent)
 {
+    invalidateExecPlan();
+
     /**
      * mCells 
      */
@@ -245,6 +258,8 @@ void N2D2::DeepNet::addCellAfter(const std::shared_ptr<Cell>& newCell,
 void N2D2::DeepNet::addCellBefore(const std::shared_ptr<Cell>& newCell,
                                   const std::shared_ptr<Cell>& child)
 {
+    invalidateExecPlan();
+
     /**
      * mCells 
      */
@@ -288,6 +303,8 @@ void N2D2::DeepNet::addCellBefore(const std::shared_ptr<Cell>& newCell,
 void N2D2::DeepNet::removeCell(const std::shared_ptr<Cell>& cell,
                                bool reconnect)
 {
+    invalidateExecPlan();
+
     // TODO Refactorize and simplify the method.
     const std::string cellName = cell->getName();
 
@@ -663,6 +680,11 @@ void N2D2::DeepNet::save(const std::string& dirName) const
          it != itEnd;
          ++it)
         (*it).second->save(dirName + "/" + Utils::filePath((*it).first));
+
+    // The parameter arena is saved in a single file, which takes precedence
+    // over the cells free parameters in load()
+    if (mParameterArena)
+        mParameterArena->save(dirName + "/ParameterArena.bin");
 }
 
 void N2D2::DeepNet::load(const std::string& dirName)
@@ -673,6 +695,11 @@ void N2D2::DeepNet::load(const std::string& dirName)
          it != itEnd;
          ++it)
         (*it).second->load(dirName + "/" + Utils::filePath((*it).first));
+
+    const std::string arenaFile = dirName + "/ParameterArena.bin";
+
+    if (mParameterArena && std::ifstream(arenaFile.c_str()).good())
+        mParameterArena->load(arenaFile);
 }
 
 void N2D2::DeepNet::saveNetworkParameters() const
@@ -1055,6 +1082,560 @@ void N2D2::DeepNet::initialize()
         CHECK_CUDA_STATUS(cudaSetDevice(currentDev));
     }
 #endif
+
+    compileExecPlan();
+}
+
+void N2D2::DeepNet::compileExecPlan()
+{
+    // The memory plan is bound to the execution plan
+    clearInferenceMemoryPlan();
+
+    std::vector<ExecNode> plan;
+    std::map<std::string, unsigned int> nodeIndex;
+
+    for (unsigned int l = 1, nbLayers = mLayers.size(); l < nbLayers; ++l) {
+        for (std::vector<std::string>::const_iterator itCell
+            = mLayers[l].begin(),
+            itCellEnd = mLayers[l].end();
+            itCell != itCellEnd;
+            ++itCell)
+        {
+            const std::shared_ptr<Cell>& cell = mCells.at(*itCell);
+            const std::string type = cell->getType();
+
+            ExecNode node;
+            node.name = (*itCell);
+            node.cell = std::dynamic_pointer_cast<Cell_Frame_Top>(cell);
+            node.nbPredecessors = 0;
+            node.nbBackPredecessors = 0;
+            // Random is not thread-safe
+            node.exclusive = (type == DropoutCell::Type
+                || type == FMPCell::Type
+                || type == RPCell::Type
+                || type == AnchorCell::Type
+                || (type == FcCell::Type && cell->isParameter("DropConnect")
+                    && cell->getParameter<double>("DropConnect") < 1.0));
+            node.memorySlot = -1;
+
+            nodeIndex.insert(std::make_pair(node.name, plan.size()));
+            plan.push_back(node);
+        }
+    }
+
+    std::vector<unsigned int> backOrder;
+
+    for (unsigned int l = mLayers.size() - 1; l > 0; --l) {
+        for (std::vector<std::string>::const_iterator itCell
+            = mLayers[l].begin(),
+            itCellEnd = mLayers[l].end();
+            itCell != itCellEnd;
+            ++itCell)
+        {
+            backOrder.push_back(nodeIndex.at(*itCell));
+        }
+    }
+
+    // For the propagation, a cell depends on its parents.
+    // For the back-propagation, a cell depends on its children, and the
+    // children of a same parent, which accumulate their gradient in the same
+    // tensor, are chained in the back-propagation order, which keeps the
+    // result identical to the sequential execution.
+    std::map<std::string, unsigned int> lastChild;
+
+    for (std::vector<unsigned int>::const_iterator it = backOrder.begin(),
+         itEnd = backOrder.end(); it != itEnd; ++it)
+    {
+        const unsigned int index = (*it);
+        const std::pair<std::multimap<std::string, std::string>::const_iterator,
+                        std::multimap<std::string, std::string>::const_iterator>
+            parents = mParentLayers.equal_range(plan[index].name);
+
+        for (std::multimap<std::string, std::string>::const_iterator itParent
+             = parents.first; itParent != parents.second; ++itParent)
+        {
+            const std::string& parentName = (*itParent).second;
+            const std::map<std::string, unsigned int>::const_iterator
+                itParentIndex = nodeIndex.find(parentName);
+
+            if (itParentIndex != nodeIndex.end()) {
+                const unsigned int parentIndex = (*itParentIndex).second;
+
+                plan[parentIndex].successors.push_back(index);
+                ++plan[index].nbPredecessors;
+                plan[index].backSuccessors.push_back(parentIndex);
+                ++plan[parentIndex].nbBackPredecessors;
+            }
+
+            std::map<std::string, unsigned int>::iterator itLast;
+            bool newParent;
+            std::tie(itLast, newParent)
+                = lastChild.insert(std::make_pair(parentName, index));
+
+            if (!newParent && (*itLast).second != index) {
+                plan[(*itLast).second].backSuccessors.push_back(index);
+                ++plan[index].nbBackPredecessors;
+                (*itLast).second = index;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mExecPlanMutex);
+    mExecPlan.swap(plan);
+    mExecBackOrder.swap(backOrder);
+    mExecPlanValid = true;
+}
+
+void N2D2::DeepNet::invalidateExecPlan()
+{
+    // The memory plan is bound to the execution plan
+    clearInferenceMemoryPlan();
+
+    std::lock_guard<std::mutex> lock(mExecPlanMutex);
+    mExecPlanValid = false;
+}
+
+void N2D2::DeepNet::runExecPlan(
+    bool backward,
+    bool parallel,
+    const std::function<void(const ExecNode&)>& func)
+{
+    {
+        std::unique_lock<std::mutex> lock(mExecPlanMutex);
+
+        if (!mExecPlanValid) {
+            lock.unlock();
+            compileExecPlan();
+        }
+    }
+
+#ifdef CUDA
+    // The cells are sharing the device streams and handles
+    parallel = false;
+#endif
+
+    // The memory plan lifetimes assume a sequential execution
+    if (!parallel || !mParallelBranches || !mMemorySlots.empty()) {
+        if (backward) {
+            for (std::vector<unsigned int>::const_iterator it
+                 = mExecBackOrder.begin(), itEnd = mExecBackOrder.end();
+                 it != itEnd; ++it)
+            {
+                func(mExecPlan[*it]);
+            }
+        }
+        else {
+            for (std::vector<ExecNode>::const_iterator it = mExecPlan.begin(),
+                 itEnd = mExecPlan.end(); it != itEnd; ++it)
+            {
+                func(*it);
+            }
+        }
+
+        return;
+    }
+
+    // Execute the plan by waves of ready nodes. A node alone in its wave
+    // keeps all the OpenMP threads for its own computation.
+    std::vector<unsigned int> nbPredecessors(mExecPlan.size());
+    std::vector<unsigned int> ready;
+
+    for (unsigned int index = 0; index < mExecPlan.size(); ++index) {
+        nbPredecessors[index] = (backward)
+            ? mExecPlan[index].nbBackPredecessors
+            : mExecPlan[index].nbPredecessors;
+
+        if (nbPredecessors[index] == 0)
+            ready.push_back(index);
+    }
+
+    std::vector<unsigned int> concurrent;
+    std::vector<unsigned int> next;
+
+    while (!ready.empty()) {
+        concurrent.clear();
+
+        for (std::vector<unsigned int>::const_iterator it = ready.begin(),
+             itEnd = ready.end(); it != itEnd; ++it)
+        {
+            if (ready.size() == 1 || mExecPlan[*it].exclusive)
+                func(mExecPlan[*it]);
+            else
+                concurrent.push_back(*it);
+        }
+
+        if (!concurrent.empty()) {
+            std::exception_ptr error;
+
+#pragma omp parallel for schedule(dynamic) if (concurrent.size() > 1)
+            for (int i = 0; i < (int)concurrent.size(); ++i) {
+                try {
+                    func(mExecPlan[concurrent[i]]);
+                }
+                catch (...) {
+#pragma omp critical(DeepNet__runExecPlan)
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+        next.clear();
+
+        for (std::vector<unsigned int>::const_iterator it = ready.begin(),
+             itEnd = ready.end(); it != itEnd; ++it)
+        {
+            const std::vector<unsigned int>& successors = (backward)
+                ? mExecPlan[*it].backSuccessors
+                : mExecPlan[*it].successors;
+
+            for (std::vector<unsigned int>::const_iterator itSucc
+                 = successors.begin(), itSuccEnd = successors.end();
+                 itSucc != itSuccEnd; ++itSucc)
+            {
+                if (--nbPredecessors[*itSucc] == 0)
+                    next.push_back(*itSucc);
+            }
+        }
+
+        std::sort(next.begin(), next.end());
+        ready.swap(next);
+    }
+}
+
+namespace {
+std::size_t storageSize(const N2D2::BaseTensor& tensor)
+{
+    const std::type_info* type = tensor.getType();
+    const std::size_t elemSize
+        = (type == &typeid(double)) ? sizeof(double)
+        : (type == &typeid(half_float::half)) ? sizeof(half_float::half)
+        : sizeof(float);
+
+    return tensor.size() * elemSize;
+}
+
+template <class T>
+bool swapStorage(N2D2::BaseTensor& tensor, N2D2::BaseTensor& holder)
+{
+    N2D2::Tensor<T>* typedTensor = dynamic_cast<N2D2::Tensor<T>*>(&tensor);
+
+    if (typedTensor == NULL)
+        return false;
+
+    N2D2::Tensor<T>& typedHolder = dynamic_cast<N2D2::Tensor<T>&>(holder);
+    typedTensor->data().swap(typedHolder.data());
+    // No reallocation, the storage capacity is the slot size
+    typedTensor->data().resize(typedTensor->size());
+    return true;
+}
+
+template <class T>
+bool reserveStorage(N2D2::BaseTensor& tensor, std::size_t size)
+{
+    N2D2::Tensor<T>* typedTensor = dynamic_cast<N2D2::Tensor<T>*>(&tensor);
+
+    if (typedTensor == NULL)
+        return false;
+
+    typedTensor->data().reserve(size / sizeof(T));
+    return true;
+}
+
+template <class T>
+bool releaseStorage(N2D2::BaseTensor& tensor)
+{
+    N2D2::Tensor<T>* typedTensor = dynamic_cast<N2D2::Tensor<T>*>(&tensor);
+
+    if (typedTensor == NULL)
+        return false;
+
+    std::vector<T>().swap(typedTensor->data());
+    return true;
+}
+
+template <class T>
+bool restoreStorage(N2D2::BaseTensor& tensor)
+{
+    N2D2::Tensor<T>* typedTensor = dynamic_cast<N2D2::Tensor<T>*>(&tensor);
+
+    if (typedTensor == NULL)
+        return false;
+
+    if (typedTensor->data().size() != typedTensor->size())
+        typedTensor->data().resize(typedTensor->size());
+
+    return true;
+}
+}
+
+std::size_t N2D2::DeepNet::planInferenceMemory(
+    MemoryManager::OptimizeStrategy strategy)
+{
+#ifdef CUDA
+    throw std::runtime_error("DeepNet::planInferenceMemory(): not available "
+                             "with CUDA");
+#endif
+
+    clearInferenceMemoryPlan();
+    compileExecPlan();
+
+    std::set<std::string> targetCells;
+
+    for (std::vector<std::shared_ptr<Target> >::const_iterator itTargets
+         = mTargets.begin(), itTargetsEnd = mTargets.end();
+         itTargets != itTargetsEnd; ++itTargets)
+    {
+        targetCells.insert((*itTargets)->getCell()->getName());
+    }
+
+    // Outputs lifetimes: allocated when the cell is propagated, released
+    // when all its children are propagated. The network outputs and the
+    // targets cells outputs are never released.
+    MemoryManager memManager;
+    std::vector<bool> keep(mExecPlan.size(), false);
+    std::size_t unplannedSize = 0;
+    std::size_t keptSize = 0;
+
+    for (unsigned int index = 0; index < mExecPlan.size(); ++index) {
+        const ExecNode& node = mExecPlan[index];
+
+        if (!node.cell)
+            throw std::runtime_error("DeepNet::planInferenceMemory(): "
+                                     "requires Cell_Frame_Top cells");
+
+        const std::shared_ptr<Cell> cell = mCells.at(node.name);
+        const std::vector<std::shared_ptr<Cell> > childs
+            = getChildCells(node.name);
+        const std::size_t size = storageSize(node.cell->getOutputs());
+
+        keep[index] = (childs.empty()
+            || targetCells.find(node.name) != targetCells.end());
+        unplannedSize += size + storageSize(node.cell->getDiffInputs());
+
+        if (keep[index])
+            keptSize += size;
+
+        memManager.allocate(cell, size,
+            (keep[index]) ? std::vector<std::shared_ptr<Cell> >() : childs);
+        memManager.releaseDependencies(cell);
+        memManager.tick(false);
+    }
+
+    memManager.optimize(strategy);
+
+    // The Tensor storage cannot be a view in a single memory arena: the
+    // outputs are assigned to shared slots instead, according to their
+    // lifetimes (best fit among the slots free at allocation time).
+    std::vector<MemorySlot> slots;
+
+    for (unsigned int index = 0; index < mExecPlan.size(); ++index) {
+        if (keep[index])
+            continue;
+
+        ExecNode& node = mExecPlan[index];
+        const MemoryManager::MemoryPlane& plane
+            = memManager.getPlanes(mCells.at(node.name)).front();
+        const std::type_info* type = node.cell->getOutputs().getType();
+        const std::size_t size = plane.memSpace->size;
+        int bestSlot = -1;
+
+        for (int slot = 0; slot < (int)slots.size(); ++slot) {
+            if (slots[slot].type != type
+                || slots[slot].released >= plane.memSpace->allocated)
+            {
+                continue;
+            }
+
+            if (bestSlot < 0)
+                bestSlot = slot;
+            else if (slots[bestSlot].size < size)
+                bestSlot = (slots[slot].size > slots[bestSlot].size)
+                    ? slot : bestSlot;
+            else if (slots[slot].size >= size
+                     && slots[slot].size < slots[bestSlot].size)
+            {
+                bestSlot = slot;
+            }
+        }
+
+        if (bestSlot < 0) {
+            MemorySlot newSlot;
+            newSlot.type = type;
+            newSlot.size = 0;
+            newSlot.holder = &node;
+
+            bestSlot = slots.size();
+            slots.push_back(newSlot);
+        }
+
+        slots[bestSlot].size = std::max(slots[bestSlot].size, size);
+        slots[bestSlot].released = plane.memSpace->released;
+        node.memorySlot = bestSlot;
+    }
+
+    // Give the slot storage to the first user of each slot
+    std::size_t plannedSize = keptSize;
+
+    for (std::vector<ExecNode>::iterator it = mExecPlan.begin(),
+         itEnd = mExecPlan.end(); it != itEnd; ++it)
+    {
+        BaseTensor& diffInputs = (*it).cell->getDiffInputs();
+
+        if (!diffInputs.empty()) {
+            releaseStorage<float>(diffInputs)
+                || releaseStorage<double>(diffInputs)
+                || releaseStorage<half_float::half>(diffInputs);
+        }
+
+        if ((*it).memorySlot < 0)
+            continue;
+
+        MemorySlot& slot = slots[(*it).memorySlot];
+        BaseTensor& outputs = (*it).cell->getOutputs();
+
+        if (slot.holder == &(*it)) {
+            reserveStorage<float>(outputs, slot.size)
+                || reserveStorage<double>(outputs, slot.size)
+                || reserveStorage<half_float::half>(outputs, slot.size);
+            plannedSize += slot.size;
+        }
+        else {
+            releaseStorage<float>(outputs)
+                || releaseStorage<double>(outputs)
+                || releaseStorage<half_float::half>(outputs);
+        }
+    }
+
+    mMemorySlots.swap(slots);
+
+    std::cout << "Inference memory plan: " << mMemorySlots.size()
+        << " shared buffer(s) for " << mExecPlan.size() << " cells\n"
+        << "  Outputs and gradients memory without plan: "
+        << (unplannedSize / 1024.0) << " KiB\n"
+        << "  Outputs peak memory with plan: "
+        << (plannedSize / 1024.0) << " KiB\n"
+        << "  Outputs peak memory in a single arena (MemoryManager): "
+        << (memManager.getPeakUsage() / 1024.0) << " KiB" << std::endl;
+
+    return plannedSize;
+}
+
+void N2D2::DeepNet::clearInferenceMemoryPlan()
+{
+    if (mMemorySlots.empty())
+        return;
+
+    for (std::vector<ExecNode>::iterator it = mExecPlan.begin(),
+         itEnd = mExecPlan.end(); it != itEnd; ++it)
+    {
+        BaseTensor& outputs = (*it).cell->getOutputs();
+        BaseTensor& diffInputs = (*it).cell->getDiffInputs();
+
+        restoreStorage<float>(outputs)
+            || restoreStorage<double>(outputs)
+            || restoreStorage<half_float::half>(outputs);
+        restoreStorage<float>(diffInputs)
+            || restoreStorage<double>(diffInputs)
+            || restoreStorage<half_float::half>(diffInputs);
+
+        (*it).memorySlot = -1;
+    }
+
+    mMemorySlots.clear();
+}
+
+void N2D2::DeepNet::initializeParameterArena()
+{
+    // A new arena can replace the previous one: the tensors are moved in the
+    // new arena storage
+    std::shared_ptr<ParameterArena<Float_T> > arena
+        = std::make_shared<ParameterArena<Float_T> >();
+
+    for (std::vector<std::vector<std::string> >::const_iterator itLayer
+         = mLayers.begin() + 1, itLayerEnd = mLayers.end();
+         itLayer != itLayerEnd; ++itLayer)
+    {
+        for (std::vector<std::string>::const_iterator itCell
+             = (*itLayer).begin(), itCellEnd = (*itLayer).end();
+             itCell != itCellEnd; ++itCell)
+        {
+            std::shared_ptr<Cell_Frame_Top> cellFrame
+                = std::dynamic_pointer_cast<Cell_Frame_Top>(mCells[(*itCell)]);
+
+            if (!cellFrame)
+                continue;
+
+            // The arena is in host memory
+            if (cellFrame->isCuda()) {
+                throw std::runtime_error("DeepNet::"
+                    "initializeParameterArena(): the parameter arena is not "
+                    "supported for CUDA cells (cell " + (*itCell) + ")");
+            }
+
+            const std::shared_ptr<Activation>& activation
+                = cellFrame->getActivation();
+
+            if (activation && activation->getQuantizer()) {
+                throw std::runtime_error("DeepNet::"
+                    "initializeParameterArena(): the parameters of the "
+                    "activation quantizer of cell " + (*itCell) + " cannot be "
+                    "moved in the parameter arena");
+            }
+
+            std::vector<BaseTensor*> parameters;
+            std::vector<BaseTensor*> gradients;
+            cellFrame->getFreeParameters(parameters, gradients);
+
+            for (std::size_t i = 0; i < parameters.size(); ++i) {
+                Tensor<Float_T>* tensor
+                    = dynamic_cast<Tensor<Float_T>*>(parameters[i]);
+
+                if (tensor == NULL) {
+                    throw std::runtime_error("DeepNet::"
+                        "initializeParameterArena(): the free parameters of "
+                        "cell " + (*itCell) + " are not of type Float_T");
+                }
+
+                arena->addParameters(*tensor);
+            }
+
+            for (std::size_t i = 0; i < gradients.size(); ++i) {
+                Tensor<Float_T>* tensor
+                    = dynamic_cast<Tensor<Float_T>*>(gradients[i]);
+
+                if (tensor == NULL) {
+                    throw std::runtime_error("DeepNet::"
+                        "initializeParameterArena(): the gradients of "
+                        "cell " + (*itCell) + " are not of type Float_T");
+                }
+
+                arena->addGradients(*tensor);
+            }
+        }
+    }
+
+    arena->initialize();
+    mParameterArena = arena;
+}
+
+void N2D2::DeepNet::acquireMemorySlot(const ExecNode& node)
+{
+    MemorySlot& slot = mMemorySlots[node.memorySlot];
+
+    if (slot.holder != &node) {
+        BaseTensor& outputs = node.cell->getOutputs();
+        BaseTensor& holderOutputs = slot.holder->cell->getOutputs();
+
+        swapStorage<float>(outputs, holderOutputs)
+            || swapStorage<double>(outputs, holderOutputs)
+            || swapStorage<half_float::half>(outputs, holderOutputs);
+
+        slot.holder = &node;
+    }
 }
 
 void N2D2::DeepNet::spikeCodingCompare(const std::string& dirName,
@@ -2605,7 +3186,6 @@ void N2D2::DeepNet::propagate(
     bool inference,
     std::vector<std::pair<std::string, double> >* timings)
 {
-    const unsigned int nbLayers = mLayers.size();
     std::chrono::high_resolution_clock::time_point time1, time2;
 
     // Provide targets
@@ -2631,35 +3211,38 @@ void N2D2::DeepNet::propagate(
         }
     }
 
-    // Signal propagation
-    for (unsigned int l = 1; l < nbLayers; ++l) {
-        for (std::vector<std::string>::const_iterator itCell
-             = mLayers[l].begin(),
-             itCellEnd = mLayers[l].end();
-             itCell != itCellEnd;
-             ++itCell) {
-            std::shared_ptr<Cell_Frame_Top> cellFrame
-                = std::dynamic_pointer_cast<Cell_Frame_Top>(mCells[(*itCell)]);
+    // Signal propagation (per cell timings require a sequential execution)
+    if (!inference && !mMemorySlots.empty())
+        throw std::runtime_error("DeepNet::propagate(): only inference is "
+                                 "possible with a memory plan");
 
-            if (!cellFrame)
-                throw std::runtime_error(
-                    "DeepNet::learn(): learning requires Cell_Frame_Top cells");
+    runExecPlan(false, (timings == NULL), [&](const ExecNode& node) {
+        if (!node.cell)
+            throw std::runtime_error(
+                "DeepNet::learn(): learning requires Cell_Frame_Top cells");
 
-            time1 = std::chrono::high_resolution_clock::now();
-            cellFrame->propagate(inference);
+        if (node.memorySlot >= 0)
+            acquireMemorySlot(node);
+
+        std::chrono::high_resolution_clock::time_point timeCell1, timeCell2;
 
-            if (timings != NULL) {
+        if (timings != NULL)
+            timeCell1 = std::chrono::high_resolution_clock::now();
+
+        node.cell->propagate(inference);
+
+        if (timings != NULL) {
 #ifdef CUDA
-                CHECK_CUDA_STATUS(cudaDeviceSynchronize());
+            CHECK_CUDA_STATUS(cudaDeviceSynchronize());
 #endif
-                time2 = std::chrono::high_resolution_clock::now();
-                (*timings).push_back(std::make_pair(
-                    (*itCell) + "[prop]",
-                    std::chrono::duration_cast
-                    <std::chrono::duration<double> >(time2 - time1).count()));
-            }
+            timeCell2 = std::chrono::high_resolution_clock::now();
+            (*timings).push_back(std::make_pair(
+                node.name + "[prop]",
+                std::chrono::duration_cast
+                <std::chrono::duration<double> >(timeCell2 - timeCell1)
+                                                                .count()));
         }
-    }
+    });
 
     // Targets processing
     for (std::vector<std::shared_ptr<Target> >::const_iterator itTargets
@@ -2688,59 +3271,54 @@ void N2D2::DeepNet::propagate(
 
 void N2D2::DeepNet::propagate(bool inference)
 {
-    const unsigned int nbLayers = mLayers.size();
-
     // Signal propagation
-    for (unsigned int l = 1; l < nbLayers; ++l) {
-        for (std::vector<std::string>::const_iterator itCell
-             = mLayers[l].begin(),
-             itCellEnd = mLayers[l].end();
-             itCell != itCellEnd;
-             ++itCell) {
-            std::shared_ptr<Cell_Frame_Top> cellFrame
-                = std::dynamic_pointer_cast<Cell_Frame_Top>(mCells[(*itCell)]);
+    if (!inference && !mMemorySlots.empty())
+        throw std::runtime_error("DeepNet::propagate(): only inference is "
+                                 "possible with a memory plan");
 
-            if (!cellFrame)
-                throw std::runtime_error(
-                    "DeepNet::learn(): learning requires Cell_Frame_Top cells");
+    runExecPlan(false, true, [this, inference](const ExecNode& node) {
+        if (!node.cell)
+            throw std::runtime_error(
+                "DeepNet::learn(): learning requires Cell_Frame_Top cells");
 
-            cellFrame->propagate(inference);
-    
-        }
-    }
+        if (node.memorySlot >= 0)
+            acquireMemorySlot(node);
+
+        node.cell->propagate(inference);
+    });
 }
 
 void N2D2::DeepNet::backPropagate(
     std::vector<std::pair<std::string, double> >* timings)
 {
-    const unsigned int nbLayers = mLayers.size();
-    std::chrono::high_resolution_clock::time_point time1, time2;
+    if (!mMemorySlots.empty())
+        throw std::runtime_error("DeepNet::backPropagate(): not possible "
+                                 "with a memory plan");
 
     // Error back-propagation
-    for (unsigned int l = nbLayers - 1; l > 0; --l) {
-        for (std::vector<std::string>::const_iterator itCell
-             = mLayers[l].begin(),
-             itCellEnd = mLayers[l].end();
-             itCell != itCellEnd;
-             ++itCell)
-        {
+    runExecPlan(true, (timings == NULL), [timings](const ExecNode& node) {
+        if (!node.cell)
+            throw std::runtime_error(
+                "DeepNet::learn(): learning requires Cell_Frame_Top cells");
 
+        std::chrono::high_resolution_clock::time_point time1, time2;
+
+        if (timings != NULL)
             time1 = std::chrono::high_resolution_clock::now();
-            std::dynamic_pointer_cast
-                <Cell_Frame_Top>(mCells[(*itCell)])->backPropagate();
 
-            if (timings != NULL) {
+        node.cell->backPropagate();
+
+        if (timings != NULL) {
 #ifdef CUDA
-                CHECK_CUDA_STATUS(cudaDeviceSynchronize());
+            CHECK_CUDA_STATUS(cudaDeviceSynchronize());
 #endif
-                time2 = std::chrono::high_resolution_clock::now();
-                (*timings).push_back(std::make_pair(
-                    (*itCell) + "[back-prop]",
-                    std::chrono::duration_cast
-                    <std::chrono::duration<double> >(time2 - time1).count()));
-            }
+            time2 = std::chrono::high_resolution_clock::now();
+            (*timings).push_back(std::make_pair(
+                node.name + "[back-prop]",
+                std::chrono::duration_cast
+                <std::chrono::duration<double> >(time2 - time1).count()));
         }
-    }
+    });
 }
 
 void N2D2::DeepNet::update(
@@ -2754,42 +3332,109 @@ void N2D2::DeepNet::update(
     CHECK_CUDA_STATUS(cudaGetDevice(&dev));
 #endif
 
-    // Weights update
-    for (unsigned int l = 1; l < nbLayers; ++l) {
-        for (std::vector<std::string>::const_iterator itCell
-             = mLayers[l].begin(),
-             itCellEnd = mLayers[l].end();
-             itCell != itCellEnd;
-             ++itCell)
-        {
-      
-            time1 = std::chrono::high_resolution_clock::now();
+    // Data-parallel learning: the gradients of the parameter arena are
+    // averaged in a single reduction, instead of one per tensor in the solvers
+    if (mParameterArena && Solver::mGradientReduction
+        && mParameterArena->getGradientsSize() > 0)
+    {
+        time1 = std::chrono::high_resolution_clock::now();
+
+        Float_T* gradients = mParameterArena->getGradients();
+        Solver::mGradientReduction->average(gradients,
+            mParameterArena->getGradientsSize());
+        Solver::mReducedGradients = std::make_pair(gradients,
+            gradients + mParameterArena->getGradientsSize());
+
+        if (timings != NULL) {
+            time2 = std::chrono::high_resolution_clock::now();
+            (*timings).push_back(std::make_pair(
+                "ParameterArena[update]",
+                std::chrono::duration_cast
+                <std::chrono::duration<double> >(time2 - time1).count()));
+        }
+    }
+
+    // The Frame solvers only record their update, which is executed for all
+    // the cells at once, in a single parallel sweep, after the loop
+    FusedUpdate fusedUpdate;
+    Solver::mFusedUpdate = &fusedUpdate;
+
+    // Time of the update of each cell, excluding the fused update, whose
+    // time is added per cell once it is executed
+    std::vector<std::pair<std::string, double> > cellTimings;
+
+    if (timings != NULL) {
+        std::size_t nbCells = 0;
+
+        for (unsigned int l = 1; l < nbLayers; ++l)
+            nbCells += mLayers[l].size();
+
+        fusedUpdate.enableTimings(nbCells);
+    }
+
+    try {
+        // Weights update
+        for (unsigned int l = 1; l < nbLayers; ++l) {
+            for (std::vector<std::string>::const_iterator itCell
+                 = mLayers[l].begin(),
+                 itCellEnd = mLayers[l].end();
+                 itCell != itCellEnd;
+                 ++itCell)
+            {
+                fusedUpdate.setGroup(cellTimings.size());
+                const double runTime = fusedUpdate.getRunTime();
+
+                time1 = std::chrono::high_resolution_clock::now();
 #ifdef CUDA
-            //update states
-            std::dynamic_pointer_cast
-                <Cell_Frame_Top>(mCells[(*itCell)])->updateDeviceStates(mStates);
+                //update states
+                std::dynamic_pointer_cast
+                    <Cell_Frame_Top>(mCells[(*itCell)])->updateDeviceStates(mStates);
 #endif
-            std::dynamic_pointer_cast
-                <Cell_Frame_Top>(mCells[(*itCell)])->update();
+                std::dynamic_pointer_cast
+                    <Cell_Frame_Top>(mCells[(*itCell)])->update();
 
 #ifdef CUDA
-            // MultiGPU issue
-            // After BatchNorm layer update, the master changes
-            // Thus, this line is to fix this issue
-            CHECK_CUDA_STATUS(cudaSetDevice(dev));
+                // MultiGPU issue
+                // After BatchNorm layer update, the master changes
+                // Thus, this line is to fix this issue
+                CHECK_CUDA_STATUS(cudaSetDevice(dev));
 #endif
 
-            if (timings != NULL) {
+                if (timings != NULL) {
 #ifdef CUDA
-                CHECK_CUDA_STATUS(cudaDeviceSynchronize());
+                    CHECK_CUDA_STATUS(cudaDeviceSynchronize());
 #endif
-                time2 = std::chrono::high_resolution_clock::now();
-                (*timings).push_back(std::make_pair(
-                    (*itCell) + "[update]",
-                    std::chrono::duration_cast
-                    <std::chrono::duration<double> >(time2 - time1).count()));
+                    time2 = std::chrono::high_resolution_clock::now();
+
+                    // The pending updates executed during the cell update
+                    // (FusedUpdateBarrier) are counted in the fused update
+                    cellTimings.push_back(std::make_pair(
+                        (*itCell) + "[update]",
+                        std::chrono::duration_cast
+                        <std::chrono::duration<double> >(time2 - time1).count()
+                            - (fusedUpdate.getRunTime() - runTime)));
+                }
             }
         }
+
+        fusedUpdate.run();
+    }
+    catch (...) {
+        Solver::mFusedUpdate = NULL;
+        Solver::mReducedGradients = std::pair<const void*, const void*>();
+        throw;
+    }
+
+    Solver::mFusedUpdate = NULL;
+    Solver::mReducedGradients = std::pair<const void*, const void*>();
+
+    if (timings != NULL) {
+        const std::vector<double>& fusedTimes = fusedUpdate.getGroupTimes();
+
+        for (std::size_t i = 0; i < cellTimings.size(); ++i) {
+            cellTimings[i].second += fusedTimes[i];
+            (*timings).push_back(cellTimings[i]);
+        }
     }
 }
 
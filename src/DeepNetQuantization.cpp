@@ -204,65 +204,203 @@ void N2D2::DeepNetQuantization::reportOutputsHistogram(
     const std::vector<std::vector<std::string>>& layers = mDeepNet.getLayers();
     std::map<std::string, std::shared_ptr<Cell>>& cells = mDeepNet.getCells();
 
-    if (outputsHistogram.empty()) {
-        // Populate outputsHistogram first to avoid thread issues
-        for (auto itLayer = layers.begin(); itLayer != layers.end(); ++itLayer) {
-            for(auto itCell = itLayer->begin(); itCell != itLayer->end(); ++itCell) {
-                const auto range = outputsRange.at(*itCell);
-                const bool isCellOutputUnsigned = (itLayer == layers.begin())?
-                                            DeepNetExport::mEnvDataUnsigned:
-                                            DeepNetExport::isCellOutputUnsigned(*cells.at(*itCell));
-                
-                double val = Utils::max_abs(range.minVal(), range.maxVal());
-                // Take 0.1 as minimum value as we don't want a range of [0;0]
-                val = std::max(val, 0.1);
+    if (outputsHistogram.empty())
+        initOutputsHistogram(outputsHistogram, outputsRange, nbBins);
 
-                const double min = isCellOutputUnsigned?0:-val;
-                const double max = val;
-                outputsHistogram.insert(std::make_pair(*itCell, Histogram(min, max, nbBins)));
+    // The layers are processed sequentially, as Histogram::add() already
+    // bins the outputs of a layer in parallel
+    for (auto itLayer = layers.begin(); itLayer != layers.end(); ++itLayer) {
+        for(auto itCell = itLayer->begin(); itCell != itLayer->end(); ++itCell) {
+            std::shared_ptr<Cell_Frame_Top> cellFrame;
+
+            if (cells.find(*itCell) != cells.end()) {
+                cellFrame = std::dynamic_pointer_cast<Cell_Frame_Top>(cells.at(*itCell));
+                cellFrame->getOutputs().synchronizeDToH();
             }
+
+            // No tensor_cast<Float_T>(), which would copy non Float_T outputs
+            const BaseTensor& outputs = (cellFrame)
+                ? cellFrame->getOutputs()
+                : mDeepNet.getStimuliProvider()->getData();
+
+            Histogram& hist = outputsHistogram.at(*itCell);
+            assert(outputs.size() == outputs.dimB()*outputs.dimZ()*outputs.dimY()*outputs.dimX());
+
+            const auto range = outputsRange.at(*itCell);
+            const bool enlargeSymetric = hist.getMinVal() < 0.0;
+            hist.enlarge(Utils::max_abs(range.minVal(), range.maxVal()), enlargeSymetric);
+
+            if (outputs.getType() == &typeid(float)) {
+                addOutputsHistogram(hist,
+                    dynamic_cast<const Tensor<float>&>(outputs));
+            }
+            else if (outputs.getType() == &typeid(half_float::half)) {
+                addOutputsHistogram(hist,
+                    dynamic_cast<const Tensor<half_float::half>&>(outputs));
+            }
+            else if (outputs.getType() == &typeid(double)) {
+                addOutputsHistogram(hist,
+                    dynamic_cast<const Tensor<double>&>(outputs));
+            }
+            else {
+                throw std::runtime_error("DeepNetQuantization::"
+                    "reportOutputsHistogram(): type not supported");
+            }
+        }
+    }
+}
+
+void N2D2::DeepNetQuantization::snapshotOutputs(OutputsSnapshot& outputs) const
+{
+    const std::vector<std::vector<std::string>>& layers = mDeepNet.getLayers();
+    std::map<std::string, std::shared_ptr<Cell>>& cells = mDeepNet.getCells();
+    const std::vector<int>& batch = mDeepNet.getStimuliProvider()->getBatch();
+    std::vector<std::vector<Float_T>*> snapshots;
+    std::vector<std::string> cellNames;
+
+    // Populate outputs first to avoid thread issues
+    for (auto itLayer = layers.begin(); itLayer != layers.end(); ++itLayer) {
+        for(auto itCell = itLayer->begin(); itCell != itLayer->end(); ++itCell) {
+            snapshots.push_back(&outputs[*itCell]);
+            cellNames.push_back(*itCell);
         }
     }
 
     #pragma omp parallel for schedule(dynamic)
-    for (int i = 0; i < (int)layers.size(); ++i) {
+    for (int i = 0; i < (int)cellNames.size(); ++i) {
 #ifdef CUDA
         CudaContext::setDevice();
 #endif
 
-        for(auto itCell = layers[i].begin(); itCell != layers[i].end(); ++itCell) {
-            std::shared_ptr<Cell_Frame_Top> cellFrame;
+        std::shared_ptr<Cell_Frame_Top> cellFrame;
 
-            if (cells.find(*itCell) != cells.end()) {
-                cellFrame = std::dynamic_pointer_cast<Cell_Frame_Top>(cells.at(*itCell));
-                cellFrame->getOutputs().synchronizeDToH();
+        if (cells.find(cellNames[i]) != cells.end()) {
+            cellFrame = std::dynamic_pointer_cast<Cell_Frame_Top>(cells.at(cellNames[i]));
+            cellFrame->getOutputs().synchronizeDToH();
+        }
+
+        const Tensor<Float_T>& cellOutputs = (cellFrame)
+            ? tensor_cast<Float_T>(cellFrame->getOutputs())
+            : mDeepNet.getStimuliProvider()->getData();
+
+        assert(cellOutputs.size() == cellOutputs.dimB()*cellOutputs.dimZ()*cellOutputs.dimY()*cellOutputs.dimX());
+
+        // Keep the allocated memory from one batch to the next
+        std::vector<Float_T>& snapshot = *snapshots[i];
+        snapshot.clear();
+
+        if (cellOutputs.empty())
+            continue;
+
+        const std::size_t batchSize = cellOutputs.size() / cellOutputs.dimB();
+
+        for(std::size_t b = 0; b < cellOutputs.dimB(); b++) {
+            if(batch.at(b) == -1) {
+                continue;
             }
 
-            const Tensor<Float_T>& outputs = (cellFrame)
-                ? tensor_cast<Float_T>(cellFrame->getOutputs())
-                : mDeepNet.getStimuliProvider()->getData();
+            snapshot.insert(snapshot.end(),
+                            cellOutputs.begin() + b * batchSize,
+                            cellOutputs.begin() + (b + 1) * batchSize);
+        }
+    }
+}
+
+void N2D2::DeepNetQuantization::reportOutputsStats(
+                        const OutputsSnapshot& outputs,
+                        std::unordered_map<std::string, RangeStats>& outputsRange,
+                        std::unordered_map<std::string, Histogram>& outputsHistogram,
+                        std::size_t nbBits, ClippingMode actClippingMode) const
+{
+    const std::vector<std::vector<std::string>>& layers = mDeepNet.getLayers();
 
+    for (auto itLayer = layers.begin(); itLayer != layers.end(); ++itLayer) {
+        for(auto itCell = itLayer->begin(); itCell != itLayer->end(); ++itCell) {
+            const std::vector<Float_T>& values = outputs.at(*itCell);
 
+            if (!values.empty())
+                outputsRange[*itCell].add(&values[0], values.size());
+        }
+    }
+
+    if(actClippingMode == ClippingMode::NONE) {
+        return;
+    }
+
+    if (outputsHistogram.empty()) {
+        initOutputsHistogram(outputsHistogram, outputsRange,
+                             getNbBinsForClippingMode(nbBits, actClippingMode));
+    }
+
+    for (auto itLayer = layers.begin(); itLayer != layers.end(); ++itLayer) {
+        for(auto itCell = itLayer->begin(); itCell != itLayer->end(); ++itCell) {
+            const std::vector<Float_T>& values = outputs.at(*itCell);
             Histogram& hist = outputsHistogram.at(*itCell);
-            assert(outputs.size() == outputs.dimB()*outputs.dimZ()*outputs.dimY()*outputs.dimX());
 
             const auto range = outputsRange.at(*itCell);
             const bool enlargeSymetric = hist.getMinVal() < 0.0;
             hist.enlarge(Utils::max_abs(range.minVal(), range.maxVal()), enlargeSymetric);
 
-            for(std::size_t batch = 0; batch < outputs.dimB(); batch++) {
-                if(mDeepNet.getStimuliProvider()->getBatch().at(batch) == -1) {
-                    continue;
-                }
+            if (!values.empty())
+                hist.add(&values[0], values.size());
+        }
+    }
+}
 
-                for(Float_T val: outputs[batch]) {
-                    hist(val);
-                }
-            }
+void N2D2::DeepNetQuantization::initOutputsHistogram(
+                        std::unordered_map<std::string, Histogram>& outputsHistogram,
+                        const std::unordered_map<std::string, RangeStats>& outputsRange,
+                        std::size_t nbBins) const
+{
+    const std::vector<std::vector<std::string>>& layers = mDeepNet.getLayers();
+    std::map<std::string, std::shared_ptr<Cell>>& cells = mDeepNet.getCells();
+
+    for (auto itLayer = layers.begin(); itLayer != layers.end(); ++itLayer) {
+        for(auto itCell = itLayer->begin(); itCell != itLayer->end(); ++itCell) {
+            const auto range = outputsRange.at(*itCell);
+            const bool isCellOutputUnsigned = (itLayer == layers.begin())?
+                                        DeepNetExport::mEnvDataUnsigned:
+                                        DeepNetExport::isCellOutputUnsigned(*cells.at(*itCell));
+            
+            double val = Utils::max_abs(range.minVal(), range.maxVal());
+            // Take 0.1 as minimum value as we don't want a range of [0;0]
+            val = std::max(val, 0.1);
+
+            const double min = isCellOutputUnsigned?0:-val;
+            const double max = val;
+            outputsHistogram.insert(std::make_pair(*itCell, Histogram(min, max, nbBins)));
         }
     }
 }
 
+template <class T>
+void N2D2::DeepNetQuantization::addOutputsHistogram(Histogram& hist,
+                                                    const Tensor<T>& outputs) const
+{
+    if (outputs.empty())
+        return;
+
+    const std::vector<int>& batch = mDeepNet.getStimuliProvider()->getBatch();
+    const std::size_t batchSize = outputs.size() / outputs.dimB();
+    const T* data = &(*outputs.begin());
+
+    // Add the consecutive valid stimuli of the batch at once
+    for (std::size_t first = 0; first < outputs.dimB(); ) {
+        if (batch.at(first) == -1) {
+            ++first;
+            continue;
+        }
+
+        std::size_t last = first + 1;
+
+        while (last < outputs.dimB() && batch.at(last) != -1)
+            ++last;
+
+        hist.add(data + first * batchSize, (last - first) * batchSize);
+        first = last;
+    }
+}
+
 void N2D2::DeepNetQuantization::rescaleAdditiveParameters(double rescaleFactor) {
     const std::vector<std::vector<std::string>>& layers = mDeepNet.getLayers();
 
@@ -19,6 +19,7 @@
 */
 
 #include <cassert>
+#include <cctype>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -845,6 +846,11 @@ void N2D2::CPP_DeepNetExport::generateNetworkPropagateFile(
     std::stringstream includes;
     std::stringstream buffers;
     std::stringstream functionCalls;
+    // Batched version of functionCalls: each layer is computed for the whole
+    // batch before the next one, with one memory space per batch position
+    std::stringstream batchFunctionCalls;
+    // Output buffer declaration of each cell, for the batched version
+    std::vector<std::pair<std::string, std::string> > outputBuffers;
 
     // Fill in includes, buffers and functionCalls for each layer
     buffers << "static uint8_t mem[MEMORY_SIZE]"
@@ -893,16 +899,25 @@ void N2D2::CPP_DeepNetExport::generateNetworkPropagateFile(
                     ? "udata" : "data";
             }
 
-            // functionCalls
-            functionCalls << "    // " << cell->getName() << "\n";
-            functionCalls << "    " << dataType << "<" << nbBits << ">* "
+            std::stringstream outputBuffer;
+            outputBuffer << dataType << "<" << nbBits << ">* "
                 << identifier << "_output = (" << dataType << "<" << nbBits
-                << ">*)(mem + " << prefix << "_MEM_CONT_OFFSET);\n\n";
+                << ">*)(mem + " << prefix << "_MEM_CONT_OFFSET);\n";
+            outputBuffers.push_back(std::make_pair(identifier + "_output",
+                                                   outputBuffer.str()));
 
+            std::stringstream callCode;
             CPP_CellExport::getInstance(*cell)->generateCallCode(deepNet, *cell, 
-                includes, buffers, functionCalls);
+                includes, buffers, callCode);
 
+            // functionCalls
+            functionCalls << "    // " << cell->getName() << "\n";
+            functionCalls << "    " << outputBuffer.str() << "\n";
+            functionCalls << callCode.str();
             functionCalls << "\n\n\n\n";
+
+            generateBatchLoop(cell->getName(), outputBuffers, callCode.str(),
+                              batchFunctionCalls);
         }
     }
 
@@ -911,13 +926,15 @@ void N2D2::CPP_DeepNetExport::generateNetworkPropagateFile(
                                                     =  deepNet.getTargets();
     const unsigned int nbTarget = outputTargets.size();
 
+    std::stringstream targetCalls;
+
     for (unsigned int targetIdx = 0; targetIdx < nbTarget; ++targetIdx) {
         const std::shared_ptr<Cell> targetCell = deepNet.getTargetCell(targetIdx);
         const std::string targetCellIdentifier = N2D2::Utils::CIdentifier(targetCell->getName());
         const std::string targetCellPrefix = N2D2::Utils::upperCase(targetCellIdentifier);
 
         if (!outputTargets[targetIdx]->getParameter<bool>("DataAsTarget")) {
-            functionCalls << "    maxPropagate<"
+            targetCalls << "    maxPropagate<"
                         << targetCellPrefix << "_NB_OUTPUTS, "
                         << targetCellPrefix << "_OUTPUTS_HEIGHT, "
                         << targetCellPrefix << "_OUTPUTS_WIDTH, "
@@ -931,7 +948,7 @@ void N2D2::CPP_DeepNetExport::generateNetworkPropagateFile(
                         << "outputs"
                     << ");\n\n";
 
-            functionCalls << "#ifdef SAVE_OUTPUTS\n"
+            targetCalls << "#ifdef SAVE_OUTPUTS\n"
                         << "    FILE* max_stream = fopen(\"max_output.txt\", \"w\");\n"
                         << "    saveOutputs("
                         << targetCellPrefix << "_NB_OUTPUTS, "
@@ -950,7 +967,7 @@ void N2D2::CPP_DeepNetExport::generateNetworkPropagateFile(
                         << "#endif\n";
         }
         else {
-            functionCalls << "    memcpy(outputs, "
+            targetCalls << "    memcpy(outputs, "
                         << targetCellIdentifier << "_output, "
                         << targetCellPrefix << "_MEM_CONT_SIZE);\n"
                         "    if (" << targetCellPrefix << "_MEM_WRAP_SIZE > 0)\n"
@@ -961,6 +978,10 @@ void N2D2::CPP_DeepNetExport::generateNetworkPropagateFile(
         }
     }
 
+    functionCalls << targetCalls.str();
+    generateBatchLoop("outputs", outputBuffers, targetCalls.str(),
+                      batchFunctionCalls);
+
     // Write source file with includes, buffers and functionCalls
     std::ofstream networkPropagateFile(filePath);
 
@@ -991,6 +1012,15 @@ void N2D2::CPP_DeepNetExport::generateNetworkPropagateFile(
         << functionCalls.str()
         << "\n"
         << "}\n"
+        << "\n"
+        << "template<>\n"
+        << "void Network::propagate(const " << inputType << "<" << inputNbBits
+            << ">* batchInputs, " << "Target_T* batchOutputs,\n"
+        << "                        std::size_t batchSize, uint8_t* workspace)"
+            " const\n"
+        << "{\n"
+        << batchFunctionCalls.str()
+        << "}\n"
         << "\n";
 
 
@@ -1013,6 +1043,90 @@ void N2D2::CPP_DeepNetExport::generateNetworkPropagateFile(
     }
 }
 
+void N2D2::CPP_DeepNetExport::generateBatchLoop(
+    const std::string& name,
+    const std::vector<std::pair<std::string, std::string> >& outputBuffers,
+    const std::string& callCode,
+    std::stringstream& batchFunctionCalls)
+{
+    std::stringstream declarations;
+
+    if (isIdentifierInCode("inputs", callCode)) {
+        declarations << "        const " << ((int)CellExport::mPrecision > 0
+                && DeepNetExport::mEnvDataUnsigned ? "udata" : "data")
+            << "<" << (int)CellExport::mPrecision << ">* inputs"
+            " = batchInputs + batchPos * ENV_OUTPUTS_SIZE;\n";
+    }
+
+    if (isIdentifierInCode("outputs", callCode)) {
+        declarations << "        Target_T* outputs"
+            " = batchOutputs + batchPos * OUTPUTS_SIZE[0];\n";
+    }
+
+    bool useMemory = isIdentifierInCode("mem", callCode);
+
+    for (std::vector<std::pair<std::string, std::string> >::const_iterator
+        it = outputBuffers.begin(), itEnd = outputBuffers.end();
+        it != itEnd; ++it)
+    {
+        if (isIdentifierInCode((*it).first, callCode)) {
+            declarations << "        " << (*it).second;
+            useMemory = true;
+        }
+    }
+
+    // Nothing to compute (for example Reshape)
+    if (declarations.str().empty())
+        return;
+
+    batchFunctionCalls << "    // " << name << "\n"
+        "#if !defined(BENCHMARK) && !defined(SAVE_OUTPUTS)\n"
+        "#pragma omp parallel for if (batchSize > 1)\n"
+        "#endif\n"
+        "    for (int batchPos = 0; batchPos < (int)batchSize; ++batchPos) {\n";
+
+    if (useMemory) {
+        batchFunctionCalls << "        uint8_t* mem = workspace"
+            " + batchPos * memorySize();\n";
+    }
+
+    batchFunctionCalls << declarations.str() << "\n";
+
+    // Indent the call code inside the batch loop
+    std::istringstream callCodeLines(callCode);
+    std::string line;
+
+    while (std::getline(callCodeLines, line)) {
+        if (!line.empty() && line[0] != '#')
+            batchFunctionCalls << "    ";
+
+        batchFunctionCalls << line << "\n";
+    }
+
+    batchFunctionCalls << "    }\n\n";
+}
+
+bool N2D2::CPP_DeepNetExport::isIdentifierInCode(const std::string& identifier,
+                                                 const std::string& code)
+{
+    std::size_t pos = code.find(identifier);
+
+    while (pos != std::string::npos) {
+        const std::size_t endPos = pos + identifier.size();
+        const bool startOk = (pos == 0 || !(std::isalnum(code[pos - 1])
+                                            || code[pos - 1] == '_'));
+        const bool endOk = (endPos == code.size() || !(std::isalnum(code[endPos])
+                                                || code[endPos] == '_'));
+
+        if (startOk && endOk)
+            return true;
+
+        pos = code.find(identifier, pos + 1);
+    }
+
+    return false;
+}
+
 void N2D2::CPP_DeepNetExport::printStats(const DeepNet& deepNet, 
                                          const MemoryManager& memManager) 
 {
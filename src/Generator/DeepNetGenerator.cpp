@@ -166,6 +166,9 @@ N2D2::DeepNetGenerator::generateFromINI(Network& network,
 
     std::shared_ptr<DeepNet> deepNet(new DeepNet(network));
     deepNet->setParameter("Name", Utils::baseName(fileName));
+    deepNet->setParameter("ParallelBranches",
+                          iniConfig.getProperty<bool>("ParallelBranches",
+                                                      false));
 
     if (iniConfig.isSection("database"))
         deepNet->setDatabase(
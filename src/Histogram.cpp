@@ -23,6 +23,48 @@
 #include "utils/Utils.hpp"
 #include "utils/Gnuplot.hpp"
 
+namespace {
+/**
+ * Return the first index in ]first, last[ for which @p isPast is true, or
+ * last if there is none. isPast must be monotonic (false then true) and
+ * false for first. Galloping search: O(log(result - first)) evaluations.
+ */
+template <class Predicate>
+std::size_t findRangeEnd(std::size_t first, std::size_t last,
+                         Predicate isPast)
+{
+    std::size_t lower = first;
+    std::size_t upper = last;
+    std::size_t step = 1;
+
+    while (step < last - lower) {
+        const std::size_t index = lower + step;
+
+        if (isPast(index)) {
+            upper = index;
+            break;
+        }
+
+        lower = index;
+        step *= 2;
+    }
+
+    ++lower;
+
+    while (lower < upper) {
+        const std::size_t index = lower + (upper - lower) / 2;
+
+        if (isPast(index))
+            upper = index;
+        else
+            lower = index + 1;
+    }
+
+    return lower;
+}
+}
+
+const std::size_t N2D2::Histogram::ParallelMinSize;
 
 N2D2::Histogram::Histogram(double minVal, double maxVal, std::size_t nbBins)
     : mMinVal(minVal), mMaxVal(maxVal),
@@ -58,14 +100,7 @@ std::size_t N2D2::Histogram::getNbBins() const {
 
 std::size_t N2D2::Histogram::getBinIdx(double value) const {
     assert(getBinWidth() > 0);
-    
-    const double clampedValue = Utils::clamp(value, mMinVal, mMaxVal);
-    std::size_t binIdx = static_cast<std::size_t>((clampedValue - mMinVal) / getBinWidth() + 1e-6);
-    if(binIdx == mNbBins) {
-        binIdx--;
-    }
-
-    return binIdx;
+    return getBinIdx(value, mMinVal, mMaxVal, mNbBins);
 }
 
 double N2D2::Histogram::getMinVal() const {
@@ -180,13 +215,18 @@ double N2D2::Histogram::calibrateMSE(std::size_t nbBits) const {
         return 0.0;
     }
 
+    std::vector<unsigned long long> count;
+    std::vector<unsigned long long> first;
+    std::vector<unsigned long long> second;
+    getPrefixSums(count, first, second);
+
     double threshold = Utils::max_abs(mMinVal, mMaxVal);
     double bestThreshold = threshold;
     double bestMSE = std::numeric_limits<double>::max();
 
     const double threshold_decr_step = threshold/1000.0;
     while(threshold > 0.0) {
-        const double mse = MSE(threshold, nbBits);
+        const double mse = MSE(threshold, nbBits, count, first, second);
         if(mse < bestMSE) {
             bestMSE = mse;
             bestThreshold = threshold;
@@ -198,7 +238,11 @@ double N2D2::Histogram::calibrateMSE(std::size_t nbBits) const {
     return bestThreshold;
 }
 
-double N2D2::Histogram::MSE(double threshold, std::size_t nbBits) const {
+double N2D2::Histogram::MSE(double threshold, std::size_t nbBits,
+                            const std::vector<unsigned long long>& count,
+                            const std::vector<unsigned long long>& first,
+                            const std::vector<unsigned long long>& second) const
+{
     assert(nbBits > 1);
 
     const bool isUnsigned = mMinVal >= 0.0;
@@ -206,17 +250,49 @@ double N2D2::Histogram::MSE(double threshold, std::size_t nbBits) const {
     const double minVal = isUnsigned?0:-(1LL << (nbBits - 1));
     const double maxVal = isUnsigned?((1ULL << nbBits) - 1):((1ULL << (nbBits - 1)) - 1);
     const double scaling = maxVal/threshold;
+    const double binWidth = getBinWidth();
 
+    // The quantized value is non-decreasing with the bin index: the error is
+    // summed by ranges of bins with the same quantized value, in which the
+    // error of bin lo + k is err(lo) + k * binWidth.
+    const auto getLevel = [&](std::size_t bin) {
+        return Utils::clamp(std::round(getBinValue(bin)*scaling), minVal, maxVal);
+    };
 
     double mse = 0.0;
-    for(std::size_t bin = 0; bin < mNbBins; bin++) {
-        const double approx = Utils::clamp(std::round(getBinValue(bin)*scaling), minVal, maxVal)/scaling;
-        const double normalizedValue = 1.0*mValues[bin]/mNbValues;
+    for(std::size_t lo = 0; lo < mNbBins; ) {
+        const double level = getLevel(lo);
+        const std::size_t hi = findRangeEnd(lo, mNbBins,
+            [&](std::size_t bin) { return getLevel(bin) != level; });
+
+        // Sums of count, k * count and k^2 * count on the range, computed
+        // modulo 2^64 from the prefix sums (exact if the result fits)
+        const unsigned long long s0 = count[hi] - count[lo];
+        const unsigned long long d1 = first[hi] - first[lo];
+        const unsigned long long s1 = d1 - lo * s0;
+        const unsigned long long s2 = (second[hi] - second[lo])
+            - 2 * lo * d1 + lo * lo * s0;
+        const unsigned long long kMax = hi - lo - 1;
+        const double err = getBinValue(lo) - level/scaling;
+
+        if (s0 == 0)
+            ;
+        else if (kMax == 0
+            || s0 <= std::numeric_limits<unsigned long long>::max()
+                        / (kMax * kMax))
+        {
+            mse += err * err * s0 + 2.0 * err * binWidth * s1
+                + binWidth * binWidth * s2;
+        }
+        else {
+            for(std::size_t bin = lo; bin < hi; bin++)
+                mse += std::pow(getBinValue(bin) - level/scaling, 2) * mValues[bin];
+        }
 
-        mse += std::pow(getBinValue(bin) - approx, 2) * normalizedValue;
+        lo = hi;
     }
 
-    return mse;
+    return mse/mNbValues;
 }
 
 
@@ -225,8 +301,19 @@ double N2D2::Histogram::calibrateKLDivergence(std::size_t nbBits) const {
         return 0.0;
     }
 
-    const bool isUnsigned = mMinVal >= 0.0;
-    const std::size_t nbQuantizedBins = static_cast<std::size_t>(1) << nbBits;
+    std::vector<unsigned long long> count;
+    std::vector<unsigned long long> first;
+    std::vector<unsigned long long> second;
+    getPrefixSums(count, first, second);
+
+    double entropy = 0.0;
+
+    for (std::size_t bin = 0; bin < mNbBins; ++bin) {
+        const double p = (mValues[bin] / (double)mNbValues);
+
+        if (p != 0)
+            entropy += p * std::log(p);
+    }
 
     double threshold = Utils::max_abs(mMinVal, mMaxVal);
     double bestThreshold = threshold;
@@ -234,8 +321,8 @@ double N2D2::Histogram::calibrateKLDivergence(std::size_t nbBits) const {
 
     const double threshold_decr_step = threshold/1000.0;
     while(threshold > 0.0) {
-        const double divergence = KLDivergence(*this, quantize(isUnsigned?0:-threshold, 
-                                                               threshold, nbQuantizedBins));
+        const double divergence = KLDivergence(threshold, nbBits, count,
+                                               entropy);
         if(divergence < bestDivergence) {
             bestDivergence = divergence;
             bestThreshold = threshold;
@@ -261,49 +348,62 @@ double N2D2::Histogram::getQuantileValue(double quantile) const {
     return getBinValue(mNbBins - 1);
 }
 
-N2D2::Histogram N2D2::Histogram::quantize(double newMinVal, double newMaxVal,
-                                          std::size_t newNbBins) const
+void N2D2::Histogram::getPrefixSums(std::vector<unsigned long long>& count,
+                                    std::vector<unsigned long long>& first,
+                                    std::vector<unsigned long long>& second)
+    const
 {
-    Histogram hist(newMinVal, newMaxVal, newNbBins);
+    count.assign(mNbBins + 1, 0);
+    first.assign(mNbBins + 1, 0);
+    second.assign(mNbBins + 1, 0);
 
+    // Modulo 2^64: only the differences are used
     for (std::size_t bin = 0; bin < mNbBins; ++bin) {
-        const double value = Utils::clamp(getBinValue(bin), hist.mMinVal, hist.mMaxVal);
-        hist(value, mValues[bin]);
-    }
+        const unsigned long long binCount = mValues[bin];
 
-    assert(mNbValues == hist.mNbValues);
-    return hist;
+        count[bin + 1] = count[bin] + binCount;
+        first[bin + 1] = first[bin] + bin * binCount;
+        second[bin + 1] = second[bin] + bin * bin * binCount;
+    }
 }
 
-double N2D2::Histogram::KLDivergence(const Histogram& ref, const Histogram& quant) {
-    assert(ref.mNbValues == quant.mNbValues);
-    assert(ref.mMaxVal >= quant.mMaxVal);
-
-    double qNorm = 0.0;
-
-    for (std::size_t bin = 0; bin < ref.mNbBins; ++bin) {
-        const std::size_t quantIdx = quant.getBinIdx(ref.getBinValue(bin));
-        qNorm += quant.mValues[quantIdx];
-    }
+double N2D2::Histogram::KLDivergence(double threshold, std::size_t nbBits,
+                                     const std::vector<unsigned long long>& count,
+                                     double entropy) const
+{
+    // Divergence with the histogram quantized in [-threshold, threshold]
+    // (or [0, threshold] if unsigned) on 2^nbBits bins, where the
+    // probability of a bin is q = count(quantized bin) / qNorm.
+    // With p = count(bin) / N, sum(p * log(p / q)) is equal to
+    // entropy - sum(count(quantized bin) * log(count(quantized bin))) / N
+    // + log(qNorm), where the sum is on the quantized bins.
+    const bool isUnsigned = mMinVal >= 0.0;
+    const double quantMinVal = isUnsigned?0:-threshold;
+    const std::size_t nbQuantizedBins = static_cast<std::size_t>(1) << nbBits;
 
-    double divergence = 0.0;
+    const auto getQuantIdx = [&](std::size_t bin) {
+        return getBinIdx(getBinValue(bin), quantMinVal, threshold,
+                         nbQuantizedBins);
+    };
 
-    for (std::size_t bin = 0; bin < ref.mNbBins; ++bin) {
-        const std::size_t quantIdx = quant.getBinIdx(ref.getBinValue(bin));
+    double qNorm = 0.0;
+    double quantEntropy = 0.0;
 
-        // Sum of p and q over bin [0,ref.mNbBins) must be 1
-        const double p = (ref.mValues[bin] / (double)ref.mNbValues);
-        const double q = (quant.mValues[quantIdx] / qNorm);
+    for (std::size_t lo = 0; lo < mNbBins; ) {
+        const std::size_t quantIdx = getQuantIdx(lo);
+        const std::size_t hi = findRangeEnd(lo, mNbBins,
+            [&](std::size_t bin) { return getQuantIdx(bin) != quantIdx; });
+        const double quantCount = (double)(count[hi] - count[lo]);
 
-        // q = 0 => p = 0
-        // p = 0 => contribution = 0
-        if (p != 0) {
-            assert(q != 0);  // q = 0 => p = 0
-            divergence += p * std::log(p / q);
+        if (quantCount != 0) {
+            qNorm += quantCount * (hi - lo);
+            quantEntropy += quantCount * std::log(quantCount);
         }
+
+        lo = hi;
     }
 
-    return divergence;
+    return entropy - quantEntropy / mNbValues + std::log(qNorm);
 }
 
 void N2D2::Histogram::save(std::ostream& state) const {
@@ -0,0 +1,138 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <algorithm>
+#include <chrono>
+
+#include "Solver/FusedUpdate.hpp"
+
+const std::size_t N2D2::FusedUpdate::ChunkSize;
+
+void N2D2::FusedUpdate::addRange(const char* begin,
+                                  const char* end,
+                                  std::size_t size,
+                                  const Kernel_T& kernel)
+{
+    if (size == 0)
+        return;
+
+    // The chunks of the pending kernels are executed in any order: two
+    // updates of the same elements cannot be in the same sweep
+    for (std::vector<std::pair<const char*, const char*> >::const_iterator
+         it = mRanges.begin(), itEnd = mRanges.end(); it != itEnd; ++it)
+    {
+        if (begin < (*it).second && (*it).first < end) {
+            run();
+            break;
+        }
+    }
+
+    mKernels.push_back(std::make_pair(size, kernel));
+    mGroups.push_back(mGroup);
+    mRanges.push_back(std::make_pair(begin, end));
+    mNbElements += size;
+}
+
+void N2D2::FusedUpdate::run()
+{
+    if (mKernels.empty())
+        return;
+
+    const std::chrono::high_resolution_clock::time_point startTime
+        = std::chrono::high_resolution_clock::now();
+
+    // Chunks of every tensor: small tensors are a single chunk, which is
+    // executed in parallel with the other tensors
+    std::vector<std::pair<std::size_t, std::size_t> > chunks;
+    chunks.reserve(mNbElements / ChunkSize + mKernels.size());
+
+    for (std::size_t k = 0; k < mKernels.size(); ++k) {
+        for (std::size_t begin = 0; begin < mKernels[k].first;
+            begin += ChunkSize)
+        {
+            chunks.push_back(std::make_pair(k, begin));
+        }
+    }
+
+    // Busy time of each chunk, only when the timings are enabled
+    std::vector<double> chunkTimes((!mGroupTimes.empty()) ? chunks.size() : 0);
+
+#pragma omp parallel for schedule(dynamic) if (mNbElements > ChunkSize)
+    for (int i = 0; i < (int)chunks.size(); ++i) {
+        const std::pair<std::size_t, Kernel_T>& kernel
+            = mKernels[chunks[i].first];
+        const std::size_t begin = chunks[i].second;
+
+        if (!chunkTimes.empty()) {
+            const std::chrono::high_resolution_clock::time_point time1
+                = std::chrono::high_resolution_clock::now();
+
+            kernel.second(begin, std::min(begin + ChunkSize, kernel.first));
+
+            chunkTimes[i] = std::chrono::duration_cast
+                <std::chrono::duration<double> >(
+                    std::chrono::high_resolution_clock::now() - time1).count();
+        }
+        else
+            kernel.second(begin, std::min(begin + ChunkSize, kernel.first));
+    }
+
+    const double runTime = std::chrono::duration_cast
+        <std::chrono::duration<double> >(
+            std::chrono::high_resolution_clock::now() - startTime).count();
+
+    if (!chunkTimes.empty()) {
+        double busyTime = 0.0;
+
+        for (std::size_t i = 0; i < chunkTimes.size(); ++i)
+            busyTime += chunkTimes[i];
+
+        // Split the run time between the groups, in proportion of the busy
+        // time of their chunks
+        for (std::size_t i = 0; i < chunks.size(); ++i) {
+            const std::size_t group = mGroups[chunks[i].first];
+
+            if (group < mGroupTimes.size()) {
+                mGroupTimes[group] += (busyTime > 0.0)
+                    ? runTime * chunkTimes[i] / busyTime
+                    : runTime / chunks.size();
+            }
+        }
+    }
+
+    mRunTime += runTime;
+
+    mKernels.clear();
+    mGroups.clear();
+    mRanges.clear();
+    mNbElements = 0;
+}
+
+void N2D2::FusedUpdate::run(std::size_t size, const Kernel_T& kernel)
+{
+    const int nbChunks = (int)((size + ChunkSize - 1) / ChunkSize);
+
+#pragma omp parallel for schedule(static) if (nbChunks > 1)
+    for (int chunk = 0; chunk < nbChunks; ++chunk) {
+        const std::size_t begin = chunk * ChunkSize;
+
+        kernel(begin, std::min(begin + ChunkSize, size));
+    }
+}
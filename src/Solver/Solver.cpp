@@ -19,11 +19,16 @@
 */
 
 #include "Solver/Solver.hpp"
+#include "utils/RingAllReduce.hpp"
 #include "utils/Utils.hpp"
 
 unsigned long long int N2D2::Solver::mMaxSteps = 0;
 unsigned long long int N2D2::Solver::mLogSteps = 0;
 double N2D2::Solver::mGlobalLearningRate = 0.0;
+std::shared_ptr<N2D2::RingAllReduce> N2D2::Solver::mGradientReduction;
+std::pair<const void*, const void*> N2D2::Solver::mReducedGradients(NULL,
+                                                                    NULL);
+N2D2::FusedUpdate* N2D2::Solver::mFusedUpdate = NULL;
 
 void N2D2::Solver::save(const std::string& dirName) const
 {
@@ -0,0 +1,331 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "StimuliCache.hpp"
+#include "utils/Utils.hpp"
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+const char N2D2::StimuliCache::Magic[8] = {'N', '2', 'D', '2', 'S', 'C', '0', '1'};
+
+N2D2::StimuliCache::StimuliCache(const std::string& fileName)
+    : mFileName(fileName),
+      mDataSize(0),
+      mFd(-1),
+      mMapping(NULL),
+      mMappingSize(0)
+{
+    const std::string dataFileName = mFileName + ".dat";
+
+    mDataFile.open(dataFileName.c_str(), std::ios::binary | std::ios::app);
+
+    if (!mDataFile.good()) {
+        throw std::runtime_error("StimuliCache::StimuliCache(): could not "
+                                 "open cache data file: " + dataFileName);
+    }
+
+    std::ifstream data(dataFileName.c_str(), std::ios::binary);
+    data.seekg(0, std::ios::end);
+    mDataSize = data.tellg();
+
+    loadIndex();
+
+#if !defined(WIN32) && !defined(_WIN32)
+    mFd = open(dataFileName.c_str(), O_RDONLY);
+
+    if (mFd < 0) {
+        throw std::runtime_error("StimuliCache::StimuliCache(): could not "
+                                 "open cache data file: " + dataFileName);
+    }
+
+    if (mDataSize > 0) {
+        mMapping = mmap(NULL, mDataSize, PROT_READ, MAP_SHARED, mFd, 0);
+
+        if (mMapping == MAP_FAILED) {
+            mMapping = NULL;
+            close(mFd);
+            throw std::runtime_error("StimuliCache::StimuliCache(): could not "
+                                     "map cache data file: " + dataFileName);
+        }
+
+        mMappingSize = mDataSize;
+    }
+#endif
+}
+
+void N2D2::StimuliCache::loadIndex()
+{
+    const std::string indexFileName = mFileName + ".idx";
+    std::vector<Entry> entries;
+    bool valid = false;
+
+    std::ifstream index(indexFileName.c_str(), std::ios::binary);
+
+    if (index.good()) {
+        char magic[sizeof(Magic)];
+        index.read(magic, sizeof(magic));
+
+        if (index.good() && std::equal(magic, magic + sizeof(magic), Magic)) {
+            valid = true;
+            Entry entry;
+
+            while (index.read(reinterpret_cast<char*>(&entry), sizeof(entry)))
+            {
+                if (entry.offset + entry.size > mDataSize) {
+                    // Data not entirely written
+                    valid = false;
+                    break;
+                }
+
+                entries.push_back(entry);
+            }
+
+            // Partially written entry
+            if (index.gcount() != 0)
+                valid = false;
+        }
+
+        index.close();
+    }
+
+    for (std::vector<Entry>::const_iterator it = entries.begin(),
+        itEnd = entries.end(); it != itEnd; ++it)
+    {
+        mEntries.insert(std::make_pair((*it).id, *it));
+    }
+
+    if (valid) {
+        mIndexFile.open(indexFileName.c_str(),
+                        std::ios::binary | std::ios::app);
+    }
+    else {
+        // Rewrite the index with the valid entries only
+        mIndexFile.open(indexFileName.c_str(),
+                        std::ios::binary | std::ios::trunc);
+        mIndexFile.write(Magic, sizeof(Magic));
+
+        for (std::vector<Entry>::const_iterator it = entries.begin(),
+            itEnd = entries.end(); it != itEnd; ++it)
+        {
+            mIndexFile.write(reinterpret_cast<const char*>(&(*it)),
+                             sizeof(*it));
+        }
+
+        mIndexFile.flush();
+    }
+
+    if (!mIndexFile.good()) {
+        throw std::runtime_error("StimuliCache::loadIndex(): could not "
+                                 "open cache index file: " + indexFileName);
+    }
+}
+
+bool N2D2::StimuliCache::contains(Database::StimulusID id) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return (mEntries.find(id) != mEntries.end());
+}
+
+bool N2D2::StimuliCache::get(Database::StimulusID id,
+                             std::vector<cv::Mat>& data,
+                             std::vector<cv::Mat>& labels) const
+{
+    Entry entry;
+    const char* record;
+    std::vector<char> buffer;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+
+        const std::unordered_map<Database::StimulusID, Entry>::const_iterator
+            it = mEntries.find(id);
+
+        if (it == mEntries.end())
+            return false;
+
+        entry = (*it).second;
+    }
+
+    if (entry.offset + entry.size <= mMappingSize)
+        record = static_cast<const char*>(mMapping) + entry.offset;
+    else {
+        // Appended after the mapping: mapping the data file again for every
+        // new stimulus would exhaust the number of mappings
+        readData(entry.offset, entry.size, buffer);
+        record = buffer.data();
+    }
+
+    data.clear();
+    labels.clear();
+
+    for (unsigned int i = 0; i < entry.nbData + entry.nbLabels; ++i) {
+        const MatHeader* header = reinterpret_cast<const MatHeader*>(record);
+        // The mapping is read-only: the views must not be modified
+        cv::Mat mat(header->rows, header->cols, header->type,
+                    const_cast<char*>(record + sizeof(MatHeader)));
+
+        if (!buffer.empty())
+            mat = mat.clone();
+
+        if (i < entry.nbData)
+            data.push_back(mat);
+        else
+            labels.push_back(mat);
+
+        record += matSize(mat);
+    }
+
+    return true;
+}
+
+void N2D2::StimuliCache::put(Database::StimulusID id,
+                             const std::vector<cv::Mat>& data,
+                             const std::vector<cv::Mat>& labels)
+{
+    std::vector<cv::Mat> mats(data);
+    mats.insert(mats.end(), labels.begin(), labels.end());
+
+    std::lock_guard<std::mutex> lock(mMutex);
+
+    if (mEntries.find(id) != mEntries.end())
+        return;
+
+    // Align the record in the data file
+    const std::uint64_t padding = (Alignment - mDataSize % Alignment)
+        % Alignment;
+    const std::vector<char> zeros(Alignment, 0);
+    mDataFile.write(&zeros[0], padding);
+
+    Entry entry;
+    entry.id = id;
+    entry.nbData = data.size();
+    entry.nbLabels = labels.size();
+    entry.reserved = 0;
+    entry.offset = mDataSize + padding;
+    entry.size = 0;
+
+    for (std::vector<cv::Mat>::const_iterator it = mats.begin(),
+        itEnd = mats.end(); it != itEnd; ++it)
+    {
+        const cv::Mat mat = ((*it).isContinuous()) ? (*it) : (*it).clone();
+
+        MatHeader header;
+        header.rows = mat.rows;
+        header.cols = mat.cols;
+        header.type = mat.type();
+        header.reserved = 0;
+
+        const std::uint64_t dataSize = mat.elemSize() * mat.rows * mat.cols;
+
+        mDataFile.write(reinterpret_cast<const char*>(&header),
+                        sizeof(header));
+        mDataFile.write(reinterpret_cast<const char*>(mat.data), dataSize);
+        mDataFile.write(&zeros[0],
+                        matSize(mat) - sizeof(MatHeader) - dataSize);
+
+        entry.size += matSize(mat);
+    }
+
+    mDataFile.flush();
+
+    if (!mDataFile.good()) {
+        throw std::runtime_error("StimuliCache::put(): error writing cache "
+                                 "data file: " + mFileName + ".dat");
+    }
+
+    mDataSize = entry.offset + entry.size;
+
+    // The data is written: the stimulus can be indexed
+    mIndexFile.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    mIndexFile.flush();
+
+    if (!mIndexFile.good()) {
+        throw std::runtime_error("StimuliCache::put(): error writing cache "
+                                 "index file: " + mFileName + ".idx");
+    }
+
+    mEntries.insert(std::make_pair(id, entry));
+}
+
+unsigned int N2D2::StimuliCache::size() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mEntries.size();
+}
+
+void N2D2::StimuliCache::readData(std::uint64_t offset,
+                                  std::uint64_t size,
+                                  std::vector<char>& buffer) const
+{
+    buffer.resize(size);
+
+#if !defined(WIN32) && !defined(_WIN32)
+    std::uint64_t nbRead = 0;
+
+    while (nbRead < size) {
+        const ssize_t nbBytes = pread(mFd, &buffer[nbRead], size - nbRead,
+                                      offset + nbRead);
+
+        if (nbBytes < 0 && errno == EINTR)
+            continue;
+        else if (nbBytes <= 0) {
+            throw std::runtime_error("StimuliCache::readData(): could not "
+                                     "read cache data file: " + mFileName
+                                     + ".dat");
+        }
+
+        nbRead += nbBytes;
+    }
+#else
+    std::ifstream dataFile((mFileName + ".dat").c_str(), std::ios::binary);
+    dataFile.seekg(offset);
+    dataFile.read(&buffer[0], size);
+
+    if (!dataFile.good()) {
+        throw std::runtime_error("StimuliCache::readData(): could not read "
+                                 "cache data file: " + mFileName + ".dat");
+    }
+#endif
+}
+
+std::uint64_t N2D2::StimuliCache::matSize(const cv::Mat& mat)
+{
+    // Header and data, padded so that the next matrix data stays aligned
+    const std::uint64_t size = sizeof(MatHeader)
+        + mat.elemSize() * mat.rows * mat.cols;
+    return ((size + sizeof(MatHeader) - 1) / sizeof(MatHeader))
+        * sizeof(MatHeader);
+}
+
+N2D2::StimuliCache::~StimuliCache()
+{
+#if !defined(WIN32) && !defined(_WIN32)
+    if (mMapping != NULL)
+        munmap(mMapping, mMappingSize);
+
+    if (mFd >= 0)
+        close(mFd);
+#endif
+}
@@ -18,14 +18,21 @@
     knowledge of the CeCILL-C license and that you accept its terms.
 */
 
+#include "StimuliCache.hpp"
 #include "StimuliProvider.hpp"
 #include "Solver/SGDSolver_Kernels.hpp"
+#include "Transformation/RandomResizeCropTransformation.hpp"
 #include "Transformation/RangeAffineTransformation.hpp"
-#include "utils/BinaryCvMat.hpp"
+#include "Transformation/RescaleTransformation.hpp"
 #include "utils/Gnuplot.hpp"
 #include "utils/GraphViz.hpp"
 #include "Adversarial.hpp"
 
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 N2D2::StimuliProvider::ProvidedData::ProvidedData(ProvidedData&& other)
     : batch(std::move(other.batch)),
       data(other.data),
@@ -54,12 +61,19 @@ N2D2::StimuliProvider::StimuliProvider(Database& database,
       mQuantizationMax(this, "QuantizationMax", 1.0),
       mStreamTensor(this, "StreamTensor", false),
       mStreamLabel(this, "StreamLabel", false),
+      mPrefetchDepth(this, "PrefetchDepth", 0U),
+      mPrefetchThreads(this, "PrefetchThreads", 2U),
+      mPrefetchPinning(this, "PrefetchPinning", false),
+      mReducedDecode(this, "ReducedDecode", false),
+      mReducedDecodeTolerance(this, "ReducedDecodeTolerance", 0.0),
+      mGeometricFusion(this, "GeometricFusion", false),
       mDatabase(database),
       mSize(size),
       mBatchSize(batchSize),
       mCompositeStimuli(compositeStimuli),
       mCachePath(""),
-      mFuture(false)
+      mFuture(false),
+      mPrefetchStop(false)
 {
     // ctor
     int count = 1;
@@ -148,16 +162,25 @@ N2D2::StimuliProvider::StimuliProvider(StimuliProvider&& other)
       mQuantizationMax(this, "QuantizationMax", other.mQuantizationMax),
       mStreamTensor(this, "StreamTensor", false),
       mStreamLabel(this, "StreamLabel", false),
+      mPrefetchDepth(this, "PrefetchDepth", other.mPrefetchDepth),
+      mPrefetchThreads(this, "PrefetchThreads", other.mPrefetchThreads),
+      mPrefetchPinning(this, "PrefetchPinning", other.mPrefetchPinning),
+      mReducedDecode(this, "ReducedDecode", other.mReducedDecode),
+      mReducedDecodeTolerance(this, "ReducedDecodeTolerance",
+                              other.mReducedDecodeTolerance),
+      mGeometricFusion(this, "GeometricFusion", other.mGeometricFusion),
       mDatabase(other.mDatabase),
       mSize(std::move(other.mSize)),
       mBatchSize(other.mBatchSize),
       mCompositeStimuli(other.mCompositeStimuli),
       mCachePath(std::move(other.mCachePath)),
+      mStimuliCaches(std::move(other.mStimuliCaches)),
       mTransformations(other.mTransformations),
       mChannelsTransformations(std::move(other.mChannelsTransformations)),
       mProvidedData(std::move(other.mProvidedData)),
       mFutureProvidedData(std::move(other.mFutureProvidedData)),
-      mFuture(other.mFuture)
+      mFuture(other.mFuture),
+      mPrefetchStop(false)
 {
 }
 
@@ -167,6 +190,12 @@ N2D2::StimuliProvider N2D2::StimuliProvider::cloneParameters() const {
     sp.mQuantizationLevels = mQuantizationLevels;
     sp.mQuantizationMin = mQuantizationMin;
     sp.mQuantizationMax = mQuantizationMax;
+    sp.mPrefetchDepth = mPrefetchDepth;
+    sp.mPrefetchThreads = mPrefetchThreads;
+    sp.mPrefetchPinning = mPrefetchPinning;
+    sp.mReducedDecode = mReducedDecode;
+    sp.mReducedDecodeTolerance = mReducedDecodeTolerance;
+    sp.mGeometricFusion = mGeometricFusion;
     sp.mCachePath = mCachePath;
     sp.mTransformations = mTransformations;
     sp.mChannelsTransformations = mChannelsTransformations;
@@ -306,7 +335,10 @@ void N2D2::StimuliProvider::addTransformation(const CompositeTransformation
     {
         mTransformations(*it).cacheable.push_back(transformation);
         mTransformations(*it).cacheable.setStimuliProvider(this);
+        mTransformations(*it).cacheable.setGeometricFusion(mGeometricFusion);
     }
+
+    updateDecodeSizeHint();
 }
 
 void N2D2::StimuliProvider::addOnTheFlyTransformation(
@@ -324,7 +356,94 @@ void N2D2::StimuliProvider::addOnTheFlyTransformation(
     {
         mTransformations(*it).onTheFly.push_back(transformation);
         mTransformations(*it).onTheFly.setStimuliProvider(this);
+        mTransformations(*it).onTheFly.setGeometricFusion(mGeometricFusion);
+    }
+
+    updateDecodeSizeHint();
+}
+
+void N2D2::StimuliProvider::updateDecodeSizeHint()
+{
+    DataFile::SizeHint sizeHint;
+
+    if (mReducedDecode) {
+        const std::vector<Database::StimuliSet> stimuliSets
+            = mDatabase.getStimuliSets(Database::All);
+        bool fullResolution = false;
+
+        for (std::vector<Database::StimuliSet>::const_iterator it
+             = stimuliSets.begin(),
+             itEnd = stimuliSets.end();
+             it != itEnd;
+             ++it)
+        {
+            const Transformations& trans = mTransformations(*it);
+            const CompositeTransformation& chain = (!trans.cacheable.empty())
+                ? trans.cacheable : trans.onTheFly;
+
+            if (chain.empty()) {
+                fullResolution = true;
+                break;
+            }
+
+            // Minimum size of the input of the first transformation, for
+            // which it still only downscales the stimulus
+            const std::shared_ptr<RescaleTransformation> rescale
+                = std::dynamic_pointer_cast<RescaleTransformation>(chain[0]);
+            const std::shared_ptr<RandomResizeCropTransformation> resizeCrop
+                = std::dynamic_pointer_cast<RandomResizeCropTransformation>(
+                    chain[0]);
+
+            if (rescale) {
+                // With KeepAspectRatio, requiring both dimensions is
+                // conservative when ResizeToFit is true
+                sizeHint.width = std::max(sizeHint.width,
+                                          rescale->getWidth());
+                sizeHint.height = std::max(sizeHint.height,
+                                           rescale->getHeight());
+            }
+            else if (resizeCrop) {
+                // The smallest crop must still be larger than the output
+                const double width = resizeCrop->getWidth();
+                const double height = resizeCrop->getHeight();
+                const double scaleMin = resizeCrop->getScaleMin();
+                const double ratioMin = std::min(resizeCrop->getRatioMin(),
+                                                 resizeCrop->getRatioMax());
+                const double ratioMax = std::max(resizeCrop->getRatioMin(),
+                                                 resizeCrop->getRatioMax());
+
+                if (scaleMin <= 0.0 || ratioMin <= 0.0) {
+                    fullResolution = true;
+                    break;
+                }
+
+                sizeHint.width = std::max(sizeHint.width,
+                                          resizeCrop->getWidth());
+                sizeHint.height = std::max(sizeHint.height,
+                                           resizeCrop->getHeight());
+                sizeHint.area = std::max(sizeHint.area,
+                    std::max(width * width / (scaleMin * ratioMin),
+                             height * height * ratioMax / scaleMin));
+            }
+            else {
+                fullResolution = true;
+                break;
+            }
+        }
+
+        if (fullResolution)
+            sizeHint = DataFile::SizeHint();
+        else {
+            const double scale = 1.0 - std::min(1.0,
+                std::max(0.0, (double)mReducedDecodeTolerance));
+
+            sizeHint.width = (unsigned int)std::ceil(scale * sizeHint.width);
+            sizeHint.height = (unsigned int)std::ceil(scale * sizeHint.height);
+            sizeHint.area *= scale * scale;
+        }
     }
+
+    mDatabase.setDecodeSizeHint(sizeHint);
 }
 
 void N2D2::StimuliProvider::addChannelTransformation(
@@ -843,6 +962,198 @@ void N2D2::StimuliProvider::synchronize()
 
     synchronizeToDevices();
 }
+
+void N2D2::StimuliProvider::startPrefetch(Database::StimuliSet set)
+{
+    stopPrefetch();
+
+    const unsigned int depth = std::max(1U, (unsigned int)mPrefetchDepth);
+    const unsigned int nbWorkers = std::max(1U,
+                                            (unsigned int)mPrefetchThreads);
+
+    // The prefetch buffers mirror the current provided data
+    mPrefetchBuffers.clear();
+    mPrefetchBuffers.resize(depth);
+    mPrefetchFree.clear();
+    mPrefetchReady.clear();
+
+    for (unsigned int buffer = 0; buffer < depth; ++buffer) {
+        mPrefetchBuffers[buffer].resize(mProvidedData.size());
+
+        for (int dev = 0; dev < (int)mProvidedData.size(); ++dev) {
+            ProvidedData& provided = mPrefetchBuffers[buffer][dev];
+
+            provided.batch.resize(mProvidedData[dev].batch.size());
+            provided.data.resize(mProvidedData[dev].data.dims());
+            provided.labelsData.resize(mProvidedData[dev].labelsData.dims());
+            provided.targetData.resize(mProvidedData[dev].targetData.dims());
+            provided.labelsROI.resize(mProvidedData[dev].labelsROI.size());
+#ifdef CUDA
+            provided.data.hostBased() = mProvidedData[dev].data.hostBased();
+            provided.targetData.hostBased()
+                = mProvidedData[dev].targetData.hostBased();
+#endif
+        }
+
+        mPrefetchFree.push_back(buffer);
+    }
+
+    mPrefetchError = nullptr;
+    mPrefetchStop = false;
+
+    for (unsigned int worker = 0; worker < nbWorkers; ++worker) {
+        mPrefetchWorkers.push_back(std::thread(
+            &StimuliProvider::prefetchWorker, this, set, worker));
+    }
+}
+
+void N2D2::StimuliProvider::readPrefetchedBatch()
+{
+    if (mPrefetchWorkers.empty()) {
+        throw std::runtime_error("StimuliProvider::readPrefetchedBatch(): "
+                                 "prefetch is not started");
+    }
+
+    unsigned int buffer;
+    std::exception_ptr error;
+
+    {
+        std::unique_lock<std::mutex> lock(mPrefetchMutex);
+        mPrefetchCond.wait(lock, [this]() { return !mPrefetchReady.empty(); });
+
+        buffer = mPrefetchReady.front();
+        mPrefetchReady.pop_front();
+        std::swap(error, mPrefetchError);
+    }
+
+    if (!error) {
+        // Don't swap the vectors directly, as it would invalidate the
+        // address to the tensors
+        for (int dev = 0; dev < (int)mProvidedData.size(); ++dev)
+            mProvidedData[dev].swap(mPrefetchBuffers[buffer][dev]);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mPrefetchMutex);
+        mPrefetchFree.push_back(buffer);
+    }
+
+    mPrefetchCond.notify_all();
+
+    if (error)
+        std::rethrow_exception(error);
+
+    mFuture = false;
+    synchronizeToDevices();
+}
+
+void N2D2::StimuliProvider::stopPrefetch()
+{
+    {
+        std::lock_guard<std::mutex> lock(mPrefetchMutex);
+        mPrefetchStop = true;
+    }
+
+    mPrefetchCond.notify_all();
+
+    for (std::vector<std::thread>::iterator it = mPrefetchWorkers.begin(),
+         itEnd = mPrefetchWorkers.end(); it != itEnd; ++it)
+    {
+        (*it).join();
+    }
+
+    mPrefetchWorkers.clear();
+}
+
+void N2D2::StimuliProvider::prefetchWorker(Database::StimuliSet set,
+                                           unsigned int worker)
+{
+#if defined(__linux__)
+    if (mPrefetchPinning) {
+        // Pin the worker to one of the last CPUs, the compute threads
+        // being usually scheduled on the first ones
+        cpu_set_t available;
+
+        if (sched_getaffinity(0, sizeof(available), &available) == 0) {
+            std::vector<int> cpus;
+
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &available))
+                    cpus.push_back(cpu);
+            }
+
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            CPU_SET(cpus[cpus.size() - 1 - (worker % cpus.size())], &cpuset);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpuset), &cpuset);
+        }
+    }
+#else
+    (void)worker;
+#endif
+
+    while (true) {
+        unsigned int buffer;
+
+        {
+            // Back-pressure: wait for a free buffer
+            std::unique_lock<std::mutex> lock(mPrefetchMutex);
+            mPrefetchCond.wait(lock, [this]() {
+                return (mPrefetchStop || !mPrefetchFree.empty()); });
+
+            if (mPrefetchStop)
+                return;
+
+            buffer = mPrefetchFree.front();
+            mPrefetchFree.pop_front();
+
+            // Random::randUniform() is not thread-safe!
+            for (int dev = 0; dev < (int)mProvidedData.size(); ++dev) {
+                if (mDevices.find(dev) != mDevices.end()) {
+                    std::vector<int>& batchRef
+                        = mPrefetchBuffers[buffer][dev].batch;
+
+                    for (unsigned int batchPos = 0; batchPos < mBatchSize;
+                        ++batchPos)
+                    {
+                        batchRef[batchPos] = getRandomID(set);
+                    }
+                }
+            }
+        }
+
+        std::exception_ptr error;
+
+        try {
+            for (int dev = 0; dev < (int)mProvidedData.size(); ++dev) {
+                if (mDevices.find(dev) != mDevices.end()) {
+                    ProvidedData& provided = mPrefetchBuffers[buffer][dev];
+
+                    for (unsigned int batchPos = 0; batchPos < mBatchSize;
+                        ++batchPos)
+                    {
+                        readStimulusData(provided.batch[batchPos], set,
+                                         batchPos, dev, provided);
+                    }
+                }
+            }
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mPrefetchMutex);
+
+            if (error)
+                mPrefetchError = error;
+
+            mPrefetchReady.push_back(buffer);
+        }
+
+        mPrefetchCond.notify_all();
+    }
+}
 // unsigned int
 //     N2D2::StimuliProvider::setStimuliIndexes(   Database::StimuliSet set,   
 //                                                 const unsigned int nbEpochs,
@@ -1076,15 +1387,18 @@ void N2D2::StimuliProvider::readStimulus(Database::StimulusID id,
                                          unsigned int batchPos,
                                          int dev)
 {
-    std::stringstream dataCacheFile, labelsCacheFile, validCacheFile;
-    dataCacheFile << mCachePath << "/" << std::setfill('0') << std::setw(7)
-                  << id << "_data_" << set << ".bin";
-    labelsCacheFile << mCachePath << "/" << std::setfill('0') << std::setw(7)
-                    << id << "_labels_" << set << ".bin";
-    validCacheFile << mCachePath << "/" << std::setfill('0') << std::setw(7)
-                    << id << "_" << set << ".valid";
-
     dev = getDevice(dev);
+    readStimulusData(id, set, batchPos, dev,
+                     (mFuture) ? mFutureProvidedData[dev]
+                               : mProvidedData[dev]);
+}
+
+void N2D2::StimuliProvider::readStimulusData(Database::StimulusID id,
+                                             Database::StimuliSet set,
+                                             unsigned int batchPos,
+                                             int dev,
+                                             ProvidedData& provided)
+{
 #ifdef CUDA
 
     // Necessary to save the current device id before calling
@@ -1101,58 +1415,20 @@ void N2D2::StimuliProvider::readStimulus(Database::StimulusID id,
     cudaSetDevice(dev);
 #endif
 
-    std::vector<std::shared_ptr<ROI> >& labelsROI = (mFuture)
-        ? mFutureProvidedData[dev].labelsROI[batchPos]
-        : mProvidedData[dev].labelsROI[batchPos];
+    std::vector<std::shared_ptr<ROI> >& labelsROI = provided.labelsROI[batchPos];
     labelsROI = mDatabase.getStimulusROIs(id);
 
     std::vector<cv::Mat> rawChannelsData;
     std::vector<cv::Mat> rawChannelsLabels;
 
     // 1. Cached data
-    if (!mCachePath.empty() && std::ifstream(validCacheFile.str()).good()) {
-        // Cache present, load the pre-processed data
-        rawChannelsData = loadDataCache(dataCacheFile.str());
-        rawChannelsLabels = loadDataCache(labelsCacheFile.str());
-    } else {
-        // Cache not present, load the raw stimuli from the database
-        cv::Mat rawData
-            = mDatabase.getStimulusData(id)
-                  .clone(); // make sure the database image will not be altered
-        cv::Mat rawLabels
-            = mDatabase.getStimulusLabelsData(id)
-                  .clone(); // make sure the database image will not be altered
-
-        // Apply global cacheable transformation
-        mTransformations(set)
-            .cacheable.apply(rawData, rawLabels, labelsROI, id);
-
-        if (mTransformations(set).onTheFly.empty()
-            && !mChannelsTransformations.empty()) {
-            // If no global on-the-fly transformation, apply the cacheable
-            // channels transformations
-            for (std::vector<TransformationsSets>::iterator it
-                 = mChannelsTransformations.begin(),
-                 itEnd = mChannelsTransformations.end();
-                 it != itEnd;
-                 ++it) {
-                cv::Mat channelData = rawData.clone();
-                cv::Mat channelLabels = rawLabels.clone();
-                (*it)(set).cacheable.apply(channelData, channelLabels, id);
-                rawChannelsData.push_back(channelData);
-                rawChannelsLabels.push_back(channelLabels);
-            }
-        } else {
-            rawChannelsData.push_back(rawData);
-            rawChannelsLabels.push_back(rawLabels);
-        }
-
-        // Save the pre-processed data
-        if (!mCachePath.empty()) {
-            saveDataCache(dataCacheFile.str(), rawChannelsData);
-            saveDataCache(labelsCacheFile.str(), rawChannelsLabels);
-            std::ofstream(validCacheFile.str());
-        }
+    if (readCacheableStimulus(id, set, labelsROI,
+                              rawChannelsData, rawChannelsLabels)
+        && !mTransformations(set).onTheFly.empty())
+    {
+        // The cached data are read-only views on the disk cache
+        rawChannelsData[0] = rawChannelsData[0].clone();
+        rawChannelsLabels[0] = rawChannelsLabels[0].clone();
     }
 
     // 2. On-the-fly processing
@@ -1234,15 +1510,9 @@ void N2D2::StimuliProvider::readStimulus(Database::StimulusID id,
         }
     }
 
-    TensorData_T& dataRef = (mFuture)
-        ? mFutureProvidedData[dev].data
-        : mProvidedData[dev].data;
-    Tensor<int>& labelsRef = (mFuture)
-        ? mFutureProvidedData[dev].labelsData
-        : mProvidedData[dev].labelsData;
-    TensorData_T& targetDataRef = (mFuture)
-        ? mFutureProvidedData[dev].targetData
-        : mProvidedData[dev].targetData;
+    TensorData_T& dataRef = provided.data;
+    Tensor<int>& labelsRef = provided.labelsData;
+    TensorData_T& targetDataRef = provided.targetData;
 
     if (mBatchSize > 0) {
         TensorData_T dataRefPos = dataRef[batchPos];
@@ -1699,11 +1969,8 @@ void N2D2::StimuliProvider::setBatch(Database::StimuliSet set,
         }
     }
     //Sort index of data stimuli under a pseudo random range
-    if (randShuffle) {
-        std::random_shuffle(batchs.begin(),
-                            batchs.end(),
-                            Random::randShuffle);
-    }
+    if (randShuffle)
+        mDatabase.shuffleIndexes(set, batchs);
     
     std::deque<unsigned int>& indexes = 
                 (set == Database::StimuliSet::Learn) ? mIndexesLearn :
@@ -1717,7 +1984,8 @@ void N2D2::StimuliProvider::setBatch(Database::StimuliSet set,
 	for (auto& x: indexes)
         x *= batchSize;
     
-    if (randShuffle) {
+    // Sequential databases are read in the order of their shuffle
+    if (randShuffle && !mDatabase.isSequential()) {
         std::random_shuffle(indexes.begin(),
                             indexes.end(),
                             Random::randShuffle);
@@ -1743,7 +2011,9 @@ void N2D2::StimuliProvider::setCachePath(const std::string& path)
         }
     }
 
+    std::lock_guard<std::mutex> lock(mStimuliCachesMutex);
     mCachePath = path;
+    mStimuliCaches.clear();
 }
 
 unsigned int
@@ -2450,36 +2720,147 @@ void N2D2::StimuliProvider::logRgbData(const std::string& fileName,
 }
 */
 
-std::vector<cv::Mat> N2D2::StimuliProvider::loadDataCache(const std::string
-                                                          & fileName) const
+bool N2D2::StimuliProvider::readCacheableStimulus(
+    Database::StimulusID id,
+    Database::StimuliSet set,
+    std::vector<std::shared_ptr<ROI> >& labelsROI,
+    std::vector<cv::Mat>& rawChannelsData,
+    std::vector<cv::Mat>& rawChannelsLabels)
+{
+    const std::shared_ptr<StimuliCache> cache = getStimuliCache(set);
+
+    // Cache present, get the pre-processed data
+    if (cache && cache->get(id, rawChannelsData, rawChannelsLabels))
+        return true;
+
+    // Cache not present, load the raw stimuli from the database
+    cv::Mat rawData
+        = mDatabase.getStimulusData(id)
+              .clone(); // make sure the database image will not be altered
+    cv::Mat rawLabels
+        = mDatabase.getStimulusLabelsData(id)
+              .clone(); // make sure the database image will not be altered
+
+    // Apply global cacheable transformation
+    mTransformations(set)
+        .cacheable.apply(rawData, rawLabels, labelsROI, id);
+
+    rawChannelsData.clear();
+    rawChannelsLabels.clear();
+
+    if (mTransformations(set).onTheFly.empty()
+        && !mChannelsTransformations.empty()) {
+        // If no global on-the-fly transformation, apply the cacheable
+        // channels transformations
+        for (std::vector<TransformationsSets>::iterator it
+             = mChannelsTransformations.begin(),
+             itEnd = mChannelsTransformations.end();
+             it != itEnd;
+             ++it) {
+            cv::Mat channelData = rawData.clone();
+            cv::Mat channelLabels = rawLabels.clone();
+            (*it)(set).cacheable.apply(channelData, channelLabels, id);
+            rawChannelsData.push_back(channelData);
+            rawChannelsLabels.push_back(channelLabels);
+        }
+    } else {
+        rawChannelsData.push_back(rawData);
+        rawChannelsLabels.push_back(rawLabels);
+    }
+
+    // Save the pre-processed data
+    if (cache)
+        cache->put(id, rawChannelsData, rawChannelsLabels);
+
+    return false;
+}
+
+bool N2D2::StimuliProvider::cacheStimulus(Database::StimulusID id,
+                                          Database::StimuliSet set)
 {
-    std::ifstream is(fileName.c_str(), std::ios::binary);
+    const std::shared_ptr<StimuliCache> cache = getStimuliCache(set);
+
+    if (!cache || cache->contains(id))
+        return false;
 
-    if (!is.good())
-        throw std::runtime_error("Could not read cache file: " + fileName);
+    std::vector<std::shared_ptr<ROI> > labelsROI
+        = mDatabase.getStimulusROIs(id);
+    std::vector<cv::Mat> rawChannelsData;
+    std::vector<cv::Mat> rawChannelsLabels;
+
+    return !readCacheableStimulus(id, set, labelsROI,
+                                  rawChannelsData, rawChannelsLabels);
+}
+
+std::shared_ptr<N2D2::StimuliCache>
+N2D2::StimuliProvider::getStimuliCache(Database::StimuliSet set)
+{
+    std::lock_guard<std::mutex> lock(mStimuliCachesMutex);
 
-    std::vector<cv::Mat> data;
+    if (mCachePath.empty())
+        return std::shared_ptr<StimuliCache>();
 
-    do {
-        data.push_back(cv::Mat());
-        BinaryCvMat::read(is, data.back());
-    } while (is.peek() != EOF);
+    std::shared_ptr<StimuliCache>& cache = mStimuliCaches[set];
 
-    return data;
+    if (!cache) {
+        // The cache is opened on first use, once all the transformations
+        // are set
+        cache = std::make_shared<StimuliCache>(mCachePath + "/"
+                                               + getCacheName(set));
+    }
+
+    return cache;
 }
 
-void N2D2::StimuliProvider::saveDataCache(const std::string& fileName,
-                                          const std::vector
-                                          <cv::Mat>& data) const
+std::string
+N2D2::StimuliProvider::getCacheName(Database::StimuliSet set) const
 {
-    std::ofstream os(fileName.c_str(), std::ios::binary);
+    // Describe everything the cached data depends on, so that a cache built
+    // with different transformations is not reused
+    std::ostringstream desc;
+    desc << mDatabase.getNbStimuli();
+
+    const std::function<void(const Transformation&)> describe
+        = [&desc](const Transformation& trans)
+    {
+        desc << "|" << trans.getType();
 
-    if (!os.good())
-        throw std::runtime_error("Could not create cache file: " + fileName);
+        const std::map<std::string, std::string> params
+            = trans.getParameters();
 
-    for (std::vector<cv::Mat>::const_iterator it = data.begin(),
-                                              itEnd = data.end();
-         it != itEnd;
-         ++it)
-        BinaryCvMat::write(os, *it);
+        for (std::map<std::string, std::string>::const_iterator it
+             = params.begin(), itEnd = params.end(); it != itEnd; ++it)
+        {
+            desc << ";" << (*it).first << "=" << (*it).second;
+        }
+    };
+
+    mTransformations(set).cacheable.iterTransformations(describe);
+
+    if (mTransformations(set).onTheFly.empty()) {
+        for (std::vector<TransformationsSets>::const_iterator it
+             = mChannelsTransformations.begin(),
+             itEnd = mChannelsTransformations.end();
+             it != itEnd;
+             ++it) {
+            desc << "|channel";
+            (*it)(set).cacheable.iterTransformations(describe);
+        }
+    }
+
+    // 64 bits FNV-1a hash
+    const std::string descStr = desc.str();
+    unsigned long long hash = 14695981039346656037ULL;
+
+    for (std::string::const_iterator it = descStr.begin(),
+         itEnd = descStr.end(); it != itEnd; ++it)
+    {
+        hash ^= (unsigned char)(*it);
+        hash *= 1099511628211ULL;
+    }
+
+    std::ostringstream name;
+    name << set << "_" << std::hex << std::setfill('0') << std::setw(16)
+        << hash;
+    return name.str();
 }
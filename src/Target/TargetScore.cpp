@@ -533,69 +533,77 @@ void N2D2::TargetScore::computeScore(Database::StimuliSet set)
 
         batchSuccess.assign(values.dimB(), -1.0);
 
-#pragma omp parallel for if (values.dimB() > 4 && values[0].size() > 1)
-        for (int batchPos = 0; batchPos < (int)values.dimB(); ++batchPos) {
+#pragma omp parallel if (values.dimB() > 4 && values[0].size() > 1)
+        {
+            // Per-thread confusion matrix, merged once per batch
+            ConfusionMatrix<unsigned long long int> threadConfusion(
+                mConfusionQuantSteps, mConfusionQuantSteps, 0);
+
+#pragma omp for
+            for (int batchPos = 0; batchPos < (int)values.dimB(); ++batchPos) {
 #ifdef CUDA
-            CHECK_CUDA_STATUS(cudaSetDevice(dev));
+                CHECK_CUDA_STATUS(cudaSetDevice(dev));
 #endif
 
-            const int id = mStimuliProvider->getBatch()[batchPos];
-
-            if (id < 0) {
-                // Invalid stimulus in batch (can occur for the last batch of the
-                // set)
-                continue;
-            }
-
-            const Tensor<Float_T> target = mStimuliProvider->getTargetData()[batchPos];
-            const Tensor<Float_T> estimated = values[batchPos];
+                const int id = mStimuliProvider->getBatch()[batchPos];
 
-            ConfusionMatrix<unsigned long long int> confusion(
-                mConfusionQuantSteps, mConfusionQuantSteps, 0);
+                if (id < 0) {
+                    // Invalid stimulus in batch (can occur for the last batch
+                    // of the set)
+                    continue;
+                }
 
-            double mse = 0.0;
+                const Tensor<Float_T> target
+                    = mStimuliProvider->getTargetData()[batchPos];
+                const Tensor<Float_T> estimated = values[batchPos];
 
-            for (size_t index = 0; index < target.size(); ++index) {
-                Float_T estimatedValue = estimated(index);
+                Float_T affineTrans = 1.0;
 
                 if (mCell->isQuantized()) {
                     const int precision = mCell->getQuantizedNbBits();
-                    const Float_T affineTrans
+                    affineTrans
                         = (targetCell->getActivation()
                             && targetCell->getActivation()->getType()
                                 == RectifierActivation::Type)
                             ? (std::pow(2, (int)precision) - 1)
                             : (std::pow(2, (int)precision - 1) - 1);
-                    estimatedValue /= affineTrans;
                 }
 
-                const double err = target(index) - estimatedValue;
-                mse += err * err;
-
-                const unsigned int t = Utils::clamp<unsigned int>(
-                    Utils::round((mConfusionQuantSteps - 1)
-                        * (target(index) - mConfusionRangeMin)
-                            / (double)(mConfusionRangeMax - mConfusionRangeMin)),
-                    0U, mConfusionQuantSteps - 1);
-                const unsigned int e = Utils::clamp<unsigned int>(
-                    Utils::round((mConfusionQuantSteps - 1)
-                        * (estimatedValue - mConfusionRangeMin)
-                            / (double)(mConfusionRangeMax - mConfusionRangeMin)),
-                    0U, mConfusionQuantSteps - 1);
-
-                confusion(t, e) += 1ULL;
-            }
+                double mse = 0.0;
+
+                for (size_t index = 0; index < target.size(); ++index) {
+                    Float_T estimatedValue = estimated(index);
+
+                    if (mCell->isQuantized())
+                        estimatedValue /= affineTrans;
+
+                    const double err = target(index) - estimatedValue;
+                    mse += err * err;
+
+                    const unsigned int t = Utils::clamp<unsigned int>(
+                        Utils::round((mConfusionQuantSteps - 1)
+                            * (target(index) - mConfusionRangeMin)
+                            / (double)(mConfusionRangeMax
+                                - mConfusionRangeMin)),
+                        0U, mConfusionQuantSteps - 1);
+                    const unsigned int e = Utils::clamp<unsigned int>(
+                        Utils::round((mConfusionQuantSteps - 1)
+                            * (estimatedValue - mConfusionRangeMin)
+                            / (double)(mConfusionRangeMax
+                                - mConfusionRangeMin)),
+                        0U, mConfusionQuantSteps - 1);
+
+                    threadConfusion(t, e) += 1ULL;
+                }
 
-            if (target.size() > 0)
-                mse /= target.size();
+                if (target.size() > 0)
+                    mse /= target.size();
 
-            batchSuccess[batchPos] = mse;
+                batchSuccess[batchPos] = mse;
+            }
 
 #pragma omp critical(TargetScore__process_confusionMatrix)
-            std::transform(confusionMatrix.begin(), confusionMatrix.end(),
-                        confusion.begin(),
-                        confusionMatrix.begin(),
-                        std::plus<unsigned long long int>());
+            confusionMatrix += threadConfusion;
         }
     }
     else {
@@ -625,168 +633,223 @@ void N2D2::TargetScore::computeScore(Database::StimuliSet set)
         if (mTargetTopN > 1)
             batchTopNSuccess.assign(targets.dimB(), -1.0);
 
-#pragma omp parallel for if (targets.dimB() > 4 && targets[0].size() > 1)
-        for (int batchPos = 0; batchPos < (int)targets.dimB(); ++batchPos) {
+#pragma omp parallel if (targets.dimB() > 4 && targets[0].size() > 1)
+        {
+            // Per-thread confusion matrix and misclassified stimuli, merged
+            // once per batch
+            ConfusionMatrix<unsigned long long int> threadConfusion(
+                nbTargetsConfusion, nbTargetsConfusion, 0);
+            std::vector<std::pair<int, std::map<unsigned int,
+                std::vector<unsigned int> > > > threadMisclassified;
+
+            // Confusion matrix of a single stimulus (for pixel-wise targets)
+            ConfusionMatrix<unsigned long long int> confusion(
+                nbTargetsConfusion, nbTargetsConfusion, 0);
+
+#pragma omp for
+            for (int batchPos = 0; batchPos < (int)targets.dimB(); ++batchPos)
+            {
 #ifdef CUDA
-            CHECK_CUDA_STATUS(cudaSetDevice(dev));
+                CHECK_CUDA_STATUS(cudaSetDevice(dev));
 #endif
 
-            const int id = mStimuliProvider->getBatch()[batchPos];
+                const int id = mStimuliProvider->getBatch()[batchPos];
 
-            if (id < 0) {
-                // Invalid stimulus in batch (can occur for the last batch of the
-                // set)
-                continue;
-            }
+                if (id < 0) {
+                    // Invalid stimulus in batch (can occur for the last batch
+                    // of the set)
+                    continue;
+                }
 
-            const Tensor<int> target = targets[batchPos][0];
-            const Tensor<int> estLabels = estimatedLabels[batchPos];
-            const TensorLabels_T mask = (mMaskLabelTarget && mMaskedLabel >= 0)
-                ? mMaskLabelTarget->getEstimatedLabels()[batchPos][0]
-                : TensorLabels_T();
+                const Tensor<int> target = targets[batchPos][0];
+                const Tensor<int> estLabels = estimatedLabels[batchPos];
+                const TensorLabels_T mask
+                    = (mMaskLabelTarget && mMaskedLabel >= 0)
+                        ? mMaskLabelTarget->getEstimatedLabels()[batchPos][0]
+                        : TensorLabels_T();
 
-            if (!mask.empty() && mask.dims() != target.dims()) {
-                std::ostringstream errorStr;
-                errorStr << "Mask dims (" << mask.dims() << ") from MaskLabelTarget"
-                    " does not match target dims (" << target.dims() << ") for"
-                    " target \"" << mName << "\"";
+                if (!mask.empty() && mask.dims() != target.dims()) {
+                    std::ostringstream errorStr;
+                    errorStr << "Mask dims (" << mask.dims() << ") from "
+                        "MaskLabelTarget does not match target dims ("
+                        << target.dims() << ") for target \"" << mName
+                        << "\"";
 
 #pragma omp critical(TargetScore__process)
-                throw std::runtime_error(errorStr.str());
-            }
+                    throw std::runtime_error(errorStr.str());
+                }
 
-            std::map<unsigned int, std::vector<unsigned int> > misclass;
+                std::map<unsigned int, std::vector<unsigned int> > misclass;
 
-            if (target.size() == 1) {
-                if (target(0) >= 0) {
-#pragma omp atomic
-                    confusionMatrix(target(0), estLabels(0)) += 1ULL;
+                if (target.size() == 1) {
+                    if (target(0) >= 0) {
+                        threadConfusion(target(0), estLabels(0)) += 1ULL;
 
-                    batchSuccess[batchPos] = (estLabels(0) == target(0));
+                        batchSuccess[batchPos] = (estLabels(0) == target(0));
 
-                    if (!batchSuccess[batchPos]) {
-                        // Misclassified
-                        std::map<unsigned int, std::vector<unsigned int> >
-                            ::iterator itMisclass;
-                        std::tie(itMisclass, std::ignore)
-                            = misclass.insert(std::make_pair(target(0),
-                                std::vector<unsigned int>(nbTargets, 0U)));
-                        (*itMisclass).second[estLabels(0)] = 1U;
-                    }
+                        if (!batchSuccess[batchPos]) {
+                            // Misclassified
+                            std::map<unsigned int, std::vector<unsigned int> >
+                                ::iterator itMisclass;
+                            std::tie(itMisclass, std::ignore)
+                                = misclass.insert(std::make_pair(target(0),
+                                    std::vector<unsigned int>(nbTargets, 0U)));
+                            (*itMisclass).second[estLabels(0)] = 1U;
+                        }
 
-                    // Top-N case :
-                    if (mTargetTopN > 1) {
-                        unsigned int topNscore = 0;
+                        // Top-N case :
+                        if (mTargetTopN > 1) {
+                            unsigned int topNscore = 0;
+
+                            for (unsigned int n = 0; n < mTargetTopN; ++n) {
+                                if (estLabels(n) == target(0))
+                                    ++topNscore;
+                            }
 
-                        for (unsigned int n = 0; n < mTargetTopN; ++n) {
-                            if (estLabels(n) == target(0))
-                                ++topNscore;
+                            batchTopNSuccess[batchPos] = (topNscore > 0);
                         }
+                    }
+                } else {
+                    std::fill(confusion.begin(), confusion.end(), 0ULL);
 
-                        batchTopNSuccess[batchPos] = (topNscore > 0);
+                    std::vector<unsigned int> nbHits(nbTargets, 0);
+                    std::vector<unsigned int> nbHitsTopN(nbTargets, 0);
+                    std::vector<unsigned int> nbLabels(nbTargets, 0);
+
+                    if (mask.empty() && mTargetTopN <= 1) {
+                        // Histogram of the (target, estimated) pairs, the
+                        // hits and labels count are given by the matrix
+                        confusion.accumulate(&target(0), &estLabels(0),
+                                             target.size());
+
+                        for (unsigned int t = 0; t < nbTargets; ++t) {
+                            for (unsigned int e = 0; e < nbTargets; ++e)
+                                nbLabels[t] += confusion(t, e);
+
+                            nbHits[t] = confusion(t, t);
+                        }
                     }
-                }
-            } else {
-                ConfusionMatrix<unsigned long long int> confusion(nbTargetsConfusion,
-                                                                nbTargetsConfusion,
-                                                                0);
-
-                std::vector<unsigned int> nbHits(nbTargets, 0);
-                std::vector<unsigned int> nbHitsTopN(nbTargets, 0);
-                std::vector<unsigned int> nbLabels(nbTargets, 0);
-
-                for (unsigned int oy = 0; oy < targets.dimY(); ++oy) {
-                    for (unsigned int ox = 0; ox < targets.dimX(); ++ox) {
-                        if (target(ox, oy) >= 0) {
-                            ++nbLabels[target(ox, oy)];
-
-                            if (mask.empty() || mask(ox, oy) == mMaskedLabel) {
-                                confusion(target(ox, oy),
-                                          estLabels(ox, oy, 0)) += 1;
-
-                                if (target(ox, oy)
-                                    == (int)estLabels(ox, oy, 0))
-                                    ++nbHits[target(ox, oy)];
-
-                                // Top-N case :
-                                if (mTargetTopN > 1) {
-                                    unsigned int topNscore = 0;
-
-                                    for (unsigned int n = 0; n < mTargetTopN; ++n) {
-                                        if (estLabels(ox, oy, n)
-                                            == target(ox, oy))
-                                            ++topNscore;
+                    else {
+                        for (unsigned int oy = 0; oy < targets.dimY(); ++oy) {
+                            for (unsigned int ox = 0; ox < targets.dimX();
+                                ++ox)
+                            {
+                                if (target(ox, oy) >= 0) {
+                                    ++nbLabels[target(ox, oy)];
+
+                                    if (mask.empty()
+                                        || mask(ox, oy) == mMaskedLabel)
+                                    {
+                                        confusion(target(ox, oy),
+                                                  estLabels(ox, oy, 0)) += 1;
+
+                                        if (target(ox, oy)
+                                            == (int)estLabels(ox, oy, 0))
+                                            ++nbHits[target(ox, oy)];
+
+                                        // Top-N case :
+                                        if (mTargetTopN > 1) {
+                                            unsigned int topNscore = 0;
+
+                                            for (unsigned int n = 0;
+                                                n < mTargetTopN; ++n)
+                                            {
+                                                if (estLabels(ox, oy, n)
+                                                    == target(ox, oy))
+                                                    ++topNscore;
+                                            }
+
+                                            if (topNscore > 0)
+                                                ++nbHitsTopN[target(ox, oy)];
+                                        }
+                                    }
+                                    else {
+                                        // Masked target = masked false
+                                        // negative
+                                        // Should affect the recall
+                                        confusion(target(ox, oy), nbTargets)
+                                            += 1;
                                     }
-
-                                    if (topNscore > 0)
-                                        ++nbHitsTopN[target(ox, oy)];
+                                }
+                                else if (!mask.empty()
+                                    && mask(ox, oy) == mMaskedLabel)
+                                {
+                                    // Masked no target = masked false
+                                    // positive
+                                    // Should affect the precision
+                                    confusion(nbTargets, estLabels(ox, oy, 0))
+                                        += 1;
                                 }
                             }
-                            else {
-                                // Masked target = masked false negative
-                                // Should affect the recall
-                                confusion(target(ox, oy), nbTargets) += 1;
-                            }
-                        }
-                        else if (!mask.empty() && mask(ox, oy) == mMaskedLabel)
-                        {
-                            // Masked no target = masked false positive
-                            // Should affect the precision
-                            confusion(nbTargets, estLabels(ox, oy, 0)) += 1;
                         }
                     }
-                }
 
-                double success = 0.0;
-                double successTopN = 0.0;
-                unsigned int nbValidTargets = 0;
-
-                for (unsigned int t = 0; t < nbTargets; ++t) {
-                    if (nbLabels[t] > 0) {
-                        success += nbHits[t] / (double)nbLabels[t];
-                        successTopN += nbHitsTopN[t] / (double)nbLabels[t];
-                        ++nbValidTargets;
+                    double success = 0.0;
+                    double successTopN = 0.0;
+                    unsigned int nbValidTargets = 0;
+
+                    for (unsigned int t = 0; t < nbTargets; ++t) {
+                        if (nbLabels[t] > 0) {
+                            success += nbHits[t] / (double)nbLabels[t];
+                            successTopN += nbHitsTopN[t] / (double)nbLabels[t];
+                            ++nbValidTargets;
+
+                            // Misclassified
+                            std::map<unsigned int, std::vector<unsigned int> >
+                                ::iterator itMisclass;
+                            std::tie(itMisclass, std::ignore)
+                                = misclass.insert(std::make_pair(t,
+                                    std::vector<unsigned int>(
+                                        nbTargetsConfusion, 0U)));
+
+                            for (unsigned int e = 0; e < nbTargetsConfusion;
+                                ++e)
+                            {
+                                (*itMisclass).second[e] = confusion(t, e);
+                            }
+                        }
+                    }
 
-                        // Misclassified
+                    if (nbTargetsConfusion > nbTargets) {
                         std::map<unsigned int, std::vector<unsigned int> >
                             ::iterator itMisclass;
                         std::tie(itMisclass, std::ignore)
-                            = misclass.insert(std::make_pair(t,
-                                std::vector<unsigned int>(nbTargetsConfusion, 0U)));
+                            = misclass.insert(std::make_pair(nbTargets,
+                                std::vector<unsigned int>(
+                                    nbTargetsConfusion, 0U)));
 
                         for (unsigned int e = 0; e < nbTargetsConfusion; ++e)
-                            (*itMisclass).second[e] = confusion(t, e);
+                            (*itMisclass).second[e] = confusion(nbTargets, e);
                     }
-                }
-
-                if (nbTargetsConfusion > nbTargets) {
-                    std::map<unsigned int, std::vector<unsigned int> >
-                        ::iterator itMisclass;
-                    std::tie(itMisclass, std::ignore)
-                        = misclass.insert(std::make_pair(nbTargets,
-                            std::vector<unsigned int>(nbTargetsConfusion, 0U)));
 
-                    for (unsigned int e = 0; e < nbTargetsConfusion; ++e)
-                        (*itMisclass).second[e] = confusion(nbTargets, e);
-                }
+                    batchSuccess[batchPos] = (nbValidTargets > 0) ?
+                        (success / nbValidTargets) : 1.0;
 
-                batchSuccess[batchPos] = (nbValidTargets > 0) ?
-                    (success / nbValidTargets) : 1.0;
+                    if (mTargetTopN > 1) {
+                        batchTopNSuccess[batchPos] = (nbValidTargets > 0) ?
+                            (successTopN / nbValidTargets) : 1.0;
+                    }
 
-                if (mTargetTopN > 1) {
-                    batchTopNSuccess[batchPos] = (nbValidTargets > 0) ?
-                        (successTopN / nbValidTargets) : 1.0;
+                    threadConfusion += confusion;
                 }
 
-#pragma omp critical(TargetScore__process_confusionMatrix)
-                std::transform(confusionMatrix.begin(), confusionMatrix.end(),
-                            confusion.begin(),
-                            confusionMatrix.begin(),
-                            std::plus<unsigned long long int>());
+                threadMisclassified.push_back(std::make_pair(id,
+                    std::map<unsigned int, std::vector<unsigned int> >()));
+                threadMisclassified.back().second.swap(misclass);
             }
 
-#pragma omp critical(TargetScore__process_misclassified)
-            misclassified[id].swap(misclass);
+#pragma omp critical(TargetScore__process_confusionMatrix)
+            {
+                confusionMatrix += threadConfusion;
+
+                for (std::vector<std::pair<int, std::map<unsigned int,
+                        std::vector<unsigned int> > > >::iterator it
+                     = threadMisclassified.begin(),
+                     itEnd = threadMisclassified.end(); it != itEnd; ++it)
+                {
+                    misclassified[(*it).first].swap((*it).second);
+                }
+            }
         }
     }
 
@@ -64,3 +64,114 @@ void N2D2::CompositeTransformation::iterTransformations(
         func(*(*it));
     }
 }
+
+void N2D2::CompositeTransformation::applyFused(cv::Mat& frame,
+                                               cv::Mat& labels,
+                                               std::vector
+                                               <std::shared_ptr<ROI> >&
+                                                    labelsROI,
+                                               int id)
+{
+    const Warp noWarp;
+
+    for (std::vector<std::shared_ptr<Transformation> >::const_iterator it
+         = mTransformationSet.begin(),
+         itEnd = mTransformationSet.end();
+         it != itEnd; )
+    {
+        // Run of consecutive geometric transformations
+        std::vector<std::shared_ptr<Transformation> >::const_iterator itRun
+            = it;
+
+        while (itRun != itEnd && (*itRun)->isWarpable(noWarp))
+            ++itRun;
+
+        // cv::warpAffine() handles up to 4 channels, and the labels matrix
+        // must have the same size as the frame
+        const bool fusable = (itRun - it >= 2)
+            && frame.channels() <= 4
+            && frame.depth() != CV_8S && frame.depth() != CV_32S
+            && ((labels.rows <= 1 && labels.cols <= 1)
+                || labels.size() == frame.size());
+
+        if (!fusable) {
+            // Nothing to fuse, apply the transformations one by one
+            if (itRun == it)
+                ++itRun;
+
+            for (; it != itRun; ++it)
+                (*it)->apply(frame, labels, labelsROI, id);
+
+            continue;
+        }
+
+        Warp warp(frame.size());
+
+        for (; it != itRun; ++it) {
+            if (!(*it)->isWarpable(warp)) {
+                // Incompatible interpolation or border: resample the frame
+                // and start a new warp
+                applyWarp(warp, frame, labels);
+                warp = Warp(frame.size());
+
+                if (!(*it)->isWarpable(warp)) {
+                    (*it)->apply(frame, labels, labelsROI, id);
+                    continue;
+                }
+            }
+
+            (*it)->warp(warp, labelsROI, id);
+        }
+
+        applyWarp(warp, frame, labels);
+    }
+}
+
+void N2D2::CompositeTransformation::applyWarp(const Warp& warp,
+                                              cv::Mat& frame,
+                                              cv::Mat& labels)
+{
+    if (warp.matrix == cv::Matx33d::eye() && warp.size == frame.size())
+        return;
+
+    // Without resampling step, the mapping is made of integer translations
+    // and flips only, for which the nearest interpolation is exact
+    const int interpolation = (warp.interpolation >= 0)
+        ? warp.interpolation : (int)cv::INTER_NEAREST;
+    const int borderType = (warp.borderType >= 0)
+        ? warp.borderType : (int)cv::BORDER_CONSTANT;
+    const bool affine = (warp.matrix(2, 0) == 0.0
+                         && warp.matrix(2, 1) == 0.0
+                         && warp.matrix(2, 2) == 1.0);
+    const cv::Mat matrix(warp.matrix);
+
+    cv::Mat frameWarped;
+
+    if (affine) {
+        cv::warpAffine(frame, frameWarped, matrix.rowRange(0, 2), warp.size,
+                       interpolation, borderType, warp.borderValue);
+    }
+    else {
+        cv::warpPerspective(frame, frameWarped, matrix, warp.size,
+                            interpolation, borderType, warp.borderValue);
+    }
+
+    frame = frameWarped;
+
+    if (labels.rows > 1 || labels.cols > 1) {
+        cv::Mat labelsWarped;
+
+        if (affine) {
+            cv::warpAffine(labels, labelsWarped, matrix.rowRange(0, 2),
+                           warp.size, cv::INTER_NEAREST, cv::BORDER_CONSTANT,
+                           cv::Scalar::all(-1));
+        }
+        else {
+            cv::warpPerspective(labels, labelsWarped, matrix, warp.size,
+                                cv::INTER_NEAREST, cv::BORDER_CONSTANT,
+                                cv::Scalar::all(-1));
+        }
+
+        labels = labelsWarped;
+    }
+}
@@ -74,6 +74,35 @@ void N2D2::FlipTransformation::apply(cv::Mat& frame,
                             frameVerticalFlip));
 }
 
+void N2D2::FlipTransformation::warp(Warp& warp,
+                                    std::vector
+                                    <std::shared_ptr<ROI> >& labelsROI,
+                                    int /*id*/)
+{
+    const bool frameHorizontalFlip
+        = (mRandomHorizontalFlip) ? Random::randUniform(0, 1) : mHorizontalFlip;
+    const bool frameVerticalFlip
+        = (mRandomVerticalFlip) ? Random::randUniform(0, 1) : mVerticalFlip;
+
+    const cv::Matx33d flipMatrix(
+        (frameHorizontalFlip) ? -1.0 : 1.0, 0.0,
+        (frameHorizontalFlip) ? warp.size.width - 1.0 : 0.0,
+        0.0, (frameVerticalFlip) ? -1.0 : 1.0,
+        (frameVerticalFlip) ? warp.size.height - 1.0 : 0.0,
+        0.0, 0.0, 1.0);
+
+    warp.matrix = flipMatrix * warp.matrix;
+
+    std::for_each(labelsROI.begin(),
+                  labelsROI.end(),
+                  std::bind(&ROI::flip,
+                            std::placeholders::_1,
+                            warp.size.width,
+                            warp.size.height,
+                            frameHorizontalFlip,
+                            frameVerticalFlip));
+}
+
 void N2D2::FlipTransformation::reverse(cv::Mat& frame,
                                        cv::Mat& labels,
                                        std::vector
@@ -99,6 +99,52 @@ void N2D2::PadCropTransformation::reverse(cv::Mat& frame,
             labelsROI);
 }
 
+bool N2D2::PadCropTransformation::isWarpable(const Warp& warp) const
+{
+    if (mBorderType == MeanBorder)
+        return false;
+
+    const int width = (mAdditiveWH) ? warp.size.width + mWidth : mWidth;
+    const int height = (mAdditiveWH) ? warp.size.height + mHeight : mHeight;
+
+    // A single border can be composed
+    return (warp.borderType < 0
+            || (width <= warp.size.width && height <= warp.size.height));
+}
+
+void N2D2::PadCropTransformation::warp(Warp& warp,
+                                       std::vector
+                                       <std::shared_ptr<ROI> >& labelsROI,
+                                       int /*id*/)
+{
+    const int width = (mAdditiveWH) ? warp.size.width + mWidth : mWidth;
+    const int height = (mAdditiveWH) ? warp.size.height + mHeight : mHeight;
+
+    const int dw = width - warp.size.width;
+    const int dh = height - warp.size.height;
+
+    const int top = std::ceil(dh / 2.0);
+    const int left = std::ceil(dw / 2.0);
+
+    const cv::Matx33d translation(1.0, 0.0, left,
+                                  0.0, 1.0, top,
+                                  0.0, 0.0, 1.0);
+
+    warp.matrix = translation * warp.matrix;
+    warp.size = cv::Size(width, height);
+
+    if (dw > 0 || dh > 0) {
+        std::vector<double> bgColorValue = mBorderValue;
+        bgColorValue.resize(4, 0.0);
+
+        warp.borderType = mBorderType;
+        warp.borderValue = cv::Scalar(bgColorValue[0], bgColorValue[1],
+                                      bgColorValue[2], bgColorValue[3]);
+    }
+
+    padCropLabelsROI(labelsROI, -left, -top, width, height);
+}
+
 void
 N2D2::PadCropTransformation::padCrop(cv::Mat& mat,
                                      unsigned int matWidth,
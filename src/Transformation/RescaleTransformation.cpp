@@ -88,32 +88,57 @@ void N2D2::RescaleTransformation::reverse(cv::Mat& frame,
         std::bind(&ROI::rescale, std::placeholders::_1, xRatio, yRatio));
 }
 
+bool N2D2::RescaleTransformation::isWarpable(const Warp& warp) const
+{
+    if (warp.interpolation >= 0 && warp.interpolation != cv::INTER_LINEAR)
+        return false;
+
+    if (mKeepAspectRatio && warp.size.area() > 0) {
+        double xRatio, yRatio;
+        return (getResizedSize(warp.size, xRatio, yRatio).area() > 0);
+    }
+
+    return true;
+}
+
+void N2D2::RescaleTransformation::warp(Warp& warp,
+                                       std::vector
+                                       <std::shared_ptr<ROI> >& labelsROI,
+                                       int /*id*/)
+{
+    double xRatio, yRatio;
+    const cv::Size size = getResizedSize(warp.size, xRatio, yRatio);
+
+    // Same pixel centers alignment as cv::resize()
+    const double sx = size.width / (double)warp.size.width;
+    const double sy = size.height / (double)warp.size.height;
+    const cv::Matx33d scale(sx, 0.0, 0.5 * (sx - 1.0),
+                            0.0, sy, 0.5 * (sy - 1.0),
+                            0.0, 0.0, 1.0);
+
+    warp.matrix = scale * warp.matrix;
+    warp.size = size;
+    warp.interpolation = cv::INTER_LINEAR;
+
+    std::for_each(
+        labelsROI.begin(),
+        labelsROI.end(),
+        std::bind(&ROI::rescale, std::placeholders::_1, xRatio, yRatio));
+}
+
 void
 N2D2::RescaleTransformation::resize(cv::Mat& mat,
                                     int interpolation,
                                     std::vector
                                     <std::shared_ptr<ROI> >& labelsROI) const
 {
-    cv::Mat matResized;
+    double xRatio, yRatio;
+    const cv::Size size = getResizedSize(mat.size(), xRatio, yRatio);
 
-    double xRatio = mWidth / (double)mat.cols;
-    double yRatio = mHeight / (double)mat.rows;
-
-    if (mKeepAspectRatio) {
-        const double ratio = (mResizeToFit) ? std::min(xRatio, yRatio)
-                                            : std::max(xRatio, yRatio);
-        xRatio = yRatio = ratio;
+    cv::Mat matResized;
 
-        if (ratio * mat.cols >= 1.0 && ratio * mat.rows >= 1.0)
-            cv::resize(mat,
-                       matResized,
-                       cv::Size(ratio * mat.cols, ratio * mat.rows),
-                       0,
-                       0,
-                       interpolation);
-    } else
-        cv::resize(
-            mat, matResized, cv::Size(mWidth, mHeight), 0, 0, interpolation);
+    if (!mKeepAspectRatio || size.area() > 0)
+        cv::resize(mat, matResized, size, 0, 0, interpolation);
 
     std::for_each(
         labelsROI.begin(),
@@ -122,3 +147,24 @@ N2D2::RescaleTransformation::resize(cv::Mat& mat,
 
     mat = matResized;
 }
+
+cv::Size N2D2::RescaleTransformation::getResizedSize(const cv::Size& size,
+                                                     double& xRatio,
+                                                     double& yRatio) const
+{
+    xRatio = mWidth / (double)size.width;
+    yRatio = mHeight / (double)size.height;
+
+    if (mKeepAspectRatio) {
+        const double ratio = (mResizeToFit) ? std::min(xRatio, yRatio)
+                                            : std::max(xRatio, yRatio);
+        xRatio = yRatio = ratio;
+
+        if (ratio * size.width >= 1.0 && ratio * size.height >= 1.0)
+            return cv::Size(ratio * size.width, ratio * size.height);
+        else
+            return cv::Size();
+    }
+    else
+        return cv::Size(mWidth, mHeight);
+}
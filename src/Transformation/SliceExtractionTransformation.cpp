@@ -74,47 +74,13 @@ N2D2::SliceExtractionTransformation::apply(cv::Mat& frame,
                                            <std::shared_ptr<ROI> >& labelsROI,
                                            int id)
 {
-    if (mRandomScaling && mRandomScalingRange->size() != 2) {
-        throw std::runtime_error("SliceExtractionTransformation::apply(): "
-                                 "RandomScalingRange must have two value "
-                                 "(\"min max\")");
-    }
-
-    const double scaling = (mRandomScaling)
-        ? Random::randUniform(*(mRandomScalingRange->begin()),
-                              *(mRandomScalingRange->begin() + 1))
-        : 1.0;
+    double scaling;
+    unsigned int targetWidth, targetHeight;
+    unsigned int width, height;
+    unsigned int frameOffsetX, frameOffsetY;
 
-    const unsigned int targetWidth
-        = (mWidth > 0) ? mWidth : frame.cols / scaling;
-    const unsigned int targetHeight
-        = (mHeight > 0) ? mHeight : frame.rows / scaling;
-    const unsigned int width = Utils::round(targetWidth * scaling);
-    const unsigned int height = Utils::round(targetHeight * scaling);
-
-    const unsigned int frameOffsetX
-        = (mRandomOffsetX) ? ((frame.cols > (int)width)
-                                  ? Random::randUniform(0, frame.cols - width)
-                                  : 0)
-                           : mOffsetX;
-    const unsigned int frameOffsetY
-        = (mRandomOffsetY) ? ((frame.rows > (int)height)
-                                  ? Random::randUniform(0, frame.rows - height)
-                                  : 0)
-                           : mOffsetY;
-
-    const int padWidth = (int)frameOffsetX + width - frame.cols;
-    const int padHeight = (int)frameOffsetY + height - frame.rows;
-
-    if ((padWidth > 0 || padHeight > 0) && !mAllowPadding) {
-        std::ostringstream msgStr;
-        msgStr << "SliceExtractionTransformation::apply(): cannot extract a"
-            " slice with an image size (" << frame.cols << "x" << frame.rows
-            << ") smaller than the slice size (" << width << "x" << height
-            << "), when padding is not allowed";
-
-        throw std::runtime_error(msgStr.str());
-    }
+    randomSlice(frame.size(), scaling, targetWidth, targetHeight,
+                width, height, frameOffsetX, frameOffsetY);
 
     if (mRandomRotation && mRandomRotationRange->size() != 2) {
         throw std::runtime_error("SliceExtractionTransformation::apply(): "
@@ -173,6 +139,123 @@ N2D2::SliceExtractionTransformation::apply(cv::Mat& frame,
     }
 }
 
+bool N2D2::SliceExtractionTransformation::isWarpable(const Warp& warp) const
+{
+    // Random rotations are applied on a padded bounding box of the slice
+    return (!mRandomRotation
+            && mBorderType != MeanBorder
+            && (!mRandomScaling || warp.interpolation < 0
+                || warp.interpolation == cv::INTER_LINEAR)
+            && (!mAllowPadding || warp.borderType < 0));
+}
+
+void N2D2::SliceExtractionTransformation::warp(Warp& warp,
+                                               std::vector
+                                               <std::shared_ptr<ROI> >&
+                                                    labelsROI,
+                                               int /*id*/)
+{
+    double scaling;
+    unsigned int targetWidth, targetHeight;
+    unsigned int width, height;
+    unsigned int offsetX, offsetY;
+
+    const bool padding = randomSlice(warp.size, scaling,
+                                     targetWidth, targetHeight,
+                                     width, height, offsetX, offsetY);
+
+    const cv::Matx33d translation(1.0, 0.0, -(double)offsetX,
+                                  0.0, 1.0, -(double)offsetY,
+                                  0.0, 0.0, 1.0);
+
+    warp.matrix = translation * warp.matrix;
+    warp.size = cv::Size(width, height);
+
+    if (padding) {
+        std::vector<double> bgColorValue = mBorderValue;
+        bgColorValue.resize(4, 0.0);
+
+        warp.borderType = mBorderType;
+        warp.borderValue = cv::Scalar(bgColorValue[0], bgColorValue[1],
+                                      bgColorValue[2], bgColorValue[3]);
+    }
+
+    padCropLabelsROI(labelsROI, offsetX, offsetY, width, height);
+
+    if (scaling != 1.0) {
+        // Same pixel centers alignment as cv::resize()
+        const double sx = targetWidth / (double)width;
+        const double sy = targetHeight / (double)height;
+        const cv::Matx33d scale(sx, 0.0, 0.5 * (sx - 1.0),
+                                0.0, sy, 0.5 * (sy - 1.0),
+                                0.0, 0.0, 1.0);
+
+        warp.matrix = scale * warp.matrix;
+        warp.size = cv::Size(targetWidth, targetHeight);
+        warp.interpolation = cv::INTER_LINEAR;
+
+        std::for_each(
+            labelsROI.begin(),
+            labelsROI.end(),
+            std::bind(&ROI::rescale, std::placeholders::_1, sx, sy));
+    }
+}
+
+bool N2D2::SliceExtractionTransformation::randomSlice(const cv::Size& size,
+                                                      double& scaling,
+                                                      unsigned int&
+                                                        targetWidth,
+                                                      unsigned int&
+                                                        targetHeight,
+                                                      unsigned int& width,
+                                                      unsigned int& height,
+                                                      unsigned int& offsetX,
+                                                      unsigned int& offsetY)
+    const
+{
+    if (mRandomScaling && mRandomScalingRange->size() != 2) {
+        throw std::runtime_error("SliceExtractionTransformation::apply(): "
+                                 "RandomScalingRange must have two value "
+                                 "(\"min max\")");
+    }
+
+    scaling = (mRandomScaling)
+        ? Random::randUniform(*(mRandomScalingRange->begin()),
+                              *(mRandomScalingRange->begin() + 1))
+        : 1.0;
+
+    targetWidth = (mWidth > 0) ? mWidth : size.width / scaling;
+    targetHeight = (mHeight > 0) ? mHeight : size.height / scaling;
+    width = Utils::round(targetWidth * scaling);
+    height = Utils::round(targetHeight * scaling);
+
+    offsetX = (mRandomOffsetX) ? ((size.width > (int)width)
+                            ? Random::randUniform(0, size.width - width)
+                            : 0)
+                      : mOffsetX;
+    offsetY = (mRandomOffsetY) ? ((size.height > (int)height)
+                            ? Random::randUniform(0, size.height - height)
+                            : 0)
+                      : mOffsetY;
+
+    const int padWidth = (int)offsetX + width - size.width;
+    const int padHeight = (int)offsetY + height - size.height;
+
+    if ((padWidth > 0 || padHeight > 0) && !mAllowPadding) {
+        std::ostringstream msgStr;
+        msgStr << "SliceExtractionTransformation::apply(): cannot extract a"
+            " slice with an image size (" << size.width << "x" << size.height
+            << ") smaller than the slice size (" << width << "x" << height
+            << "), when padding is not allowed";
+
+        throw std::runtime_error(msgStr.str());
+    }
+
+    return (padWidth > 0 || padHeight > 0);
+
+
+}
+
 void
 N2D2::SliceExtractionTransformation::reverse(cv::Mat& frame,
                                              cv::Mat& labels,
@@ -23,8 +23,17 @@
 
 #include "Xnet/NodeNeuron.hpp"
 #include "Xnet/SpikeEvent.hpp"
+#include "Xnet/SpikeEventQueue.hpp"
 #include "Xnet/Xcell.hpp"
 
+#include <exception>
+#include <limits>
+#include <map>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace N2D2 {
 const Time_T TimeFs = 1;
 const Time_T TimePs = 1000 * TimeFs;
@@ -87,12 +96,24 @@ N2D2::NetworkObserver::~NetworkObserver()
     mNet.removeObserver(this);
 }
 
-N2D2::Network::Network(unsigned int seed, bool saveSeed, bool printTimeElapsed)
-    : mInitialized(false),
+N2D2::Network::Network(unsigned int seed,
+                       bool saveSeed,
+                       bool printTimeElapsed,
+                       EventScheduler scheduler,
+                       Time_T wheelResolution)
+    : mScheduler(scheduler),
+      mWheelResolution(wheelResolution),
+      mInitialized(false),
       mFirstEvent(0),
       mLastEvent(0),
       mStop(0),
       mDiscard(false),
+      mNbThreads(1),
+      mPartitionsValid(false),
+      mNbPartitions(1),
+      mLookahead(0),
+      mParallelRun(false),
+      mWindowEnd(0),
       mStartTime(std::chrono::high_resolution_clock::now()),
       mSaveSeed(saveSeed),
       mPrintTimeElapsed(printTimeElapsed)
@@ -136,7 +157,9 @@ N2D2::Network::Network(unsigned int seed, bool saveSeed, bool printTimeElapsed)
         seedFile << seed;
         seedFile.close();
     }
-    
+
+    mQueues.push_back(std::make_shared<SpikeEventQueue>(mScheduler,
+                                                        mWheelResolution));
 }
 
 bool N2D2::Network::run(Time_T stop, bool clearActivity)
@@ -155,60 +178,21 @@ bool N2D2::Network::run(Time_T stop, bool clearActivity)
         mInitialized = true;
     }
 
-    SpikeEvent* event;
-    bool stopped = false;
-
-    if (!mEvents.empty())
-        mFirstEvent = mEvents.top()->getTimestamp();
-
     mStop = stop;
     mDiscard = false;
 
-    while (!mEvents.empty()) {
-        event = mEvents.top();
-
-        if (event->isDiscarded()) {
-            mEvents.pop();
-            mEventsPool.push(event);
-            continue;
-        }
-
-        // Safety check
-        if (event->getTimestamp() < mLastEvent) {
-            std::ostringstream errorMsg;
-            errorMsg
-                << "Cannot go back in time! I want to deal with event at time "
-                << event->getTimestamp() << " whereas last event was at "
-                << mLastEvent << ", type is " << event->getType();
-            throw std::runtime_error(errorMsg.str());
-        }
-
-        if (mStop > 0 && event->getTimestamp() >= mStop) {
-            // In this case, the event should not be released. It must be kept
-            // in the priority queue.
-            // mLastEvent should not be changed either, because if one loads new
-            // events starting from mStop afterward, and the
-            // timestamp of this event if > mStop, we have a completely
-            // legitimate "cannot go back in time" error!
-            stopped = true;
-            break;
-        }
+    if (mNbThreads > 1 && !isPartitioningValid())
+        partition();
 
-        // On supprime d'abord l'évènement de la priority_queue avant de le
-        // traiter. Dans le cas limite où la fonction release()
-        // crérait un nouvel évènement au même timestamp que l'évènement
-        // courant, celui-ci pourrait se retrouver en haut de la
-        // queue si bien que si on faisait dans ce cas le pop() après le
-        // release(), on risque de supprimer le mauvais évènement.
-        mEvents.pop();
-        mLastEvent = event->release();
-        mEventsPool.push(event);
-    }
+    const bool stopped = (mNbThreads > 1 && mNbPartitions > 1 && !canStop())
+        ? runParallel()
+        : runSequential();
 
     if (mDiscard) {
-        while (!mEvents.empty()) {
-            mEventsPool.push(mEvents.top());
-            mEvents.pop();
+        for (std::vector<std::shared_ptr<SpikeEventQueue> >::const_iterator it
+             = mQueues.begin(), itEnd = mQueues.end(); it != itEnd; ++it)
+        {
+            (*it)->clear();
         }
     }
 
@@ -222,6 +206,33 @@ bool N2D2::Network::run(Time_T stop, bool clearActivity)
     return stopped;
 }
 
+void N2D2::Network::stop(Time_T stop, bool discard)
+{
+    if (mParallelRun) {
+        // Several partitions may request a stop in the same time window
+#pragma omp critical(Network__stop)
+        {
+            if (stop > 0 && (mStop == 0 || stop < mStop)) {
+                // Read by the other partitions at each event
+#pragma omp atomic write
+                mStop = stop;
+            }
+
+            mDiscard = (mDiscard || discard);
+        }
+    }
+    else {
+        mStop = stop;
+        mDiscard = discard;
+    }
+}
+
+void N2D2::Network::setNbThreads(unsigned int nbThreads)
+{
+    mNbThreads = nbThreads;
+    mPartitionsValid = false;
+}
+
 void N2D2::Network::reset(Time_T timestamp)
 {
     mFirstEvent = timestamp;
@@ -263,11 +274,13 @@ void N2D2::Network::load(const std::string& dirName)
 void N2D2::Network::addObserver(NetworkObserver* obs)
 {
     mObservers.insert(obs);
+    mPartitionsValid = false;
 }
 
 void N2D2::Network::removeObserver(NetworkObserver* obs)
 {
     mObservers.erase(obs);
+    mPartitionsValid = false;
 }
 
 N2D2::SpikeEvent* N2D2::Network::newEvent(Node* origin,
@@ -275,28 +288,522 @@ N2D2::SpikeEvent* N2D2::Network::newEvent(Node* origin,
                                           Time_T timestamp,
                                           EventType_T type)
 {
-    SpikeEvent* event;
+#ifdef _OPENMP
+    if (mParallelRun) {
+        const unsigned int partition = omp_get_thread_num();
+        SpikeEventQueue& queue = *mQueues[partition];
+        SpikeEvent* event
+            = queue.newEvent(origin, destination, timestamp, type);
+        const unsigned int target = ((destination != NULL) ? destination
+                                                           : origin)
+                                        ->getPartition();
+
+        if (target == partition)
+            queue.push(event);
+        else {
+            if (timestamp < mWindowEnd) {
+                queue.recycle(event);
+
+                std::ostringstream errorMsg;
+                errorMsg << "Network::newEvent(): event at time " << timestamp
+                    << " for another partition before the end of the current"
+                    " time window (" << mWindowEnd << "), the synaptic delay"
+                    " is lower than the lookahead";
+                throw std::runtime_error(errorMsg.str());
+            }
+
+            // Delivered at the end of the time window
+            mOutbox[partition][target].push_back(event);
+        }
 
-    if (mEventsPool.empty())
-        event = new SpikeEvent(origin, destination, timestamp, type);
-    else {
-        event = mEventsPool.top();
-        mEventsPool.pop();
-        event->initialize(origin, destination, timestamp, type);
+        return event;
     }
+#endif
 
-    mEvents.push(event);
+    SpikeEventQueue& queue = *mQueues[0];
+    SpikeEvent* event = queue.newEvent(origin, destination, timestamp, type);
+    queue.push(event);
     return event;
 }
 
-N2D2::Network::~Network()
+bool N2D2::Network::runSequential()
 {
-    // dtor
-    while (!mEventsPool.empty()) {
-        delete mEventsPool.top();
-        mEventsPool.pop();
+    // Events may remain in the queues of a previous parallel simulation
+    if (mQueues.size() > 1)
+        distributeEvents(1);
+
+    SpikeEventQueue& queue = *mQueues[0];
+    SpikeEvent* event = queue.top();
+    bool stopped = false;
+
+    if (event != NULL)
+        mFirstEvent = event->getTimestamp();
+
+    while ((event = queue.top()) != NULL) {
+        if (event->isDiscarded()) {
+            queue.pop();
+            queue.recycle(event);
+            continue;
+        }
+
+        // Safety check
+        if (event->getTimestamp() < mLastEvent) {
+            std::ostringstream errorMsg;
+            errorMsg
+                << "Cannot go back in time! I want to deal with event at time "
+                << event->getTimestamp() << " whereas last event was at "
+                << mLastEvent << ", type is " << event->getType();
+            throw std::runtime_error(errorMsg.str());
+        }
+
+        if (mStop > 0 && event->getTimestamp() >= mStop) {
+            // In this case, the event should not be released. It must be kept
+            // in the priority queue.
+            // mLastEvent should not be changed either, because if one loads new
+            // events starting from mStop afterward, and the
+            // timestamp of this event if > mStop, we have a completely
+            // legitimate "cannot go back in time" error!
+            stopped = true;
+            break;
+        }
+
+        // On supprime d'abord l'évènement de la priority_queue avant de le
+        // traiter. Dans le cas limite où la fonction release()
+        // crérait un nouvel évènement au même timestamp que l'évènement
+        // courant, celui-ci pourrait se retrouver en haut de la
+        // queue si bien que si on faisait dans ce cas le pop() après le
+        // release(), on risque de supprimer le mauvais évènement.
+        queue.pop();
+        mLastEvent = event->release();
+        queue.recycle(event);
+    }
+
+    return stopped;
+}
+
+bool N2D2::Network::runParallel()
+{
+#ifdef _OPENMP
+    distributeEvents(mNbPartitions);
+
+    const unsigned int nbPartitions = mNbPartitions;
+    std::vector<Time_T> lastEvents(nbPartitions, mLastEvent);
+    std::exception_ptr error;
+    bool firstWindow = true;
+    bool stopped = false;
+    bool done = false;
+    bool nbThreadsValid = true;
+
+    mParallelRun = true;
+
+#pragma omp parallel num_threads(nbPartitions)
+    {
+        const unsigned int partition = omp_get_thread_num();
+        SpikeEventQueue& queue = *mQueues[partition];
+
+        // Each partition requires its own thread (they may be limited by the
+        // OpenMP settings or in a nested parallel region)
+        if (omp_get_num_threads() != (int)nbPartitions) {
+#pragma omp single
+            nbThreadsValid = false;
+        }
+
+        while (nbThreadsValid) {
+#pragma omp single
+            {
+                // The next time window starts at the earliest event of all
+                // the partitions
+                SpikeEvent* first = NULL;
+
+                for (unsigned int p = 0; p < nbPartitions; ++p) {
+                    SpikeEvent* event = mQueues[p]->top();
+
+                    if (event != NULL && (first == NULL
+                        || event->getTimestamp() < first->getTimestamp()))
+                    {
+                        first = event;
+                    }
+                }
+
+                if (error || first == NULL)
+                    done = true;
+                else {
+                    const Time_T windowStart = first->getTimestamp();
+
+                    if (firstWindow) {
+                        mFirstEvent = windowStart;
+                        firstWindow = false;
+                    }
+
+                    if (mStop > 0 && windowStart >= mStop) {
+                        stopped = true;
+                        done = true;
+                    }
+                    else {
+                        mWindowEnd = (windowStart
+                            < std::numeric_limits<Time_T>::max() - mLookahead)
+                                ? windowStart + mLookahead
+                                : std::numeric_limits<Time_T>::max();
+
+                        if (mStop > 0 && mStop < mWindowEnd)
+                            mWindowEnd = mStop;
+                    }
+                }
+            }
+
+            if (done)
+                break;
+
+            // Events of the partition in the time window: they cannot be
+            // affected by the other partitions
+            try {
+                SpikeEvent* event;
+
+                while ((event = queue.top()) != NULL
+                       && event->getTimestamp() < mWindowEnd)
+                {
+                    // A stop may be requested by any partition during the
+                    // time window
+                    Time_T stop;
+#pragma omp atomic read
+                    stop = mStop;
+
+                    if (stop > 0 && event->getTimestamp() >= stop)
+                        break;
+
+                    queue.pop();
+
+                    if (!event->isDiscarded()) {
+                        if (event->getTimestamp() < lastEvents[partition]) {
+                            std::ostringstream errorMsg;
+                            errorMsg << "Cannot go back in time! I want to"
+                                " deal with event at time "
+                                << event->getTimestamp() << " whereas last"
+                                " event was at " << lastEvents[partition]
+                                << ", type is " << event->getType();
+                            throw std::runtime_error(errorMsg.str());
+                        }
+
+                        lastEvents[partition] = event->release();
+                    }
+
+                    queue.recycle(event);
+                }
+            }
+            catch (...) {
+#pragma omp critical(Network__runParallel)
+                {
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+
+#pragma omp barrier
+
+            // Events created by the other partitions during the time window
+            for (unsigned int p = 0; p < nbPartitions; ++p) {
+                std::vector<SpikeEvent*>& events = mOutbox[p][partition];
+
+                for (std::vector<SpikeEvent*>::const_iterator it
+                     = events.begin(), itEnd = events.end(); it != itEnd; ++it)
+                {
+                    queue.push(*it);
+                }
+
+                events.clear();
+            }
+
+#pragma omp barrier
+        }
+    }
+
+    mParallelRun = false;
+
+    if (!nbThreadsValid)
+        return runSequential();
+
+    // The nodes of a partition are only recorded by this partition, in the
+    // order of the sequential simulation
+    for (unsigned int p = 0; p < nbPartitions; ++p) {
+        for (std::unordered_map<NodeId_T, NodeEvents_T>::const_iterator it
+             = mPartitionsRecording[p].begin(),
+             itEnd = mPartitionsRecording[p].end(); it != itEnd; ++it)
+        {
+            NodeEvents_T& record = mSpikeRecording[(*it).first];
+            record.insert(record.end(), (*it).second.begin(),
+                          (*it).second.end());
+        }
+
+        mPartitionsRecording[p].clear();
+    }
+
+    mLastEvent = *std::max_element(lastEvents.begin(), lastEvents.end());
+
+    if (error)
+        std::rethrow_exception(error);
+
+    return stopped;
+#else
+    return runSequential();
+#endif
+}
+
+bool N2D2::Network::isPartitioningValid() const
+{
+    if (!mPartitionsValid)
+        return false;
+
+    for (std::vector<std::pair<NodeNeuron*, unsigned int> >::const_iterator it
+         = mLinkDelayStates.begin(), itEnd = mLinkDelayStates.end();
+         it != itEnd; ++it)
+    {
+        if ((*it).first->getLinkDelayState() != (*it).second)
+            return false;
+    }
+
+    return true;
+}
+
+bool N2D2::Network::canStop() const
+{
+    for (std::set<NetworkObserver*>::const_iterator it = mObservers.begin(),
+         itEnd = mObservers.end(); it != itEnd; ++it)
+    {
+        if ((*it)->canStop())
+            return true;
+    }
+
+    return false;
+}
+
+void N2D2::Network::recordSpikeParallel(NodeId_T nodeId,
+                                        Time_T timestamp,
+                                        EventType_T type)
+{
+#ifdef _OPENMP
+    mPartitionsRecording[omp_get_thread_num()][nodeId]
+        .push_back(std::make_pair(timestamp, type));
+#else
+    mSpikeRecording[nodeId].push_back(std::make_pair(timestamp, type));
+#endif
+}
+
+void N2D2::Network::distributeEvents(unsigned int nbQueues)
+{
+    std::vector<SpikeEvent*> events;
+
+    // The events scheduled outside of a parallel simulation are all in the
+    // first queue
+    for (unsigned int q = (nbQueues > 1) ? 0 : 1; q < mQueues.size(); ++q)
+        mQueues[q]->drain(events);
+
+    for (std::vector<SpikeEvent*>::const_iterator it = events.begin(),
+         itEnd = events.end(); it != itEnd; ++it)
+    {
+        const Node* node = ((*it)->getDestination() != NULL)
+            ? (*it)->getDestination() : (*it)->getOrigin();
+
+        mQueues[(nbQueues > 1) ? node->getPartition() : 0]->push(*it);
+    }
+}
+
+namespace N2D2 {
+unsigned int findPartitionRoot(std::vector<unsigned int>& parents,
+                               unsigned int index)
+{
+    while (parents[index] != index) {
+        parents[index] = parents[parents[index]];
+        index = parents[index];
+    }
+
+    return index;
+}
+
+void mergePartitions(std::vector<unsigned int>& parents,
+                     unsigned int index1,
+                     unsigned int index2)
+{
+    const unsigned int root1 = findPartitionRoot(parents, index1);
+    const unsigned int root2 = findPartitionRoot(parents, index2);
+
+    // The root is the node with the lowest ID, for a deterministic
+    // partitioning
+    if (root1 < root2)
+        parents[root2] = root1;
+    else if (root2 < root1)
+        parents[root1] = root2;
+}
+}
+
+void N2D2::Network::partition()
+{
+    // Nodes of the network, in a deterministic order
+    std::vector<Node*> nodes;
+
+    for (std::set<NetworkObserver*>::const_iterator it = mObservers.begin(),
+         itEnd = mObservers.end(); it != itEnd; ++it)
+    {
+        Node* node = dynamic_cast<Node*>(*it);
+
+        if (node != NULL)
+            nodes.push_back(node);
     }
 
+    std::sort(nodes.begin(), nodes.end(),
+              [](Node* node1, Node* node2)
+                { return (node1->getId() < node2->getId()); });
+
+    std::unordered_map<Node*, unsigned int> indexes;
+
+    for (unsigned int i = 0; i < nodes.size(); ++i)
+        indexes[nodes[i]] = i;
+
+    // Nodes interacting synchronously must be in the same partition
+    std::vector<unsigned int> parents(nodes.size());
+
+    for (unsigned int i = 0; i < nodes.size(); ++i)
+        parents[i] = i;
+
+    int sequential = -1;
+    mLinkDelayStates.clear();
+
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+        NodeNeuron* neuron = dynamic_cast<NodeNeuron*>(nodes[i]);
+
+        if (neuron != NULL) {
+            const bool parallelizable = neuron->isParallelizable();
+
+            if (parallelizable) {
+                mLinkDelayStates.push_back(std::make_pair(neuron,
+                                            neuron->getLinkDelayState()));
+            }
+
+            // All the non parallelizable neurons are simulated together
+            if (!parallelizable) {
+                if (sequential < 0)
+                    sequential = i;
+                else
+                    mergePartitions(parents, i, sequential);
+            }
+
+            const std::vector<NodeNeuron*>& lateralBranches
+                = neuron->getLateralBranches();
+
+            for (std::vector<NodeNeuron*>::const_iterator it
+                 = lateralBranches.begin(), itEnd = lateralBranches.end();
+                 it != itEnd; ++it)
+            {
+                mergePartitions(parents, i, indexes.at(*it));
+            }
+
+            const std::vector<Node*>& links = neuron->getLinkOrigins();
+
+            for (std::vector<Node*>::const_iterator it = links.begin(),
+                 itEnd = links.end(); it != itEnd; ++it)
+            {
+                if (!parallelizable || neuron->getLinkDelay(*it) == 0)
+                    mergePartitions(parents, i, indexes.at(*it));
+            }
+        }
+
+        // The branches which are not parallelizable neurons are activated
+        // synchronously
+        const std::vector<Node*>& branches = nodes[i]->getBranches();
+
+        for (std::vector<Node*>::const_iterator it = branches.begin(),
+             itEnd = branches.end(); it != itEnd; ++it)
+        {
+            NodeNeuron* branch = dynamic_cast<NodeNeuron*>(*it);
+
+            if (branch == NULL || !branch->isParallelizable()
+                || branch->findLink(nodes[i]) < 0)
+            {
+                mergePartitions(parents, i, indexes.at(*it));
+            }
+        }
+    }
+
+    // Groups of nodes, weighted by their number of synapses
+    std::map<unsigned int, std::size_t> groups;
+
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+        const NodeNeuron* neuron = dynamic_cast<NodeNeuron*>(nodes[i]);
+
+        groups[findPartitionRoot(parents, i)]
+            += 1 + ((neuron != NULL) ? neuron->getNbLinks() : 0);
+    }
+
+    std::vector<std::pair<std::size_t, unsigned int> > sortedGroups;
+
+    for (std::map<unsigned int, std::size_t>::const_iterator it
+         = groups.begin(), itEnd = groups.end(); it != itEnd; ++it)
+    {
+        sortedGroups.push_back(std::make_pair((*it).second, (*it).first));
+    }
+
+    std::sort(sortedGroups.begin(), sortedGroups.end(),
+              [](const std::pair<std::size_t, unsigned int>& group1,
+                 const std::pair<std::size_t, unsigned int>& group2)
+                { return (group1.first > group2.first
+                          || (group1.first == group2.first
+                              && group1.second < group2.second)); });
+
+    // Largest groups first, in the least loaded partition
+    mNbPartitions = std::max(1U, std::min(mNbThreads,
+                                    (unsigned int)sortedGroups.size()));
+
+    std::vector<std::size_t> loads(mNbPartitions, 0);
+    std::map<unsigned int, unsigned int> groupsPartition;
+
+    for (std::vector<std::pair<std::size_t, unsigned int> >::const_iterator it
+         = sortedGroups.begin(), itEnd = sortedGroups.end(); it != itEnd; ++it)
+    {
+        const unsigned int p = std::distance(loads.begin(),
+                                std::min_element(loads.begin(), loads.end()));
+
+        loads[p] += (*it).first;
+        groupsPartition[(*it).second] = p;
+    }
+
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+        nodes[i]->setPartition(
+            groupsPartition[findPartitionRoot(parents, i)]);
+    }
+
+    // The lookahead is the minimum delay between two partitions
+    mLookahead = std::numeric_limits<Time_T>::max();
+
+    for (unsigned int i = 0; i < nodes.size(); ++i) {
+        const NodeNeuron* neuron = dynamic_cast<NodeNeuron*>(nodes[i]);
+
+        if (neuron == NULL)
+            continue;
+
+        const std::vector<Node*>& links = neuron->getLinkOrigins();
+
+        for (std::vector<Node*>::const_iterator it = links.begin(),
+             itEnd = links.end(); it != itEnd; ++it)
+        {
+            if ((*it)->getPartition() != neuron->getPartition()) {
+                mLookahead = std::min(mLookahead, neuron->getLinkDelay(*it));
+            }
+        }
+    }
+
+    while (mQueues.size() < mNbPartitions) {
+        mQueues.push_back(std::make_shared<SpikeEventQueue>(mScheduler,
+                                                        mWheelResolution));
+    }
+
+    mOutbox.assign(mNbPartitions,
+                   std::vector<std::vector<SpikeEvent*> >(mNbPartitions));
+    mPartitionsRecording.resize(mNbPartitions);
+    mPartitionsValid = true;
+}
+
+N2D2::Network::~Network()
+{
+    // dtor
     const double timeElapsed
         = std::chrono::duration_cast<std::chrono::duration<double> >(
             std::chrono::high_resolution_clock::now() - mStartTime).count();
@@ -31,7 +31,8 @@ N2D2::Node::Node(Network& net)
       mScale(1.0),
       mOrientation(0.0),
       mLayer(0),
-      mArea(0, 0, 0, 0)
+      mArea(0, 0, 0, 0),
+      mPartition(0)
 {
     // ctor
 }
@@ -39,12 +40,14 @@ N2D2::Node::Node(Network& net)
 void N2D2::Node::addBranch(Node* branch)
 {
     mBranches.push_back(branch);
+    mNet.invalidatePartitions();
 }
 
 void N2D2::Node::removeBranch(Node* branch)
 {
     mBranches.erase(std::remove(mBranches.begin(), mBranches.end(), branch),
                     mBranches.end());
+    mNet.invalidatePartitions();
 }
 
 void N2D2::Node::emitSpike(Time_T timestamp, EventType_T type)
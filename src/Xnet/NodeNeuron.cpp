@@ -24,10 +24,14 @@
 #include "Xnet/NodeNeuron_Reflective.hpp"
 #include "Xnet/NodeSync.hpp"
 
+const unsigned int N2D2::NodeNeuron::NoLink
+    = std::numeric_limits<unsigned int>::max();
+
 N2D2::NodeNeuron::NodeNeuron(Network& net)
     : Node(net),
       // Internal variables
       mInitializedState(false),
+      mLinksIdOffset(0),
       mStateLogPlot(false),
       mCacheValid(false)
 {
@@ -36,14 +40,14 @@ N2D2::NodeNeuron::NodeNeuron(Network& net)
 
 void N2D2::NodeNeuron::addLink(Node* origin)
 {
-    if (mLinks.find(origin) != mLinks.end())
+    if (findLink(origin) >= 0)
         throw std::logic_error("Synaptic link already exists!");
 
     // Internal parameters for image reconstruction and data representation
     if (mLayer <= origin->getLayer())
         mLayer = origin->getLayer() + 1;
 
-    if (mLinks.empty())
+    if (mLinkOrigins.empty())
         mArea = origin->getArea();
     else {
         const Area& area = origin->getArea();
@@ -58,11 +62,88 @@ void N2D2::NodeNeuron::addLink(Node* origin)
             mArea.height = area.y + area.height - mArea.y;
     }
 
-    // Add the connexion
-    mLinks.insert(std::make_pair(origin, newSynapse()));
+    // Add the connexion, keeping the links sorted by input node ID
+    const NodeId_T id = origin->getId();
+    const std::vector<Node*>::iterator it
+        = std::upper_bound(mLinkOrigins.begin(), mLinkOrigins.end(), id,
+                           [](NodeId_T nodeId, const Node* node)
+                           { return (nodeId < node->getId()); });
+    const unsigned int link = it - mLinkOrigins.begin();
+    Synapse* synapse = newSynapse();
+
+    const Time_T delay = synapse->getDelay();
+
+    mLinkOrigins.insert(it, origin);
+    mSynapses.insert(mSynapses.begin() + link, synapse);
+
+    if (!mLinkDelays.empty())
+        mLinkDelays.insert(mLinkDelays.begin() + link, delay);
+    else if (delay > 0) {
+        mLinkDelays.resize(mLinkOrigins.size(), 0);
+        mLinkDelays[link] = delay;
+    }
+
+    if (link + 1 == mLinkOrigins.size()
+        && (!mLinksIndex.empty() || link == 0))
+    {
+        // The nodes are usually linked by increasing ID: extend the table
+        if (link == 0)
+            mLinksIdOffset = id;
+
+        const NodeId_T span = id - mLinksIdOffset + 1;
+
+        if (span <= 4 * mLinkOrigins.size() + 64) {
+            mLinksIndex.resize(span, NoLink);
+            mLinksIndex.back() = link;
+        }
+        else
+            indexLinks();
+    }
+    else
+        indexLinks();
+
     origin->addBranch(this);
 }
 
+void N2D2::NodeNeuron::updateLinkDelays()
+{
+    mLinkDelays.clear();
+
+    for (unsigned int i = 0, size = mSynapses.size(); i < size; ++i) {
+        const Time_T delay = mSynapses[i]->getDelay();
+
+        if (delay > 0) {
+            if (mLinkDelays.empty())
+                mLinkDelays.resize(size, 0);
+
+            mLinkDelays[i] = delay;
+        }
+    }
+
+    mNet.invalidatePartitions();
+}
+
+void N2D2::NodeNeuron::indexLinks()
+{
+    mLinksIndex.clear();
+
+    if (mLinkOrigins.empty())
+        return;
+
+    mLinksIdOffset = mLinkOrigins.front()->getId();
+    const NodeId_T span = mLinkOrigins.back()->getId() - mLinksIdOffset + 1;
+
+    // The direct lookup table is only used if it is not much larger than the
+    // links arrays, otherwise findLink() falls back to a binary search
+    if (span > 4 * mLinkOrigins.size() + 64)
+        return;
+
+    mLinksIndex.resize(span, NoLink);
+
+    for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i)
+        mLinksIndex[mLinkOrigins[i]->getId() - mLinksIdOffset] = i;
+}
+
 void N2D2::NodeNeuron::addLateralBranch(NodeNeuron* lateralBranch)
 {
     if (std::find(mLateralBranches.begin(),
@@ -71,14 +152,22 @@ void N2D2::NodeNeuron::addLateralBranch(NodeNeuron* lateralBranch)
         throw std::logic_error("Lateral inhibition already exists!");
 
     mLateralBranches.push_back(lateralBranch);
+    mNet.invalidatePartitions();
 }
 
 void N2D2::NodeNeuron::notify(Time_T timestamp, NotifyType notify)
 {
     Node::notify(timestamp, notify);
 
-    if (notify == Initialize)
+    if (notify == Initialize) {
+        // The links are set: release the growth margin of the arrays
+        mLinkOrigins.shrink_to_fit();
+        mSynapses.shrink_to_fit();
+        mLinkDelays.shrink_to_fit();
+        mLinksIndex.shrink_to_fit();
+
         initialize();
+    }
     else if (notify == Finalize) {
         finalize();
 
@@ -128,21 +217,12 @@ void N2D2::NodeNeuron::save(const std::string& dirName) const
         throw std::runtime_error("Could not create synaptic file (.SYN): "
                                  + fileName.str());
 
-    std::map<NodeId_T, Synapse*> orderedLinks;
-
-    for (std::unordered_map<Node*, Synapse*>::const_iterator it
-         = mLinks.begin(),
-         itEnd = mLinks.end();
+    // The synapses are sorted by input node ID
+    for (std::vector<Synapse*>::const_iterator it = mSynapses.begin(),
+                                               itEnd = mSynapses.end();
          it != itEnd;
          ++it)
-        orderedLinks.insert(std::make_pair((*it).first->getId(), (*it).second));
-
-    for (std::map<NodeId_T, Synapse*>::const_iterator it = orderedLinks.begin(),
-                                                      itEnd
-                                                      = orderedLinks.end();
-         it != itEnd;
-         ++it)
-        (*it).second->saveInternal(syn);
+        (*it)->saveInternal(syn);
 
     // Save internal state
     fileName.str(std::string());
@@ -172,21 +252,13 @@ void N2D2::NodeNeuron::load(const std::string& dirName)
         throw std::runtime_error("Could not open synaptic file (.SYN): "
                                  + fileName.str());
 
-    std::map<NodeId_T, Synapse*> orderedLinks;
-
-    for (std::unordered_map<Node*, Synapse*>::const_iterator it
-         = mLinks.begin(),
-         itEnd = mLinks.end();
+    for (std::vector<Synapse*>::const_iterator it = mSynapses.begin(),
+                                               itEnd = mSynapses.end();
          it != itEnd;
          ++it)
-        orderedLinks.insert(std::make_pair((*it).first->getId(), (*it).second));
+        (*it)->loadInternal(syn);
 
-    for (std::map<NodeId_T, Synapse*>::const_iterator it = orderedLinks.begin(),
-                                                      itEnd
-                                                      = orderedLinks.end();
-         it != itEnd;
-         ++it)
-        (*it).second->loadInternal(syn);
+    updateLinkDelays();
 
     if (syn.eof())
         throw std::runtime_error(
@@ -223,18 +295,15 @@ void N2D2::NodeNeuron::logWeights(const std::string& fileName) const
         throw std::runtime_error("Could not create weights log file: "
                                  + fileName);
 
-    for (std::unordered_map<Node*, Synapse*>::const_iterator it
-         = mLinks.begin(),
-         itEnd = mLinks.end();
-         it != itEnd;
-         ++it) {
-        const Area& area = (*it).first->getArea();
+    for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i) {
+        const Area& area = mLinkOrigins[i]->getArea();
 
         // MAP X Y WEIGHT TIMING
-        data << (*it).first->getScale() << " " << (*it).first->getOrientation()
+        data << mLinkOrigins[i]->getScale() << " "
+             << mLinkOrigins[i]->getOrientation()
              << " " << area.x << " " << area.y << " "
-             << (*it).second->getRelativeWeight() << " "
-             << (*it).first->getLastActivationTime() << "\n";
+             << mSynapses[i]->getRelativeWeight() << " "
+             << mLinkOrigins[i]->getLastActivationTime() << "\n";
     }
 }
 
@@ -269,24 +338,17 @@ N2D2::NodeNeuron::logState(const std::string& fileName, bool append, bool plot)
 void N2D2::NodeNeuron::logStats(std::ofstream& dataFile,
                                 const std::string& suffix) const
 {
-    for (std::unordered_map<Node*, Synapse*>::const_iterator it
-         = mLinks.begin(),
-         itEnd = mLinks.end();
-         it != itEnd;
-         ++it) {
+    for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i) {
         std::ostringstream suffixStr;
-        suffixStr << (*it).first->getId() << " " << suffix;
-        (*it).second->logStats(dataFile, suffixStr.str());
+        suffixStr << mLinkOrigins[i]->getId() << " " << suffix;
+        mSynapses[i]->logStats(dataFile, suffixStr.str());
     }
 }
 
 void N2D2::NodeNeuron::clearStats()
 {
-    for (std::unordered_map<Node*, Synapse*>::iterator it = mLinks.begin(),
-                                                       itEnd = mLinks.end();
-         it != itEnd;
-         ++it)
-        (*it).second->clearStats();
+    for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i)
+        mSynapses[i]->clearStats();
 }
 
 cv::Mat N2D2::NodeNeuron::reconstructPattern(bool normalize, bool multiLayer)
@@ -308,10 +370,10 @@ cv::Mat N2D2::NodeNeuron::reconstructPattern(bool normalize, bool multiLayer)
     } else {
         img = cv::Mat(cv::Size(mArea.width, mArea.height), CV_32FC3, 0.0);
 
-        NodeNeuron* nodePtr = dynamic_cast<NodeNeuron*>(mLinks.begin()->first);
+        NodeNeuron* nodePtr = dynamic_cast<NodeNeuron*>(mLinkOrigins.front());
         NodeNeuron_ReflectiveBridge* nodeBridgePtr = dynamic_cast
-            <NodeNeuron_ReflectiveBridge*>(mLinks.begin()->first);
-        NodeSync* nodeSyncPtr = dynamic_cast<NodeSync*>(mLinks.begin()->first);
+            <NodeNeuron_ReflectiveBridge*>(mLinkOrigins.front());
+        NodeSync* nodeSyncPtr = dynamic_cast<NodeSync*>(mLinkOrigins.front());
 
         // Pour la reconstruction des poids sur plusieurs niveaux :
         // - On vérifie que l'on est bien sur une couche qui n'est pas connecté
@@ -323,13 +385,10 @@ cv::Mat N2D2::NodeNeuron::reconstructPattern(bool normalize, bool multiLayer)
             unsigned int max = 0;
             double wSum = 0.0;
 
-            for (std::unordered_map<Node*, Synapse*>::const_iterator it
-                 = mLinks.begin(),
-                 itEnd = mLinks.end();
-                 it != itEnd;
-                 ++it) {
-                const Area& area = (*it).first->getArea();
-                wSum += (*it).second->getRelativeWeight();
+            for (unsigned int i = 0, size = mLinkOrigins.size(); i < size;
+                 ++i) {
+                const Area& area = mLinkOrigins[i]->getArea();
+                wSum += mSynapses[i]->getRelativeWeight();
 
                 for (int x = area.x; x < area.x + area.width; ++x) {
                     for (int y = area.y; y < area.y + area.height; ++y) {
@@ -357,24 +416,21 @@ cv::Mat N2D2::NodeNeuron::reconstructPattern(bool normalize, bool multiLayer)
                     cv::imwrite("mask.jpg", imgMaskDebugResized);
             */
 
-            for (std::unordered_map<Node*, Synapse*>::const_iterator it
-                 = mLinks.begin(),
-                 itEnd = mLinks.end();
-                 it != itEnd;
-                 ++it) {
-                const Area& area = (*it).first->getArea();
-                const double w = (*it).second->getRelativeWeight();
+            for (unsigned int i = 0, size = mLinkOrigins.size(); i < size;
+                 ++i) {
+                const Area& area = mLinkOrigins[i]->getArea();
+                const double w = mSynapses[i]->getRelativeWeight();
                 cv::Mat subImg;
 
                 if (multiLayer) {
                     NodeNeuron* parent = NULL;
 
                     if (nodePtr != NULL)
-                        parent = dynamic_cast<NodeNeuron*>((*it).first);
+                        parent = dynamic_cast<NodeNeuron*>(mLinkOrigins[i]);
                     else if (nodeSyncPtr != NULL) {
                         // It has to be a NodeSync, so we take its link
                         NodeSync* parentSync = dynamic_cast
-                            <NodeSync*>((*it).first);
+                            <NodeSync*>(mLinkOrigins[i]);
 
                         if (parentSync != NULL)
                             parent = dynamic_cast
@@ -420,14 +476,11 @@ cv::Mat N2D2::NodeNeuron::reconstructPattern(bool normalize, bool multiLayer)
             std::map<double, std::map<double, cv::Mat> > orientedMaps;
             bool singleOrientation = true;
 
-            for (std::unordered_map<Node*, Synapse*>::const_iterator it
-                 = mLinks.begin(),
-                 itEnd = mLinks.end();
-                 it != itEnd;
-                 ++it) {
-                const double scale = (*it).first->getScale();
-                const double orientation = (*it).first->getOrientation();
-                const Area& area = (*it).first->getArea();
+            for (unsigned int i = 0, size = mLinkOrigins.size(); i < size;
+                 ++i) {
+                const double scale = mLinkOrigins[i]->getScale();
+                const double orientation = mLinkOrigins[i]->getOrientation();
+                const Area& area = mLinkOrigins[i]->getArea();
 
                 if (orientedMaps.find(scale) == orientedMaps.end()
                     || orientedMaps[scale].find(orientation)
@@ -448,7 +501,7 @@ cv::Mat N2D2::NodeNeuron::reconstructPattern(bool normalize, bool multiLayer)
                                 area.x - (unsigned int)(scale* mArea.x))
                     = cv::Vec3f(360.0 * orientation,
                                 1.0,
-                                (*it).second->getRelativeWeight());
+                                mSynapses[i]->getRelativeWeight());
             }
 
             // DEBUG
@@ -586,16 +639,12 @@ cv::Mat N2D2::NodeNeuron::reconstructActivity(
     double value;
     bool validTime = false;
 
-    for (std::unordered_map<Node*, Synapse*>::const_iterator it
-         = mLinks.begin(),
-         itEnd = mLinks.end();
-         it != itEnd;
-         ++it) {
+    for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i) {
         if (order)
             std::tie(value, validTime)
-                = (*it).first->getFirstActivationTime(start, stop, type);
+                = mLinkOrigins[i]->getFirstActivationTime(start, stop, type);
         else
-            value = (*it).first->getActivity(start, stop, type);
+            value = mLinkOrigins[i]->getActivity(start, stop, type);
 
         if (value > normFactor && (!order || (order && validTime)))
             normFactor = value;
@@ -606,10 +655,10 @@ cv::Mat N2D2::NodeNeuron::reconstructActivity(
     if (normFactor == 0)
         return img;
 
-    NodeNeuron* nodePtr = dynamic_cast<NodeNeuron*>(mLinks.begin()->first);
+    NodeNeuron* nodePtr = dynamic_cast<NodeNeuron*>(mLinkOrigins.front());
     NodeNeuron_ReflectiveBridge* nodeBridgePtr = dynamic_cast
-        <NodeNeuron_ReflectiveBridge*>(mLinks.begin()->first);
-    NodeSync* nodeSyncPtr = dynamic_cast<NodeSync*>(mLinks.begin()->first);
+        <NodeNeuron_ReflectiveBridge*>(mLinkOrigins.front());
+    NodeSync* nodeSyncPtr = dynamic_cast<NodeSync*>(mLinkOrigins.front());
 
     if ((mLayer > 1 && nodePtr != NULL && nodeBridgePtr == NULL)
         || (mLayer > 2 && nodeSyncPtr != NULL)) {
@@ -617,12 +666,8 @@ cv::Mat N2D2::NodeNeuron::reconstructActivity(
             mArea.width, std::vector<unsigned int>(mArea.height, 0));
         unsigned int max = 0;
 
-        for (std::unordered_map<Node*, Synapse*>::const_iterator it
-             = mLinks.begin(),
-             itEnd = mLinks.end();
-             it != itEnd;
-             ++it) {
-            const Area& area = (*it).first->getArea();
+        for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i) {
+            const Area& area = mLinkOrigins[i]->getArea();
 
             for (int x = area.x; x < area.x + area.width; ++x) {
                 for (int y = area.y; y < area.y + area.height; ++y) {
@@ -641,31 +686,29 @@ cv::Mat N2D2::NodeNeuron::reconstructActivity(
                 imgMask.at<float>(y, x) = 1.0 / mask[x][y];
         }
 
-        for (std::unordered_map<Node*, Synapse*>::const_iterator it
-             = mLinks.begin(),
-             itEnd = mLinks.end();
-             it != itEnd;
-             ++it) {
-            const Area& area = (*it).first->getArea();
+        for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i) {
+            const Area& area = mLinkOrigins[i]->getArea();
 
             if (order) {
                 std::tie(value, validTime)
-                    = (*it).first->getFirstActivationTime(start, stop, type);
+                    = mLinkOrigins[i]->getFirstActivationTime(start, stop,
+                                                              type);
 
                 if (validTime)
                     value = (normFactor - value) / normFactor;
             } else
-                value = (*it).first->getActivity(start, stop, type)
+                value = mLinkOrigins[i]->getActivity(start, stop, type)
                         / normFactor;
             /*
                         NodeNeuron* parent = NULL;
 
                         if (nodePtr != NULL)
-                            parent = dynamic_cast<NodeNeuron*> ((*it).first);
+                            parent = dynamic_cast<NodeNeuron*>
+               (mLinkOrigins[i]);
                         else if (nodeSyncPtr != NULL) {
                             // It has to be a NodeSync, so we take its link
                             NodeSync* parentSync = dynamic_cast<NodeSync*>
-               ((*it).first);
+               (mLinkOrigins[i]);
 
                             if (parentSync != NULL)
                                 parent = dynamic_cast<NodeNeuron*>
@@ -694,14 +737,10 @@ cv::Mat N2D2::NodeNeuron::reconstructActivity(
         std::map<double, std::map<double, cv::Mat> > orientedMaps;
         bool singleOrientation = true;
 
-        for (std::unordered_map<Node*, Synapse*>::const_iterator it
-             = mLinks.begin(),
-             itEnd = mLinks.end();
-             it != itEnd;
-             ++it) {
-            const double scale = (*it).first->getScale();
-            const double orientation = (*it).first->getOrientation();
-            const Area& area = (*it).first->getArea();
+        for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i) {
+            const double scale = mLinkOrigins[i]->getScale();
+            const double orientation = mLinkOrigins[i]->getOrientation();
+            const Area& area = mLinkOrigins[i]->getArea();
 
             if (orientedMaps.find(scale) == orientedMaps.end()
                 || orientedMaps[scale].find(orientation)
@@ -719,12 +758,13 @@ cv::Mat N2D2::NodeNeuron::reconstructActivity(
 
             if (order) {
                 std::tie(value, validTime)
-                    = (*it).first->getFirstActivationTime(start, stop, type);
+                    = mLinkOrigins[i]->getFirstActivationTime(start, stop,
+                                                              type);
 
                 if (validTime)
                     value = 1.0 - value / normFactor;
             } else
-                value = (*it).first->getActivity(start, stop, type)
+                value = mLinkOrigins[i]->getActivity(start, stop, type)
                         / normFactor;
 
             orientedMaps[scale][orientation].at
@@ -820,14 +860,11 @@ cv::Mat N2D2::NodeNeuron::reconstructActivity(
 N2D2::NodeNeuron::~NodeNeuron()
 {
     // dtor
-    for (std::unordered_map<Node*, Synapse*>::iterator it = mLinks.begin(),
-                                                       itEnd = mLinks.end();
-         it != itEnd;
-         ++it) {
+    for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i) {
         // Avoid segmentation fault if shared synapses are used...
-        if ((*it).second != NULL) {
-            delete (*it).second;
-            (*it).second = NULL;
+        if (mSynapses[i] != NULL) {
+            delete mSynapses[i];
+            mSynapses[i] = NULL;
         }
     }
 }
@@ -81,8 +81,7 @@ void N2D2::NodeNeuron_Behavioral::propagateSpike(Node* origin,
                                                  Time_T timestamp,
                                                  EventType_T type)
 {
-    const Time_T delay = static_cast
-                         <Synapse_Behavioral*>(mLinks[origin])->delay;
+    const Time_T delay = getLinkDelayAt(findLink(origin));
 
     if (delay > 0)
         mNet.newEvent(origin, this, timestamp + delay, type);
@@ -90,12 +89,23 @@ void N2D2::NodeNeuron_Behavioral::propagateSpike(Node* origin,
         incomingSpike(origin, timestamp, type);
 }
 
+N2D2::Time_T N2D2::NodeNeuron_Behavioral::getLinkDelay(Node* origin) const
+{
+    // Time-based STDP (see getLinkDelayState())
+    if (getLinkDelayState())
+        return 0;
+
+    const int link = findLink(origin);
+
+    return (link >= 0) ? getLinkDelayAt(link) : 0;
+}
+
 void N2D2::NodeNeuron_Behavioral::incomingSpike(Node* origin,
                                                 Time_T timestamp,
                                                 EventType_T /*type*/)
 {
     Synapse_Behavioral* synapse = static_cast
-        <Synapse_Behavioral*>(mLinks[origin]);
+        <Synapse_Behavioral*>(getSynapse(origin));
     ++synapse->statsReadEvents;
 
     // LTP
@@ -199,36 +209,30 @@ void N2D2::NodeNeuron_Behavioral::emitSpike(Time_T timestamp, EventType_T type)
                 ++ltp;
             }
 
-            for (std::unordered_map<Node*, Synapse*>::const_iterator it
-                 = mLinks.begin(),
-                 itEnd = mLinks.end();
-                 it != itEnd;
-                 ++it) {
+            for (unsigned int i = 0, size = mLinkOrigins.size(); i < size;
+                 ++i) {
                 Synapse_Behavioral* synapse = static_cast
-                    <Synapse_Behavioral*>((*it).second);
+                    <Synapse_Behavioral*>(mSynapses[i]);
 
                 if (std::find(mLtpFifo.begin(), mLtpFifo.end(), synapse)
                     == mLtpFifo.end())
                     decreaseWeight(synapse, synapse->weightDecrement);
             }
         } else {
-            for (std::unordered_map<Node*, Synapse*>::const_iterator it
-                 = mLinks.begin(),
-                 itEnd = mLinks.end();
-                 it != itEnd;
-                 ++it) {
+            for (unsigned int i = 0, size = mLinkOrigins.size(); i < size;
+                 ++i) {
                 Synapse_Behavioral* synapse = static_cast
-                    <Synapse_Behavioral*>((*it).second);
+                    <Synapse_Behavioral*>(mSynapses[i]);
 
                 if (stdp(synapse,
-                         (*it).first->getLastActivationTime(),
+                         mLinkOrigins[i]->getLastActivationTime(),
                          timestamp))
                     ++ltp;
             }
         }
         /*
                 // DEBUG
-                std::cout << "LTP (%) = " << 100.0*((double) ltp)/mLinks.size()
+                std::cout << "LTP (%) = " << 100.0*((double) ltp)/mLinkOrigins.size()
            << std::endl;
         */
         mLastStdp = timestamp;
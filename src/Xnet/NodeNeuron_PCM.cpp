@@ -93,7 +93,7 @@ void N2D2::NodeNeuron_PCM::propagateSpike(Node* origin,
                                           Time_T timestamp,
                                           EventType_T type)
 {
-    const Time_T delay = static_cast<Synapse_PCM*>(mLinks[origin])->delay;
+    const Time_T delay = getLinkDelayAt(findLink(origin));
 
     if (delay > 0)
         mNet.newEvent(origin, this, timestamp + delay, type);
@@ -105,7 +105,7 @@ void N2D2::NodeNeuron_PCM::incomingSpike(Node* origin,
                                          Time_T timestamp,
                                          EventType_T /*type*/)
 {
-    Synapse_PCM* synapse = static_cast<Synapse_PCM*>(mLinks[origin]);
+    Synapse_PCM* synapse = static_cast<Synapse_PCM*>(getSynapse(origin));
 
     // Stats
     ++synapse->statsReadEvents;
@@ -168,27 +168,22 @@ void N2D2::NodeNeuron_PCM::emitSpike(Time_T timestamp, EventType_T type)
     if (mEnableStdp) {
         ++mWeightUpdate;
 
-        for (std::unordered_map<Node*, Synapse*>::const_iterator it
-             = mLinks.begin(),
-             itEnd = mLinks.end();
-             it != itEnd;
-             ++it) {
-            Synapse_PCM* synapse = static_cast<Synapse_PCM*>((*it).second);
+        for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i) {
+            Synapse_PCM* synapse = static_cast<Synapse_PCM*>(mSynapses[i]);
 
-            if ((*it).first->getLastActivationTime() > 0
-                && (*it).first->getLastActivationTime() + mStdpLtp >= timestamp)
+            const Time_T lastActivation
+                = mLinkOrigins[i]->getLastActivationTime();
+
+            if (lastActivation > 0 && lastActivation + mStdpLtp >= timestamp)
                 increaseWeight(synapse, LTP);
             else
                 increaseWeight(synapse, LTD);
         }
 
         if (mWeightUpdate == mWeightsUpdateLimit) {
-            for (std::unordered_map<Node*, Synapse*>::iterator it
-                 = mLinks.begin(),
-                 itEnd = mLinks.end();
-                 it != itEnd;
-                 ++it) {
-                Synapse_PCM* synapse = static_cast<Synapse_PCM*>((*it).second);
+            for (unsigned int i = 0, size = mLinkOrigins.size(); i < size;
+                 ++i) {
+                Synapse_PCM* synapse = static_cast<Synapse_PCM*>(mSynapses[i]);
 
                 if (mWeightsRefreshMethod == Nearest) {
                     // Optimal algorithm, but may require a lot of read/write
@@ -94,7 +94,7 @@ void N2D2::NodeNeuron_RRAM::propagateSpike(Node* origin,
                                            Time_T timestamp,
                                            EventType_T type)
 {
-    const Time_T delay = static_cast<Synapse_RRAM*>(mLinks[origin])->delay;
+    const Time_T delay = getLinkDelayAt(findLink(origin));
 
     if (delay > 0)
         mNet.newEvent(origin, this, timestamp + delay, type);
@@ -106,7 +106,7 @@ void N2D2::NodeNeuron_RRAM::incomingSpike(Node* origin,
                                           Time_T timestamp,
                                           EventType_T /*type*/)
 {
-    Synapse_RRAM* synapse = static_cast<Synapse_RRAM*>(mLinks[origin]);
+    Synapse_RRAM* synapse = static_cast<Synapse_RRAM*>(getSynapse(origin));
 
     // Stats
     ++synapse->statsReadEvents;
@@ -165,15 +165,13 @@ void N2D2::NodeNeuron_RRAM::emitSpike(Time_T timestamp, EventType_T type)
     mRefractoryEnd = timestamp + mRefractory;
 
     if (mEnableStdp) {
-        for (std::unordered_map<Node*, Synapse*>::const_iterator it
-             = mLinks.begin(),
-             itEnd = mLinks.end();
-             it != itEnd;
-             ++it) {
-            Synapse_RRAM* synapse = static_cast<Synapse_RRAM*>((*it).second);
-
-            if ((*it).first->getLastActivationTime() > 0
-                && (*it).first->getLastActivationTime() + mStdpLtp >= timestamp)
+        for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i) {
+            Synapse_RRAM* synapse = static_cast<Synapse_RRAM*>(mSynapses[i]);
+
+            const Time_T lastActivation
+                = mLinkOrigins[i]->getLastActivationTime();
+
+            if (lastActivation > 0 && lastActivation + mStdpLtp >= timestamp)
                 increaseWeight(synapse);
             else
                 decreaseWeight(synapse);
@@ -240,19 +238,15 @@ void N2D2::NodeNeuron_RRAM::logWeights(const std::string& fileName) const
         throw std::runtime_error("Could not create weights log file: "
                                  + fileName);
 
-    for (std::unordered_map<Node*, Synapse*>::const_iterator it
-         = mLinks.begin(),
-         itEnd = mLinks.end();
-         it != itEnd;
-         ++it) {
-        Synapse_RRAM* synapse = static_cast<Synapse_RRAM*>((*it).second);
+    for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i) {
+        Synapse_RRAM* synapse = static_cast<Synapse_RRAM*>(mSynapses[i]);
 
-        const Area& area = (*it).first->getArea();
+        const Area& area = mLinkOrigins[i]->getArea();
 
         // MAP X Y WEIGHT TIMING
-        data << (*it).first->getScale() << " " << area.x << " " << area.y << " "
-             << (*it).second->getRelativeWeight() << " "
-             << (*it).first->getLastActivationTime();
+        data << mLinkOrigins[i]->getScale() << " " << area.x << " " << area.y
+             << " " << mSynapses[i]->getRelativeWeight() << " "
+             << mLinkOrigins[i]->getLastActivationTime();
 
         for (unsigned int dev = 0; dev < mSynapticRedundancy; ++dev)
             data << " " << synapse->devices[dev].weight;
@@ -95,11 +95,12 @@ void N2D2::NodeNeuron_Reflective::propagateSpike(Node* origin,
     Synapse_Behavioral* synapse = NULL;
 
     if (type == ForwardEvent)
-        synapse = static_cast<Synapse_Behavioral*>(mLinks[origin]);
+        synapse = static_cast<Synapse_Behavioral*>(getSynapse(origin));
     else if (type == BackwardEvent) {
         NodeNeuron_Reflective* reflective = static_cast
             <NodeNeuron_Reflective*>(origin);
-        synapse = static_cast<Synapse_Behavioral*>(reflective->mLinks[this]);
+        synapse = static_cast
+            <Synapse_Behavioral*>(reflective->getSynapse(this));
     } else
         throw std::runtime_error(
             "Unexpected incoming event type for reflective node!");
@@ -133,11 +134,12 @@ void N2D2::NodeNeuron_Reflective::incomingSpike(Node* origin,
     Synapse_Behavioral* synapse = NULL;
 
     if (type == ForwardEvent)
-        synapse = static_cast<Synapse_Behavioral*>(mLinks[origin]);
+        synapse = static_cast<Synapse_Behavioral*>(getSynapse(origin));
     else if (type == BackwardEvent) {
         NodeNeuron_Reflective* reflective = static_cast
             <NodeNeuron_Reflective*>(origin);
-        synapse = static_cast<Synapse_Behavioral*>(reflective->mLinks[this]);
+        synapse = static_cast
+            <Synapse_Behavioral*>(reflective->getSynapse(this));
     } else
         throw std::runtime_error(
             "Unexpected incoming event type for reflective node!");
@@ -224,16 +226,14 @@ void N2D2::NodeNeuron_Reflective::emitSpike(Time_T timestamp, EventType_T type)
     if ((mStdpLearning == Forward || mStdpLearning == Both)
         && (type == ForwardEvent || (type == ForwardSubEvent && mSubEventStdp)
             || (type == ForwardEchoEvent && mEchoEventStdp))) {
-        for (std::unordered_map<Node*, Synapse*>::const_iterator it
-             = mLinks.begin(),
-             itEnd = mLinks.end();
-             it != itEnd;
-             ++it) {
+        for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i) {
             Synapse_Behavioral* synapse = static_cast
-                <Synapse_Behavioral*>((*it).second);
+                <Synapse_Behavioral*>(mSynapses[i]);
 
-            if ((*it).first->getLastActivationTime() > 0
-                && (*it).first->getLastActivationTime() + stdpLtp >= timestamp)
+            const Time_T lastActivation
+                = mLinkOrigins[i]->getLastActivationTime();
+
+            if (lastActivation > 0 && lastActivation + stdpLtp >= timestamp)
                 increaseWeight(synapse);
             else
                 decreaseWeight(synapse);
@@ -249,7 +249,7 @@ void N2D2::NodeNeuron_Reflective::emitSpike(Time_T timestamp, EventType_T type)
             NodeNeuron_Reflective* reflective = static_cast
                 <NodeNeuron_Reflective*>((*it));
             Synapse_Behavioral* synapse = static_cast
-                <Synapse_Behavioral*>(reflective->mLinks[this]);
+                <Synapse_Behavioral*>(reflective->getSynapse(this));
 
             if (reflective->getLastActivationTime() > 0
                 && reflective->getLastActivationTime() + stdpLtp >= timestamp)
@@ -291,15 +291,12 @@ void N2D2::NodeNeuron_Reflective::emitSpike(Time_T timestamp, EventType_T type)
 
         mLastActivationTime = timestamp;
 
-        // If this is in fact a NodeNeuron_ReflectiveBridge, mLinks is empty, so
+        // If this is in fact a NodeNeuron_ReflectiveBridge, mLinkOrigins is empty,
+        // so
         // no event is actually created but the activation of
         // the neuron is still reported.
-        for (std::unordered_map<Node*, Synapse*>::const_iterator it
-             = mLinks.begin(),
-             itEnd = mLinks.end();
-             it != itEnd;
-             ++it)
-            (*it).first->propagateSpike(this, timestamp, BackwardEvent);
+        for (unsigned int i = 0, size = mLinkOrigins.size(); i < size; ++i)
+            mLinkOrigins[i]->propagateSpike(this, timestamp, BackwardEvent);
     }
 
     event = NULL;
@@ -0,0 +1,57 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "Xnet/SpikeEventQueue.hpp"
+
+N2D2::SpikeEventQueue::SpikeEventQueue(Network::EventScheduler scheduler,
+                                       Time_T wheelResolution)
+{
+    // ctor
+    if (scheduler == Network::TimingWheel) {
+        mEventsWheel.reset(new SpikeEventWheel(wheelResolution,
+                                               mEventsPool));
+    }
+}
+
+void N2D2::SpikeEventQueue::drain(std::vector<SpikeEvent*>& events)
+{
+    SpikeEvent* event;
+
+    while ((event = top()) != NULL) {
+        pop();
+
+        if (event->isDiscarded())
+            recycle(event);
+        else
+            events.push_back(event);
+    }
+}
+
+void N2D2::SpikeEventQueue::clear()
+{
+    if (mEventsWheel)
+        mEventsWheel->clear();
+    else {
+        while (!mEvents.empty()) {
+            mEventsPool.push_back(mEvents.top());
+            mEvents.pop();
+        }
+    }
+}
@@ -0,0 +1,176 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "Xnet/SpikeEventWheel.hpp"
+
+N2D2::SpikeEventWheel::SpikeEventWheel(Time_T resolution,
+                                       std::vector<SpikeEvent*>& eventsPool)
+    : mResolution(resolution),
+      mEventsPool(eventsPool),
+      mCurrentTick(0),
+      mSize(0)
+{
+    // ctor
+    if (mResolution == 0) {
+        throw std::runtime_error("SpikeEventWheel: the resolution must be "
+                                 "greater than 0");
+    }
+
+    std::fill(&mOccupancy[0][0], &mOccupancy[0][0] + NbLevels * NbSlots / 64,
+              0);
+}
+
+void N2D2::SpikeEventWheel::push(SpikeEvent* event)
+{
+    if (mSize == 0) {
+        // Nothing is scheduled: restart the wheel from this event, which
+        // allows going back in time after a Network::reset()
+        mCurrentTick = event->getTimestamp() / mResolution;
+    }
+
+    insert(event);
+    ++mSize;
+}
+
+void N2D2::SpikeEventWheel::clear()
+{
+    while (!mCurrent.empty()) {
+        mEventsPool.push_back(mCurrent.top());
+        mCurrent.pop();
+    }
+
+    for (unsigned int level = 0; level < NbLevels; ++level) {
+        for (unsigned int slot = 0; slot < NbSlots; ++slot) {
+            std::vector<SpikeEvent*>& events = mSlots[level][slot];
+
+            mEventsPool.insert(mEventsPool.end(), events.begin(), events.end());
+            events.clear();
+        }
+    }
+
+    std::fill(&mOccupancy[0][0], &mOccupancy[0][0] + NbLevels * NbSlots / 64,
+              0);
+    mSize = 0;
+}
+
+void N2D2::SpikeEventWheel::insert(SpikeEvent* event)
+{
+    const Time_T tick = event->getTimestamp() / mResolution;
+
+    if (tick <= mCurrentTick) {
+        // Current tick, or an event in the past that is legitimate for the
+        // Network (after a stop): it is handled by the heap
+        mCurrent.push(event);
+        return;
+    }
+
+    // Level of the most significant byte that differs from the current tick
+    const Time_T diff = tick ^ mCurrentTick;
+    unsigned int level = 0;
+
+    while (level < NbLevels - 1 && (diff >> (8 * (level + 1))) != 0)
+        ++level;
+
+    const unsigned int slot = (tick >> (8 * level)) & (NbSlots - 1);
+
+    mSlots[level][slot].push_back(event);
+    mOccupancy[level][slot / 64] |= (UINT64_C(1) << (slot % 64));
+}
+
+bool N2D2::SpikeEventWheel::advance()
+{
+    while (mCurrent.empty()) {
+        if (mSize == 0)
+            return false;
+
+        // The next events are in the first occupied slot after the current
+        // tick, on the lowest level
+        unsigned int level = 0;
+        int slot = -1;
+
+        for (; level < NbLevels; ++level) {
+            const unsigned int current
+                = (mCurrentTick >> (8 * level)) & (NbSlots - 1);
+
+            slot = findSlot(level, current + 1);
+
+            if (slot >= 0)
+                break;
+        }
+
+        if (slot < 0) {
+            throw std::runtime_error("SpikeEventWheel::advance(): "
+                                     "inconsistent wheel state");
+        }
+
+        const unsigned int shift = 8 * level;
+        const Time_T upper = (level < NbLevels - 1)
+            ? ((mCurrentTick >> (shift + 8)) << (shift + 8))
+            : 0;
+
+        mCurrentTick = upper | ((Time_T)slot << shift);
+
+        mOccupancy[level][slot / 64] &= ~(UINT64_C(1) << (slot % 64));
+        mExpanded.swap(mSlots[level][slot]);
+
+        // Re-distribute the events of the slot in the lower levels (they are
+        // all in the current tick for level 0)
+        for (std::vector<SpikeEvent*>::const_iterator it = mExpanded.begin(),
+             itEnd = mExpanded.end(); it != itEnd; ++it)
+        {
+            if ((*it)->isDiscarded()) {
+                mEventsPool.push_back(*it);
+                --mSize;
+            }
+            else
+                insert(*it);
+        }
+
+        mExpanded.clear();
+    }
+
+    return true;
+}
+
+int N2D2::SpikeEventWheel::findSlot(unsigned int level, unsigned int first)
+    const
+{
+    for (unsigned int word = first / 64; word < NbSlots / 64; ++word) {
+        uint64_t bits = mOccupancy[level][word];
+
+        if (word == first / 64)
+            bits &= ~((UINT64_C(1) << (first % 64)) - 1);
+
+        if (bits != 0) {
+#if defined(__GNUC__)
+            const unsigned int bit = __builtin_ctzll(bits);
+#else
+            unsigned int bit = 0;
+
+            while (!(bits & (UINT64_C(1) << bit)))
+                ++bit;
+#endif
+
+            return (int)(64 * word + bit);
+        }
+    }
+
+    return -1;
+}
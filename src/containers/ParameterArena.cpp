@@ -0,0 +1,228 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "containers/ParameterArena.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+
+#include "third_party/half.hpp"
+
+template <class T>
+N2D2::ParameterArena<T>::ParameterArena()
+    : mInitialized(false)
+{
+    // ctor
+}
+
+template <class T>
+void N2D2::ParameterArena<T>::addParameters(Tensor<T>& parameters)
+{
+    add(mParameters, parameters);
+}
+
+template <class T>
+void N2D2::ParameterArena<T>::addGradients(Tensor<T>& gradients)
+{
+    add(mGradients, gradients);
+}
+
+template <class T>
+void N2D2::ParameterArena<T>::initialize()
+{
+    if (mInitialized) {
+        throw std::runtime_error("ParameterArena::initialize(): already "
+                                 "initialized");
+    }
+
+    initialize(mParameters);
+    initialize(mGradients);
+    mInitialized = true;
+}
+
+template <class T>
+void N2D2::ParameterArena<T>::snapshot(std::vector<T>& parameters) const
+{
+    const T* data = getData(mParameters);
+    parameters.assign(data, data + mParameters.size);
+}
+
+template <class T>
+void N2D2::ParameterArena<T>::restore(const std::vector<T>& parameters)
+{
+    if (parameters.size() != mParameters.size) {
+        throw std::runtime_error("ParameterArena::restore(): the snapshot "
+                                 "size does not match the arena size");
+    }
+
+    std::copy(parameters.begin(), parameters.end(), getData(mParameters));
+}
+
+template <class T>
+void N2D2::ParameterArena<T>::save(const std::string& fileName) const
+{
+    std::ofstream data(fileName.c_str(), std::ios::binary);
+
+    if (!data.good()) {
+        throw std::runtime_error("ParameterArena::save(): could not create "
+                                 "file: " + fileName);
+    }
+
+    const std::size_t size = mParameters.size;
+    data.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    data.write(reinterpret_cast<const char*>(getData(mParameters)),
+               size * sizeof(T));
+
+    if (!data.good()) {
+        throw std::runtime_error("ParameterArena::save(): error writing "
+                                 "file: " + fileName);
+    }
+}
+
+template <class T>
+void N2D2::ParameterArena<T>::load(const std::string& fileName)
+{
+    std::ifstream data(fileName.c_str(), std::ios::binary);
+
+    if (!data.good()) {
+        throw std::runtime_error("ParameterArena::load(): could not open "
+                                 "file: " + fileName);
+    }
+
+    std::size_t size;
+    data.read(reinterpret_cast<char*>(&size), sizeof(size));
+
+    if (!data.good() || size != mParameters.size) {
+        throw std::runtime_error("ParameterArena::load(): the file size does "
+                                 "not match the arena size: " + fileName);
+    }
+
+    // Read in a temporary buffer, in order to leave the parameters unchanged
+    // in case of error
+    std::vector<T> parameters(size);
+    data.read(reinterpret_cast<char*>(parameters.data()), size * sizeof(T));
+
+    if (!data.good()) {
+        throw std::runtime_error("ParameterArena::load(): error reading "
+                                 "file: " + fileName);
+    }
+
+    restore(parameters);
+}
+
+template <class T>
+double N2D2::ParameterArena<T>::getGradientsNorm() const
+{
+    const T* data = getData(mGradients);
+    const int size = (int)mGradients.size;
+    double sumSq = 0.0;
+
+#pragma omp parallel for reduction(+:sumSq) if (size > 16384)
+    for (int index = 0; index < size; ++index) {
+        const double value = (double)data[index];
+        sumSq += value * value;
+    }
+
+    return std::sqrt(sumSq);
+}
+
+template <class T>
+double N2D2::ParameterArena<T>::clipGradientsNorm(double maxNorm)
+{
+    const double norm = getGradientsNorm();
+
+    if (norm > maxNorm) {
+        T* data = getData(mGradients);
+        const int size = (int)mGradients.size;
+        const double scale = maxNorm / norm;
+
+#pragma omp parallel for if (size > 16384)
+        for (int index = 0; index < size; ++index)
+            data[index] = (T)(scale * (double)data[index]);
+    }
+
+    return norm;
+}
+
+template <class T>
+void N2D2::ParameterArena<T>::add(Buffer& buffer, Tensor<T>& tensor)
+{
+    if (mInitialized) {
+        throw std::runtime_error("ParameterArena::add(): tensors cannot be "
+                                 "added once the arena is initialized");
+    }
+
+    if (!tensor.empty() && std::find(buffer.tensors.begin(),
+                                     buffer.tensors.end(), &tensor)
+                                == buffer.tensors.end())
+    {
+        buffer.tensors.push_back(&tensor);
+    }
+}
+
+template <class T>
+void N2D2::ParameterArena<T>::initialize(Buffer& buffer)
+{
+    const std::size_t alignment = Alignment / sizeof(T);
+    std::vector<std::size_t> offsets;
+
+    for (typename std::vector<Tensor<T>*>::const_iterator it
+         = buffer.tensors.begin(), itEnd = buffer.tensors.end();
+         it != itEnd; ++it)
+    {
+        offsets.push_back(buffer.size);
+        buffer.size += alignment
+            * (((*it)->size() + alignment - 1) / alignment);
+    }
+
+    // The storage is allocated with one more alignment block, in order to
+    // align its first element
+    buffer.storage.resize({buffer.size + alignment}, T(0.0));
+
+    const std::size_t misalignment
+        = reinterpret_cast<std::uintptr_t>(&buffer.storage(0)) % Alignment;
+
+    if (misalignment > 0 && (Alignment - misalignment) % sizeof(T) == 0)
+        buffer.offset = (Alignment - misalignment) / sizeof(T);
+
+    for (std::size_t i = 0; i < buffer.tensors.size(); ++i)
+        buffer.tensors[i]->share(buffer.storage, buffer.offset + offsets[i]);
+}
+
+template <class T>
+T* N2D2::ParameterArena<T>::getData(Buffer& buffer)
+{
+    return (buffer.size > 0) ? &buffer.storage(buffer.offset) : NULL;
+}
+
+template <class T>
+const T* N2D2::ParameterArena<T>::getData(const Buffer& buffer)
+{
+    return (buffer.size > 0) ? &buffer.storage(buffer.offset) : NULL;
+}
+
+namespace N2D2 {
+    template class ParameterArena<half_float::half>;
+    template class ParameterArena<float>;
+    template class ParameterArena<double>;
+}
@@ -533,9 +533,7 @@ void N2D2::Tensor<T>::save(std::ostream& stream) const
 
     stream.write(reinterpret_cast<const char*>(&mSize), sizeof(mSize));
 
-    for (typename std::vector<T>::const_iterator it = (*mData)().begin();
-        it != (*mData)().end(); ++it)
-    {
+    for (const_iterator it = begin(); it != end(); ++it) {
         const T value = (*it);
         stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
     }
@@ -566,9 +564,7 @@ void N2D2::Tensor<T>::load(std::istream& stream)
     if (dataSize != mSize)
         throw std::runtime_error("Tensor<T>::load(): mismatch in tensor size!");
 
-    for (typename std::vector<T>::iterator it = (*mData)().begin();
-        it != (*mData)().end(); ++it)
-    {
+    for (iterator it = begin(); it != end(); ++it) {
         T value;
         stream.read(reinterpret_cast<char*>(&value), sizeof(value));
         (*it) = value;
@@ -596,6 +592,28 @@ void N2D2::Tensor<T>::swap(Tensor<T>& tensor)
     assert((*tensor.mData)().size() == tensor.size());
 }
 
+template <class T>
+void N2D2::Tensor<T>::share(Tensor<T>& storage, size_t offset)
+{
+    if (storage.mData == mData)
+        throw std::runtime_error("Tensor<T>::share(): the tensor already "
+                                 "shares the storage data");
+
+    if (offset + size() > storage.size()) {
+        std::stringstream errorStr;
+        errorStr << "Tensor<T>::share(): the storage is too small (size "
+            << storage.size() << ") for a tensor of size " << size()
+            << " at offset " << offset << std::endl;
+
+        throw std::runtime_error(errorStr.str());
+    }
+
+    std::copy(begin(), end(), storage.begin() + offset);
+
+    mData = storage.mData;
+    mDataOffset = storage.mDataOffset + offset;
+}
+
 template <class T>
 N2D2::Tensor<T> N2D2::Tensor<T>::clone() const {
     return Tensor<T>(mDims,
@@ -28,15 +28,262 @@
 #include <pybind11/numpy.h>
 
 
+#include <cstdint>
+#include <cstring>
+
 namespace py = pybind11;
 
+namespace {
+// DLPack ABI (https://github.com/dmlc/dlpack), unversioned "dltensor"
+// capsules
+enum DLDeviceType {
+    kDLCPU = 1
+};
+
+enum DLDataTypeCode {
+    kDLInt = 0U,
+    kDLUInt = 1U,
+    kDLFloat = 2U
+};
+
+struct DLDevice {
+    DLDeviceType device_type;
+    int32_t device_id;
+};
+
+struct DLDataType {
+    uint8_t code;
+    uint8_t bits;
+    uint16_t lanes;
+};
+
+struct DLTensor {
+    void* data;
+    DLDevice device;
+    int32_t ndim;
+    DLDataType dtype;
+    int64_t* shape;
+    int64_t* strides;
+    uint64_t byte_offset;
+};
+
+struct DLManagedTensor {
+    DLTensor dl_tensor;
+    void* manager_ctx;
+    void (*deleter)(DLManagedTensor* self);
+};
+
+template <class T>
+DLDataType getDLDataType()
+{
+    DLDataType dtype;
+    dtype.code = (std::is_floating_point<T>::value) ? kDLFloat
+        : (std::is_signed<T>::value) ? kDLInt : kDLUInt;
+    dtype.bits = 8 * sizeof(T);
+    dtype.lanes = 1;
+    return dtype;
+}
+
+/// Exported tensor: the Tensor copy shares the DataTensor of the exported
+/// tensor, which stays alive as long as the consumer holds it
+template <class T>
+struct DLPackTensor {
+    DLPackTensor(const N2D2::Tensor<T>& tensor_) : tensor(tensor_) {}
+
+    DLManagedTensor managed;
+    N2D2::Tensor<T> tensor;
+    std::vector<int64_t> shape;
+    std::vector<int64_t> strides;
+};
+
+template <class T>
+void deleteDLPackTensor(DLManagedTensor* managed)
+{
+    delete static_cast<DLPackTensor<T>*>(managed->manager_ctx);
+}
+
+void deleteDLPackCapsule(PyObject* capsule)
+{
+    // A consumed capsule is renamed "used_dltensor" and is released by its
+    // consumer
+    if (PyCapsule_IsValid(capsule, "dltensor")) {
+        DLManagedTensor* managed = static_cast<DLManagedTensor*>(
+            PyCapsule_GetPointer(capsule, "dltensor"));
+
+        if (managed->deleter != NULL)
+            managed->deleter(managed);
+    }
+}
+
+template <class T>
+py::capsule toDLPack(const N2D2::Tensor<T>& tensor)
+{
+    DLPackTensor<T>* dlTensor = new DLPackTensor<T>(tensor);
+
+    // N2D2 dimensions are in reverse order compared to DLPack (row-major)
+    dlTensor->shape.assign(tensor.dims().rbegin(), tensor.dims().rend());
+    dlTensor->strides.resize(dlTensor->shape.size());
+
+    int64_t stride = 1;
+
+    for (int dim = (int)dlTensor->shape.size() - 1; dim >= 0; --dim) {
+        dlTensor->strides[dim] = stride;
+        stride *= dlTensor->shape[dim];
+    }
+
+    DLTensor& dl = dlTensor->managed.dl_tensor;
+    dl.data = (tensor.size() > 0)
+        ? const_cast<T*>(&(*dlTensor->tensor.begin())) : NULL;
+    dl.device.device_type = kDLCPU;
+    dl.device.device_id = 0;
+    dl.ndim = dlTensor->shape.size();
+    dl.dtype = getDLDataType<T>();
+    dl.shape = dlTensor->shape.data();
+    dl.strides = dlTensor->strides.data();
+    dl.byte_offset = 0;
+    dlTensor->managed.manager_ctx = dlTensor;
+    dlTensor->managed.deleter = &deleteDLPackTensor<T>;
+
+    PyObject* capsule = PyCapsule_New(&dlTensor->managed, "dltensor",
+                                      &deleteDLPackCapsule);
+
+    if (capsule == NULL) {
+        delete dlTensor;
+        throw py::error_already_set();
+    }
+
+    return py::reinterpret_steal<py::capsule>(capsule);
+}
+
+template <class T>
+py::object fromDLPack(const DLTensor& dl)
+{
+    std::vector<size_t> dims(dl.shape, dl.shape + dl.ndim);
+    std::reverse(dims.begin(), dims.end());
+
+    N2D2::Tensor<T>* tensor = new N2D2::Tensor<T>(dims);
+
+    if (tensor->size() > 0) {
+        const T* src = reinterpret_cast<const T*>(
+            static_cast<const char*>(dl.data) + dl.byte_offset);
+        T* dst = &(*tensor->begin());
+
+        // Contiguous row-major source?
+        bool compact = true;
+
+        if (dl.strides != NULL) {
+            int64_t stride = 1;
+
+            for (int dim = dl.ndim - 1; dim >= 0; --dim) {
+                if (dl.shape[dim] != 1 && dl.strides[dim] != stride)
+                    compact = false;
+
+                stride *= dl.shape[dim];
+            }
+        }
+
+        if (compact)
+            std::memcpy(dst, src, tensor->size() * sizeof(T));
+        else {
+            // Strided copy, in a single pass
+            std::vector<int64_t> index(dl.ndim, 0);
+
+            for (size_t i = 0; i < tensor->size(); ++i) {
+                int64_t offset = 0;
+
+                for (int dim = 0; dim < dl.ndim; ++dim)
+                    offset += index[dim] * dl.strides[dim];
+
+                dst[i] = src[offset];
+
+                for (int dim = dl.ndim - 1; dim >= 0; --dim) {
+                    if (++index[dim] < dl.shape[dim])
+                        break;
+
+                    index[dim] = 0;
+                }
+            }
+        }
+    }
+
+    return py::cast(tensor, py::return_value_policy::take_ownership);
+}
+
+/// Create a Tensor from a DLPack capsule or from any object implementing
+/// __dlpack__(). The data is copied once, as the Tensor owns its storage.
+py::object tensorFromDLPack(py::object obj)
+{
+    py::object capsule = (py::hasattr(obj, "__dlpack__"))
+        ? obj.attr("__dlpack__")() : obj;
+
+    if (!PyCapsule_IsValid(capsule.ptr(), "dltensor")) {
+        throw std::runtime_error("tensorFromDLPack(): expected a DLPack "
+                                 "capsule or an object implementing "
+                                 "__dlpack__()");
+    }
+
+    DLManagedTensor* managed = static_cast<DLManagedTensor*>(
+        PyCapsule_GetPointer(capsule.ptr(), "dltensor"));
+    const DLTensor& dl = managed->dl_tensor;
+
+    if (dl.device.device_type != kDLCPU) {
+        throw std::runtime_error("tensorFromDLPack(): only CPU tensors are "
+                                 "supported");
+    }
+
+    if (dl.dtype.lanes != 1) {
+        throw std::runtime_error("tensorFromDLPack(): vector data types are "
+                                 "not supported");
+    }
+
+    const uint8_t code = dl.dtype.code;
+    const uint8_t bits = dl.dtype.bits;
+    py::object tensor;
+
+    if (code == kDLFloat && bits == 32)
+        tensor = fromDLPack<float>(dl);
+    else if (code == kDLFloat && bits == 64)
+        tensor = fromDLPack<double>(dl);
+    else if (code == kDLInt && bits == 8)
+        tensor = fromDLPack<char>(dl);
+    else if (code == kDLUInt && bits == 8)
+        tensor = fromDLPack<unsigned char>(dl);
+    else if (code == kDLInt && bits == 16)
+        tensor = fromDLPack<short>(dl);
+    else if (code == kDLInt && bits == 32)
+        tensor = fromDLPack<int>(dl);
+    else if (code == kDLUInt && bits == 32)
+        tensor = fromDLPack<unsigned int>(dl);
+    else if (code == kDLInt && bits == 64) {
+        tensor = (sizeof(long) == 8) ? fromDLPack<long>(dl)
+                                     : fromDLPack<long long>(dl);
+    }
+    else if (code == kDLUInt && bits == 64) {
+        tensor = (sizeof(unsigned long) == 8)
+            ? fromDLPack<unsigned long>(dl)
+            : fromDLPack<unsigned long long>(dl);
+    }
+    else {
+        throw std::runtime_error("tensorFromDLPack(): unsupported data "
+            "type (code " + std::to_string(code) + ", "
+            + std::to_string(bits) + " bits)");
+    }
+
+    // The capsule is consumed
+    PyCapsule_SetName(capsule.ptr(), "used_dltensor");
+
+    if (managed->deleter != NULL)
+        managed->deleter(managed);
+
+    return tensor;
+}
+}
+
 namespace N2D2 {
 template<typename T, typename std::enable_if<!std::is_same<T, bool>::value>::type* = nullptr>
 void declare_Tensor_buffer_protocol(py::class_<Tensor<T>, BaseTensor>& tensor) {
     // Buffer protocol
     tensor.def_buffer([](Tensor<T>& b) -> py::buffer_info {
-        //assert(mData.unique());
-
         std::vector<ssize_t> dims;
         std::vector<ssize_t> strides;
         ssize_t stride = sizeof(T);
@@ -51,7 +298,7 @@ void declare_Tensor_buffer_protocol(py::class_<Tensor<T>, BaseTensor>& tensor) {
         std::reverse(strides.begin(), strides.end());
 
         return py::buffer_info(
-            &b.data()[0],                               /* Pointer to buffer */
+            (b.size() > 0) ? &(*b.begin()) : NULL,     /* Pointer to buffer (views start at their offset) */
             sizeof(T),                                  /* Size of one scalar */
             py::format_descriptor<T>::format(),         /* Python struct-style format descriptor */
             b.nbDims(),                                 /* Number of dimensions */
@@ -78,7 +325,33 @@ void declare_Tensor_buffer_protocol(py::class_<Tensor<T>, BaseTensor>& tensor) {
 */
         const std::vector<size_t> dims(info.shape.begin(), info.shape.end());
         return new Tensor<T>(dims, static_cast<T*>(info.ptr));
-    }));
+    }))
+    // Non-owning NumPy view: the array holds a Tensor sharing the same
+    // data, which stays valid as long as the tensor is not resized
+    .def("numpyView", [](const Tensor<T>& b) {
+        std::vector<ssize_t> dims(b.dims().rbegin(), b.dims().rend());
+        Tensor<T>* view = new Tensor<T>(b);
+        py::capsule base(view, [](void* ptr) {
+            delete static_cast<Tensor<T>*>(ptr);
+        });
+
+        return py::array_t<T>(dims,
+            (view->size() > 0) ? &(*view->begin()) : NULL, base);
+    })
+    // DLPack export, without copy
+    .def("__dlpack__", [](const Tensor<T>& b, py::kwargs kwargs) {
+        // The "stream" argument is irrelevant for CPU tensors
+        if (kwargs.contains("copy") && !kwargs["copy"].is_none()
+            && kwargs["copy"].cast<bool>())
+        {
+            return toDLPack(b.clone());
+        }
+
+        return toDLPack(b);
+    })
+    .def("__dlpack_device__", [](const Tensor<T>& /*b*/) {
+        return py::make_tuple((int)kDLCPU, 0);
+    });
 }
 
 template<typename T, typename std::enable_if<std::is_same<T, bool>::value>::type* = nullptr>
@@ -204,6 +477,8 @@ void init_Tensor(py::module &m) {
     declare_Tensor<long long>(m, "long long");
     declare_Tensor<unsigned long long>(m, "unsigned_long_long");
     declare_Tensor<bool>(m, "bool");
+
+    m.def("tensorFromDLPack", &tensorFromDLPack, py::arg("obj"));
 }
 }
 #endif
@@ -77,6 +77,7 @@ void init_Fashion_MNIST_IDX_Database(py::module&);
 void init_FDDB_Database(py::module&);
 void init_Daimler_Database(py::module&);
 void init_CaltechPedestrian_Database(py::module&);
+void init_Packed_Database(py::module&);
 
 void init_Scaling(py::module&);
 void init_ScalingMode(py::module&);
@@ -334,6 +335,7 @@ void init_N2D2(py::module& m) {
     init_Fashion_MNIST_IDX_Database(m);
     init_FDDB_Database(m);
     init_Daimler_Database(m);
+    init_Packed_Database(m);
 
 
     init_DeepNet(m);
@@ -24,13 +24,25 @@
 #include "Xnet/Network.hpp"
 
 #include <pybind11/pybind11.h>
+#include <pybind11/stl.h>
 
 namespace py = pybind11;
 
 namespace N2D2 {
 void init_Network(py::module &m) {
-    py::class_<Network>(m, "Network")
-    .def(py::init<unsigned int, bool, bool>(), py::arg("seed") = 0, py::arg("saveSeed") = true, py::arg("printTimeElapsed") = true)
+    py::class_<Network> network(m, "Network");
+
+    py::enum_<Network::EventScheduler>(network, "EventScheduler")
+    .value("PriorityQueue", Network::PriorityQueue)
+    .value("TimingWheel", Network::TimingWheel)
+    .export_values();
+
+    network
+    .def(py::init<unsigned int, bool, bool, Network::EventScheduler, Time_T>(), py::arg("seed") = 0, py::arg("saveSeed") = true, py::arg("printTimeElapsed") = true, py::arg("scheduler") = Network::PriorityQueue, py::arg("wheelResolution") = TimeNs)
+    .def("getEventScheduler", &Network::getEventScheduler)
+    .def("setNbThreads", &Network::setNbThreads, py::arg("nbThreads"))
+    .def("getNbThreads", &Network::getNbThreads)
+    .def("getPartitioning", &Network::getPartitioning)
     // .def("run", &Network::run, py::arg("stop") = 0, py::arg("clearActivity") = true)
     // .def("stop", &Network::stop, py::arg("stop") = 0, py::arg("discard") = false)
     // .def("reset", &Network::reset, py::arg("timestamp") = 0)
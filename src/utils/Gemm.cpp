@@ -0,0 +1,403 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <algorithm>
+#include <vector>
+
+#include "utils/Gemm.hpp"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define GEMM_X86_DISPATCH 1
+#endif
+
+namespace {
+// Register tile: MR rows of op(A) x NR columns of op(B). MR spans two AVX2
+// registers, so that the AVX2 micro-kernels keep 12 accumulators in registers.
+template <class U> struct Tile;
+template <> struct Tile<float> {
+    static const int MR = 16;
+    static const int NR = 6;
+};
+template <> struct Tile<double> {
+    static const int MR = 8;
+    static const int NR = 6;
+};
+
+// Cache blocking: a MC x KC block of op(A) is meant to stay in L2 and a
+// KC x NC block of op(B) in L3
+const int GEMM_MC = 128;
+const int GEMM_KC = 256;
+const int GEMM_NC = 2048;
+
+/// Pack a mc x kc block of op(A) into panels of MR rows, k-major
+template <class T, class U>
+void packA(N2D2::Gemm::Operation transA,
+           const T* A, int lda,
+           int i0, int mc, int p0, int kc,
+           U* Ap)
+{
+    const int MR = Tile<U>::MR;
+
+    for (int ir = 0; ir < mc; ir += MR) {
+        const int mr = std::min(MR, mc - ir);
+
+        for (int p = 0; p < kc; ++p) {
+            if (transA == N2D2::Gemm::NoTrans) {
+                const T* a = A + (i0 + ir) + (size_t)(p0 + p) * lda;
+
+                for (int i = 0; i < mr; ++i)
+                    Ap[i] = U(a[i]);
+            }
+            else {
+                const T* a = A + (p0 + p) + (size_t)(i0 + ir) * lda;
+
+                for (int i = 0; i < mr; ++i)
+                    Ap[i] = U(a[(size_t)i * lda]);
+            }
+
+            for (int i = mr; i < MR; ++i)
+                Ap[i] = U(0.0);
+
+            Ap += MR;
+        }
+    }
+}
+
+/// Pack a panel of nr (<= NR) columns of a kc x nc block of op(B), k-major
+template <class T, class U>
+void packB(N2D2::Gemm::Operation transB,
+           const T* B, int ldb,
+           int p0, int kc, int j0, int nr,
+           U* Bp)
+{
+    const int NR = Tile<U>::NR;
+
+    for (int p = 0; p < kc; ++p) {
+        if (transB == N2D2::Gemm::NoTrans) {
+            const T* b = B + (p0 + p) + (size_t)j0 * ldb;
+
+            for (int j = 0; j < nr; ++j)
+                Bp[j] = U(b[(size_t)j * ldb]);
+        }
+        else {
+            const T* b = B + j0 + (size_t)(p0 + p) * ldb;
+
+            for (int j = 0; j < nr; ++j)
+                Bp[j] = U(b[j]);
+        }
+
+        for (int j = nr; j < NR; ++j)
+            Bp[j] = U(0.0);
+
+        Bp += NR;
+    }
+}
+
+/// Accumulate A * B in a MR x NR tile from packed panels, keeping the
+/// accumulators in registers. The tile ab is column-major; its initial
+/// content is the starting value of the accumulators.
+template <class U>
+void microKernel(int kc, const U* Ap, const U* Bp, U* ab)
+{
+    const int MR = Tile<U>::MR;
+    const int NR = Tile<U>::NR;
+
+    U acc[MR * NR];
+    std::copy(ab, ab + MR * NR, acc);
+
+    for (int p = 0; p < kc; ++p) {
+        for (int j = 0; j < NR; ++j) {
+            const U b = Bp[j];
+
+            for (int i = 0; i < MR; ++i)
+                acc[i + j * MR] += Ap[i] * b;
+        }
+
+        Ap += MR;
+        Bp += NR;
+    }
+
+    std::copy(acc, acc + MR * NR, ab);
+}
+
+#ifdef GEMM_X86_DISPATCH
+__attribute__((target("avx2,fma")))
+void microKernelAvx2(int kc, const float* Ap, const float* Bp, float* ab)
+{
+    __m256 acc[6][2];
+
+    for (int j = 0; j < 6; ++j) {
+        acc[j][0] = _mm256_loadu_ps(ab + 16 * j);
+        acc[j][1] = _mm256_loadu_ps(ab + 16 * j + 8);
+    }
+
+    for (int p = 0; p < kc; ++p) {
+        const __m256 a0 = _mm256_loadu_ps(Ap);
+        const __m256 a1 = _mm256_loadu_ps(Ap + 8);
+
+        for (int j = 0; j < 6; ++j) {
+            const __m256 b = _mm256_broadcast_ss(Bp + j);
+            acc[j][0] = _mm256_fmadd_ps(a0, b, acc[j][0]);
+            acc[j][1] = _mm256_fmadd_ps(a1, b, acc[j][1]);
+        }
+
+        Ap += 16;
+        Bp += 6;
+    }
+
+    for (int j = 0; j < 6; ++j) {
+        _mm256_storeu_ps(ab + 16 * j, acc[j][0]);
+        _mm256_storeu_ps(ab + 16 * j + 8, acc[j][1]);
+    }
+}
+
+__attribute__((target("avx2,fma")))
+void microKernelAvx2(int kc, const double* Ap, const double* Bp, double* ab)
+{
+    __m256d acc[6][2];
+
+    for (int j = 0; j < 6; ++j) {
+        acc[j][0] = _mm256_loadu_pd(ab + 8 * j);
+        acc[j][1] = _mm256_loadu_pd(ab + 8 * j + 4);
+    }
+
+    for (int p = 0; p < kc; ++p) {
+        const __m256d a0 = _mm256_loadu_pd(Ap);
+        const __m256d a1 = _mm256_loadu_pd(Ap + 4);
+
+        for (int j = 0; j < 6; ++j) {
+            const __m256d b = _mm256_broadcast_sd(Bp + j);
+            acc[j][0] = _mm256_fmadd_pd(a0, b, acc[j][0]);
+            acc[j][1] = _mm256_fmadd_pd(a1, b, acc[j][1]);
+        }
+
+        Ap += 8;
+        Bp += 6;
+    }
+
+    for (int j = 0; j < 6; ++j) {
+        _mm256_storeu_pd(ab + 8 * j, acc[j][0]);
+        _mm256_storeu_pd(ab + 8 * j + 4, acc[j][1]);
+    }
+}
+
+__attribute__((target("avx512f")))
+void microKernelAvx512(int kc, const float* Ap, const float* Bp, float* ab)
+{
+    __m512 acc[6];
+
+    for (int j = 0; j < 6; ++j)
+        acc[j] = _mm512_loadu_ps(ab + 16 * j);
+
+    for (int p = 0; p < kc; ++p) {
+        const __m512 a = _mm512_loadu_ps(Ap);
+
+        for (int j = 0; j < 6; ++j)
+            acc[j] = _mm512_fmadd_ps(a, _mm512_set1_ps(Bp[j]), acc[j]);
+
+        Ap += 16;
+        Bp += 6;
+    }
+
+    for (int j = 0; j < 6; ++j)
+        _mm512_storeu_ps(ab + 16 * j, acc[j]);
+}
+
+__attribute__((target("avx512f")))
+void microKernelAvx512(int kc, const double* Ap, const double* Bp, double* ab)
+{
+    __m512d acc[6];
+
+    for (int j = 0; j < 6; ++j)
+        acc[j] = _mm512_loadu_pd(ab + 8 * j);
+
+    for (int p = 0; p < kc; ++p) {
+        const __m512d a = _mm512_loadu_pd(Ap);
+
+        for (int j = 0; j < 6; ++j)
+            acc[j] = _mm512_fmadd_pd(a, _mm512_set1_pd(Bp[j]), acc[j]);
+
+        Ap += 8;
+        Bp += 6;
+    }
+
+    for (int j = 0; j < 6; ++j)
+        _mm512_storeu_pd(ab + 8 * j, acc[j]);
+}
+#endif
+
+/// Select the micro-kernel for the instruction set of the running CPU
+template <class U>
+void (*selectMicroKernel())(int, const U*, const U*, U*)
+{
+#ifdef GEMM_X86_DISPATCH
+    __builtin_cpu_init();
+
+    if (__builtin_cpu_supports("avx512f"))
+        return &microKernelAvx512;
+    else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        return &microKernelAvx2;
+#endif
+
+    return &microKernel<U>;
+}
+
+template <class T>
+void scale(int m, int n, const T& beta, T* C, int ldc)
+{
+    if (beta == T(1.0))
+        return;
+
+#pragma omp parallel for if (m * n > 4096)
+    for (int j = 0; j < n; ++j) {
+        T* c = C + (size_t)j * ldc;
+
+        if (beta == T(0.0))
+            std::fill(c, c + m, T(0.0));
+        else {
+            for (int i = 0; i < m; ++i)
+                c[i] *= beta;
+        }
+    }
+}
+}
+
+template <class T>
+void N2D2::Gemm::gemm(Operation transA, Operation transB,
+                      int m, int n, int k,
+                      const T* alpha,
+                      const T* A, int lda,
+                      const T* B, int ldb,
+                      const T* beta,
+                      T* C, int ldc)
+{
+    typedef typename Acc<T>::type U;
+    typedef void (*MicroKernel)(int, const U*, const U*, U*);
+
+    static const MicroKernel microKernelIsa = selectMicroKernel<U>();
+    const int MR = Tile<U>::MR;
+    const int NR = Tile<U>::NR;
+
+    if (m <= 0 || n <= 0)
+        return;
+
+    // beta is applied once on C, the blocks of A * B are then accumulated
+    scale(m, n, *beta, C, ldc);
+
+    if (k <= 0 || *alpha == T(0.0))
+        return;
+
+    const U alphaAcc = U(*alpha);
+    // With alpha = 1, the accumulators start from C, so that the products are
+    // summed in the same order as with a sequential dot product
+    const bool unitAlpha = (alphaAcc == U(1.0));
+    const int nbPanelsMax = (GEMM_NC + NR - 1) / NR;
+    std::vector<U> Bp((size_t)nbPanelsMax * NR * GEMM_KC);
+
+#pragma omp parallel if ((double)m * n * k > 262144.0)
+    {
+        std::vector<U> Ap((size_t)GEMM_MC * GEMM_KC);
+        std::vector<U> ab(MR * NR);
+
+        for (int jc = 0; jc < n; jc += GEMM_NC) {
+            const int nc = std::min(GEMM_NC, n - jc);
+            const int nbPanels = (nc + NR - 1) / NR;
+
+            for (int pc = 0; pc < k; pc += GEMM_KC) {
+                const int kc = std::min(GEMM_KC, k - pc);
+
+#pragma omp for schedule(static)
+                for (int jp = 0; jp < nbPanels; ++jp) {
+                    const int jr = jp * NR;
+
+                    packB(transB, B, ldb, pc, kc, jc + jr,
+                          std::min(NR, nc - jr),
+                          &Bp[(size_t)jp * NR * kc]);
+                }
+
+#pragma omp for schedule(dynamic)
+                for (int ic = 0; ic < m; ic += GEMM_MC) {
+                    const int mc = std::min(GEMM_MC, m - ic);
+
+                    packA(transA, A, lda, ic, mc, pc, kc, &Ap[0]);
+
+                    for (int jr = 0; jr < nc; jr += NR) {
+                        const int nr = std::min(NR, nc - jr);
+                        const U* Bpanel = &Bp[(size_t)jr * kc];
+
+                        for (int ir = 0; ir < mc; ir += MR) {
+                            const int mr = std::min(MR, mc - ir);
+                            T* c = C + (ic + ir) + (size_t)(jc + jr) * ldc;
+
+                            if (unitAlpha) {
+                                for (int j = 0; j < nr; ++j) {
+                                    for (int i = 0; i < mr; ++i)
+                                        ab[i + j * MR] = U(c[i + j * ldc]);
+                                }
+                            }
+                            else
+                                std::fill(ab.begin(), ab.end(), U(0.0));
+
+                            (*microKernelIsa)(kc, &Ap[(size_t)ir * kc],
+                                              Bpanel, &ab[0]);
+
+                            for (int j = 0; j < nr; ++j) {
+                                for (int i = 0; i < mr; ++i) {
+                                    c[i + j * ldc] = (unitAlpha)
+                                        ? T(ab[i + j * MR])
+                                        : T(U(c[i + j * ldc])
+                                            + alphaAcc * ab[i + j * MR]);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+namespace N2D2 {
+    template void Gemm::gemm<half_float::half>(Operation transA,
+                                               Operation transB,
+                                               int m, int n, int k,
+                                               const half_float::half* alpha,
+                                               const half_float::half* A,
+                                               int lda,
+                                               const half_float::half* B,
+                                               int ldb,
+                                               const half_float::half* beta,
+                                               half_float::half* C, int ldc);
+    template void Gemm::gemm<float>(Operation transA, Operation transB,
+                                    int m, int n, int k,
+                                    const float* alpha,
+                                    const float* A, int lda,
+                                    const float* B, int ldb,
+                                    const float* beta,
+                                    float* C, int ldc);
+    template void Gemm::gemm<double>(Operation transA, Operation transB,
+                                     int m, int n, int k,
+                                     const double* alpha,
+                                     const double* A, int lda,
+                                     const double* B, int ldb,
+                                     const double* beta,
+                                     double* C, int ldc);
+}
@@ -24,8 +24,15 @@
  * The main goal is to be able to expose those functions to the python binding.
  * A secondary goal is to remove code out of the `n2d2.cpp` file.
 */
+#include <cstdio>
 #include <future>
 
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
 #include "N2D2.hpp"
 #include "DeepNet.hpp"
 #include "DeepNetQuantization.hpp"
@@ -57,6 +64,7 @@
 #include "Target/TargetMatching.hpp"
 #include "Transformation/RangeAffineTransformation.hpp"
 #include "utils/ProgramOptions.hpp"
+#include "utils/RingAllReduce.hpp"
 #include "Adversarial.hpp"
 #include "utils/Helper.hpp"
 
@@ -250,9 +258,21 @@ namespace N2D2_HELPER{
         test =        opts.parse("-test", "perform testing");
         testQAT =     opts.parse("-testQAT", "perform testing");
         fuse =        opts.parse("-fuse", "fuse BatchNorm with Conv for test and export");
+        memPlan =     opts.parse("-mem-plan", "share the layers outputs memory for test "
+                                                "(inference only)");
         bench =       opts.parse("-bench", "learning speed benchmarking");
+        dataParallel = opts.parse("-dp", dataParallel, "number of local processes for "
+                                                "data-parallel learning on CPU "
+                                                "(0 = disabled)");
+        paramArena =  opts.parse("-param-arena", "store the free parameters and "
+                                                "gradients in a single contiguous "
+                                                "arena for learning");
         learnStdp =   opts.parse("-learn-stdp", learnStdp, "number of STDP learning steps");
         presentTime =   opts.parse("-present-time", presentTime, "presentation time in Us");
+        timingWheel = opts.parse("-timing-wheel", "schedule the spike events with a "
+                                                "timing wheel instead of a priority queue");
+        simThreads =  opts.parse("-sim-threads", simThreads, "number of threads for "
+                                                "the spike simulation (0: sequential)");
         avgWindow =   opts.parse("-ws", avgWindow, "average window to compute success rate "
                                                 "during learning");
         testIndex =   opts.parse("-test-index", testIndex, "test a single specific stimulus index"
@@ -275,6 +295,10 @@ namespace N2D2_HELPER{
                                             "test dataset)");
         calibrationReload = opts.parse("-calib-reload", "reload and reuse the data of a "
                                                         " previous calibration.");
+        calibrationCheckpoint = opts.parse("-calib-checkpoint", calibrationCheckpoint,
+                                            "number of stimuli between two saves of the "
+                                            "partial calibration data, which can be resumed "
+                                            "with -calib-reload (0 = no checkpoint)");
         cRoundMode = weightsScalingMode(
                         opts.parse("-c-round-mode", std::string("NONE"), 
                                         "clip clipping mode on export, "
@@ -350,6 +374,104 @@ namespace N2D2_HELPER{
         }
     }
  
+    std::shared_ptr<RingAllReduce> initDataParallel(Options& opt,
+                                                    char* argv[])
+    {
+        if (opt.dataParallel <= 1)
+            return std::shared_ptr<RingAllReduce>();
+
+#if defined(CUDA) || !defined(__linux__)
+        // The processes are spawned by executing /proc/self/exe
+        (void)argv;
+        throw std::runtime_error("Data-parallel learning (-dp) is only "
+                                 "supported on CPU on Linux");
+#else
+        if (opt.learnEpoch > 0) {
+            throw std::runtime_error("Data-parallel learning (-dp) is only "
+                                     "supported with -learn");
+        }
+
+        unsigned int rank = 0;
+        std::string address;
+        const char* rankEnv = std::getenv("N2D2_DP_RANK");
+
+        if (rankEnv == NULL) {
+            // Launcher process: becomes the rank 0 and spawns the others.
+            // Every process must start with the same seed in order to
+            // initialize the same free parameters.
+            if (opt.seed == 0) {
+                opt.seed = std::chrono::high_resolution_clock::now()
+                    .time_since_epoch().count();
+            }
+
+            std::ostringstream addressStr;
+            addressStr << "/tmp/n2d2_dp_" << getpid();
+            address = addressStr.str();
+
+            setenv("N2D2_DP_ADDRESS", address.c_str(), 1);
+            setenv("N2D2_DP_SEED", std::to_string(opt.seed).c_str(), 1);
+
+            for (unsigned int r = 1; r < opt.dataParallel; ++r) {
+                std::ostringstream dirName;
+                dirName << "dp_rank" << r;
+                Utils::createDirectories(dirName.str());
+
+                std::cout << "Data-parallel learning: spawning rank " << r
+                    << " (log in " << dirName.str() << "/n2d2.log)"
+                    << std::endl;
+
+                const pid_t pid = fork();
+
+                if (pid < 0)
+                    throw std::runtime_error("Unable to fork data-parallel "
+                                             "process");
+                else if (pid == 0) {
+                    setenv("N2D2_DP_RANK", std::to_string(r).c_str(), 1);
+
+                    const int logFd = open((dirName.str() + "/n2d2.log")
+                        .c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+                    if (logFd >= 0) {
+                        dup2(logFd, STDOUT_FILENO);
+                        dup2(logFd, STDERR_FILENO);
+                        close(logFd);
+                    }
+
+                    execv("/proc/self/exe", argv);
+                    _exit(EXIT_FAILURE);
+                }
+            }
+        }
+        else {
+            rank = std::atoi(rankEnv);
+            address = std::getenv("N2D2_DP_ADDRESS");
+            opt.seed = std::strtoul(std::getenv("N2D2_DP_SEED"), NULL, 10);
+
+            // The rank > 0 processes run in their own directory (see
+            // exec/n2d2), make the input locations absolute
+            char cwd[4096];
+
+            if (getcwd(cwd, sizeof(cwd)) != NULL) {
+                if (!opt.load.empty() && opt.load[0] != '/')
+                    opt.load = std::string(cwd) + "/" + opt.load;
+
+                if (!opt.weights.empty() && opt.weights[0] != '/')
+                    opt.weights = std::string(cwd) + "/" + opt.weights;
+            }
+        }
+
+        std::shared_ptr<RingAllReduce> dataParallel
+            = std::make_shared<RingAllReduce>(rank, opt.dataParallel,
+                                              address);
+
+        std::cout << "Data-parallel learning: rank " << rank << "/"
+            << opt.dataParallel << " connected" << std::endl;
+
+        Solver::mGradientReduction = dataParallel;
+        return dataParallel;
+#endif
+    }
+
     void test(const Options& opt, std::shared_ptr<DeepNet>& deepNet, bool afterCalibration) {
         const std::string testName = (afterCalibration) ? "export" : "test";
 
@@ -387,6 +509,15 @@ namespace N2D2_HELPER{
             deepNet->exportNetworkFreeParameters("weights_quantized");
         }
 
+        if (opt.memPlan) {
+            if (opt.logOutputs > 0) {
+                std::cout << Utils::cwarning << "Warning: -mem-plan ignored "
+                    "with -log-outputs" << Utils::cdef << std::endl;
+            }
+            else
+                deepNet->planInferenceMemory();
+        }
+
         startTimeSp = std::chrono::high_resolution_clock::now();
         if (opt.testId >= 0)
             sp->readStimulusBatch(opt.testId, Database::Test);
@@ -588,7 +719,9 @@ namespace N2D2_HELPER{
                 }
             }
         }
-        
+
+        if (deepNet->isInferenceMemoryPlanned())
+            deepNet->clearInferenceMemoryPlan();
     }
 
     void importFreeParameters(const Options& opt, DeepNet& deepNet) {
@@ -676,9 +809,13 @@ namespace N2D2_HELPER{
 
             const std::string outputsRangeFile = exportDir + "/calibration/outputs_range.bin";
             const std::string outputsHistogramFile = exportDir + "/calibration/outputs_histogram.bin";
+            // Number of stimuli already processed, for a partial calibration
+            const std::string progressFile = exportDir + "/calibration/progress.dat";
 
             std::unordered_map<std::string, RangeStats> outputsRange;
             std::unordered_map<std::string, Histogram> outputsHistogram;
+            std::size_t firstStimulus = 0;
+            bool reloaded = false;
 
             if(opt.calibrationReload &&
             std::ifstream(outputsRangeFile.c_str()).good() && 
@@ -686,33 +823,55 @@ namespace N2D2_HELPER{
             {
                 RangeStats::loadOutputsRange(outputsRangeFile, outputsRange);
                 Histogram::loadOutputsHistogram(outputsHistogramFile, outputsHistogram);
+                reloaded = true;
+
+                std::ifstream progress(progressFile.c_str());
+
+                if (progress.good()) {
+                    if (!(progress >> firstStimulus)) {
+                        throw std::runtime_error("Could not read calibration "
+                                                 "progress file: " + progressFile);
+                    }
+
+                    std::cout << "Resuming calibration at stimulus "
+                        << firstStimulus << "/" << nbStimuli << std::endl;
+                }
+                else
+                    firstStimulus = nbStimuli;
             }
-            else {
+
+            if (firstStimulus < nbStimuli) {
                 const std::size_t batchSize = sp->getMultiBatchSize();
-                const std::size_t nbBatches = std::ceil(1.0*nbStimuli/batchSize);
+                const std::size_t nbBatches = std::ceil(1.0*(nbStimuli - firstStimulus)/batchSize);
+
+                if (!reloaded)
+                    std::cout << "Calculating calibration data range and histogram..." << std::endl;
 
-                std::cout << "Calculating calibration data range and histogram..." << std::endl;
-                std::size_t nextReport = opt.report;
+                std::size_t nextReport = firstStimulus + opt.report;
+                std::size_t nextCheckpoint = firstStimulus + opt.calibrationCheckpoint;
 
                 // Globally disable logistic activation, in order to evaluate the
                 // correct range and shifting required for layers with logistic
                 LogisticActivationDisabled = true;
 
-                sp->readBatch(dbSet, 0);
+                // The statistics of a batch are computed on a copy of its
+                // outputs, during the propagation of the next batch
+                DeepNetQuantization::OutputsSnapshot outputs[2];
+                std::future<void> reportTask;
+
+                sp->readBatch(dbSet, firstStimulus);
                 for(std::size_t b = 1; b <= nbBatches; ++b) {
-                    const std::size_t istimulus = b * batchSize;
+                    const std::size_t istimulus = firstStimulus + b * batchSize;
 
                     sp->synchronize();
 
                     // TODO Use a pool of threads
-                    auto reportTask = std::async(std::launch::async, [&]() { 
+                    auto testTask = std::async(std::launch::async, [&, b]() { 
     #ifdef CUDA
                         CudaContext::setDevice(cudaDevice);
     #endif
                         deepNet->test(dbSet);
-                        dnQuantization.reportOutputsRange(outputsRange);
-                        dnQuantization.reportOutputsHistogram(outputsHistogram, outputsRange, 
-                                                            opt.nbBits, opt.actClippingMode);
+                        dnQuantization.snapshotOutputs(outputs[b % 2]);
                     });
 
                     if(b < nbBatches) {
@@ -720,19 +879,53 @@ namespace N2D2_HELPER{
                         sp->readBatch(dbSet, istimulus);
                     }
 
-                    reportTask.wait();
+                    // get() rethrows the exceptions of the tasks
+                    testTask.get();
+
+                    if (reportTask.valid())
+                        reportTask.get();
+
+                    reportTask = std::async(std::launch::async, [&, b]() {
+                        dnQuantization.reportOutputsStats(outputs[b % 2],
+                                                          outputsRange,
+                                                          outputsHistogram,
+                                                          opt.nbBits,
+                                                          opt.actClippingMode);
+                    });
 
                     if(istimulus >= nextReport && b < nbBatches) {
                         nextReport += opt.report;
                         std::cout << "Calibration data " << istimulus << "/" << nbStimuli << std::endl;
                     }
+
+                    if (opt.calibrationCheckpoint > 0
+                        && istimulus >= nextCheckpoint && b < nbBatches)
+                    {
+                        nextCheckpoint += opt.calibrationCheckpoint;
+                        reportTask.get();
+
+                        RangeStats::saveOutputsRange(outputsRangeFile, outputsRange);
+                        Histogram::saveOutputsHistogram(outputsHistogramFile, outputsHistogram);
+
+                        std::ofstream progress(progressFile.c_str());
+                        progress << istimulus << std::endl;
+
+                        if (!progress.good()) {
+                            throw std::runtime_error("Could not write calibration "
+                                                     "progress file: " + progressFile);
+                        }
+                    }
                 }
 
+                if (reportTask.valid())
+                    reportTask.get();
+
                 LogisticActivationDisabled = false;
 
 
                 RangeStats::saveOutputsRange(outputsRangeFile, outputsRange);
                 Histogram::saveOutputsHistogram(outputsHistogramFile, outputsHistogram);
+                std::remove(progressFile.c_str());
             }
 
             RangeStats::logOutputsRange(exportDir + "/calibration/outputs_range.dat", outputsRange);
@@ -948,11 +1141,30 @@ namespace N2D2_HELPER{
         std::cout << "Done!" << std::endl;
     }
 
+    void initParameterArena(const Options& opt,
+                            std::shared_ptr<DeepNet>& deepNet)
+    {
+        if (!opt.paramArena)
+            return;
+
+        deepNet->initializeParameterArena();
+
+        const std::shared_ptr<ParameterArena<Float_T> > arena
+            = deepNet->getParameterArena();
+
+        std::cout << "Parameter arena: "
+            << arena->getNbParametersTensors() << " parameters tensors ("
+            << arena->getParametersSize() << " elements), "
+            << arena->getNbGradientsTensors() << " gradients tensors ("
+            << arena->getGradientsSize() << " elements)" << std::endl;
+    }
+
     void learn_epoch(const Options& opt, std::shared_ptr<DeepNet>& deepNet) {
         std::shared_ptr<Database> database = deepNet->getDatabase();
         std::shared_ptr<StimuliProvider> sp = deepNet->getStimuliProvider();
 
         deepNet->exportNetworkFreeParameters("weights_init");
+        initParameterArena(opt, deepNet);
 
     #ifdef CUDA
         sp->setStates(deepNet->getStates());
@@ -1163,6 +1375,7 @@ namespace N2D2_HELPER{
                 deepNet->logEstimatedLabels("learning");
                 deepNet->log("learning", Database::Learn);
                 deepNet->clear(Database::Learn);
+                database->logMemoryCacheStats("learning_cache.log", epoch + 1);
 
                 if (database->getNbStimuli(Database::Validation) > 0) {
 
@@ -1441,6 +1654,7 @@ namespace N2D2_HELPER{
         const int nbEpochSize = database->getNbStimuli(Database::Learn);
 
         deepNet->exportNetworkFreeParameters("weights_init");
+        initParameterArena(opt, deepNet);
 
     #ifdef CUDA
         sp->setStates(deepNet->getStates());
@@ -1455,17 +1669,38 @@ namespace N2D2_HELPER{
         unsigned int nbNoValid = 0;
 
         const unsigned int batchSize = sp->getMultiBatchSize();
-        const unsigned int nbBatch = std::ceil(opt.learn / (double)batchSize);
+        // With data-parallel learning, each process learns its own batch and
+        // the steps count the stimuli of all the processes
+        const unsigned int nbProcesses = (Solver::mGradientReduction)
+            ? Solver::mGradientReduction->getSize() : 1;
+        // The validation runs on the rank 0 only, which decides for all the
+        // processes when to stop the learning: the other processes may have
+        // different BatchNorm statistics and would not reach the same
+        // decision
+        const bool validationRank = (!Solver::mGradientReduction
+                                || Solver::mGradientReduction->getRank() == 0);
+        bool stopLearning = false;
+        const unsigned int nbBatch
+            = std::ceil(opt.learn / (double)(batchSize * nbProcesses));
         const unsigned int avgBatchWindow = opt.avgWindow / (double)sp->getBatchSize();
+        // With prefetching, the learning batches are read ahead by the
+        // StimuliProvider worker threads instead of the main thread
+        const bool prefetch
+            = (sp->getParameter<unsigned int>("PrefetchDepth") > 0);
 
         startTimeSp = std::chrono::high_resolution_clock::now();
-        sp->readRandomBatch(Database::Learn);
+
+        if (prefetch)
+            sp->startPrefetch(Database::Learn);
+        else
+            sp->readRandomBatch(Database::Learn);
+
         endTimeSp = std::chrono::high_resolution_clock::now();
 
         std::vector<std::pair<std::string, double> > timings, cumTimings;
 
         for (unsigned int b = 0; b < nbBatch; ++b) {
-            const unsigned int i = b * batchSize;
+            const unsigned int i = b * batchSize * nbProcesses;
 
             if (opt.bench) {
                 timings.push_back(std::make_pair(
@@ -1474,7 +1709,14 @@ namespace N2D2_HELPER{
                                                     .count()));
             }
 
-            sp->synchronize();
+            if (prefetch) {
+                // Only measures the time spent waiting for a ready batch
+                startTimeSp = std::chrono::high_resolution_clock::now();
+                sp->readPrefetchedBatch();
+                endTimeSp = std::chrono::high_resolution_clock::now();
+            }
+            else
+                sp->synchronize();
 
             if (sp->getAdversarialAttack()->getAttackName() != Adversarial::Attack_T::None) 
                 sp->getAdversarialAttack()->attackLauncher(deepNet);
@@ -1483,10 +1725,12 @@ namespace N2D2_HELPER{
                                     deepNet,
                                     (opt.bench) ? &timings : NULL);
 
-            sp->future();
-            startTimeSp = std::chrono::high_resolution_clock::now();
-            sp->readRandomBatch(Database::Learn);
-            endTimeSp = std::chrono::high_resolution_clock::now();
+            if (!prefetch) {
+                sp->future();
+                startTimeSp = std::chrono::high_resolution_clock::now();
+                sp->readRandomBatch(Database::Learn);
+                endTimeSp = std::chrono::high_resolution_clock::now();
+            }
 
             learnThread.join();
 
@@ -1628,8 +1872,12 @@ namespace N2D2_HELPER{
                 deepNet->logEstimatedLabels("learning");
                 deepNet->log("learning", Database::Learn);
                 deepNet->clear(Database::Learn);
+                database->logMemoryCacheStats("learning_cache.log",
+                                              i + batchSize);
 
-                if (database->getNbStimuli(Database::Validation) > 0) {
+                if (database->getNbStimuli(Database::Validation) > 0
+                    && validationRank)
+                {
                     const unsigned int nbValid
                         = database->getNbStimuli(Database::Validation);
                     const unsigned int nbBatchValid
@@ -1640,6 +1888,9 @@ namespace N2D2_HELPER{
 
                     // We are alread in sp->future(), read the first validation
                     // batch
+                    if (prefetch)
+                        sp->future();
+
                     sp->readBatch(Database::Validation, 0);
 
                     for (unsigned int bv = 1; bv <= nbBatchValid; ++bv) {
@@ -1670,8 +1921,9 @@ namespace N2D2_HELPER{
                     std::cout << std::endl;
 
                     // We are in sp->future(), must read the next batch for the 
-                    // learning
-                    sp->readRandomBatch(Database::Learn);
+                    // learning (already in the prefetch queue otherwise)
+                    if (!prefetch)
+                        sp->readRandomBatch(Database::Learn);
 
                     bool bestValidationPrimary = false;
 
@@ -1757,6 +2009,7 @@ namespace N2D2_HELPER{
                                         << opt.stopValid << " steps\n" << std::endl;
                                     std::cout << "\n--- STOPPING THE LEARNING\n"
                                                 << std::endl;
+                                    stopLearning = true;
                                     break;
                                 }
                             }
@@ -1828,6 +2081,7 @@ namespace N2D2_HELPER{
                                         << opt.stopValid << " steps\n" << std::endl;
                                     std::cout << "\n--- STOPPING THE LEARNING\n"
                                                 << std::endl;
+                                    stopLearning = true;
                                     break;
                                 }
                             }
@@ -1885,6 +2139,7 @@ namespace N2D2_HELPER{
                                         << opt.stopValid << " steps\n" << std::endl;
                                     std::cout << "\n--- STOPPING THE LEARNING\n"
                                                 << std::endl;
+                                    stopLearning = true;
                                     break;
                                 }
                             }
@@ -1895,13 +2150,25 @@ namespace N2D2_HELPER{
 
                     deepNet->clear(Database::Validation);
                 }
-                else {
+                else if (database->getNbStimuli(Database::Validation) == 0) {
                     deepNet->exportNetworkFreeParameters("weights");
                     deepNet->save("net_state");
                 }
+
+                if (Solver::mGradientReduction) {
+                    int stop = stopLearning;
+                    Solver::mGradientReduction->broadcast(&stop, 1, 0);
+                    stopLearning = (stop != 0);
+                }
+
+                if (stopLearning)
+                    break;
             }
         }
 
+        if (prefetch)
+            sp->stopPrefetch();
+
         if (opt.logKernels)
             deepNet->logFreeParameters("kernels");
 
@@ -0,0 +1,103 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "utils/MemoryMappedFile.hpp"
+
+#include <fstream>
+#include <stdexcept>
+
+#if !defined(WIN32) && !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+N2D2::MemoryMappedFile::MemoryMappedFile(const std::string& fileName)
+    : mFileName(fileName),
+      mData(NULL),
+      mSize(0)
+{
+#if !defined(WIN32) && !defined(_WIN32)
+    const int fd = open(mFileName.c_str(), O_RDONLY);
+
+    if (fd < 0) {
+        throw std::runtime_error("MemoryMappedFile::MemoryMappedFile(): "
+                                 "could not open file: " + mFileName);
+    }
+
+    struct stat fileStat;
+
+    if (fstat(fd, &fileStat) != 0) {
+        close(fd);
+        throw std::runtime_error("MemoryMappedFile::MemoryMappedFile(): "
+                                 "could not stat file: " + mFileName);
+    }
+
+    mSize = fileStat.st_size;
+
+    if (mSize > 0) {
+        void* mapping = mmap(NULL, mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (mapping == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("MemoryMappedFile::MemoryMappedFile(): "
+                                     "could not map file: " + mFileName);
+        }
+
+        mData = static_cast<unsigned char*>(mapping);
+    }
+
+    // The mapping remains valid after the file descriptor is closed
+    close(fd);
+#else
+    std::ifstream file(mFileName.c_str(), std::ios::binary);
+
+    if (!file.good()) {
+        throw std::runtime_error("MemoryMappedFile::MemoryMappedFile(): "
+                                 "could not open file: " + mFileName);
+    }
+
+    file.seekg(0, std::ios::end);
+    mSize = file.tellg();
+    file.seekg(0, std::ios::beg);
+
+    mBuffer.resize(mSize);
+
+    if (mSize > 0) {
+        file.read(reinterpret_cast<char*>(&mBuffer[0]), mSize);
+
+        if (!file.good()) {
+            throw std::runtime_error("MemoryMappedFile::MemoryMappedFile(): "
+                                     "could not read file: " + mFileName);
+        }
+
+        mData = &mBuffer[0];
+    }
+#endif
+}
+
+N2D2::MemoryMappedFile::~MemoryMappedFile()
+{
+#if !defined(WIN32) && !defined(_WIN32)
+    if (mData != NULL)
+        munmap(mData, mSize);
+#endif
+}
@@ -0,0 +1,378 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "utils/RingAllReduce.hpp"
+#include "third_party/half.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifndef WIN32
+    std::string socketError(const std::string& what)
+    {
+        return "RingAllReduce: " + what + ": " + std::string(std::strerror(errno));
+    }
+
+    sockaddr_un socketAddress(const std::string& address, unsigned int rank)
+    {
+        std::ostringstream pathStr;
+        pathStr << address << "." << rank;
+
+        sockaddr_un addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+
+        if (pathStr.str().size() >= sizeof(addr.sun_path)) {
+            throw std::runtime_error("RingAllReduce: socket path too long: "
+                                     + pathStr.str());
+        }
+
+        std::strncpy(addr.sun_path, pathStr.str().c_str(),
+                     sizeof(addr.sun_path) - 1);
+        return addr;
+    }
+#endif
+}
+
+N2D2::RingAllReduce::RingAllReduce(unsigned int rank,
+                                   unsigned int size,
+                                   const std::string& address,
+                                   std::size_t chunkSize,
+                                   double connectTimeout)
+    : mRank(rank),
+      mSize(size),
+      mChunkSize(std::max<std::size_t>(1, chunkSize)),
+      mNextFd(-1),
+      mPrevFd(-1)
+{
+    if (mSize == 0 || mRank >= mSize) {
+        std::ostringstream msgStr;
+        msgStr << "RingAllReduce: invalid rank " << mRank << " for a ring of "
+            "size " << mSize;
+        throw std::runtime_error(msgStr.str());
+    }
+
+    if (mSize == 1)
+        return;
+
+#ifndef WIN32
+    // Listen for the previous rank
+    const sockaddr_un listenAddr = socketAddress(address, mRank);
+    const int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listenFd < 0)
+        throw std::runtime_error(socketError("socket()"));
+
+    unlink(listenAddr.sun_path);
+
+    if (bind(listenFd, (const sockaddr*)&listenAddr, sizeof(listenAddr)) < 0
+        || listen(listenFd, 1) < 0)
+    {
+        const std::string msg = socketError(std::string("unable to listen on ")
+                                            + listenAddr.sun_path);
+        close(listenFd);
+        throw std::runtime_error(msg);
+    }
+
+    // Connect to the next rank, which may not be listening yet
+    const sockaddr_un nextAddr = socketAddress(address, (mRank + 1) % mSize);
+    const std::chrono::high_resolution_clock::time_point startTime
+        = std::chrono::high_resolution_clock::now();
+
+    while (true) {
+        mNextFd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (mNextFd < 0) {
+            close(listenFd);
+            throw std::runtime_error(socketError("socket()"));
+        }
+
+        if (connect(mNextFd, (const sockaddr*)&nextAddr, sizeof(nextAddr)) == 0)
+            break;
+
+        close(mNextFd);
+        mNextFd = -1;
+
+        const double elapsed = std::chrono::duration_cast
+            <std::chrono::duration<double> >(
+                std::chrono::high_resolution_clock::now() - startTime).count();
+
+        if ((errno != ENOENT && errno != ECONNREFUSED)
+            || elapsed > connectTimeout)
+        {
+            const std::string msg = socketError(std::string("unable to "
+                "connect to ") + nextAddr.sun_path);
+            close(listenFd);
+            unlink(listenAddr.sun_path);
+            throw std::runtime_error(msg);
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    mPrevFd = accept(listenFd, NULL, NULL);
+    close(listenFd);
+    unlink(listenAddr.sun_path);
+
+    if (mPrevFd < 0) {
+        close(mNextFd);
+        throw std::runtime_error(socketError("accept()"));
+    }
+
+    fcntl(mNextFd, F_SETFL, fcntl(mNextFd, F_GETFL) | O_NONBLOCK);
+    fcntl(mPrevFd, F_SETFL, fcntl(mPrevFd, F_GETFL) | O_NONBLOCK);
+
+    mRecvBuffer.resize(mChunkSize);
+#else
+    throw std::runtime_error("RingAllReduce: not supported on this platform");
+#endif
+}
+
+template <class T>
+void N2D2::RingAllReduce::allReduce(T* data, std::size_t count)
+{
+    if (mSize == 1 || count == 0)
+        return;
+
+    // Number of elements exchanged per chunk
+    const std::size_t chunkCount = std::max<std::size_t>(1,
+                                                    mChunkSize / sizeof(T));
+
+    // Reduce-scatter: after step k, segment (rank - k - 1) holds the partial
+    // sum of k + 2 ranks. Rank r ends with the full sum of segment r + 1.
+    for (unsigned int k = 0; k < mSize - 1; ++k) {
+        const unsigned int sendSeg = (mRank + mSize - k) % mSize;
+        const unsigned int recvSeg = (mRank + 2 * mSize - k - 1) % mSize;
+        const std::size_t sendBegin = segmentBegin(sendSeg, count);
+        const std::size_t sendEnd = segmentBegin(sendSeg + 1, count);
+        const std::size_t recvBegin = segmentBegin(recvSeg, count);
+        const std::size_t recvEnd = segmentBegin(recvSeg + 1, count);
+
+        for (std::size_t offset = 0;
+            sendBegin + offset < sendEnd || recvBegin + offset < recvEnd;
+            offset += chunkCount)
+        {
+            const std::size_t nbSend = (sendBegin + offset < sendEnd)
+                ? std::min(chunkCount, sendEnd - sendBegin - offset) : 0;
+            const std::size_t nbRecv = (recvBegin + offset < recvEnd)
+                ? std::min(chunkCount, recvEnd - recvBegin - offset) : 0;
+
+            exchange((const char*)(data + sendBegin + offset),
+                     nbSend * sizeof(T),
+                     &mRecvBuffer[0],
+                     nbRecv * sizeof(T));
+
+            const T* recvData = reinterpret_cast<const T*>(&mRecvBuffer[0]);
+            T* accData = data + recvBegin + offset;
+
+            for (std::size_t i = 0; i < nbRecv; ++i)
+                accData[i] += recvData[i];
+        }
+    }
+
+    // All-gather: circulate the fully reduced segments
+    for (unsigned int k = 0; k < mSize - 1; ++k) {
+        const unsigned int sendSeg = (mRank + 1 + mSize - k) % mSize;
+        const unsigned int recvSeg = (mRank + mSize - k) % mSize;
+        const std::size_t sendBegin = segmentBegin(sendSeg, count);
+        const std::size_t sendEnd = segmentBegin(sendSeg + 1, count);
+        const std::size_t recvBegin = segmentBegin(recvSeg, count);
+        const std::size_t recvEnd = segmentBegin(recvSeg + 1, count);
+
+        for (std::size_t offset = 0;
+            sendBegin + offset < sendEnd || recvBegin + offset < recvEnd;
+            offset += chunkCount)
+        {
+            const std::size_t nbSend = (sendBegin + offset < sendEnd)
+                ? std::min(chunkCount, sendEnd - sendBegin - offset) : 0;
+            const std::size_t nbRecv = (recvBegin + offset < recvEnd)
+                ? std::min(chunkCount, recvEnd - recvBegin - offset) : 0;
+
+            // Sent and received segments never overlap, receive in place
+            exchange((const char*)(data + sendBegin + offset),
+                     nbSend * sizeof(T),
+                     (char*)(data + recvBegin + offset),
+                     nbRecv * sizeof(T));
+        }
+    }
+}
+
+template <class T>
+void N2D2::RingAllReduce::average(T* data, std::size_t count)
+{
+    if (mSize == 1)
+        return;
+
+    allReduce(data, count);
+
+    const T scale = T(1.0 / mSize);
+
+    for (std::size_t index = 0; index < count; ++index)
+        data[index] *= scale;
+}
+
+template <class T>
+void N2D2::RingAllReduce::broadcast(T* data,
+                                    std::size_t count,
+                                    unsigned int root)
+{
+    if (mSize == 1)
+        return;
+
+    if (mRank != root)
+        std::fill(data, data + count, T(0));
+
+    allReduce(data, count);
+}
+
+void N2D2::RingAllReduce::barrier()
+{
+    int token = 0;
+    allReduce(&token, 1);
+}
+
+void N2D2::RingAllReduce::exchange(const char* sendData,
+                                   std::size_t sendSize,
+                                   char* recvData,
+                                   std::size_t recvSize)
+{
+#ifndef WIN32
+    // Full duplex transfer: every rank sends and receives at the same time,
+    // which would deadlock with blocking calls once the socket buffers are
+    // full.
+    while (sendSize > 0 || recvSize > 0) {
+        pollfd fds[2];
+        nfds_t nfds = 0;
+
+        if (sendSize > 0) {
+            fds[nfds].fd = mNextFd;
+            fds[nfds].events = POLLOUT;
+            fds[nfds].revents = 0;
+            ++nfds;
+        }
+
+        if (recvSize > 0) {
+            fds[nfds].fd = mPrevFd;
+            fds[nfds].events = POLLIN;
+            fds[nfds].revents = 0;
+            ++nfds;
+        }
+
+        if (poll(fds, nfds, -1) < 0) {
+            if (errno == EINTR)
+                continue;
+
+            throw std::runtime_error(socketError("poll()"));
+        }
+
+        for (nfds_t n = 0; n < nfds; ++n) {
+            if (fds[n].revents == 0)
+                continue;
+
+            if (fds[n].fd == mNextFd) {
+                const ssize_t nbBytes = send(mNextFd, sendData, sendSize,
+                                             MSG_NOSIGNAL);
+
+                if (nbBytes < 0) {
+                    if (errno == EAGAIN || errno == EWOULDBLOCK
+                        || errno == EINTR)
+                        continue;
+
+                    throw std::runtime_error(socketError("send()"));
+                }
+
+                sendData += nbBytes;
+                sendSize -= nbBytes;
+            }
+            else {
+                const ssize_t nbBytes = recv(mPrevFd, recvData, recvSize, 0);
+
+                if (nbBytes == 0) {
+                    throw std::runtime_error("RingAllReduce: connection "
+                                             "closed by the previous rank");
+                }
+                else if (nbBytes < 0) {
+                    if (errno == EAGAIN || errno == EWOULDBLOCK
+                        || errno == EINTR)
+                        continue;
+
+                    throw std::runtime_error(socketError("recv()"));
+                }
+
+                recvData += nbBytes;
+                recvSize -= nbBytes;
+            }
+        }
+    }
+#else
+    (void)sendData;
+    (void)sendSize;
+    (void)recvData;
+    (void)recvSize;
+#endif
+}
+
+N2D2::RingAllReduce::~RingAllReduce()
+{
+#ifndef WIN32
+    if (mNextFd >= 0)
+        close(mNextFd);
+
+    if (mPrevFd >= 0)
+        close(mPrevFd);
+#endif
+}
+
+namespace N2D2 {
+template void RingAllReduce::allReduce<int>(int* data, std::size_t count);
+template void RingAllReduce::allReduce<float>(float* data, std::size_t count);
+template void RingAllReduce::allReduce<double>(double* data,
+                                               std::size_t count);
+template void RingAllReduce::allReduce<half_float::half>(
+    half_float::half* data, std::size_t count);
+
+template void RingAllReduce::average<float>(float* data, std::size_t count);
+template void RingAllReduce::average<double>(double* data,
+                                             std::size_t count);
+template void RingAllReduce::average<half_float::half>(
+    half_float::half* data, std::size_t count);
+
+template void RingAllReduce::broadcast<int>(int* data, std::size_t count,
+                                            unsigned int root);
+template void RingAllReduce::broadcast<float>(float* data, std::size_t count,
+                                              unsigned int root);
+template void RingAllReduce::broadcast<double>(double* data,
+                                               std::size_t count,
+                                               unsigned int root);
+}
@@ -24,6 +24,7 @@
 #include "Cell/ConvCell_Frame.hpp"
 #include "DeepNet.hpp"
 #include "Xnet/Environment.hpp"
+#include "containers/ParameterArena.hpp"
 #include "Xnet/Network.hpp"
 #include "utils/UnitTest.hpp"
 
@@ -93,6 +94,68 @@ TEST(BatchNormCell_Frame_float, setScales)
     ASSERT_EQUALS(bn2Scale(0), 2.0);
 }
 
+TEST(BatchNormCell_Frame_float, getFreeParameters)
+{
+    Network net(0U,false);
+    DeepNet dn(net);
+    Environment env(net, EmptyDatabase, {10, 10, 3});
+
+    BatchNormCell_Frame_Test<float> bn1(
+        dn, "bn1", 3, std::shared_ptr<Activation>());
+    BatchNormCell_Frame_Test<float> bn2(
+        dn, "bn2", 3, std::shared_ptr<Activation>());
+
+    bn1.addInput(env);
+    bn2.addInput(env);
+
+    bn2.setScales(bn1.getScales());
+    bn1.initialize();
+    bn2.initialize();
+
+    Tensor<float> bn1BiasSet({1}, 0.5);
+    bn1.setBias(2, bn1BiasSet);
+
+    std::vector<BaseTensor*> parameters;
+    std::vector<BaseTensor*> gradients;
+    bn1.getFreeParameters(parameters, gradients);
+    bn2.getFreeParameters(parameters, gradients);
+
+    ASSERT_EQUALS(parameters.size(), 4U);
+    ASSERT_EQUALS(gradients.size(), 4U);
+
+    ParameterArena<float> arena;
+
+    for (unsigned int i = 0; i < parameters.size(); ++i) {
+        arena.addParameters(dynamic_cast<Tensor<float>&>(*parameters[i]));
+        arena.addGradients(dynamic_cast<Tensor<float>&>(*gradients[i]));
+    }
+
+    arena.initialize();
+
+    // The scales shared between the two cells are stored once
+    ASSERT_EQUALS(arena.getNbParametersTensors(), 3U);
+    ASSERT_EQUALS(arena.getNbGradientsTensors(), 4U);
+
+    const float* data = arena.getParameters();
+    const float* dataEnd = data + arena.getParametersSize();
+    const float* scale = &(*std::dynamic_pointer_cast<Tensor<float> >(
+        bn1.getScales()))(0);
+    const float* bias = &(*std::dynamic_pointer_cast<Tensor<float> >(
+        bn1.getBiases()))(0);
+
+    ASSERT_TRUE(scale >= data && scale < dataEnd);
+    ASSERT_TRUE(bias >= data && bias < dataEnd);
+    ASSERT_EQUALS(bias[2], 0.5);
+
+    Tensor<float> bn1ScaleSet({1}, 2.0);
+    bn1.setScale(0, bn1ScaleSet);
+
+    Tensor<float> bn2Scale;
+    bn2.getScale(0, bn2Scale);
+
+    ASSERT_EQUALS(bn2Scale(0), 2.0);
+}
+
 TEST_DATASET(BatchNormCell_Frame_float,
              addInput__env,
              (unsigned int channelsWidth, unsigned int channelsHeight),
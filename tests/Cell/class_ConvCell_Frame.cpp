@@ -20,9 +20,11 @@
 
 #include "N2D2.hpp"
 
+#include "Activation/RectifierActivation_Frame.hpp"
 #include "Cell/ConvCell_Frame.hpp"
 #include "Database/MNIST_IDX_Database.hpp"
 #include "DeepNet.hpp"
+#include "Filler/NormalFiller.hpp"
 #include "Xnet/Environment.hpp"
 #include "Xnet/Network.hpp"
 #include "third_party/half.hpp"
@@ -65,6 +67,7 @@ public:
     friend class UnitTest_ConvCell_Frame_float_propagate_input_check;
     friend class UnitTest_ConvCell_Frame_float_propagate_2_input_check;
     friend class UnitTest_ConvCell_Frame_float_setWeight;
+    friend class UnitTest_ConvCell_Frame_float_propagate_fused_activation;
     friend class UnitTest_ConvCell_Frame_double_addInput__env;
     friend class UnitTest_ConvCell_Frame_double_addInput;
     friend class UnitTest_ConvCell_Frame_double_propagate_input_check;
@@ -761,6 +764,204 @@ TEST_DATASET(ConvCell_Frame_float,
     }
 }
 
+TEST_DATASET(ConvCell_Frame_float,
+             im2col_check,
+             (unsigned int kernelWidth,
+              unsigned int kernelHeight,
+              unsigned int strideX,
+              unsigned int strideY,
+              int paddingX,
+              int paddingY,
+              unsigned int nbChannels,
+              unsigned int nbOutputs,
+              bool partialMap),
+             std::make_tuple(3U, 3U, 1U, 1U, 0, 0, 1U, 5U, false),
+             std::make_tuple(3U, 3U, 1U, 1U, 1, 1, 4U, 6U, false),
+             std::make_tuple(2U, 5U, 2U, 1U, 1, 2, 4U, 6U, false),
+             std::make_tuple(3U, 3U, 1U, 3U, 1, 1, 4U, 6U, true),
+             std::make_tuple(1U, 1U, 1U, 1U, 0, 0, 16U, 8U, false),
+             std::make_tuple(1U, 1U, 1U, 1U, 0, 0, 16U, 8U, true),
+             std::make_tuple(5U, 5U, 2U, 2U, 2, 2, 3U, 7U, false))
+{
+    const unsigned int channelsWidth = 13;
+    const unsigned int channelsHeight = 11;
+    const unsigned int batchSize = 3;
+    const unsigned int outputsWidth = (channelsWidth + 2 * paddingX
+                                       - kernelWidth + strideX) / strideX;
+    const unsigned int outputsHeight = (channelsHeight + 2 * paddingY
+                                        - kernelHeight + strideY) / strideY;
+
+    ConvCell_Frame_Kernels::Descriptor desc(
+        std::vector<unsigned int>({1U, 1U}),
+        std::vector<unsigned int>({strideX, strideY}),
+        std::vector<int>({paddingX, paddingY}),
+        std::vector<unsigned int>({1U, 1U}));
+    ConvCell_Frame_Kernels::Descriptor descIm2col(desc);
+    descIm2col.algorithm = ConvCell_Frame_Kernels::Im2col;
+
+    Tensor<float> inputs({channelsWidth, channelsHeight, nbChannels,
+                          batchSize});
+    Tensor<float> synapses({kernelWidth, kernelHeight, nbChannels,
+                            nbOutputs});
+    Tensor<float> diffInputs({outputsWidth, outputsHeight, nbOutputs,
+                              batchSize});
+    Tensor<bool> maps;
+
+    if (partialMap) {
+        maps.resize({nbOutputs, nbChannels});
+
+        for (unsigned int output = 0; output < nbOutputs; ++output) {
+            for (unsigned int channel = 0; channel < nbChannels; ++channel)
+                maps(output, channel) = ((output + channel) % 2 == 0);
+        }
+    }
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-1.0, 1.0);
+
+    for (unsigned int index = 0; index < synapses.size(); ++index)
+        synapses(index) = Random::randUniform(-1.0, 1.0);
+
+    for (unsigned int index = 0; index < diffInputs.size(); ++index)
+        diffInputs(index) = Random::randUniform(-1.0, 1.0);
+
+    const float alpha = 1.0f;
+    const float beta = 0.5f;
+
+    // Forward
+    Tensor<float> outputs({outputsWidth, outputsHeight, nbOutputs,
+                           batchSize}, 1.0f);
+    Tensor<float> outputsIm2col({outputsWidth, outputsHeight, nbOutputs,
+                                 batchSize}, 1.0f);
+
+    ConvCell_Frame_Kernels::forward(&alpha, inputs, synapses, desc,
+                                    &beta, outputs, maps);
+    ConvCell_Frame_Kernels::forward(&alpha, inputs, synapses, descIm2col,
+                                    &beta, outputsIm2col, maps);
+
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS_DELTA(outputsIm2col(index), outputs(index), 1e-4);
+
+    // Backward data
+    Tensor<float> diffOutputs({channelsWidth, channelsHeight, nbChannels,
+                               batchSize}, 1.0f);
+    Tensor<float> diffOutputsIm2col({channelsWidth, channelsHeight,
+                                     nbChannels, batchSize}, 1.0f);
+
+    ConvCell_Frame_Kernels::backwardData(&alpha, synapses, diffInputs, desc,
+                                         &beta, diffOutputs, maps);
+    ConvCell_Frame_Kernels::backwardData(&alpha, synapses, diffInputs,
+                                         descIm2col, &beta,
+                                         diffOutputsIm2col, maps);
+
+    for (unsigned int index = 0; index < diffOutputs.size(); ++index) {
+        ASSERT_EQUALS_DELTA(diffOutputsIm2col(index), diffOutputs(index),
+                            1e-4);
+    }
+
+    // Backward filter
+    Tensor<float> diffSynapses({kernelWidth, kernelHeight, nbChannels,
+                                nbOutputs}, 1.0f);
+    Tensor<float> diffSynapsesIm2col({kernelWidth, kernelHeight, nbChannels,
+                                      nbOutputs}, 1.0f);
+
+    ConvCell_Frame_Kernels::backwardFilter(&alpha, inputs, diffInputs, desc,
+                                           &beta, diffSynapses, maps);
+    ConvCell_Frame_Kernels::backwardFilter(&alpha, inputs, diffInputs,
+                                           descIm2col, &beta,
+                                           diffSynapsesIm2col, maps);
+
+    for (unsigned int index = 0; index < diffSynapses.size(); ++index) {
+        ASSERT_EQUALS_DELTA(diffSynapsesIm2col(index), diffSynapses(index),
+                            1e-4);
+    }
+}
+
+TEST_DATASET(ConvCell_Frame_float,
+             propagate_fused_activation,
+             (unsigned int subSample,
+              unsigned int stride,
+              int padding,
+              bool im2col,
+              std::size_t quantizedNbBits),
+             std::make_tuple(1U, 1U, 1, false, 0U),
+             std::make_tuple(1U, 1U, 1, true, 0U),
+             std::make_tuple(1U, 2U, 0, false, 0U),
+             std::make_tuple(1U, 2U, 0, true, 0U),
+             std::make_tuple(2U, 1U, 1, false, 0U),
+             std::make_tuple(1U, 1U, 1, false, 8U),
+             std::make_tuple(1U, 1U, 1, true, 8U))
+{
+    const unsigned int channelsWidth = 13;
+    const unsigned int channelsHeight = 11;
+    const unsigned int nbChannels = 3;
+    const unsigned int nbOutputs = 6;
+    const unsigned int batchSize = 4;
+
+    Network net(0U,false);
+    DeepNet dn(net);
+
+    std::shared_ptr<Activation> activation
+        = std::make_shared<RectifierActivation_Frame<float> >();
+    activation->setParameter<double>("LeakSlope", 0.1);
+    activation->setParameter<double>("Clipping", 2.0);
+
+    std::vector<Float_T> scaling;
+
+    for (unsigned int output = 0; output < nbOutputs; ++output)
+        scaling.push_back((quantizedNbBits > 0) ? 8.0 + output
+                                                : 0.5 + 0.25 * output);
+
+    activation->setActivationScaling(
+        Scaling::floatingPointScaling(scaling, false,
+                                      std::vector<Float_T>()));
+    activation->setQuantized(quantizedNbBits);
+
+    ConvCell_Frame_Test<float> conv1(dn, "conv1",
+        std::vector<unsigned int>({3U, 3U}),
+        nbOutputs,
+        std::vector<unsigned int>({subSample, subSample}),
+        std::vector<unsigned int>({stride, stride}),
+        std::vector<int>({padding, padding}),
+        std::vector<unsigned int>({1U, 1U}),
+        activation);
+    conv1.setBiasFiller(std::make_shared<NormalFiller<float> >(0.0, 1.0));
+
+    if (im2col)
+        conv1.setParameter("Algorithm", ConvCell_Frame_Kernels::Im2col);
+
+    Tensor<float> inputs({channelsWidth, channelsHeight, nbChannels,
+                          batchSize});
+    Tensor<float> diffOutputs({channelsWidth, channelsHeight, nbChannels,
+                               batchSize});
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-1.0, 1.0);
+
+    conv1.addInput(inputs, diffOutputs);
+    conv1.initialize();
+
+    // Bias and activation fused in the convolution kernel
+    conv1.propagate(true);
+    const Tensor<float>& outputsFused = tensor_cast<float>(conv1.getOutputs());
+
+    // Separate bias and activation passes
+    Tensor<float> outputs(outputsFused.dims());
+    const float alpha = 1.0f;
+    const float beta = 0.0f;
+
+    ConvCell_Frame_Kernels::forward(&alpha, inputs, conv1.mSharedSynapses[0],
+                                    conv1.mConvDesc, &beta, outputs);
+    ConvCell_Frame_Kernels::forwardBias(&alpha, *conv1.mBias, &alpha,
+                                        outputs);
+    activation->propagate(conv1, outputs, true);
+
+    ASSERT_EQUALS(outputsFused.size(), outputs.size());
+
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS(outputsFused(index), outputs(index));
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // double
 ////////////////////////////////////////////////////////////////////////////////
@@ -1440,6 +1641,119 @@ TEST_DATASET(ConvCell_Frame_double,
     }
 }
 
+TEST_DATASET(ConvCell_Frame_double,
+             im2col_check,
+             (unsigned int kernelWidth,
+              unsigned int kernelHeight,
+              unsigned int strideX,
+              unsigned int strideY,
+              int paddingX,
+              int paddingY,
+              unsigned int nbChannels,
+              unsigned int nbOutputs,
+              bool partialMap),
+             std::make_tuple(3U, 3U, 1U, 1U, 0, 0, 1U, 5U, false),
+             std::make_tuple(3U, 3U, 1U, 1U, 1, 1, 4U, 6U, false),
+             std::make_tuple(2U, 5U, 2U, 1U, 1, 2, 4U, 6U, false),
+             std::make_tuple(3U, 3U, 1U, 3U, 1, 1, 4U, 6U, true),
+             std::make_tuple(1U, 1U, 1U, 1U, 0, 0, 16U, 8U, false),
+             std::make_tuple(1U, 1U, 1U, 1U, 0, 0, 16U, 8U, true),
+             std::make_tuple(5U, 5U, 2U, 2U, 2, 2, 3U, 7U, false))
+{
+    const unsigned int channelsWidth = 13;
+    const unsigned int channelsHeight = 11;
+    const unsigned int batchSize = 3;
+    const unsigned int outputsWidth = (channelsWidth + 2 * paddingX
+                                       - kernelWidth + strideX) / strideX;
+    const unsigned int outputsHeight = (channelsHeight + 2 * paddingY
+                                        - kernelHeight + strideY) / strideY;
+
+    ConvCell_Frame_Kernels::Descriptor desc(
+        std::vector<unsigned int>({1U, 1U}),
+        std::vector<unsigned int>({strideX, strideY}),
+        std::vector<int>({paddingX, paddingY}),
+        std::vector<unsigned int>({1U, 1U}));
+    ConvCell_Frame_Kernels::Descriptor descIm2col(desc);
+    descIm2col.algorithm = ConvCell_Frame_Kernels::Im2col;
+
+    Tensor<double> inputs({channelsWidth, channelsHeight, nbChannels,
+                           batchSize});
+    Tensor<double> synapses({kernelWidth, kernelHeight, nbChannels,
+                             nbOutputs});
+    Tensor<double> diffInputs({outputsWidth, outputsHeight, nbOutputs,
+                               batchSize});
+    Tensor<bool> maps;
+
+    if (partialMap) {
+        maps.resize({nbOutputs, nbChannels});
+
+        for (unsigned int output = 0; output < nbOutputs; ++output) {
+            for (unsigned int channel = 0; channel < nbChannels; ++channel)
+                maps(output, channel) = ((output + channel) % 2 == 0);
+        }
+    }
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = Random::randUniform(-1.0, 1.0);
+
+    for (unsigned int index = 0; index < synapses.size(); ++index)
+        synapses(index) = Random::randUniform(-1.0, 1.0);
+
+    for (unsigned int index = 0; index < diffInputs.size(); ++index)
+        diffInputs(index) = Random::randUniform(-1.0, 1.0);
+
+    const double alpha = 1.0;
+    const double beta = 0.5;
+
+    // Forward
+    Tensor<double> outputs({outputsWidth, outputsHeight, nbOutputs,
+                            batchSize}, 1.0);
+    Tensor<double> outputsIm2col({outputsWidth, outputsHeight, nbOutputs,
+                                  batchSize}, 1.0);
+
+    ConvCell_Frame_Kernels::forward(&alpha, inputs, synapses, desc,
+                                    &beta, outputs, maps);
+    ConvCell_Frame_Kernels::forward(&alpha, inputs, synapses, descIm2col,
+                                    &beta, outputsIm2col, maps);
+
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS_DELTA(outputsIm2col(index), outputs(index), 1e-9);
+
+    // Backward data
+    Tensor<double> diffOutputs({channelsWidth, channelsHeight, nbChannels,
+                                batchSize}, 1.0);
+    Tensor<double> diffOutputsIm2col({channelsWidth, channelsHeight,
+                                      nbChannels, batchSize}, 1.0);
+
+    ConvCell_Frame_Kernels::backwardData(&alpha, synapses, diffInputs, desc,
+                                         &beta, diffOutputs, maps);
+    ConvCell_Frame_Kernels::backwardData(&alpha, synapses, diffInputs,
+                                         descIm2col, &beta,
+                                         diffOutputsIm2col, maps);
+
+    for (unsigned int index = 0; index < diffOutputs.size(); ++index) {
+        ASSERT_EQUALS_DELTA(diffOutputsIm2col(index), diffOutputs(index),
+                            1e-9);
+    }
+
+    // Backward filter
+    Tensor<double> diffSynapses({kernelWidth, kernelHeight, nbChannels,
+                                 nbOutputs}, 1.0);
+    Tensor<double> diffSynapsesIm2col({kernelWidth, kernelHeight, nbChannels,
+                                       nbOutputs}, 1.0);
+
+    ConvCell_Frame_Kernels::backwardFilter(&alpha, inputs, diffInputs, desc,
+                                           &beta, diffSynapses, maps);
+    ConvCell_Frame_Kernels::backwardFilter(&alpha, inputs, diffInputs,
+                                           descIm2col, &beta,
+                                           diffSynapsesIm2col, maps);
+
+    for (unsigned int index = 0; index < diffSynapses.size(); ++index) {
+        ASSERT_EQUALS_DELTA(diffSynapsesIm2col(index), diffSynapses(index),
+                            1e-9);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // half
 ////////////////////////////////////////////////////////////////////////////////
@@ -2119,4 +2433,132 @@ TEST_DATASET(ConvCell_Frame_half,
     }
 }
 
+TEST_DATASET(ConvCell_Frame_half,
+             im2col_check,
+             (unsigned int kernelWidth,
+              unsigned int kernelHeight,
+              unsigned int strideX,
+              unsigned int strideY,
+              int paddingX,
+              int paddingY,
+              unsigned int nbChannels,
+              unsigned int nbOutputs,
+              bool partialMap),
+             std::make_tuple(3U, 3U, 1U, 1U, 0, 0, 1U, 5U, false),
+             std::make_tuple(3U, 3U, 1U, 1U, 1, 1, 4U, 6U, false),
+             std::make_tuple(2U, 5U, 2U, 1U, 1, 2, 4U, 6U, false),
+             std::make_tuple(3U, 3U, 1U, 3U, 1, 1, 4U, 6U, true),
+             std::make_tuple(1U, 1U, 1U, 1U, 0, 0, 16U, 8U, false),
+             std::make_tuple(1U, 1U, 1U, 1U, 0, 0, 16U, 8U, true),
+             std::make_tuple(5U, 5U, 2U, 2U, 2, 2, 3U, 7U, false))
+{
+    const unsigned int channelsWidth = 13;
+    const unsigned int channelsHeight = 11;
+    const unsigned int batchSize = 3;
+    const unsigned int outputsWidth = (channelsWidth + 2 * paddingX
+                                       - kernelWidth + strideX) / strideX;
+    const unsigned int outputsHeight = (channelsHeight + 2 * paddingY
+                                        - kernelHeight + strideY) / strideY;
+
+    ConvCell_Frame_Kernels::Descriptor desc(
+        std::vector<unsigned int>({1U, 1U}),
+        std::vector<unsigned int>({strideX, strideY}),
+        std::vector<int>({paddingX, paddingY}),
+        std::vector<unsigned int>({1U, 1U}));
+    ConvCell_Frame_Kernels::Descriptor descIm2col(desc);
+    descIm2col.algorithm = ConvCell_Frame_Kernels::Im2col;
+
+    Tensor<half_float::half> inputs({channelsWidth, channelsHeight,
+                                     nbChannels, batchSize});
+    Tensor<half_float::half> synapses({kernelWidth, kernelHeight,
+                                       nbChannels, nbOutputs});
+    Tensor<half_float::half> diffInputs({outputsWidth, outputsHeight,
+                                         nbOutputs, batchSize});
+    Tensor<bool> maps;
+
+    if (partialMap) {
+        maps.resize({nbOutputs, nbChannels});
+
+        for (unsigned int output = 0; output < nbOutputs; ++output) {
+            for (unsigned int channel = 0; channel < nbChannels; ++channel)
+                maps(output, channel) = ((output + channel) % 2 == 0);
+        }
+    }
+
+    for (unsigned int index = 0; index < inputs.size(); ++index)
+        inputs(index) = half_float::half(Random::randUniform(-1.0, 1.0));
+
+    for (unsigned int index = 0; index < synapses.size(); ++index)
+        synapses(index) = half_float::half(Random::randUniform(-1.0, 1.0));
+
+    for (unsigned int index = 0; index < diffInputs.size(); ++index)
+        diffInputs(index) = half_float::half(Random::randUniform(-1.0, 1.0));
+
+    // The direct loops accumulate in half precision, while the GEMM
+    // accumulates in float: the reference is computed in double precision
+    // from the same values. The col2im step still sums the overlapping
+    // contributions in half precision.
+    const Tensor<double> inputsRef = tensor_cast<double>(inputs);
+    const Tensor<double> synapsesRef = tensor_cast<double>(synapses);
+    const Tensor<double> diffInputsRef = tensor_cast<double>(diffInputs);
+
+    const half_float::half alpha(1.0f);
+    const half_float::half beta(0.5f);
+    const double alphaRef = 1.0;
+    const double betaRef = 0.5;
+
+    // Forward
+    Tensor<double> outputs({outputsWidth, outputsHeight, nbOutputs,
+                            batchSize}, 1.0);
+    Tensor<half_float::half> outputsIm2col({outputsWidth, outputsHeight,
+                                            nbOutputs, batchSize},
+                                           half_float::half(1.0f));
+
+    ConvCell_Frame_Kernels::forward(&alphaRef, inputsRef, synapsesRef, desc,
+                                    &betaRef, outputs, maps);
+    ConvCell_Frame_Kernels::forward(&alpha, inputs, synapses, descIm2col,
+                                    &beta, outputsIm2col, maps);
+
+    for (unsigned int index = 0; index < outputs.size(); ++index)
+        ASSERT_EQUALS_DELTA(outputsIm2col(index), outputs(index), 5e-2);
+
+    // Backward data
+    Tensor<double> diffOutputs({channelsWidth, channelsHeight, nbChannels,
+                                batchSize}, 1.0);
+    Tensor<half_float::half> diffOutputsIm2col({channelsWidth, channelsHeight,
+                                                nbChannels, batchSize},
+                                               half_float::half(1.0f));
+
+    ConvCell_Frame_Kernels::backwardData(&alphaRef, synapsesRef,
+                                         diffInputsRef, desc,
+                                         &betaRef, diffOutputs, maps);
+    ConvCell_Frame_Kernels::backwardData(&alpha, synapses, diffInputs,
+                                         descIm2col, &beta,
+                                         diffOutputsIm2col, maps);
+
+    for (unsigned int index = 0; index < diffOutputs.size(); ++index) {
+        ASSERT_EQUALS_DELTA(diffOutputsIm2col(index), diffOutputs(index),
+                            5e-2);
+    }
+
+    // Backward filter
+    Tensor<double> diffSynapses({kernelWidth, kernelHeight, nbChannels,
+                                 nbOutputs}, 1.0);
+    Tensor<half_float::half> diffSynapsesIm2col({kernelWidth, kernelHeight,
+                                                 nbChannels, nbOutputs},
+                                                half_float::half(1.0f));
+
+    ConvCell_Frame_Kernels::backwardFilter(&alphaRef, inputsRef,
+                                           diffInputsRef, desc,
+                                           &betaRef, diffSynapses, maps);
+    ConvCell_Frame_Kernels::backwardFilter(&alpha, inputs, diffInputs,
+                                           descIm2col, &beta,
+                                           diffSynapsesIm2col, maps);
+
+    for (unsigned int index = 0; index < diffSynapses.size(); ++index) {
+        ASSERT_EQUALS_DELTA(diffSynapsesIm2col(index), diffSynapses(index),
+                            5e-2);
+    }
+}
+
 RUN_TESTS()
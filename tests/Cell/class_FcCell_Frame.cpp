@@ -51,6 +51,7 @@ public:
     friend class UnitTest_FcCell_Frame_float_propagate_normalize_check;
     friend class UnitTest_FcCell_Frame_float_propagate_2_input_check;
     friend class UnitTest_FcCell_Frame_float_propagate_weight_check;
+    friend class UnitTest_FcCell_Frame_float_propagate_2_input_bias_check;
     friend class UnitTest_FcCell_Frame_double_addInput__env;
     friend class UnitTest_FcCell_Frame_double_addInput;
     friend class UnitTest_FcCell_Frame_double_addInput_multi_outputs;
@@ -709,6 +710,64 @@ TEST_DATASET(FcCell_Frame_float,
     }
 }
 
+TEST_DATASET(FcCell_Frame_float,
+             propagate_2_input_bias_check,
+             (unsigned int nbOutputs,
+              unsigned int channelsWidth,
+              unsigned int channelsHeight),
+             std::make_tuple(1U, 1U, 1U),
+             std::make_tuple(3U, 3U, 3U),
+             std::make_tuple(17U, 5U, 7U),
+             std::make_tuple(7U, 30U, 25U))
+{
+    Network net(0U,false);
+    DeepNet dn(net);
+    Environment env(
+        net, EmptyDatabase, {channelsWidth, channelsHeight, 1}, 2, false);
+
+    FcCell_Frame_Test<float> fc1(
+        dn, "fc1", nbOutputs, std::shared_ptr<Activation>());
+
+    const cv::Mat img0(
+        channelsHeight, channelsWidth, CV_32FC1, cv::Scalar(1.0));
+    const cv::Mat img1(
+        channelsHeight, channelsWidth, CV_32FC1, cv::Scalar(0.5));
+
+    env.streamStimulus(img0, Database::Learn, 0);
+    env.streamStimulus(img1, Database::Learn, 1);
+
+    fc1.addInput(env);
+    fc1.addInput(env);
+    fc1.initialize();
+
+    const unsigned int inputSize = fc1.getNbChannels() * fc1.getChannelsWidth()
+                                   * fc1.getChannelsHeight();
+
+    for (unsigned int output = 0; output < nbOutputs; ++output) {
+        for (unsigned int channel = 0; channel < inputSize; ++channel) {
+            Tensor<float> weight({1}, 1.0);
+            fc1.setWeight(output, channel, weight);
+        }
+
+        Tensor<float> bias({1}, output + 1.0);
+        fc1.setBias(output, bias);
+    }
+
+    fc1.propagate();
+
+    const Tensor<float>& out = tensor_cast<float>(fc1.getOutputs());
+
+    ASSERT_EQUALS(out.dimZ(), nbOutputs);
+    ASSERT_EQUALS(out.dimB(), 2U);
+
+    // The bias is added once, not once per input
+    for (unsigned int output = 0; output < nbOutputs; ++output) {
+        ASSERT_EQUALS_DELTA(out(output, 0), inputSize + output + 1.0, 1e-4);
+        ASSERT_EQUALS_DELTA(out(output, 1),
+                            0.5 * inputSize + output + 1.0, 1e-4);
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // double
 ////////////////////////////////////////////////////////////////////////////////
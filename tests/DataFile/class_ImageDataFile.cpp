@@ -0,0 +1,105 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "DataFile/ImageDataFile.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+TEST(ImageDataFile, readHeader)
+{
+    unsigned int width = 0;
+    unsigned int height = 0;
+    unsigned int channels = 0;
+
+    ImageDataFile dataFile;
+    const cv::Mat lenna = dataFile.read("tests_data/Lenna.png");
+    cv::Mat lennaGray;
+#if CV_MAJOR_VERSION >= 3
+    cv::cvtColor(lenna, lennaGray, cv::COLOR_BGR2GRAY);
+#else
+    cv::cvtColor(lenna, lennaGray, CV_BGR2GRAY);
+#endif
+
+    dataFile.write("ImageDataFile_readHeader.jpg", lenna);
+    dataFile.write("ImageDataFile_readHeader_gray.jpg", lennaGray);
+
+    ASSERT_TRUE(ImageDataFile::readHeader("ImageDataFile_readHeader.jpg",
+                                          width, height, channels));
+    ASSERT_EQUALS(width, 512U);
+    ASSERT_EQUALS(height, 512U);
+    ASSERT_EQUALS(channels, 3U);
+
+    ASSERT_TRUE(ImageDataFile::readHeader("ImageDataFile_readHeader_gray.jpg",
+                                          width, height, channels));
+    ASSERT_EQUALS(width, 512U);
+    ASSERT_EQUALS(height, 512U);
+    ASSERT_EQUALS(channels, 1U);
+
+    // Not a JPEG image
+    ASSERT_TRUE(!ImageDataFile::readHeader("tests_data/Lenna.png",
+                                           width, height, channels));
+    ASSERT_TRUE(!ImageDataFile::readHeader(
+        "tests_data/SIPI_Jelly_Beans_4.1.07.tiff", width, height, channels));
+}
+
+#if CV_MAJOR_VERSION > 3 || (CV_MAJOR_VERSION == 3 && CV_MINOR_VERSION >= 1)
+TEST_DATASET(ImageDataFile,
+             readReduced,
+             (std::string fileExt, unsigned int minSize, int size),
+             std::make_tuple("png", 0U, 512),
+             std::make_tuple("png", 100U, 512),
+             std::make_tuple("jpg", 0U, 512),
+             std::make_tuple("jpg", 200U, 256),
+             std::make_tuple("jpg", 128U, 128),
+             std::make_tuple("jpg", 64U, 64),
+             std::make_tuple("tiff", 64U, 256))
+{
+    const std::string fileName = (fileExt == "tiff")
+        ? "tests_data/SIPI_Jelly_Beans_4.1.07.tiff"
+        : "ImageDataFile_readReduced." + fileExt;
+
+    ImageDataFile dataFile;
+
+    if (fileExt != "tiff")
+        dataFile.write(fileName, dataFile.read("tests_data/Lenna.png"));
+
+    const cv::Mat full = dataFile.read(fileName);
+    const cv::Mat reduced = dataFile.readReduced(fileName,
+        DataFile::SizeHint(minSize, minSize));
+
+    ASSERT_EQUALS(reduced.cols, size);
+    ASSERT_EQUALS(reduced.rows, size);
+    ASSERT_EQUALS(reduced.type(), full.type());
+
+    // The reduced image must match the downscaled full resolution image
+    cv::Mat expected;
+    cv::resize(full, expected, reduced.size(), 0, 0, cv::INTER_AREA);
+
+    const double meanError = cv::norm(reduced, expected, cv::NORM_L1)
+        / (reduced.total() * reduced.channels());
+
+    ASSERT_TRUE(meanError < 8.0);
+}
+#endif
+
+RUN_TESTS()
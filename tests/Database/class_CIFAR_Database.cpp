@@ -73,4 +73,37 @@ TEST_DATASET(CIFAR100_Database,
     ASSERT_EQUALS(db.getNbLabels(), 100U);
 }
 
+TEST(CIFAR10_Database, getStimulusData_direct)
+{
+    REQUIRED(UnitTest::DirExists(N2D2_DATA("cifar-10-batches-bin")));
+
+    Random::mtSeed(0);
+
+    CIFAR10_Database db;
+    db.load(N2D2_DATA("cifar-10-batches-bin"));
+
+    Random::mtSeed(0);
+
+    CIFAR10_Database dbDirect;
+    dbDirect.setParameter("DirectLoad", true);
+    dbDirect.load(N2D2_DATA("cifar-10-batches-bin"));
+
+    ASSERT_EQUALS(dbDirect.getNbStimuli(), db.getNbStimuli());
+    ASSERT_EQUALS(dbDirect.getNbStimuli(Database::Test),
+                  db.getNbStimuli(Database::Test));
+
+    for (unsigned int index = 0; index < 100; ++index) {
+        const cv::Mat data = db.getStimulusData(Database::Learn, index);
+        const cv::Mat dataDirect
+            = dbDirect.getStimulusData(Database::Learn, index);
+
+        ASSERT_EQUALS(dbDirect.getStimulusLabel(Database::Learn, index),
+                      db.getStimulusLabel(Database::Learn, index));
+        ASSERT_EQUALS(dataDirect.channels(), 3);
+        ASSERT_EQUALS(dataDirect.rows, data.rows);
+        ASSERT_EQUALS(dataDirect.cols, data.cols);
+        ASSERT_EQUALS(cv::norm(dataDirect, data, cv::NORM_INF), 0.0);
+    }
+}
+
 RUN_TESTS()
@@ -89,4 +89,71 @@ TEST(MNIST_IDX_Database, getStimulusLabelsData)
     ASSERT_EQUALS(labels.at<int>(0, 0), 1);    // first stimulus is a 1
 }
 
+TEST(MNIST_IDX_Database, getStimulusData_direct)
+{
+    REQUIRED(UnitTest::DirExists(N2D2_DATA("mnist")));
+
+    Random::mtSeed(0);
+
+    MNIST_IDX_Database db;
+    db.load(N2D2_DATA("mnist"));
+
+    Random::mtSeed(0);
+
+    MNIST_IDX_Database dbDirect;
+    dbDirect.setParameter("DirectLoad", true);
+    dbDirect.load(N2D2_DATA("mnist"));
+
+    ASSERT_EQUALS(dbDirect.getNbStimuli(), db.getNbStimuli());
+    ASSERT_EQUALS(dbDirect.getNbStimuli(Database::Test),
+                  db.getNbStimuli(Database::Test));
+
+    for (unsigned int index = 0; index < 100; ++index) {
+        const cv::Mat data = db.getStimulusData(Database::Learn, index);
+        const cv::Mat dataDirect
+            = dbDirect.getStimulusData(Database::Learn, index);
+
+        ASSERT_EQUALS(dbDirect.getStimulusLabel(Database::Learn, index),
+                      db.getStimulusLabel(Database::Learn, index));
+        ASSERT_EQUALS(dataDirect.channels(), 1);
+        ASSERT_EQUALS(dataDirect.rows, data.rows);
+        ASSERT_EQUALS(dataDirect.cols, data.cols);
+        ASSERT_EQUALS(cv::norm(dataDirect, data, cv::NORM_INF), 0.0);
+    }
+}
+
+TEST(MNIST_IDX_Database, removeStimuli_direct)
+{
+    REQUIRED(UnitTest::DirExists(N2D2_DATA("mnist")));
+
+    MNIST_IDX_Database db;
+    db.load(N2D2_DATA("mnist"));
+
+    MNIST_IDX_Database dbDirect;
+    dbDirect.setParameter("DirectLoad", true);
+    dbDirect.load(N2D2_DATA("mnist"));
+
+    std::vector<Database::StimulusID> ids;
+
+    for (unsigned int id = 0; id < 300; id += 3)
+        ids.push_back(id);
+
+    db.removeStimuli(ids);
+    dbDirect.removeStimuli(ids);
+
+    db.removeStimulus(10);
+    dbDirect.removeStimulus(10);
+
+    ASSERT_EQUALS(dbDirect.getNbStimuli(), db.getNbStimuli());
+
+    // The data in memory follows the stimuli IDs
+    for (unsigned int id = 0; id < 300; ++id) {
+        const cv::Mat data = db.getStimulusData(id);
+        const cv::Mat dataDirect = dbDirect.getStimulusData(id);
+
+        ASSERT_EQUALS(dbDirect.getStimulusLabel(id), db.getStimulusLabel(id));
+        ASSERT_EQUALS(cv::norm(dataDirect, data, cv::NORM_INF), 0.0);
+    }
+}
+
 RUN_TESTS()
@@ -0,0 +1,257 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <map>
+#include <set>
+
+#include "N2D2.hpp"
+
+#include "Database/Packed_Database.hpp"
+#include "ROI/RectangularROI.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+namespace {
+class Memory_Database : public Database {
+public:
+    Memory_Database(unsigned int nbStimuli, bool variableSize = true)
+        : Database(true)
+    {
+        setParameter("CompositeLabel", None);
+
+        for (unsigned int i = 0; i < nbStimuli; ++i) {
+            std::ostringstream nameStr;
+            nameStr << "stimulus[" << i << "]";
+
+            std::vector<ROI*> ROIs;
+
+            if (i % 7 == 0) {
+                ROIs.push_back(new RectangularROI<int>(labelID("object"),
+                    cv::Point(i % 5, 2), 3, 4));
+            }
+
+            mStimuli.push_back(Stimulus(nameStr.str(),
+                labelID((i % 3 == 0) ? "a" : (i % 3 == 1) ? "b" : "c"),
+                ROIs));
+            mStimuliSets(Unpartitioned).push_back(i);
+
+            cv::Mat data = (variableSize)
+                ? cv::Mat(8 + i % 4, 9, (i % 2) ? CV_8UC1 : CV_32FC1)
+                : cv::Mat(8, 9, CV_8UC1);
+            unsigned char* bytes = data.ptr<unsigned char>(0);
+
+            for (size_t k = 0; k < data.total() * data.elemSize(); ++k)
+                bytes[k] = (unsigned char)(7 * k + i);
+
+            mStimuliData.push_back(data);
+        }
+
+        partitionStimuli(0.6, 0.2, 0.2);
+    }
+};
+
+bool isEqual(const cv::Mat& mat1, const cv::Mat& mat2)
+{
+    if (mat1.rows != mat2.rows || mat1.cols != mat2.cols
+        || mat1.type() != mat2.type())
+    {
+        return false;
+    }
+
+    const size_t size = mat1.elemSize() * mat1.rows * mat1.cols;
+    return std::equal(mat1.ptr<unsigned char>(0),
+                      mat1.ptr<unsigned char>(0) + size,
+                      mat2.ptr<unsigned char>(0));
+}
+}
+
+TEST_DATASET(Packed_Database,
+             pack_load,
+             (bool compressed, unsigned int shardCache),
+             std::make_tuple(false, 2U),
+             std::make_tuple(true, 2U),
+             std::make_tuple(false, 100U))
+{
+    Random::mtSeed(0);
+
+    Memory_Database db(1000);
+    Packed_Database::pack(db, "Packed_Database", Database::All, 20000,
+                          compressed);
+
+    Packed_Database packed;
+    packed.setParameter("CompositeLabel", Database::None);
+    packed.setParameter("ShardCache", shardCache);
+    packed.load("Packed_Database");
+
+    ASSERT_TRUE(packed.getNbShards() > 1U);
+    ASSERT_EQUALS(packed.getNbStimuli(), db.getNbStimuli());
+    ASSERT_EQUALS(packed.getNbLabels(), db.getNbLabels());
+
+    const std::vector<Database::StimuliSet> stimuliSets
+        = db.getStimuliSets(Database::All);
+
+    for (std::vector<Database::StimuliSet>::const_iterator it
+         = stimuliSets.begin(), itEnd = stimuliSets.end(); it != itEnd; ++it)
+    {
+        const Database::StimuliSet set = (*it);
+        const unsigned int nbStimuli = db.getNbStimuli(set);
+
+        ASSERT_EQUALS(packed.getNbStimuli(set), nbStimuli);
+
+        std::vector<char> dataEqual(nbStimuli, false);
+        std::vector<char> labelsEqual(nbStimuli, false);
+
+        // Concurrent reads, with shards eviction
+#pragma omp parallel for
+        for (int index = 0; index < (int)nbStimuli; ++index) {
+            dataEqual[index] = isEqual(db.getStimulusData(set, index),
+                                       packed.getStimulusData(set, index));
+            labelsEqual[index]
+                = isEqual(db.getStimulusLabelsData(set, index),
+                          packed.getStimulusLabelsData(set, index));
+        }
+
+        for (unsigned int index = 0; index < nbStimuli; ++index) {
+            ASSERT_TRUE(dataEqual[index]);
+            ASSERT_TRUE(labelsEqual[index]);
+            ASSERT_EQUALS(packed.getStimulusName(set, index),
+                          db.getStimulusName(set, index));
+            ASSERT_EQUALS(
+                packed.getLabelName(packed.getStimulusLabel(set, index)),
+                db.getLabelName(db.getStimulusLabel(set, index)));
+
+            const std::vector<std::shared_ptr<ROI> > ROIs
+                = db.getStimulusROIs(db.getStimulusID(set, index));
+            const std::vector<std::shared_ptr<ROI> > packedROIs
+                = packed.getStimulusROIs(packed.getStimulusID(set, index));
+
+            ASSERT_EQUALS(packedROIs.size(), ROIs.size());
+
+            for (unsigned int r = 0; r < ROIs.size(); ++r) {
+                const cv::Rect rect = ROIs[r]->getBoundingRect();
+                const cv::Rect packedRect = packedROIs[r]->getBoundingRect();
+
+                ASSERT_EQUALS(packedRect.x, rect.x);
+                ASSERT_EQUALS(packedRect.y, rect.y);
+                ASSERT_EQUALS(packedRect.width, rect.width);
+                ASSERT_EQUALS(packedRect.height, rect.height);
+            }
+        }
+    }
+}
+
+TEST(Packed_Database, shuffleIndexes)
+{
+    Random::mtSeed(0);
+
+    // Records of 2 headers of 16 bytes, 8x9 bytes of data and 1 int label
+    const unsigned int recordSize = 2 * 16 + 8 * 9 + 4;
+    const unsigned int nbStimuliPerShard = 20000 / recordSize;
+
+    Memory_Database db(1000, false);
+    Packed_Database::pack(db, "Packed_Database", Database::All, 20000);
+
+    Packed_Database packed;
+    packed.setParameter("ShuffleShards", true);
+    packed.load("Packed_Database");
+
+    ASSERT_TRUE(packed.isSequential());
+    ASSERT_EQUALS(packed.getNbShards(),
+                  (unsigned int)std::ceil(1000.0 / nbStimuliPerShard));
+
+    const unsigned int nbStimuli = packed.getNbStimuli(Database::Learn);
+    std::vector<unsigned int> indexes(nbStimuli);
+    std::iota(indexes.begin(), indexes.end(), 0U);
+
+    packed.shuffleIndexes(Database::Learn, indexes);
+
+    // The indexes are a permutation...
+    std::vector<unsigned int> sortedIndexes(indexes);
+    std::sort(sortedIndexes.begin(), sortedIndexes.end());
+
+    for (unsigned int i = 0; i < nbStimuli; ++i)
+        ASSERT_EQUALS(sortedIndexes[i], i);
+
+    // ... in which the stimuli of each shard are contiguous (the learning set
+    // is packed first)
+    std::set<unsigned int> shards;
+
+    for (unsigned int i = 0; i < nbStimuli; ++i) {
+        const unsigned int shard = indexes[i] / nbStimuliPerShard;
+
+        if (i == 0 || shard != indexes[i - 1] / nbStimuliPerShard) {
+            ASSERT_TRUE(shards.find(shard) == shards.end());
+            shards.insert(shard);
+        }
+    }
+
+    ASSERT_EQUALS(shards.size(),
+                  (size_t)std::ceil(nbStimuli / (double)nbStimuliPerShard));
+}
+
+TEST(Packed_Database, removeStimuli)
+{
+    Random::mtSeed(0);
+
+    Memory_Database db(300);
+    Packed_Database::pack(db, "Packed_Database", Database::All, 20000);
+
+    Packed_Database packed;
+    packed.setParameter("CompositeLabel", Database::None);
+    packed.load("Packed_Database");
+
+    // The stimuli are packed per set: find them in db by name
+    std::map<std::string, Database::StimulusID> dbIDs;
+
+    for (unsigned int id = 0; id < db.getNbStimuli(); ++id)
+        dbIDs[db.getStimulusName(id)] = id;
+
+    std::vector<Database::StimulusID> ids;
+
+    for (unsigned int id = 0; id < 100; id += 3)
+        ids.push_back(id);
+
+    packed.removeStimuli(ids);
+    packed.removeStimulus(10);
+
+    const unsigned int nbRemaining = packed.getNbStimuli();
+    const int label = packed.getLabelID("b");
+    const unsigned int nbLabel = packed.getNbStimuliWithLabel(label);
+
+    packed.removeLabel(label);
+
+    ASSERT_EQUALS(packed.getNbStimuli(), db.getNbStimuli() - ids.size() - 1
+                                            - nbLabel);
+    ASSERT_EQUALS(packed.getNbStimuli(), nbRemaining - nbLabel);
+
+    for (unsigned int id = 0; id < packed.getNbStimuli(); ++id) {
+        const std::map<std::string, Database::StimulusID>::const_iterator
+            itID = dbIDs.find(packed.getStimulusName(id));
+
+        ASSERT_TRUE(itID != dbIDs.end());
+        ASSERT_TRUE(isEqual(packed.getStimulusData(id),
+                            db.getStimulusData((*itID).second)));
+        ASSERT_EQUALS(packed.getLabelName(packed.getStimulusLabel(id)),
+                      db.getLabelName(db.getStimulusLabel((*itID).second)));
+    }
+}
+
+RUN_TESTS()
\ No newline at end of file
@@ -0,0 +1,142 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "Database/StimuliMemoryCache.hpp"
+#include "utils/UnitTest.hpp"
+
+#include "../utils/MatTest.hpp"
+
+using namespace N2D2;
+using namespace N2D2::MatTest;
+
+TEST_DATASET(StimuliMemoryCache,
+             put_get,
+             (bool compressed),
+             std::make_tuple(false),
+             std::make_tuple(true))
+{
+    StimuliMemoryCache cache(1024 * 1024, 3, compressed);
+    ASSERT_EQUALS(cache.getNbShards(), 4U);
+
+    const cv::Mat data = makeMat(5, 3, CV_8UC3, 1);
+    const cv::Mat labels = makeMat(5, 3, CV_32SC1, 2);
+
+    cv::Mat mat;
+    ASSERT_TRUE(!cache.get(12, StimuliMemoryCache::Data, mat));
+
+    cache.put(12, StimuliMemoryCache::Data, data);
+    cache.put(12, StimuliMemoryCache::Labels, labels);
+
+    ASSERT_TRUE(!cache.get(12, StimuliMemoryCache::Target, mat));
+    ASSERT_TRUE(!cache.get(13, StimuliMemoryCache::Data, mat));
+    ASSERT_TRUE(cache.get(12, StimuliMemoryCache::Data, mat));
+    ASSERT_TRUE(isEqual(mat, data));
+    ASSERT_TRUE(cache.get(12, StimuliMemoryCache::Labels, mat));
+    ASSERT_TRUE(isEqual(mat, labels));
+
+    // Replace
+    const cv::Mat data2 = makeMat(2, 2, CV_8UC1, 3);
+    cache.put(12, StimuliMemoryCache::Data, data2);
+    ASSERT_TRUE(cache.get(12, StimuliMemoryCache::Data, mat));
+    ASSERT_TRUE(isEqual(mat, data2));
+
+    const StimuliMemoryCache::Stats stats = cache.getStats();
+    ASSERT_EQUALS(stats.hits, 3U);
+    ASSERT_EQUALS(stats.misses, 3U);
+    ASSERT_EQUALS(stats.evictions, 0U);
+    ASSERT_EQUALS(stats.nbEntries, 2U);
+    ASSERT_EQUALS_DELTA(stats.hitRate(), 0.5, 1.0e-12);
+
+    if (!compressed)
+        ASSERT_EQUALS(stats.size, 2U * 2U + 5U * 3U * 4U);
+
+    cache.resetStats();
+    ASSERT_EQUALS(cache.getStats().hits, 0U);
+    ASSERT_EQUALS(cache.getStats().nbEntries, 2U);
+
+    cache.clear();
+    ASSERT_EQUALS(cache.getStats().nbEntries, 0U);
+    ASSERT_EQUALS(cache.getStats().size, 0U);
+    ASSERT_TRUE(!cache.get(12, StimuliMemoryCache::Data, mat));
+}
+
+TEST(StimuliMemoryCache, eviction)
+{
+    // 1 shard of 1000 bytes: 10 matrices of 100 bytes
+    StimuliMemoryCache cache(1000, 1);
+
+    for (unsigned int id = 0; id < 10; ++id)
+        cache.put(id, StimuliMemoryCache::Data, makeMat(10, 10, CV_8UC1, id));
+
+    ASSERT_EQUALS(cache.getStats().nbEntries, 10U);
+    ASSERT_EQUALS(cache.getStats().evictions, 0U);
+
+    // Access 0, so that 1 becomes the least recently used
+    cv::Mat mat;
+    ASSERT_TRUE(cache.get(0, StimuliMemoryCache::Data, mat));
+
+    cache.put(10, StimuliMemoryCache::Data, makeMat(10, 10, CV_8UC1, 10));
+
+    ASSERT_EQUALS(cache.getStats().nbEntries, 10U);
+    ASSERT_EQUALS(cache.getStats().evictions, 1U);
+    ASSERT_EQUALS(cache.getStats().size, 1000U);
+    ASSERT_TRUE(!cache.get(1, StimuliMemoryCache::Data, mat));
+    ASSERT_TRUE(cache.get(0, StimuliMemoryCache::Data, mat));
+    ASSERT_TRUE(isEqual(mat, makeMat(10, 10, CV_8UC1, 0)));
+    ASSERT_TRUE(cache.get(10, StimuliMemoryCache::Data, mat));
+
+    // Larger than the budget: not cached, nothing evicted
+    cache.put(11, StimuliMemoryCache::Data, makeMat(40, 40, CV_8UC1, 11));
+    ASSERT_TRUE(!cache.get(11, StimuliMemoryCache::Data, mat));
+    ASSERT_EQUALS(cache.getStats().nbEntries, 10U);
+
+    // Evict several entries for a larger matrix
+    cache.put(12, StimuliMemoryCache::Data, makeMat(10, 30, CV_8UC1, 12));
+    ASSERT_EQUALS(cache.getStats().nbEntries, 8U);
+    ASSERT_EQUALS(cache.getStats().evictions, 4U);
+    ASSERT_EQUALS(cache.getStats().size, 1000U);
+}
+
+TEST(StimuliMemoryCache, concurrent)
+{
+    StimuliMemoryCache cache(64 * 100, 8);
+    std::vector<int> valid(1000, 0);
+
+#pragma omp parallel for
+    for (int i = 0; i < 1000; ++i) {
+        const unsigned int id = i % 100;
+        cv::Mat mat;
+
+        if (!cache.get(id, StimuliMemoryCache::Data, mat)) {
+            mat = makeMat(8, 8, CV_8UC1, id);
+            cache.put(id, StimuliMemoryCache::Data, mat);
+        }
+
+        valid[i] = isEqual(mat, makeMat(8, 8, CV_8UC1, id));
+    }
+
+    ASSERT_EQUALS(std::count(valid.begin(), valid.end(), 1), 1000);
+
+    const StimuliMemoryCache::Stats stats = cache.getStats();
+    ASSERT_EQUALS(stats.hits + stats.misses, 1000U);
+    ASSERT_TRUE(stats.size <= 64U * 100U);
+}
+
+RUN_TESTS()
@@ -0,0 +1,248 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "N2D2.hpp"
+
+#include "Solver/AdamSolver_Frame.hpp"
+#include "Solver/FusedUpdate.hpp"
+#include "Solver/SGDSolver_Frame.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+// Tensor sizes smaller and larger than a chunk
+static const unsigned int sizes[] = {10, 4096, 10000, 1};
+
+/// Return the maximum number of pending elements after the update steps
+template <class SOLVER>
+std::size_t update(std::vector<std::shared_ptr<SOLVER> >& solvers,
+                   std::vector<Tensor<float> >& data,
+                   std::vector<Tensor<float> >& diffData,
+                   bool fused)
+{
+    std::size_t nbElements = 0;
+
+    for (unsigned int step = 0; step < 3; ++step) {
+        FusedUpdate fusedUpdate;
+
+        if (fused)
+            Solver::mFusedUpdate = &fusedUpdate;
+
+        for (unsigned int i = 0; i < solvers.size(); ++i)
+            solvers[i]->update(data[i], diffData[i], 4);
+
+        Solver::mFusedUpdate = NULL;
+
+        nbElements = std::max(nbElements, fusedUpdate.getNbElements());
+        fusedUpdate.run();
+    }
+
+    return nbElements;
+}
+
+/// Return the number of values different between the fused and the direct
+/// updates
+template <class SOLVER>
+std::size_t compareUpdate(std::vector<std::shared_ptr<SOLVER> >& solvers,
+                          std::size_t& nbFusedElements)
+{
+    std::vector<std::shared_ptr<SOLVER> > fusedSolvers;
+    std::vector<Tensor<float> > data;
+    std::vector<Tensor<float> > fusedData;
+    std::vector<Tensor<float> > diffData;
+
+    for (unsigned int i = 0; i < solvers.size(); ++i) {
+        fusedSolvers.push_back(solvers[i]->clone());
+
+        Tensor<float> tensor({sizes[i]});
+        Tensor<float> diffTensor({sizes[i]});
+
+        for (unsigned int index = 0; index < sizes[i]; ++index) {
+            tensor(index) = Random::randNormal(0.0, 0.5);
+            diffTensor(index) = Random::randNormal(0.0, 0.1);
+        }
+
+        data.push_back(tensor);
+        fusedData.push_back(tensor.clone());
+        diffData.push_back(diffTensor);
+    }
+
+    nbFusedElements = update(fusedSolvers, fusedData, diffData, true);
+
+    if (update(solvers, data, diffData, false) != 0)
+        return std::numeric_limits<std::size_t>::max();
+
+    std::size_t nbErrors = 0;
+
+    for (unsigned int i = 0; i < data.size(); ++i) {
+        for (unsigned int index = 0; index < data[i].size(); ++index) {
+            if (fusedData[i](index) != data[i](index))
+                ++nbErrors;
+        }
+    }
+
+    return nbErrors;
+}
+
+TEST_DATASET(FusedUpdate,
+             SGDSolver_Frame,
+             (double momentum, double decay, std::string clamping),
+             std::make_tuple(0.0, 0.0, ""),
+             std::make_tuple(0.0, 0.0, "-0.5:0.5"),
+             std::make_tuple(0.9, 0.0, ""),
+             std::make_tuple(0.9, 0.0005, ""),
+             std::make_tuple(0.9, 0.0005, ":0.5"))
+{
+    Random::mtSeed(0);
+
+    std::vector<std::shared_ptr<SGDSolver_Frame<float> > > solvers;
+
+    for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        solvers.push_back(std::make_shared<SGDSolver_Frame<float> >());
+        solvers.back()->setParameter("LearningRate", 0.01 * (i + 1));
+        solvers.back()->setParameter("Momentum", momentum);
+        solvers.back()->setParameter("Decay", decay);
+        solvers.back()->setParameter("Clamping", clamping);
+    }
+
+    std::size_t nbFusedElements;
+
+    ASSERT_EQUALS(compareUpdate(solvers, nbFusedElements), 0U);
+    ASSERT_EQUALS(nbFusedElements, 10U + 4096U + 10000U + 1U);
+}
+
+TEST_DATASET(FusedUpdate,
+             AdamSolver_Frame,
+             (std::string clamping),
+             std::make_tuple(""),
+             std::make_tuple("-0.5:0.5"))
+{
+    Random::mtSeed(0);
+
+    std::vector<std::shared_ptr<AdamSolver_Frame<float> > > solvers;
+
+    for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+        solvers.push_back(std::make_shared<AdamSolver_Frame<float> >());
+        solvers.back()->setParameter("LearningRate", 0.001 * (i + 1));
+        solvers.back()->setParameter("Clamping", clamping);
+    }
+
+    std::size_t nbFusedElements;
+
+    ASSERT_EQUALS(compareUpdate(solvers, nbFusedElements), 0U);
+    ASSERT_EQUALS(nbFusedElements, 10U + 4096U + 10000U + 1U);
+}
+
+TEST(FusedUpdate, SGDSolver_Frame_sharedParameters)
+{
+    Random::mtSeed(0);
+
+    // Two cells sharing the same weights (see ConvCell::setWeights()), each
+    // with its own solver
+    std::vector<std::shared_ptr<SGDSolver_Frame<float> > > solvers;
+    std::vector<Tensor<float> > diffData;
+
+    for (unsigned int i = 0; i < 2; ++i) {
+        solvers.push_back(std::make_shared<SGDSolver_Frame<float> >());
+        solvers.back()->setParameter("LearningRate", 0.01 * (i + 1));
+        solvers.back()->setParameter("Momentum", 0.9);
+
+        Tensor<float> diffTensor({10000});
+
+        for (unsigned int index = 0; index < diffTensor.size(); ++index)
+            diffTensor(index) = Random::randNormal(0.0, 0.1);
+
+        diffData.push_back(diffTensor);
+    }
+
+    Tensor<float> data({10000});
+
+    for (unsigned int index = 0; index < data.size(); ++index)
+        data(index) = Random::randNormal(0.0, 0.5);
+
+    Tensor<float> fusedData = data.clone();
+    std::vector<std::shared_ptr<SGDSolver_Frame<float> > > fusedSolvers;
+
+    for (unsigned int i = 0; i < solvers.size(); ++i)
+        fusedSolvers.push_back(solvers[i]->clone());
+
+    for (unsigned int step = 0; step < 3; ++step) {
+        for (unsigned int i = 0; i < solvers.size(); ++i)
+            solvers[i]->update(data, diffData[i], 4);
+
+        FusedUpdate fusedUpdate;
+        Solver::mFusedUpdate = &fusedUpdate;
+
+        for (unsigned int i = 0; i < fusedSolvers.size(); ++i)
+            fusedSolvers[i]->update(fusedData, diffData[i], 4);
+
+        Solver::mFusedUpdate = NULL;
+
+        // The first update was executed when the second one was added
+        ASSERT_EQUALS(fusedUpdate.getNbElements(), 10000U);
+        fusedUpdate.run();
+    }
+
+    std::size_t nbErrors = 0;
+
+    for (unsigned int index = 0; index < data.size(); ++index) {
+        if (fusedData(index) != data(index))
+            ++nbErrors;
+    }
+
+    ASSERT_EQUALS(nbErrors, 0U);
+}
+
+TEST(FusedUpdate, getGroupTimes)
+{
+    std::vector<float> data(10000 + 10);
+    FusedUpdate fusedUpdate;
+    fusedUpdate.enableTimings(3);
+
+    // Group 1 has no update
+    fusedUpdate.setGroup(0);
+    fusedUpdate.add(&data[0], 10000,
+        [&data](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i)
+                data[i] += 1.0f;
+        });
+    fusedUpdate.setGroup(2);
+    fusedUpdate.add(&data[10000], 10,
+        [&data](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i)
+                data[10000 + i] += 2.0f;
+        });
+    fusedUpdate.run();
+
+    ASSERT_EQUALS(data[0], 1.0f);
+    ASSERT_EQUALS(data[10009], 2.0f);
+
+    const std::vector<double>& groupTimes = fusedUpdate.getGroupTimes();
+
+    ASSERT_EQUALS(groupTimes.size(), 3U);
+    ASSERT_TRUE(groupTimes[0] > 0.0);
+    ASSERT_EQUALS(groupTimes[1], 0.0);
+    ASSERT_TRUE(groupTimes[2] >= 0.0);
+    ASSERT_EQUALS_DELTA(groupTimes[0] + groupTimes[1] + groupTimes[2],
+                        fusedUpdate.getRunTime(), 1.0e-9);
+}
+
+RUN_TESTS()
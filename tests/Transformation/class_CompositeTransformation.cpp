@@ -22,7 +22,9 @@
 #include "Transformation/ChannelExtractionTransformation.hpp"
 #include "Transformation/CompositeTransformation.hpp"
 #include "Transformation/FlipTransformation.hpp"
+#include "Transformation/PadCropTransformation.hpp"
 #include "Transformation/RescaleTransformation.hpp"
+#include "Transformation/SliceExtractionTransformation.hpp"
 #include "utils/UnitTest.hpp"
 #include "utils/Utils.hpp"
 
@@ -126,4 +128,117 @@ TEST(CompositeTransformation, apply__random)
                                  + fileName.str());
 }
 
+TEST_DATASET(CompositeTransformation,
+             apply__geometricFusion,
+             (unsigned int pipeline),
+             std::make_tuple(0U),
+             std::make_tuple(1U),
+             std::make_tuple(2U),
+             std::make_tuple(3U))
+{
+    CompositeTransformation trans;
+
+    if (pipeline == 0) {
+        // Cacheable pipeline of the ILSVRC2012 models
+        RescaleTransformation rescale(120, 120);
+        rescale.setParameter("KeepAspectRatio", true);
+
+        trans.push_back(rescale);
+        trans.push_back(PadCropTransformation(120, 120));
+        trans.push_back(FlipTransformation(true, false));
+    }
+    else if (pipeline == 1) {
+        trans.push_back(RescaleTransformation(100, 80));
+        trans.push_back(FlipTransformation(true, true));
+    }
+    else if (pipeline == 2) {
+        PadCropTransformation padCrop(220, 170);
+        padCrop.setParameter("BorderType",
+                             PadCropTransformation::ConstantBorder);
+
+        FlipTransformation flip;
+        flip.setParameter("RandomHorizontalFlip", true);
+
+        trans.push_back(padCrop);
+        trans.push_back(RescaleTransformation(110, 85));
+        trans.push_back(flip);
+    }
+    else {
+        // On-the-fly pipeline of the ILSVRC2012 models, with scaling
+        SliceExtractionTransformation slice(100, 100);
+        slice.setParameter("RandomOffsetX", true);
+        slice.setParameter("RandomOffsetY", true);
+        slice.setParameter("RandomScaling", true);
+
+        FlipTransformation flip;
+        flip.setParameter("RandomHorizontalFlip", true);
+
+        trans.push_back(slice);
+        trans.push_back(flip);
+        trans.push_back(RescaleTransformation(64, 64));
+    }
+
+    // Smooth synthetic image, as the fused resampling only differs in the
+    // interpolation at the borders
+    cv::Mat img(150, 200, CV_8UC3);
+
+    for (int y = 0; y < img.rows; ++y) {
+        for (int x = 0; x < img.cols; ++x) {
+            img.at<cv::Vec3b>(y, x)[0] = x;
+            img.at<cv::Vec3b>(y, x)[1] = y;
+            img.at<cv::Vec3b>(y, x)[2] = 128 + 100 * std::sin(x / 20.0);
+        }
+    }
+
+    RectangularROI<int> roi(1, cv::Point(40, 30), 80, 60);
+    cv::Mat labels(img.rows, img.cols, CV_32SC1, cv::Scalar(0));
+    roi.append(labels);
+
+    for (unsigned int i = 0; i < 10; ++i) {
+        cv::Mat frame = img.clone();
+        cv::Mat frameLabels = labels.clone();
+        std::vector<std::shared_ptr<ROI> > labelsROI(1, roi.clone());
+
+        cv::Mat frameFused = img.clone();
+        cv::Mat frameLabelsFused = labels.clone();
+        std::vector<std::shared_ptr<ROI> > labelsROIFused(1, roi.clone());
+
+        Random::mtSeed(i);
+        trans.setGeometricFusion(false);
+        trans.apply(frame, frameLabels, labelsROI);
+
+        Random::mtSeed(i);
+        trans.setGeometricFusion(true);
+        trans.apply(frameFused, frameLabelsFused, labelsROIFused);
+
+        ASSERT_EQUALS(frameFused.cols, frame.cols);
+        ASSERT_EQUALS(frameFused.rows, frame.rows);
+        ASSERT_EQUALS(frameFused.type(), frame.type());
+        ASSERT_EQUALS(frameLabelsFused.cols, frameLabels.cols);
+        ASSERT_EQUALS(frameLabelsFused.rows, frameLabels.rows);
+
+        const double meanError = cv::norm(frameFused, frame, cv::NORM_L1)
+            / (frame.total() * frame.channels());
+
+        ASSERT_TRUE(meanError < 2.0);
+
+        const double labelsError = cv::norm(frameLabelsFused, frameLabels,
+                                            cv::NORM_L1) / frameLabels.total();
+
+        ASSERT_TRUE(labelsError < 0.05);
+
+        ASSERT_EQUALS(labelsROIFused.size(), labelsROI.size());
+
+        for (unsigned int k = 0; k < labelsROI.size(); ++k) {
+            const cv::Rect rect = labelsROI[k]->getBoundingRect();
+            const cv::Rect rectFused = labelsROIFused[k]->getBoundingRect();
+
+            ASSERT_EQUALS(rectFused.x, rect.x);
+            ASSERT_EQUALS(rectFused.y, rect.y);
+            ASSERT_EQUALS(rectFused.width, rect.width);
+            ASSERT_EQUALS(rectFused.height, rect.height);
+        }
+    }
+}
+
 RUN_TESTS()
@@ -234,4 +234,150 @@ TEST(DeepNet, fuseBatchNorm)
     }
 }
 
+TEST(DeepNet, parallelBranches)
+{
+    Network net(0U,false);
+    DeepNet deepNet(net);
+
+    std::shared_ptr<Database> database(new Database);
+    std::shared_ptr<StimuliProvider> sp(new StimuliProvider(*database,
+                                                            {8, 8, 1},
+                                                            2,
+                                                            false));
+    deepNet.setDatabase(database);
+    deepNet.setStimuliProvider(sp);
+
+    Random::mtSeed(0);
+
+    for (unsigned int index = 0; index < sp->getData().size(); ++index)
+        sp->getData()(index) = Random::randUniform(-1.0, 1.0);
+
+    // fc0 -> {fc1a, fc1b} -> fc2
+    std::shared_ptr<FcCell> fc0(new FcCell_Frame<Float_T>(deepNet, "fc0", 8));
+    std::shared_ptr<FcCell> fc1a(new FcCell_Frame<Float_T>(deepNet, "fc1a", 6));
+    std::shared_ptr<FcCell> fc1b(new FcCell_Frame<Float_T>(deepNet, "fc1b", 4));
+    std::shared_ptr<FcCell> fc2(new FcCell_Frame<Float_T>(deepNet, "fc2", 3));
+
+    deepNet.addCell(fc0, std::vector<std::shared_ptr<Cell> >(1));
+    deepNet.addCell(fc1a, std::vector<std::shared_ptr<Cell> >(1, fc0));
+    deepNet.addCell(fc1b, std::vector<std::shared_ptr<Cell> >(1, fc0));
+    deepNet.addCell(fc2, std::vector<std::shared_ptr<Cell> >{fc1a, fc1b});
+
+    fc0->addInput(*sp);
+    fc1a->addInput(fc0.get());
+    fc1b->addInput(fc0.get());
+    fc2->addInput(fc1a.get());
+    fc2->addInput(fc1b.get());
+
+    deepNet.initialize();
+
+    ASSERT_EQUALS(deepNet.getLayers().size(), 4U);
+    ASSERT_EQUALS(deepNet.getLayers()[2].size(), 2U);
+
+    std::shared_ptr<Cell_Frame_Top> fc0Frame
+        = std::dynamic_pointer_cast<Cell_Frame_Top>(fc0);
+    std::shared_ptr<Cell_Frame_Top> fc2Frame
+        = std::dynamic_pointer_cast<Cell_Frame_Top>(fc2);
+
+    const Tensor<int> targets({1, 1, 1, 2}, 1);
+    std::vector<Tensor<Float_T> > outputs;
+    std::vector<Tensor<Float_T> > diffs;
+
+    for (unsigned int parallel = 0; parallel < 2; ++parallel) {
+        deepNet.setParameter("ParallelBranches", (parallel > 0));
+        deepNet.propagate(false);
+        fc2Frame->setOutputTarget(targets);
+        deepNet.backPropagate();
+
+        outputs.push_back(
+            tensor_cast<Float_T>(fc2Frame->getOutputs()).clone());
+        // Accumulated gradient from both branches
+        diffs.push_back(
+            tensor_cast<Float_T>(fc0Frame->getDiffInputs()).clone());
+    }
+
+    for (unsigned int index = 0; index < outputs[0].size(); ++index)
+        ASSERT_EQUALS(outputs[0](index), outputs[1](index));
+
+    for (unsigned int index = 0; index < diffs[0].size(); ++index)
+        ASSERT_EQUALS(diffs[0](index), diffs[1](index));
+}
+
+TEST(DeepNet, planInferenceMemory)
+{
+    Network net(0U,false);
+    DeepNet deepNet(net);
+
+    std::shared_ptr<Database> database(new Database);
+    std::shared_ptr<StimuliProvider> sp(new StimuliProvider(*database,
+                                                            {8, 8, 1},
+                                                            2,
+                                                            false));
+    deepNet.setDatabase(database);
+    deepNet.setStimuliProvider(sp);
+
+    Random::mtSeed(0);
+
+    for (unsigned int index = 0; index < sp->getData().size(); ++index)
+        sp->getData()(index) = Random::randUniform(-1.0, 1.0);
+
+    // fc0 -> fc1 -> fc2 -> fc3
+    std::vector<std::shared_ptr<FcCell> > cells;
+    const unsigned int nbOutputs[4] = {16, 8, 16, 4};
+
+    for (unsigned int i = 0; i < 4; ++i) {
+        std::stringstream name;
+        name << "fc" << i;
+
+        cells.push_back(std::make_shared<FcCell_Frame<Float_T> >(deepNet,
+                                                    name.str(), nbOutputs[i]));
+
+        if (i == 0) {
+            deepNet.addCell(cells.back(), std::vector<std::shared_ptr<Cell> >(1));
+            cells.back()->addInput(*sp);
+        }
+        else {
+            deepNet.addCell(cells.back(),
+                std::vector<std::shared_ptr<Cell> >(1, cells[i - 1]));
+            cells.back()->addInput(cells[i - 1].get());
+        }
+    }
+
+    deepNet.initialize();
+
+    std::shared_ptr<Cell_Frame_Top> fc3Frame
+        = std::dynamic_pointer_cast<Cell_Frame_Top>(cells.back());
+
+    deepNet.propagate(true);
+    const Tensor<Float_T> outputsRef
+        = tensor_cast<Float_T>(fc3Frame->getOutputs()).clone();
+
+    // fc0 and fc2 outputs share the same storage, fc3 has its own
+    const std::size_t peakSize = deepNet.planInferenceMemory();
+
+    ASSERT_EQUALS(deepNet.isInferenceMemoryPlanned(), true);
+    ASSERT_EQUALS(peakSize, (16 + 8 + 4) * 2 * sizeof(Float_T));
+    ASSERT_THROW_ANY(deepNet.propagate(false));
+
+    deepNet.propagate(true);
+    const Tensor<Float_T> outputs
+        = tensor_cast<Float_T>(fc3Frame->getOutputs()).clone();
+
+    for (unsigned int index = 0; index < outputsRef.size(); ++index)
+        ASSERT_EQUALS(outputs(index), outputsRef(index));
+
+    deepNet.clearInferenceMemoryPlan();
+
+    ASSERT_EQUALS(deepNet.isInferenceMemoryPlanned(), false);
+
+    for (unsigned int i = 0; i < 4; ++i) {
+        std::shared_ptr<Cell_Frame_Top> cellFrame
+            = std::dynamic_pointer_cast<Cell_Frame_Top>(cells[i]);
+        const Tensor<Float_T> cellOutputs
+            = tensor_cast_nocopy<Float_T>(cellFrame->getOutputs());
+
+        ASSERT_EQUALS(cellOutputs.data().size(), cellOutputs.size());
+    }
+}
+
 RUN_TESTS()
@@ -61,6 +61,29 @@ void fillRangeAndHistorgramNetwork(DeepNet& deepNet, std::size_t nbTestStimuli,
     deepNet.clear(Database::Test);
 }
 
+void fillStatsNetwork(DeepNet& deepNet, std::size_t nbTestStimuli,
+                      std::unordered_map<std::string, RangeStats>& outputsRange,
+                      std::unordered_map<std::string, Histogram>& outputsHistogram,
+                      std::size_t nbBits,
+                      ClippingMode actClippingMode)
+{
+    const std::shared_ptr<StimuliProvider>& sp = deepNet.getStimuliProvider();
+    DeepNetQuantization dnQuantization(deepNet);
+    DeepNetQuantization::OutputsSnapshot outputs;
+
+    const std::size_t nbBatches = std::ceil(1.0*nbTestStimuli/sp->getBatchSize());
+    for(std::size_t batch = 0; batch < nbBatches; batch++) {
+        sp->readBatch(Database::Test, batch*sp->getBatchSize());
+        deepNet.test(Database::Test);
+
+        dnQuantization.snapshotOutputs(outputs);
+        dnQuantization.reportOutputsStats(outputs, outputsRange, outputsHistogram,
+                                          nbBits, actClippingMode);
+    }
+
+    deepNet.clear(Database::Test);
+}
+
 double testNetwork(DeepNet& deepNet, std::size_t nbTestStimuli) {
     const std::shared_ptr<StimuliProvider>& sp = deepNet.getStimuliProvider();
 
@@ -232,6 +255,57 @@ TEST_DATASET(DeepNetQuantization, quantization,
     ASSERT_EQUALS_DELTA(testNetwork(*deepNet, nbTestStimuli), expectedQuantizedScore, 0.01);
 }
 
+TEST_DATASET(DeepNetQuantization, reportOutputsStats,
+        (const std::string& model, const std::string& weightsDir,
+         std::size_t nbTestStimuli, ClippingMode actClippingMode),
+
+    std::make_tuple("tests_data/mnist_model/model.ini", "tests_data/mnist_model/weights",
+                    100, ClippingMode::MSE),
+    std::make_tuple("tests_data/mnist_multibranch_model/model.ini", "tests_data/mnist_multibranch_model/weights",
+                    100, ClippingMode::KL_DIVERGENCE)
+)
+{
+    REQUIRED(UnitTest::DirExists(N2D2_DATA("mnist")));
+
+    const std::size_t nbBits = 8;
+    DeepNetExport::mEnvDataUnsigned = true;
+
+    Network net(SEED,false);
+    std::shared_ptr<DeepNet> deepNet = DeepNetGenerator::generate(net, model);
+
+    deepNet->initialize();
+    deepNet->importNetworkFreeParameters(weightsDir);
+
+    std::unordered_map<std::string, Histogram> outputsHistogram;
+    std::unordered_map<std::string, RangeStats> outputsRange;
+    fillRangeAndHistorgramNetwork(*deepNet, nbTestStimuli,
+                                  outputsRange, outputsHistogram, nbBits, actClippingMode);
+
+    std::unordered_map<std::string, Histogram> statsHistogram;
+    std::unordered_map<std::string, RangeStats> statsRange;
+    fillStatsNetwork(*deepNet, nbTestStimuli,
+                     statsRange, statsHistogram, nbBits, actClippingMode);
+
+    ASSERT_EQUALS(statsRange.size(), outputsRange.size());
+    ASSERT_EQUALS(statsHistogram.size(), outputsHistogram.size());
+
+    for (auto it = outputsRange.begin(); it != outputsRange.end(); ++it) {
+        const RangeStats& range = statsRange.at((*it).first);
+
+        ASSERT_EQUALS(range.minVal(), (*it).second.minVal());
+        ASSERT_EQUALS(range.maxVal(), (*it).second.maxVal());
+        ASSERT_EQUALS(range.moments()[0], (*it).second.moments()[0]);
+        ASSERT_EQUALS_DELTA(range.mean(), (*it).second.mean(), 1e-6);
+
+        const Histogram& hist = statsHistogram.at((*it).first);
+        const Histogram& refHist = outputsHistogram.at((*it).first);
+
+        ASSERT_EQUALS(hist.getMinVal(), refHist.getMinVal());
+        ASSERT_EQUALS(hist.getMaxVal(), refHist.getMaxVal());
+        ASSERT_TRUE(hist.getBins() == refHist.getBins());
+    }
+}
+
 
 #ifdef CUDA
 TEST_DATASET(DeepNetQuantization, quantization_CUDA,
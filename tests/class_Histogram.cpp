@@ -19,6 +19,9 @@
 */
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
 #include <vector>
 #include "Histogram.hpp"
 #include "utils/UnitTest.hpp"
@@ -174,4 +177,165 @@ TEST(Histogram, test_enlarge_asymetric_max) {
                 std::vector<std::size_t>({2, 0, 2, 1, 3, 1, 0, 4, 0, 0, 1, 0, 0}));
 }
 
+TEST_DATASET(Histogram,
+             add,
+             (std::size_t size, std::size_t nbBins),
+             std::make_tuple(1000U, 11U),
+             std::make_tuple(1000U, 65536U),
+             std::make_tuple(300000U, 11U),
+             std::make_tuple(1000000U, 4096U))
+{
+    std::mt19937 gen(7);
+    std::normal_distribution<float> dist(0.0, 2.0);
+    std::vector<float> values(size);
+    std::vector<double> doubleValues(size);
+
+    for (std::size_t i = 0; i < size; ++i) {
+        // Include the exact bounds of the histogram
+        values[i] = (i % 1000 == 0) ? -10.0f : (i % 1000 == 1) ? 10.0f
+            : std::max(-10.0f, std::min(10.0f, dist(gen)));
+        doubleValues[i] = values[i];
+    }
+
+    Histogram hist(-10, 10, nbBins);
+    for (std::size_t i = 0; i < size; ++i)
+        hist(values[i]);
+
+    Histogram histFloat(-10, 10, nbBins);
+    histFloat.add(&values[0], size);
+
+    Histogram histDouble(-10, 10, nbBins);
+    histDouble.add(&doubleValues[0], size / 2);
+    histDouble.add(&doubleValues[size / 2], size - size / 2);
+
+    ASSERT_TRUE(histFloat.getBins() == hist.getBins());
+    ASSERT_TRUE(histDouble.getBins() == hist.getBins());
+}
+
+TEST_DATASET(Histogram,
+             add_out_of_range,
+             (std::size_t size),
+             std::make_tuple(1000U),
+             std::make_tuple(300000U))
+{
+    std::vector<double> values(size, 1.0);
+    values[size - 2] = 11.0;
+
+    Histogram hist(-10, 10, 11);
+    hist(0);
+
+    ASSERT_THROW(hist.add(&values[0], size), std::out_of_range);
+    ASSERT_TRUE(hist.getBins() ==
+                std::vector<std::size_t>({0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0}));
+
+    values[size - 2] = 0.0;
+    hist.add(&values[0], size);
+
+    ASSERT_EQUALS(hist.getBins()[5], 2);
+    ASSERT_EQUALS(hist.getBins()[6], size - 1);
+}
+
+namespace {
+// Reference calibrations, scanning the whole histogram for each threshold
+double referenceMSE(const Histogram& hist, double threshold, std::size_t nbBits)
+{
+    const bool isUnsigned = hist.getMinVal() >= 0.0;
+    const double minVal = isUnsigned ? 0 : -(1LL << (nbBits - 1));
+    const double maxVal = isUnsigned ? ((1ULL << nbBits) - 1)
+                                     : ((1ULL << (nbBits - 1)) - 1);
+    const double scaling = maxVal / threshold;
+    const std::vector<std::size_t>& bins = hist.getBins();
+    std::size_t nbValues = 0;
+
+    for (std::size_t bin = 0; bin < bins.size(); ++bin)
+        nbValues += bins[bin];
+
+    double mse = 0.0;
+
+    for (std::size_t bin = 0; bin < bins.size(); ++bin) {
+        const double value = hist.getBinValue(bin);
+        const double approx = std::max(minVal,
+            std::min(maxVal, std::round(value * scaling))) / scaling;
+
+        mse += std::pow(value - approx, 2) * bins[bin] / nbValues;
+    }
+
+    return mse;
+}
+
+double referenceKLDivergence(const Histogram& hist, double threshold,
+                             std::size_t nbBits)
+{
+    const bool isUnsigned = hist.getMinVal() >= 0.0;
+    Histogram quant(isUnsigned ? 0 : -threshold, threshold, 1 << nbBits);
+    const std::vector<std::size_t>& bins = hist.getBins();
+    std::size_t nbValues = 0;
+
+    for (std::size_t bin = 0; bin < bins.size(); ++bin) {
+        quant(std::max(quant.getMinVal(),
+                       std::min(quant.getMaxVal(), hist.getBinValue(bin))),
+              bins[bin]);
+        nbValues += bins[bin];
+    }
+
+    double qNorm = 0.0;
+
+    for (std::size_t bin = 0; bin < bins.size(); ++bin)
+        qNorm += quant.getBins()[quant.getBinIdx(hist.getBinValue(bin))];
+
+    double divergence = 0.0;
+
+    for (std::size_t bin = 0; bin < bins.size(); ++bin) {
+        const double p = bins[bin] / (double)nbValues;
+        const double q
+            = quant.getBins()[quant.getBinIdx(hist.getBinValue(bin))] / qNorm;
+
+        if (p != 0)
+            divergence += p * std::log(p / q);
+    }
+
+    return divergence;
+}
+}
+
+TEST_DATASET(Histogram,
+             calibrate,
+             (std::size_t nbBits, bool isUnsigned),
+             std::make_tuple(4U, false),
+             std::make_tuple(4U, true),
+             std::make_tuple(8U, false),
+             std::make_tuple(8U, true))
+{
+    std::mt19937 gen(nbBits);
+    std::gamma_distribution<double> dist(1.5, 1.0);
+
+    const double minVal = (isUnsigned) ? 0.0 : -12.0;
+    Histogram hist(minVal, 12.0,
+                   getNbBinsForClippingMode(nbBits, ClippingMode::MSE));
+
+    for (unsigned int i = 0; i < 100000; ++i) {
+        const double value = std::min(12.0, dist(gen));
+        hist((isUnsigned || i % 3 != 0) ? value : -value);
+    }
+
+    const double threshold = 12.0;
+    const double step = threshold / 1000.0;
+    double bestMSE = std::numeric_limits<double>::max();
+    double bestDivergence = std::numeric_limits<double>::max();
+
+    for (double t = threshold; t > 0.0; t -= step) {
+        bestMSE = std::min(bestMSE, referenceMSE(hist, t, nbBits));
+        bestDivergence = std::min(bestDivergence,
+                                  referenceKLDivergence(hist, t, nbBits));
+    }
+
+    const double mseThreshold = hist.calibrateMSE(nbBits);
+    const double klThreshold = hist.calibrateKLDivergence(nbBits);
+
+    ASSERT_EQUALS_DELTA(referenceMSE(hist, mseThreshold, nbBits), bestMSE,
+                        1e-9 * bestMSE);
+    ASSERT_EQUALS_DELTA(referenceKLDivergence(hist, klThreshold, nbBits),
+                        bestDivergence, 1e-9);
+}
+
 RUN_TESTS()
\ No newline at end of file
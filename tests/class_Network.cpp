@@ -0,0 +1,424 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "Xnet/Network.hpp"
+#include "Xnet/Node.hpp"
+#include "Xnet/NodeEnv.hpp"
+#include "Xnet/NodeNeuron_Behavioral.hpp"
+#include "Xnet/SpikeEvent.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+class Network_TestNode : public Node {
+public:
+    enum {
+        Cascade,
+        Pending
+    };
+
+    Network_TestNode(Network& net,
+                     unsigned int nbCascades = 0,
+                     Time_T maxDelay = 0)
+        : Node(net),
+          nbScheduled(0),
+          nbDiscarded(0),
+          mNbCascades(nbCascades),
+          mMaxDelay(maxDelay),
+          mPending(NULL),
+          mGenerator(42)
+    {
+    }
+    void incomingSpike(Node* /*origin*/, Time_T timestamp, EventType_T type)
+    {
+        mNet.newEvent(this, NULL, timestamp, type);
+    }
+    void emitSpike(Time_T timestamp, EventType_T type)
+    {
+        released.push_back(std::make_pair(timestamp, type));
+
+        if (mNbCascades == 0 && mMaxDelay == 0)
+            return;
+
+        if (type == Pending) {
+            mPending = NULL;
+            return;
+        }
+
+        std::uniform_int_distribution<Time_T> delay(0, mMaxDelay);
+
+        for (unsigned int i = 0; i < 2 && mNbCascades > 0; ++i) {
+            --mNbCascades;
+            ++nbScheduled;
+            mNet.newEvent(this, NULL, timestamp + delay(mGenerator), Cascade);
+        }
+
+        // Re-schedule the pending event, like a neuron re-schedules its
+        // firing
+        if (mPending != NULL) {
+            mPending->discard();
+            ++nbDiscarded;
+        }
+
+        mPending = mNet.newEvent(this, NULL, timestamp + delay(mGenerator),
+                                 Pending);
+    }
+
+    NodeEvents_T released;
+    unsigned int nbScheduled;
+    unsigned int nbDiscarded;
+
+private:
+    unsigned int mNbCascades;
+    Time_T mMaxDelay;
+    SpikeEvent* mPending;
+    std::mt19937 mGenerator;
+};
+
+TEST_DATASET(Network,
+             run,
+             (Network::EventScheduler scheduler, Time_T resolution),
+             std::make_tuple(Network::PriorityQueue, TimeNs),
+             std::make_tuple(Network::TimingWheel, TimeFs),
+             std::make_tuple(Network::TimingWheel, TimeNs),
+             std::make_tuple(Network::TimingWheel, TimeUs),
+             std::make_tuple(Network::TimingWheel, TimeS))
+{
+    Network net(1U, false, false, scheduler, resolution);
+    Network_TestNode node(net);
+
+    std::mt19937 generator(1);
+    std::uniform_int_distribution<Time_T> time(0, 1000 * TimeMs);
+
+    NodeEvents_T expected;
+    std::vector<SpikeEvent*> events;
+
+    for (unsigned int i = 0; i < 10000; ++i) {
+        // Some events share the same timestamp
+        const Time_T timestamp = (i % 10 == 0 && !expected.empty())
+            ? expected.back().first : time(generator);
+
+        events.push_back(net.newEvent(&node, NULL, timestamp, i));
+
+        if (i % 3 == 0)
+            events.back()->discard();
+        else
+            expected.push_back(std::make_pair(timestamp, i));
+    }
+
+    ASSERT_TRUE(!net.run());
+    ASSERT_EQUALS(node.released.size(), expected.size());
+
+    for (unsigned int i = 1; i < node.released.size(); ++i) {
+        ASSERT_TRUE(node.released[i - 1].first <= node.released[i].first);
+    }
+
+    std::sort(expected.begin(), expected.end());
+    std::sort(node.released.begin(), node.released.end());
+
+    ASSERT_TRUE(node.released == expected);
+}
+
+TEST_DATASET(Network,
+             run_cascade,
+             (Network::EventScheduler scheduler, Time_T resolution),
+             std::make_tuple(Network::PriorityQueue, TimeNs),
+             std::make_tuple(Network::TimingWheel, TimeFs),
+             std::make_tuple(Network::TimingWheel, TimeNs),
+             std::make_tuple(Network::TimingWheel, TimeMs))
+{
+    Network net(1U, false, false, scheduler, resolution);
+    Network_TestNode node(net, 100000, 10 * TimeUs);
+
+    net.newEvent(&node, NULL, 5 * TimeNs, Network_TestNode::Cascade);
+    ++node.nbScheduled;
+
+    ASSERT_TRUE(!net.run());
+
+    unsigned int nbCascade = 0;
+    unsigned int nbPending = 0;
+
+    for (unsigned int i = 0; i < node.released.size(); ++i) {
+        if (i > 0) {
+            ASSERT_TRUE(node.released[i - 1].first <= node.released[i].first);
+        }
+
+        if (node.released[i].second == Network_TestNode::Cascade)
+            ++nbCascade;
+        else
+            ++nbPending;
+    }
+
+    ASSERT_EQUALS(nbCascade, node.nbScheduled);
+    ASSERT_EQUALS(nbPending + node.nbDiscarded, nbCascade);
+    ASSERT_EQUALS(net.getLastEvent(), node.released.back().first);
+}
+
+TEST_DATASET(Network,
+             run_stop,
+             (Network::EventScheduler scheduler),
+             std::make_tuple(Network::PriorityQueue),
+             std::make_tuple(Network::TimingWheel))
+{
+    Network net(1U, false, false, scheduler);
+    Network_TestNode node(net);
+
+    net.newEvent(&node, NULL, 10 * TimeUs, 0);
+    net.newEvent(&node, NULL, 30 * TimeUs, 1);
+    net.newEvent(&node, NULL, 2 * TimeS, 2);
+
+    ASSERT_TRUE(net.run(20 * TimeUs));
+    ASSERT_EQUALS(node.released.size(), 1U);
+    ASSERT_EQUALS(net.getLastEvent(), 10 * TimeUs);
+
+    // Events between the last event and the stop time are still legitimate
+    net.newEvent(&node, NULL, 15 * TimeUs, 3);
+
+    ASSERT_TRUE(!net.run());
+    ASSERT_EQUALS(node.released.size(), 4U);
+    ASSERT_EQUALS(node.released[1].second, 3U);
+    ASSERT_EQUALS(node.released[2].second, 1U);
+    ASSERT_EQUALS(node.released[3].second, 2U);
+
+    // Restart from the beginning
+    net.reset();
+    net.newEvent(&node, NULL, 1 * TimeUs, 4);
+    net.newEvent(&node, NULL, 1 * TimeMs, 5);
+
+    ASSERT_TRUE(!net.run());
+    ASSERT_EQUALS(node.released.size(), 6U);
+    ASSERT_EQUALS(node.released[4].second, 4U);
+    ASSERT_EQUALS(node.released[5].second, 5U);
+    ASSERT_EQUALS(net.getFirstEvent(), 1 * TimeUs);
+}
+
+/// Stop the simulation after a number of spikes, like FcCell_Spike with the
+/// TerminateMax parameter
+class Network_TestStopNode : public Node {
+public:
+    Network_TestStopNode(Network& net, unsigned int nbSpikes)
+        : Node(net), mNbSpikes(nbSpikes)
+    {
+    }
+    void incomingSpike(Node* /*origin*/, Time_T timestamp, EventType_T)
+    {
+        if (mNbSpikes > 0 && --mNbSpikes == 0)
+            mNet.stop(timestamp + 2 * TimeFs, true);
+    }
+    bool canStop() const
+    {
+        return true;
+    }
+
+private:
+    unsigned int mNbSpikes;
+};
+
+std::vector<NodeEvents_T> Network_simulate(Network::EventScheduler scheduler,
+                                           unsigned int nbThreads,
+                                           unsigned int& nbPartitions,
+                                           unsigned int nbStopSpikes = 0)
+{
+    Network net(1U, false, false, scheduler);
+    net.setNbThreads(nbThreads);
+
+    std::vector<std::shared_ptr<Node> > nodes;
+    std::vector<std::shared_ptr<NodeEnv> > inputs;
+
+    for (unsigned int i = 0; i < 32; ++i) {
+        inputs.push_back(std::make_shared<NodeEnv>(net, 1.0, 0.0, i));
+        inputs.back()->setActivityRecording(true);
+        nodes.push_back(inputs.back());
+    }
+
+    // Two layers of neurons with learning, the first layer is made of groups
+    // of 4 neurons with lateral inhibition
+    std::vector<std::shared_ptr<NodeNeuron_Behavioral> > layers[2];
+
+    for (unsigned int layer = 0; layer < 2; ++layer) {
+        for (unsigned int n = 0; n < ((layer == 0) ? 32U : 8U); ++n) {
+            std::shared_ptr<NodeNeuron_Behavioral> neuron
+                = std::make_shared<NodeNeuron_Behavioral>(net);
+            neuron->setParameter<Time_T>("IncomingDelay", 10 * TimeUs,
+                                         1.0 * TimeUs);
+            // No spread on the parameters drawn at initialization, as the
+            // observers are initialized in a memory dependent order
+            neuron->setParameter<Time_T>("EmitDelay", 100 * TimePs, 0.0);
+            neuron->setParameter<Time_T>("Leak", 50 * TimeUs);
+            neuron->setParameter<Time_T>("InhibitRefractory", 5 * TimeUs);
+            neuron->setParameter("Threshold", (layer == 0) ? 800.0 : 400.0);
+            neuron->setParameter("OrderStdp", 2U);
+            neuron->setActivityRecording(true);
+
+            if (layer == 0) {
+                for (unsigned int i = 0; i < inputs.size(); ++i)
+                    neuron->addLink(inputs[i].get());
+            }
+            else {
+                for (unsigned int i = 0; i < layers[0].size(); ++i)
+                    neuron->addLink(layers[0][i].get());
+            }
+
+            layers[layer].push_back(neuron);
+            nodes.push_back(neuron);
+        }
+    }
+
+    for (unsigned int n = 0; n < layers[0].size(); ++n) {
+        for (unsigned int k = 4 * (n / 4); k < 4 * (n / 4 + 1); ++k) {
+            if (k != n)
+                layers[0][n]->addLateralBranch(layers[0][k].get());
+        }
+    }
+
+    std::shared_ptr<Network_TestStopNode> stopNode;
+
+    if (nbStopSpikes > 0) {
+        // Stop on the output spikes of the first layer
+        stopNode = std::make_shared<Network_TestStopNode>(net, nbStopSpikes);
+
+        for (unsigned int n = 0; n < layers[0].size(); ++n)
+            layers[0][n]->addBranch(stopNode.get());
+    }
+
+    std::mt19937 generator(3);
+    std::exponential_distribution<double> interval(1.0 / (20.0 * TimeUs));
+
+    for (unsigned int i = 0; i < inputs.size(); ++i) {
+        double timestamp = 0.0;
+
+        for (unsigned int k = 0; k < 100; ++k) {
+            timestamp += interval(generator);
+            inputs[i]->incomingSpike(NULL, (Time_T)timestamp);
+        }
+    }
+
+    const bool stopped = net.run();
+    nbPartitions = net.getPartitioning().first;
+
+    if (stopped != (nbStopSpikes > 0))
+        nbPartitions = 0;
+
+    std::vector<NodeEvents_T> activity;
+
+    for (unsigned int i = 0; i < nodes.size(); ++i)
+        activity.push_back(net.getSpikeRecording(nodes[i]->getId()));
+
+    return activity;
+}
+
+TEST_DATASET(Network,
+             run_parallel,
+             (Network::EventScheduler scheduler, unsigned int nbThreads),
+             std::make_tuple(Network::PriorityQueue, 2U),
+             std::make_tuple(Network::PriorityQueue, 4U),
+             std::make_tuple(Network::TimingWheel, 4U))
+{
+    unsigned int nbPartitions;
+    const std::vector<NodeEvents_T> activity
+        = Network_simulate(scheduler, 1U, nbPartitions);
+
+    ASSERT_EQUALS(nbPartitions, 1U);
+
+    const std::vector<NodeEvents_T> activityParallel
+        = Network_simulate(scheduler, nbThreads, nbPartitions);
+
+    ASSERT_EQUALS(nbPartitions, nbThreads);
+    ASSERT_EQUALS(activityParallel.size(), activity.size());
+
+    unsigned int nbSpikes = 0;
+
+    for (unsigned int i = 0; i < activity.size(); ++i) {
+        ASSERT_TRUE(activityParallel[i] == activity[i]);
+        nbSpikes += activity[i].size();
+    }
+
+    // The neurons must have been active
+    ASSERT_TRUE(nbSpikes > 32U * 100U);
+}
+
+TEST_DATASET(Network,
+             run_parallel_stop,
+             (unsigned int nbThreads),
+             std::make_tuple(2U),
+             std::make_tuple(4U))
+{
+    unsigned int nbPartitions;
+    const std::vector<NodeEvents_T> activity
+        = Network_simulate(Network::PriorityQueue, 1U, nbPartitions, 50U);
+
+    ASSERT_EQUALS(nbPartitions, 1U);
+
+    const std::vector<NodeEvents_T> activityParallel
+        = Network_simulate(Network::PriorityQueue, nbThreads, nbPartitions,
+                           50U);
+
+    // The simulation is partitioned but run sequentially, as the stop node
+    // can stop it in the middle of a time window
+    ASSERT_EQUALS(nbPartitions, nbThreads);
+    ASSERT_EQUALS(activityParallel.size(), activity.size());
+
+    unsigned int nbSpikes = 0;
+
+    for (unsigned int i = 0; i < activity.size(); ++i) {
+        ASSERT_TRUE(activityParallel[i] == activity[i]);
+        nbSpikes += activity[i].size();
+    }
+
+    // The simulation must have been stopped before the end of the stimuli
+    ASSERT_TRUE(nbSpikes > 50U);
+    ASSERT_TRUE(nbSpikes < 32U * 100U);
+}
+
+TEST(Network, run_parallel_partitioning)
+{
+    Network net(1U, false, false);
+    net.setNbThreads(2U);
+
+    NodeEnv input(net, 1.0, 0.0, 0);
+    std::vector<std::shared_ptr<NodeNeuron_Behavioral> > neurons;
+
+    for (unsigned int n = 0; n < 2; ++n) {
+        neurons.push_back(std::make_shared<NodeNeuron_Behavioral>(net));
+        neurons.back()->setParameter<Time_T>("IncomingDelay", 10 * TimeUs);
+        neurons.back()->setParameter("OrderStdp", 2U);
+        neurons.back()->addLink(&input);
+    }
+
+    net.run();
+
+    ASSERT_EQUALS(net.getPartitioning().first, 2U);
+    ASSERT_EQUALS(net.getPartitioning().second, 10 * TimeUs);
+
+    // The time-based STDP reads the state of the input node: the neurons must
+    // be simulated with it
+    for (unsigned int n = 0; n < neurons.size(); ++n)
+        neurons[n]->setParameter("OrderStdp", 0U);
+
+    net.run();
+
+    ASSERT_EQUALS(net.getPartitioning().first, 1U);
+}
+
+RUN_TESTS()
@@ -0,0 +1,121 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "Xnet/Network.hpp"
+#include "Xnet/NodeEnv.hpp"
+#include "Xnet/NodeNeuron_Behavioral.hpp"
+#include "Xnet/Synapse_Behavioral.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+TEST_DATASET(NodeNeuron_Behavioral,
+             addLink,
+             (unsigned int stride, bool shuffle),
+             std::make_tuple(1U, false),
+             std::make_tuple(1U, true),
+             std::make_tuple(3U, true),
+             // Sparse input IDs: binary search instead of direct indexing
+             std::make_tuple(200U, false),
+             std::make_tuple(200U, true))
+{
+    Network net(1U, false, false);
+
+    std::vector<std::shared_ptr<NodeEnv> > inputs;
+
+    for (unsigned int i = 0; i < 2000; ++i)
+        inputs.push_back(std::make_shared<NodeEnv>(net, 1.0, 0.0, i));
+
+    NodeNeuron_Behavioral neuron(net);
+    neuron.setParameter("EnableStdp", false);
+    neuron.setParameter<Time_T>("IncomingDelay", 10 * TimeUs, 1.0 * TimeUs);
+
+    std::vector<unsigned int> linked;
+
+    for (unsigned int i = 0; i < inputs.size(); i += stride)
+        linked.push_back(i);
+
+    if (shuffle)
+        std::shuffle(linked.begin(), linked.end(), std::mt19937(1));
+
+    for (unsigned int i = 0; i < linked.size(); ++i)
+        neuron.addLink(inputs[linked[i]].get());
+
+    ASSERT_THROW(neuron.addLink(inputs[linked[0]].get()), std::logic_error);
+    ASSERT_EQUALS(neuron.getNbLinks(), linked.size());
+    ASSERT_EQUALS(neuron.getSynapses().size(), linked.size());
+
+    const std::vector<Node*>& origins = neuron.getLinkOrigins();
+
+    for (unsigned int i = 1; i < origins.size(); ++i) {
+        ASSERT_TRUE(origins[i - 1]->getId() < origins[i]->getId());
+    }
+
+    for (unsigned int i = 0; i < inputs.size(); ++i) {
+        const int link = neuron.findLink(inputs[i].get());
+
+        if (i % stride == 0) {
+            ASSERT_EQUALS(link, (int)(i / stride));
+            ASSERT_TRUE(origins[link] == inputs[i].get());
+
+            const Synapse_Behavioral* synapse = static_cast
+                <Synapse_Behavioral*>(neuron.getSynapses()[link]);
+
+            ASSERT_TRUE(synapse->delay > 0);
+            ASSERT_EQUALS(neuron.getLinkDelay(inputs[i].get()),
+                          synapse->delay);
+        }
+        else
+            ASSERT_EQUALS(link, -1);
+    }
+
+    ASSERT_EQUALS(neuron.findLink(&neuron), -1);
+}
+
+TEST(NodeNeuron_Behavioral, addLink__noDelay)
+{
+    Network net(1U, false, false);
+
+    std::vector<std::shared_ptr<NodeEnv> > inputs;
+
+    for (unsigned int i = 0; i < 100; ++i)
+        inputs.push_back(std::make_shared<NodeEnv>(net, 1.0, 0.0, i));
+
+    NodeNeuron_Behavioral neuron(net);
+    neuron.setParameter("EnableStdp", false);
+    neuron.setParameter<Time_T>("IncomingDelay", 0, 0.0);
+
+    for (unsigned int i = 0; i < inputs.size(); ++i)
+        neuron.addLink(inputs[i].get());
+
+    ASSERT_EQUALS(neuron.getNbLinks(), inputs.size());
+
+    for (unsigned int i = 0; i < inputs.size(); ++i) {
+        ASSERT_EQUALS(neuron.findLink(inputs[i].get()), (int)i);
+        ASSERT_EQUALS(neuron.getLinkDelay(inputs[i].get()), 0U);
+    }
+}
+
+RUN_TESTS()
@@ -0,0 +1,178 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "StimuliCache.hpp"
+#include "utils/UnitTest.hpp"
+#include "utils/Utils.hpp"
+
+#include "utils/MatTest.hpp"
+
+using namespace N2D2;
+using namespace N2D2::MatTest;
+
+TEST(StimuliCache, put_get)
+{
+    Utils::createDirectories("StimuliCache");
+    std::remove("StimuliCache/put_get.dat");
+    std::remove("StimuliCache/put_get.idx");
+
+    std::vector<cv::Mat> data1(1, makeMat(5, 3, CV_8UC3, 1));
+    std::vector<cv::Mat> labels1(1, makeMat(5, 3, CV_32SC1, 2));
+    std::vector<cv::Mat> data2;
+    data2.push_back(makeMat(7, 2, CV_32FC1, 3));
+    data2.push_back(makeMat(1, 1, CV_8UC1, 4));
+    std::vector<cv::Mat> labels2(1, makeMat(1, 1, CV_32SC1, 5));
+
+    {
+        StimuliCache cache("StimuliCache/put_get");
+        ASSERT_EQUALS(cache.size(), 0U);
+        ASSERT_TRUE(!cache.contains(12));
+
+        cache.put(12, data1, labels1);
+        cache.put(3, data2, labels2);
+        // Already present
+        cache.put(12, data2, labels2);
+
+        ASSERT_EQUALS(cache.size(), 2U);
+        ASSERT_TRUE(cache.contains(12));
+        ASSERT_TRUE(cache.contains(3));
+
+        std::vector<cv::Mat> data;
+        std::vector<cv::Mat> labels;
+        ASSERT_TRUE(!cache.get(4, data, labels));
+        ASSERT_TRUE(cache.get(12, data, labels));
+        ASSERT_EQUALS(data.size(), 1U);
+        ASSERT_EQUALS(labels.size(), 1U);
+        ASSERT_TRUE(isEqual(data[0], data1[0]));
+        ASSERT_TRUE(isEqual(labels[0], labels1[0]));
+    }
+
+    // Re-open the cache
+    StimuliCache cache("StimuliCache/put_get");
+    ASSERT_EQUALS(cache.size(), 2U);
+
+    std::vector<cv::Mat> data;
+    std::vector<cv::Mat> labels;
+    ASSERT_TRUE(cache.get(3, data, labels));
+    ASSERT_EQUALS(data.size(), 2U);
+    ASSERT_EQUALS(labels.size(), 1U);
+    ASSERT_TRUE(isEqual(data[0], data2[0]));
+    ASSERT_TRUE(isEqual(data[1], data2[1]));
+    ASSERT_TRUE(isEqual(labels[0], labels2[0]));
+}
+
+TEST(StimuliCache, interrupted)
+{
+    Utils::createDirectories("StimuliCache");
+    std::remove("StimuliCache/interrupted.dat");
+    std::remove("StimuliCache/interrupted.idx");
+
+    {
+        StimuliCache cache("StimuliCache/interrupted");
+
+        for (unsigned int id = 0; id < 10; ++id) {
+            cache.put(id, std::vector<cv::Mat>(1, makeMat(4, 4, CV_8UC1, id)),
+                      std::vector<cv::Mat>(1, makeMat(1, 1, CV_32SC1, id)));
+        }
+    }
+
+    // Simulate a partially written index entry
+    {
+        std::ofstream index("StimuliCache/interrupted.idx",
+                            std::ios::binary | std::ios::app);
+        index.write("xxxx", 4);
+    }
+
+    StimuliCache cache("StimuliCache/interrupted");
+    ASSERT_EQUALS(cache.size(), 10U);
+
+    cache.put(10, std::vector<cv::Mat>(1, makeMat(4, 4, CV_8UC1, 10)),
+              std::vector<cv::Mat>(1, makeMat(1, 1, CV_32SC1, 10)));
+
+    // Concurrent reads
+    std::vector<int> valid(11, 0);
+
+#pragma omp parallel for
+    for (int id = 0; id < 11; ++id) {
+        std::vector<cv::Mat> data;
+        std::vector<cv::Mat> labels;
+
+        if (cache.get(id, data, labels))
+            valid[id] = isEqual(data[0], makeMat(4, 4, CV_8UC1, id));
+    }
+
+    for (int id = 0; id < 11; ++id) {
+        ASSERT_TRUE(valid[id]);
+    }
+}
+
+#ifdef __linux__
+/// Number of mappings of @p fileName in the process
+unsigned int nbMappings(const std::string& fileName)
+{
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    unsigned int nb = 0;
+
+    while (std::getline(maps, line)) {
+        if (line.find(fileName) != std::string::npos)
+            ++nb;
+    }
+
+    return nb;
+}
+
+TEST(StimuliCache, put_get__mappings)
+{
+    Utils::createDirectories("StimuliCache");
+    std::remove("StimuliCache/mappings.dat");
+    std::remove("StimuliCache/mappings.idx");
+
+    {
+        // First epoch: every stimulus is read right after it is cached
+        StimuliCache cache("StimuliCache/mappings");
+
+        for (unsigned int id = 0; id < 100; ++id) {
+            cache.put(id, std::vector<cv::Mat>(1, makeMat(8, 8, CV_8UC1, id)),
+                      std::vector<cv::Mat>(1, makeMat(1, 1, CV_32SC1, id)));
+
+            std::vector<cv::Mat> data;
+            std::vector<cv::Mat> labels;
+            ASSERT_TRUE(cache.get(id, data, labels));
+            ASSERT_TRUE(isEqual(data[0], makeMat(8, 8, CV_8UC1, id)));
+        }
+
+        ASSERT_EQUALS(nbMappings("mappings.dat"), 0U);
+    }
+
+    StimuliCache cache("StimuliCache/mappings");
+
+    for (unsigned int id = 0; id < 100; ++id) {
+        std::vector<cv::Mat> data;
+        std::vector<cv::Mat> labels;
+        ASSERT_TRUE(cache.get(id, data, labels));
+        ASSERT_TRUE(isEqual(labels[0], makeMat(1, 1, CV_32SC1, id)));
+    }
+
+    ASSERT_EQUALS(nbMappings("mappings.dat"), 1U);
+}
+#endif
+
+RUN_TESTS()
@@ -335,6 +335,37 @@ TEST_DATASET(StimuliProvider, databasePermutation,
 
 }
 */
+#if CV_MAJOR_VERSION > 3 || (CV_MAJOR_VERSION == 3 && CV_MINOR_VERSION >= 1)
+TEST(StimuliProvider, reducedDecode)
+{
+    DIR_Database database;
+    database.loadFile("tests_data/Lenna.png", "Lenna");
+    database.loadFile("tests_data/SIPI_Jelly_Beans_4.1.07.tiff", "Jelly_Beans");
+
+    StimuliProvider sp(database, {100, 100, 3});
+    sp.setParameter("ReducedDecode", true);
+    sp.addTransformation(RescaleTransformation(100, 100));
+
+    // The 512x512 PNG image is decoded at 1/4 of its resolution
+    ASSERT_EQUALS(database.getStimulusData(0).cols, 128);
+    ASSERT_EQUALS(database.getStimulusData(0).rows, 128);
+    // TIFF images are always decoded at full resolution
+    ASSERT_EQUALS(database.getStimulusData(1).cols, 256);
+    ASSERT_EQUALS(database.getStimulusData(1).rows, 256);
+
+    sp.readStimulus(0, Database::Learn);
+
+    ASSERT_EQUALS(sp.getData().dimX(), 100U);
+    ASSERT_EQUALS(sp.getData().dimY(), 100U);
+
+    sp.setParameter("ReducedDecode", false);
+    sp.updateDecodeSizeHint();
+
+    ASSERT_EQUALS(database.getStimulusData(0).cols, 512);
+    ASSERT_EQUALS(database.getStimulusData(0).rows, 512);
+}
+#endif
+
 TEST(StimuliProvider, readRandomBatch)
 {
     REQUIRED(UnitTest::DirExists(N2D2_DATA("mnist")));
@@ -366,6 +397,53 @@ TEST(StimuliProvider, readRandomBatch_bis)
     sp.readRandomBatch(Database::Test);
 }
 
+TEST(StimuliProvider, readPrefetchedBatch)
+{
+    REQUIRED(UnitTest::DirExists(N2D2_DATA("mnist")));
+
+    Random::mtSeed(0);
+
+    MNIST_IDX_Database database;
+    database.load(N2D2_DATA("mnist"));
+
+    StimuliProvider sp(database, {28, 28, 1}, 4, false);
+    StimuliProvider spRef(database, {28, 28, 1}, 1, false);
+    sp.setParameter("PrefetchDepth", 2U);
+    sp.setParameter("PrefetchThreads", 2U);
+    sp.setCachePath();
+    spRef.setCachePath();
+
+    ASSERT_EQUALS(sp.isPrefetching(), false);
+    ASSERT_THROW_ANY(sp.readPrefetchedBatch());
+
+    sp.startPrefetch(Database::Learn);
+    ASSERT_EQUALS(sp.isPrefetching(), true);
+
+    for (unsigned int b = 0; b < 10; ++b) {
+        sp.readPrefetchedBatch();
+
+        for (unsigned int batchPos = 0; batchPos < 4; ++batchPos) {
+            const int id = sp.getBatch()[batchPos];
+            ASSERT_TRUE(id >= 0);
+
+            // The prefetched data must match the stimulus read directly
+            spRef.readStimulus(id, Database::Learn);
+
+            const Tensor<Float_T> data = sp.getDataChannel(0, batchPos);
+            const Tensor<Float_T> ref = spRef.getDataChannel(0, 0);
+
+            ASSERT_EQUALS(sp.getLabelsData()[batchPos](0),
+                          database.getStimulusLabel(id));
+
+            for (unsigned int index = 0; index < data.size(); ++index)
+                ASSERT_EQUALS_DELTA(data(index), ref(index), 1e-6);
+        }
+    }
+
+    sp.stopPrefetch();
+    ASSERT_EQUALS(sp.isPrefetching(), false);
+}
+
 TEST(StimuliProvider, streamStimulus)
 {
     StimuliProvider sp(EmptyDatabase, {28, 28, 1}, 2, false);
@@ -0,0 +1,176 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+
+#include "containers/ParameterArena.hpp"
+#include "utils/UnitTest.hpp"
+
+using namespace N2D2;
+
+TEST(ParameterArena, initialize)
+{
+    Tensor<float> weights({3, 5});
+    Tensor<float> bias({7});
+    Tensor<float> diffWeights({3, 5});
+    Tensor<float> diffBias({7});
+
+    for (unsigned int i = 0; i < weights.size(); ++i) {
+        weights(i) = 1.0f + i;
+        diffWeights(i) = -1.0f - i;
+    }
+
+    for (unsigned int i = 0; i < bias.size(); ++i) {
+        bias(i) = 100.0f + i;
+        diffBias(i) = -100.0f - i;
+    }
+
+    // A copy shares the data of the tensor before the arena initialization
+    const Tensor<float> weightsCopy = weights;
+
+    ParameterArena<float> arena;
+    arena.addParameters(weights);
+    arena.addParameters(bias);
+    arena.addParameters(weights);
+    arena.addGradients(diffWeights);
+    arena.addGradients(diffBias);
+    arena.initialize();
+
+    ASSERT_TRUE(arena.isInitialized());
+    ASSERT_EQUALS(arena.getNbParametersTensors(), 2U);
+    ASSERT_EQUALS(arena.getNbGradientsTensors(), 2U);
+    // 15 -> 16 and 7 -> 16 floats, with a 64 bytes alignment
+    ASSERT_EQUALS(arena.getParametersSize(), 32U);
+    ASSERT_EQUALS(arena.getGradientsSize(), 32U);
+    ASSERT_THROW(arena.addParameters(bias), std::runtime_error);
+
+    ASSERT_EQUALS(reinterpret_cast<std::uintptr_t>(arena.getParameters())
+                  % ParameterArena<float>::Alignment, 0U);
+    ASSERT_EQUALS(reinterpret_cast<std::uintptr_t>(&bias(0))
+                  % ParameterArena<float>::Alignment, 0U);
+    ASSERT_TRUE(&weights(0) == arena.getParameters());
+    ASSERT_TRUE(&bias(0) == arena.getParameters() + 16);
+    ASSERT_TRUE(&diffBias(0) == arena.getGradients() + 16);
+
+    for (unsigned int i = 0; i < weights.size(); ++i) {
+        ASSERT_EQUALS(weights(i), 1.0f + i);
+        ASSERT_EQUALS(diffWeights(i), -1.0f - i);
+    }
+
+    for (unsigned int i = 0; i < bias.size(); ++i) {
+        ASSERT_EQUALS(bias(i), 100.0f + i);
+        ASSERT_EQUALS(diffBias(i), -100.0f - i);
+    }
+
+    // Padding
+    ASSERT_EQUALS(arena.getParameters()[15], 0.0f);
+    ASSERT_EQUALS(arena.getParameters()[31], 0.0f);
+
+    weights(2) = 42.0f;
+    ASSERT_EQUALS(arena.getParameters()[2], 42.0f);
+    ASSERT_EQUALS(weightsCopy(2), 3.0f);
+}
+
+TEST(ParameterArena, snapshot)
+{
+    Tensor<float> weights({10, 3}, 1.0f);
+    Tensor<float> bias({3}, 2.0f);
+
+    ParameterArena<float> arena;
+    arena.addParameters(weights);
+    arena.addParameters(bias);
+    arena.initialize();
+
+    std::vector<float> snapshot;
+    arena.snapshot(snapshot);
+
+    ASSERT_EQUALS(snapshot.size(), arena.getParametersSize());
+
+    weights.fill(-1.0f);
+    bias.fill(-2.0f);
+    arena.restore(snapshot);
+
+    for (unsigned int i = 0; i < weights.size(); ++i)
+        ASSERT_EQUALS(weights(i), 1.0f);
+
+    for (unsigned int i = 0; i < bias.size(); ++i)
+        ASSERT_EQUALS(bias(i), 2.0f);
+
+    ASSERT_THROW(arena.restore(std::vector<float>(3)), std::runtime_error);
+
+    // Save/load
+    const std::string fileName = "ParameterArena_snapshot.dat";
+    arena.save(fileName);
+
+    weights.fill(0.0f);
+    bias.fill(0.0f);
+    arena.load(fileName);
+    std::remove(fileName.c_str());
+
+    ASSERT_EQUALS(weights(29), 1.0f);
+    ASSERT_EQUALS(bias(2), 2.0f);
+}
+
+TEST_DATASET(ParameterArena,
+             clipGradientsNorm,
+             (unsigned int size, double maxNorm),
+             std::make_tuple(10U, 1.0),
+             std::make_tuple(10U, 1000.0),
+             std::make_tuple(100000U, 10.0))
+{
+    Tensor<float> diffWeights({size});
+    Tensor<float> diffBias({3});
+    double sumSq = 0.0;
+
+    for (unsigned int i = 0; i < size; ++i) {
+        diffWeights(i) = (i % 7) * 0.25f - 0.5f;
+        sumSq += diffWeights(i) * diffWeights(i);
+    }
+
+    for (unsigned int i = 0; i < 3; ++i) {
+        diffBias(i) = 1.0f + i;
+        sumSq += diffBias(i) * diffBias(i);
+    }
+
+    ParameterArena<float> arena;
+    arena.addGradients(diffWeights);
+    arena.addGradients(diffBias);
+    arena.initialize();
+
+    ASSERT_EQUALS_DELTA(arena.getGradientsNorm(), std::sqrt(sumSq),
+                        1.0e-6 * std::sqrt(sumSq));
+
+    const double norm = arena.clipGradientsNorm(maxNorm);
+
+    ASSERT_EQUALS_DELTA(norm, std::sqrt(sumSq), 1.0e-6 * std::sqrt(sumSq));
+    ASSERT_EQUALS_DELTA(arena.getGradientsNorm(),
+                        std::min(norm, maxNorm), 1.0e-5 * maxNorm);
+
+    if (norm <= maxNorm) {
+        ASSERT_EQUALS(diffBias(2), 3.0f);
+    }
+    else {
+        ASSERT_EQUALS_DELTA(diffBias(2), 3.0 * maxNorm / norm, 1.0e-6);
+    }
+}
+
+RUN_TESTS()
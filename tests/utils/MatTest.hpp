@@ -0,0 +1,60 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#ifndef N2D2_MATTEST_H
+#define N2D2_MATTEST_H
+
+#include <algorithm>
+#include <cstddef>
+
+#include "utils/Utils.hpp"
+
+namespace N2D2 {
+namespace MatTest {
+    /// Matrix filled with a deterministic pattern depending on @p seed
+    inline cv::Mat makeMat(int rows, int cols, int type, int seed)
+    {
+        cv::Mat mat(rows, cols, type);
+        unsigned char* data = mat.ptr<unsigned char>(0);
+
+        for (size_t i = 0; i < mat.elemSize() * rows * cols; ++i)
+            data[i] = (unsigned char)(seed + 7 * i);
+
+        return mat;
+    }
+
+    /// True if both matrices have the same size, type and data
+    inline bool isEqual(const cv::Mat& mat1, const cv::Mat& mat2)
+    {
+        if (mat1.rows != mat2.rows || mat1.cols != mat2.cols
+            || mat1.type() != mat2.type())
+        {
+            return false;
+        }
+
+        const size_t size = mat1.elemSize() * mat1.rows * mat1.cols;
+        return std::equal(mat1.ptr<unsigned char>(0),
+                          mat1.ptr<unsigned char>(0) + size,
+                          mat2.ptr<unsigned char>(0));
+    }
+}
+}
+
+#endif // N2D2_MATTEST_H
@@ -19,6 +19,7 @@
 */
 
 #include "utils/ConfusionMatrix.hpp"
+#include "utils/Random.hpp"
 #include "utils/UnitTest.hpp"
 #include "utils/Utils.hpp"
 
@@ -61,4 +62,56 @@ TEST(ConfusionMatrix, ConfusionTable)
     ASSERT_EQUALS(confTable2.tn(), 13);
 }
 
+TEST_DATASET(ConfusionMatrix,
+             accumulate,
+             (unsigned int nbTargets, unsigned int size),
+             std::make_tuple(3U, 5U),
+             std::make_tuple(3U, 1000U),
+             std::make_tuple(19U, 100U),
+             std::make_tuple(19U, 65536U))
+{
+    Random::mtSeed(0);
+
+    std::vector<int> targets(size);
+    std::vector<int> estimated(size);
+
+    for (unsigned int i = 0; i < size; ++i) {
+        // Runs of identical pairs, like in segmentation maps
+        if (i > 0 && Random::randUniform() < 0.8) {
+            targets[i] = targets[i - 1];
+            estimated[i] = estimated[i - 1];
+        }
+        else {
+            targets[i] = Random::randUniform(-1, (int)nbTargets - 1);
+            estimated[i] = Random::randUniform(0, (int)nbTargets - 1);
+        }
+    }
+
+    ConfusionMatrix<unsigned long long int> conf(nbTargets, nbTargets, 0);
+    ConfusionMatrix<unsigned long long int> confRef(nbTargets, nbTargets, 0);
+
+    conf.accumulate(&targets[0], &estimated[0], size);
+
+    for (unsigned int i = 0; i < size; ++i) {
+        if (targets[i] >= 0)
+            confRef(targets[i], estimated[i]) += 1ULL;
+    }
+
+    ASSERT_TRUE(conf == confRef);
+
+    // Accumulation of two halves
+    ConfusionMatrix<unsigned long long int> confHalf(nbTargets, nbTargets, 0);
+    ConfusionMatrix<unsigned long long int> confSum;
+
+    confHalf.accumulate(&targets[0], &estimated[0], size / 2);
+    confSum += confHalf;
+
+    std::fill(confHalf.begin(), confHalf.end(), 0ULL);
+    confHalf.accumulate(&targets[size / 2], &estimated[size / 2],
+                        size - size / 2);
+    confSum += confHalf;
+
+    ASSERT_TRUE(confSum == confRef);
+}
+
 RUN_TESTS()
@@ -0,0 +1,246 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "Solver/SGDSolver_Frame.hpp"
+#include "utils/RingAllReduce.hpp"
+#include "utils/UnitTest.hpp"
+
+#ifndef WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace N2D2;
+
+#ifndef WIN32
+namespace {
+    std::string ringAddress()
+    {
+        std::ostringstream addressStr;
+        addressStr << "/tmp/n2d2_test_ring_" << getpid();
+        return addressStr.str();
+    }
+
+    /// Fork the ranks > 0, which return their exit status through @p pids
+    unsigned int forkRanks(unsigned int size, std::vector<pid_t>& pids)
+    {
+        for (unsigned int rank = 1; rank < size; ++rank) {
+            const pid_t pid = fork();
+
+            if (pid == 0)
+                return rank;
+
+            pids.push_back(pid);
+        }
+
+        return 0;
+    }
+
+    bool waitRanks(const std::vector<pid_t>& pids)
+    {
+        bool success = true;
+
+        for (std::vector<pid_t>::const_iterator it = pids.begin(),
+            itEnd = pids.end(); it != itEnd; ++it)
+        {
+            int status;
+
+            if (waitpid(*it, &status, 0) < 0 || !WIFEXITED(status)
+                || WEXITSTATUS(status) != EXIT_SUCCESS)
+            {
+                success = false;
+            }
+        }
+
+        return success;
+    }
+}
+
+TEST_DATASET(RingAllReduce,
+             allReduce,
+             (unsigned int size, unsigned int count, std::size_t chunkSize),
+             std::make_tuple(1U, 10U, 1024U),
+             std::make_tuple(2U, 10U, 1024U),
+             std::make_tuple(3U, 1000U, 64U),
+             std::make_tuple(4U, 3U, 1024U),
+             std::make_tuple(4U, 100000U, 4096U),
+             std::make_tuple(5U, 1237U, 8U))
+{
+    const std::string address = ringAddress();
+    std::vector<pid_t> pids;
+    const unsigned int rank = forkRanks(size, pids);
+
+    std::vector<double> data(count);
+
+    for (unsigned int i = 0; i < count; ++i)
+        data[i] = rank * 1000.0 + i;
+
+    bool success = true;
+
+    try {
+        RingAllReduce comm(rank, size, address, chunkSize);
+        comm.allReduce(&data[0], data.size());
+
+        for (unsigned int i = 0; i < count; ++i) {
+            if (data[i] != 1000.0 * size * (size - 1) / 2.0 + size * i)
+                success = false;
+        }
+    }
+    catch (const std::exception& /*e*/) {
+        success = false;
+    }
+
+    if (rank > 0)
+        _exit((success) ? EXIT_SUCCESS : EXIT_FAILURE);
+
+    ASSERT_TRUE(success);
+    ASSERT_TRUE(waitRanks(pids));
+}
+
+TEST(RingAllReduce, average)
+{
+    const unsigned int size = 3;
+    const std::string address = ringAddress();
+    std::vector<pid_t> pids;
+    const unsigned int rank = forkRanks(size, pids);
+
+    Tensor<float> gradients({4, 5}, 2.0f * rank);
+    int value = (rank == 0) ? 42 : rank;
+    bool success = true;
+
+    try {
+        RingAllReduce comm(rank, size, address);
+        comm.average(gradients);
+        comm.broadcast(&value, 1);
+        comm.barrier();
+
+        for (unsigned int i = 0; i < gradients.size(); ++i) {
+            if (std::fabs(gradients(i) - 2.0f) > 1.0e-6f)
+                success = false;
+        }
+
+        if (value != 42)
+            success = false;
+    }
+    catch (const std::exception& /*e*/) {
+        success = false;
+    }
+
+    if (rank > 0)
+        _exit((success) ? EXIT_SUCCESS : EXIT_FAILURE);
+
+    ASSERT_TRUE(success);
+    ASSERT_TRUE(waitRanks(pids));
+}
+
+TEST(RingAllReduce, average__view)
+{
+    const unsigned int size = 2;
+    const std::string address = ringAddress();
+    std::vector<pid_t> pids;
+    const unsigned int rank = forkRanks(size, pids);
+
+    Tensor<float> buffer({4, 5, 3}, 2.0f + 2.0f * rank);
+    // View on the middle slice only
+    Tensor<float> gradients = buffer[1];
+    bool success = true;
+
+    try {
+        RingAllReduce comm(rank, size, address);
+        comm.average(gradients);
+
+        for (unsigned int i = 0; i < gradients.size(); ++i) {
+            if (std::fabs(gradients(i) - 3.0f) > 1.0e-6f)
+                success = false;
+        }
+
+        // The rest of the shared buffer is left untouched
+        for (unsigned int b = 0; b < buffer.dimB(); ++b) {
+            if (b == 1)
+                continue;
+
+            for (unsigned int i = 0; i < buffer[b].size(); ++i) {
+                if (buffer[b](i) != 2.0f + 2.0f * rank)
+                    success = false;
+            }
+        }
+    }
+    catch (const std::exception& /*e*/) {
+        success = false;
+    }
+
+    if (rank > 0)
+        _exit((success) ? EXIT_SUCCESS : EXIT_FAILURE);
+
+    ASSERT_TRUE(success);
+    ASSERT_TRUE(waitRanks(pids));
+}
+
+TEST(RingAllReduce, gradientReduction__reducedGradients)
+{
+    const unsigned int size = 2;
+    const std::string address = ringAddress();
+    std::vector<pid_t> pids;
+    const unsigned int rank = forkRanks(size, pids);
+
+    Tensor<float> data({4, 5}, 0.0f);
+    // Gradients already averaged in a single reduction of the parameter
+    // arena (see DeepNet::update())
+    Tensor<float> reducedGradients({4, 5}, 1.0f + rank);
+    Tensor<float> gradients({4, 5}, 1.0f + 2.0f * rank);
+    bool success = true;
+
+    try {
+        Solver::mGradientReduction
+            = std::make_shared<RingAllReduce>(rank, size, address);
+
+        SGDSolver_Frame<float> solver;
+        solver.setParameter("LearningRate", 0.01);
+
+        Solver::mReducedGradients = std::make_pair(&reducedGradients(0),
+            &reducedGradients(0) + reducedGradients.size());
+        solver.update(data, reducedGradients, 1);
+
+        Solver::mReducedGradients = std::pair<const void*, const void*>();
+        solver.update(data, gradients, 1);
+
+        for (unsigned int i = 0; i < gradients.size(); ++i) {
+            if (reducedGradients(i) != 1.0f + rank
+                || std::fabs(gradients(i) - 2.0f) > 1.0e-6f)
+            {
+                success = false;
+            }
+        }
+    }
+    catch (const std::exception& /*e*/) {
+        success = false;
+    }
+
+    Solver::mGradientReduction.reset();
+
+    if (rank > 0)
+        _exit((success) ? EXIT_SUCCESS : EXIT_FAILURE);
+
+    ASSERT_TRUE(success);
+    ASSERT_TRUE(waitRanks(pids));
+}
+#endif
+
+RUN_TESTS()
@@ -0,0 +1,140 @@
+/*
+    (C) Copyright 2021 CEA LIST. All Rights Reserved.
+    Contributor(s): Olivier BICHLER (olivier.bichler@cea.fr)
+
+    This software is governed by the CeCILL-C license under French law and
+    abiding by the rules of distribution of free software.  You can  use,
+    modify and/ or redistribute the software under the terms of the CeCILL-C
+    license as circulated by CEA, CNRS and INRIA at the following URL
+    "http://www.cecill.info".
+
+    As a counterpart to the access to the source code and  rights to copy,
+    modify and redistribute granted by the license, users are provided only
+    with a limited warranty  and the software's author,  the holder of the
+    economic rights,  and the successive licensors  have only  limited
+    liability.
+
+    The fact that you are presently reading this means that you have had
+    knowledge of the CeCILL-C license and that you accept its terms.
+*/
+
+#include "third_party/half.hpp"
+#include "utils/Gemm.hpp"
+#include "utils/Random.hpp"
+#include "utils/UnitTest.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace N2D2;
+
+/// Maximum absolute difference between Gemm::gemm() and a naive double
+/// precision matrix product
+template <class T>
+double gemmError(bool transA, bool transB, int m, int n, int k)
+{
+    Random::mtSeed(0);
+
+    // Leading dimensions larger than the matrices, to check strides
+    const int lda = ((transA) ? k : m) + 3;
+    const int ldb = ((transB) ? n : k) + 1;
+    const int ldc = m + 2;
+
+    std::vector<T> A((size_t)lda * ((transA) ? m : k));
+    std::vector<T> B((size_t)ldb * ((transB) ? k : n));
+    std::vector<T> C((size_t)ldc * n);
+
+    for (typename std::vector<T>::iterator it = A.begin(); it != A.end(); ++it)
+        (*it) = Random::randUniform(-1.0, 1.0);
+
+    for (typename std::vector<T>::iterator it = B.begin(); it != B.end(); ++it)
+        (*it) = Random::randUniform(-1.0, 1.0);
+
+    for (typename std::vector<T>::iterator it = C.begin(); it != C.end(); ++it)
+        (*it) = Random::randUniform(-1.0, 1.0);
+
+    const T alpha(0.7);
+    const T beta(0.3);
+    std::vector<double> R(C.begin(), C.end());
+
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < m; ++i) {
+            double sum = 0.0;
+
+            for (int p = 0; p < k; ++p) {
+                const double a = (transA) ? A[p + i * lda] : A[i + p * lda];
+                const double b = (transB) ? B[j + p * ldb] : B[p + j * ldb];
+                sum += a * b;
+            }
+
+            R[i + j * ldc] = alpha * sum + beta * R[i + j * ldc];
+        }
+    }
+
+    Gemm::gemm<T>((transA) ? Gemm::Trans : Gemm::NoTrans,
+                  (transB) ? Gemm::Trans : Gemm::NoTrans,
+                  m, n, k,
+                  &alpha, &A[0], lda, &B[0], ldb,
+                  &beta, &C[0], ldc);
+
+    double error = 0.0;
+
+    for (int j = 0; j < n; ++j) {
+        for (int i = 0; i < m; ++i) {
+            error = std::max(error,
+                             std::fabs(C[i + j * ldc] - R[i + j * ldc]));
+        }
+    }
+
+    return error;
+}
+
+TEST_DATASET(Gemm,
+             gemm,
+             (bool transA, bool transB, int m, int n, int k),
+             std::make_tuple(false, false, 1, 1, 1),
+             std::make_tuple(false, false, 7, 5, 3),
+             std::make_tuple(false, true, 130, 9, 300),
+             std::make_tuple(true, false, 257, 33, 513),
+             std::make_tuple(true, true, 64, 2100, 17),
+             std::make_tuple(false, false, 3, 3000, 600))
+{
+    ASSERT_EQUALS_DELTA(gemmError<double>(transA, transB, m, n, k),
+                        0.0, 1.0e-9);
+}
+
+// The float register tile is 16 x 6 and the cache blocks are 128 (m) x 256
+// (k) x 2048 (n): the sizes cover partial tiles and partial blocks
+TEST_DATASET(Gemm,
+             gemm__float,
+             (bool transA, bool transB, int m, int n, int k),
+             std::make_tuple(false, false, 1, 1, 1),
+             std::make_tuple(false, false, 15, 5, 3),
+             std::make_tuple(false, false, 17, 7, 257),
+             std::make_tuple(false, true, 33, 13, 100),
+             std::make_tuple(true, false, 129, 11, 31),
+             std::make_tuple(true, true, 47, 2053, 19),
+             std::make_tuple(false, false, 145, 19, 521))
+{
+    ASSERT_EQUALS_DELTA(gemmError<float>(transA, transB, m, n, k),
+                        0.0, 1.0e-4);
+}
+
+// The half products are accumulated in float: the error comes from the
+// rounding of C to half precision after each k block
+TEST_DATASET(Gemm,
+             gemm__half,
+             (bool transA, bool transB, int m, int n, int k),
+             std::make_tuple(false, false, 1, 1, 1),
+             std::make_tuple(false, false, 15, 5, 3),
+             std::make_tuple(false, true, 33, 13, 100),
+             std::make_tuple(true, false, 129, 11, 31),
+             std::make_tuple(true, true, 47, 53, 19),
+             std::make_tuple(false, false, 145, 19, 521))
+{
+    ASSERT_EQUALS_DELTA(gemmError<half_float::half>(transA, transB, m, n, k),
+                        0.0, 5.0e-2);
+}
+
+RUN_TESTS()